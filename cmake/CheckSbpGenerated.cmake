@@ -0,0 +1,48 @@
+# Regenerate the SBP message code into GENERATED_DIR and fail if any of it
+# differs from the copy committed in SOURCE_DIR.
+#
+# cmake -DPYTHON_EXECUTABLE=... -DSOURCE_DIR=... -DGENERATED_DIR=...
+#       -P CheckSbpGenerated.cmake
+
+set(SBP_GENERATED_FILES
+  include/libswiftnav/sbp_messages.h
+  tests/check_sbp_messages.c
+  sbp_generate/sbp_messages.py
+)
+
+file(REMOVE_RECURSE ${GENERATED_DIR})
+file(MAKE_DIRECTORY
+  ${GENERATED_DIR}/include/libswiftnav
+  ${GENERATED_DIR}/tests
+  ${GENERATED_DIR}/sbp_generate
+)
+
+execute_process(
+  COMMAND ${PYTHON_EXECUTABLE} generate.py ${GENERATED_DIR}
+  WORKING_DIRECTORY ${SOURCE_DIR}/sbp_generate
+  RESULT_VARIABLE GENERATE_RESULT
+)
+if (NOT GENERATE_RESULT EQUAL 0)
+  message(FATAL_ERROR "sbp_generate/generate.py failed: ${GENERATE_RESULT}")
+endif (NOT GENERATE_RESULT EQUAL 0)
+
+set(SBP_GENERATED_STALE)
+foreach(f ${SBP_GENERATED_FILES})
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files
+            ${SOURCE_DIR}/${f} ${GENERATED_DIR}/${f}
+    RESULT_VARIABLE COMPARE_RESULT
+  )
+  if (NOT COMPARE_RESULT EQUAL 0)
+    list(APPEND SBP_GENERATED_STALE ${f})
+  endif (NOT COMPARE_RESULT EQUAL 0)
+endforeach(f)
+
+if (SBP_GENERATED_STALE)
+  message(FATAL_ERROR
+    "Generated SBP files out of date: ${SBP_GENERATED_STALE}\n"
+    "Regenerate them by running generate.py in sbp_generate/, the fresh "
+    "copies are in ${GENERATED_DIR}")
+endif (SBP_GENERATED_STALE)
+
+message(STATUS "Generated SBP files are up to date")
@@ -41,6 +41,7 @@ void nkf_update(nkf_t *kf, double *measurements);
 void assign_de_mtx(u8 num_sats, sdiff_t *sats_with_ref_first, double ref_ecef[3], double *DE);
 
 void assign_phase_obs_null_basis(u8 num_dds, double *DE_mtx, double *q);
+void invert_U(u8 res_dim, double *U);
 void set_nkf(nkf_t *kf, double amb_drift_var, double phase_var, double code_var, double amb_init_var,
             u8 num_sdiffs, sdiff_t *sdiffs_with_ref_first, double *dd_measurements, double ref_ecef[3]);
 void set_nkf_matrices(nkf_t *kf, double phase_var, double code_var,
@@ -45,6 +45,9 @@ typedef struct {
   residual_mtxs_t res_mtxs;
   sats_management_t sats;
   unanimous_amb_check_t amb_check;
+  /* Working area for the hash group by in ambiguity_sat_projection(). */
+  u64 group_buff[(MEMORY_POOL_GROUP_BY_HASH_BUFF_SIZE(MAX_HYPOTHESES) +
+                  sizeof(u64) - 1) / sizeof(u64)];
 } ambiguity_test_t;
 
 void print_s32_mtx_diff(u32 m, u32 n, s32 *Z_inv1, s32 *Z_inv2);
@@ -80,14 +83,15 @@ s8 make_ambiguity_dd_measurements_and_sdiffs(ambiguity_test_t *amb_test, u8 num_
 s8 make_dd_measurements_and_sdiffs(u8 ref_prn, u8 *non_ref_prns, u8 num_dds,
                                    u8 num_sdiffs, sdiff_t *sdiffs,
                                    double *ambiguity_dd_measurements, sdiff_t *amb_sdiffs);
-u8 ambiguity_sat_projection(ambiguity_test_t *amb_test, u8 num_dds_in_intersection, u8 *dd_intersection_ndxs);
+s8 ambiguity_sat_projection(ambiguity_test_t *amb_test, u8 num_dds_in_intersection, u8 *dd_intersection_ndxs);
 u8 ambiguity_sat_inclusion(ambiguity_test_t *amb_test, u8 num_dds_in_intersection,
                              sats_management_t *float_sats, double *float_mean, double *float_cov_U, double *float_cov_D);
 u32 float_to_decor(ambiguity_test_t *amb_test,
                    double *addible_float_cov, u8 num_addible_dds,
                    double *addible_float_mean,
                    u8 num_dds_to_add,
-                   s32 *lower_bounds, s32 *upper_bounds, double *Z);
+                   s32 *lower_bounds, s32 *upper_bounds, double *Z,
+                   double *Z_inv);
 s8 determine_sats_addition(ambiguity_test_t *amb_test,
                            double *float_N_cov, u8 num_float_dds, double *float_N_mean,
                            s32 *lower_bounds, s32 *upper_bounds, u8 *num_dds_to_add,
@@ -15,9 +15,43 @@
 
 #include "common.h"
 
+/** Cursor for reading sequential bit fields from a buffer.
+ * See bit_reader_init(). */
+typedef struct {
+  const u8 *buff; /**< Buffer being read. */
+  u32 len;        /**< Length of the buffer in bytes. */
+  u32 byte_pos;   /**< Index of the next byte to load into the cache. */
+  u64 cache;      /**< Bits loaded but not yet read, most significant first. */
+  u32 n_cached;   /**< Number of bits in the cache. */
+  u8 overrun;     /**< Set if a read went past the end of the buffer. */
+} bit_reader_t;
+
+/** Cursor for writing sequential bit fields into a buffer.
+ * See bit_writer_init(). */
+typedef struct {
+  u8 *buff;       /**< Buffer being written. */
+  u32 len;        /**< Length of the buffer in bytes. */
+  u32 byte_pos;   /**< Index of the next byte to be written. */
+  u64 cache;      /**< Bits not yet written, most significant first. */
+  u32 n_cached;   /**< Number of bits in the cache, always less than 8
+                       between calls. */
+  u8 overrun;     /**< Set if a write went past the end of the buffer. */
+} bit_writer_t;
+
 u32 getbitu(const u8 *buff, u32 pos, u8 len);
 s32 getbits(const u8 *buff, u32 pos, u8 len);
 void setbitu(u8 *buff, u32 pos, u32 len, u32 data);
 void setbits(u8 *buff, u32 pos, u32 len, s32 data);
 
+void bit_reader_init(bit_reader_t *r, const u8 *buff, u32 len, u32 pos);
+u32 bit_reader_getu(bit_reader_t *r, u8 len);
+s32 bit_reader_gets(bit_reader_t *r, u8 len);
+u32 bit_reader_pos(bit_reader_t *r);
+
+void bit_writer_init(bit_writer_t *w, u8 *buff, u32 len, u32 pos);
+void bit_writer_setu(bit_writer_t *w, u8 len, u32 data);
+void bit_writer_sets(bit_writer_t *w, u8 len, s32 data);
+void bit_writer_flush(bit_writer_t *w);
+u32 bit_writer_pos(bit_writer_t *w);
+
 #endif /* LIBSWIFTNAV_BITS_H */
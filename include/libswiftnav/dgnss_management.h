@@ -13,6 +13,7 @@
 
 #include "amb_kf.h"
 #include "sats_management.h"
+#include "memory_pool.h"
 
 #define DEFAULT_PHASE_VAR_TEST  (9e-4 * 16)
 #define DEFAULT_CODE_VAR_TEST   (100 * 400)
@@ -54,6 +55,7 @@ sats_management_t * get_sats_management(void);
 
 s8 dgnss_iar_resolved(void);
 u32 dgnss_iar_num_hyps(void);
+void dgnss_iar_pool_stats(memory_pool_stats_t *stats);
 u32 dgnss_iar_num_sats(void);
 s8 dgnss_iar_get_single_hyp(double *hyp);
 void dgnss_reset_iar(void);
@@ -16,6 +16,10 @@
 #include "common.h"
 
 u16 crc16_ccitt(const u8 *buf, u32 len, u16 crc);
+u16 crc16_ccitt_bytewise(const u8 *buf, u32 len, u16 crc);
+u16 crc16_ccitt_slice8(const u8 *buf, u32 len, u16 crc);
 u32 crc24q(const u8 *buf, u32 len, u32 crc);
+u32 crc24q_bytewise(const u8 *buf, u32 len, u32 crc);
+u32 crc24q_slice8(const u8 *buf, u32 len, u32 crc);
 
 #endif /* LIBSWIFTNAV_EDC_H */
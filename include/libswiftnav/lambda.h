@@ -15,9 +15,80 @@
 #define LIBSWIFTNAV_LAMBDA_H
 
 #include "common.h"
+#include "constants.h"
+#include "parallel.h"
+
+/** Largest problem dimension supported by the workspace LAMBDA functions. */
+#define LAMBDA_MAX_DIM (MAX_CHANNELS - 1)
+/** Largest number of candidates supported by lambda_solution_ws(). */
+#define LAMBDA_MAX_CANDS 4
+
+/** Number of upper search tree levels lambda_search_parallel() splits into
+ * independent subtrees. */
+#define LAMBDA_PAR_SPLIT 2
+/** Maximum number of subtrees lambda_search_parallel() will split into. */
+#define LAMBDA_PAR_MAX_TASKS 256
+/** Maximum number of worker threads used by lambda_search_parallel(). */
+#define LAMBDA_PAR_MAX_THREADS PARALLEL_MAX_THREADS
+
+/** Caller owned working storage for lambda_reduction_ws() and
+ * lambda_solution_ws(), sized for #LAMBDA_MAX_DIM so that neither function
+ * needs any stack VLAs or heap allocation. The contents are scratch only and
+ * do not need initialising. */
+typedef struct {
+  double L[LAMBDA_MAX_DIM * LAMBDA_MAX_DIM];
+  double D[LAMBDA_MAX_DIM];
+  double A[LAMBDA_MAX_DIM * LAMBDA_MAX_DIM];
+  double Z[LAMBDA_MAX_DIM * LAMBDA_MAX_DIM];
+  double Zi[LAMBDA_MAX_DIM * LAMBDA_MAX_DIM];
+  double z[LAMBDA_MAX_DIM];
+  double E[LAMBDA_MAX_DIM * LAMBDA_MAX_CANDS];
+  double dist[LAMBDA_MAX_DIM];
+  double zb[LAMBDA_MAX_DIM];
+  double zc[LAMBDA_MAX_DIM];
+  double step[LAMBDA_MAX_DIM];
+  double Lp[LAMBDA_MAX_DIM * LAMBDA_MAX_DIM];
+} lambda_workspace_t;
+
+/** Options for lambda_search_ws(). */
+typedef struct {
+  /** Number of candidates to return, at most #LAMBDA_MAX_CANDS. */
+  int m;
+  /** Partial ambiguity resolution: fix the largest subset of decorrelated
+   * ambiguities whose bootstrapped success rate is at least this. `<= 0`
+   * fixes all of them. */
+  double min_success_rate;
+  /** Ratio test threshold used to prune the search, `<= 0` disables. */
+  double ratio;
+  /** Node expansion budget, `0` uses the library default. */
+  u32 max_nodes;
+} lambda_search_params_t;
+
+/** Statistics reported by lambda_search_ws(). */
+typedef struct {
+  u32 nodes;           /**< Search loop iterations (node expansions). */
+  u32 leaves;          /**< Full integer vectors evaluated. */
+  u32 n_cands;         /**< Number of valid candidates returned. */
+  u8 n_fixed;          /**< Number of decorrelated ambiguities fixed. */
+  u8 ratio_passed;     /**< Ratio test passed with the given threshold. */
+  double success_rate; /**< Bootstrapped success rate of the fixed subset. */
+  double ratio;        /**< s[1] / s[0], or the threshold if pruned. */
+} lambda_search_stats_t;
 
 int lambda_reduction(int n, const double *Q, double *Z);
 int lambda_solution(int n, int m, const double *a, const double *Q, double *F, 
                       double *s); 
+int lambda_reduction_ws(lambda_workspace_t *ws, int n, const double *Q,
+                        double *Z);
+int lambda_solution_ws(lambda_workspace_t *ws, int n, int m, const double *a,
+                       const double *Q, double *F, double *s);
+int lambda_search_ws(lambda_workspace_t *ws, int n, const double *a,
+                     const double *Q, const lambda_search_params_t *params,
+                     double *F, double *s, lambda_search_stats_t *stats);
+int lambda_search_parallel(lambda_workspace_t *ws, int n, const double *a,
+                           const double *Q,
+                           const lambda_search_params_t *params,
+                           u32 n_threads, double *F, double *s,
+                           lambda_search_stats_t *stats);
 
 #endif /* LIBSWIFTNAV_LAMBDA_H */
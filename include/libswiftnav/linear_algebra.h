@@ -58,6 +58,16 @@ int matrix_atwaiat(u32 n, u32 m, const double *a, const double *w, double *b);
 int matrix_ataiat(u32 n, u32 m, const double *a, double *b);
 int matrix_atawati(u32 n, u32 m, const double *a, const double *w, double *b);
 int matrix_ataati(u32 n, u32 m, const double *a, double *b);
+void matrix_atwa(u32 n, u32 m, const double *a, const double *w,
+                 double *c);
+s32 matrix_cholesky(u32 n, const double *a, double *l);
+void matrix_cholesky_solve(u32 n, const double *l, const double *b,
+                           double *x);
+void matrix_cholesky_inverse(u32 n, const double *l, double *b);
+s32 solve_normal_equations(u32 n, u32 m, const double *a, const double *w,
+                           const double *y, double *x, double *l);
+s32 weighted_least_squares(u32 n, u32 m, const double *a, const double *w,
+                           const double *y, double *x);
 
 double vector_dot(u32 n, const double *a, const double *b);
 double vector_norm(u32 n, const double *a);
@@ -70,5 +80,20 @@ void vector_subtract(u32 n, const double *a,
                      const double *b, double *c);
 void vector_cross(const double a[3], const double b[3], double c[3]);
 
+/* Portable reference implementations of the SIMD primitives above. */
+void matrix_multiply_scalar(u32 n, u32 m, u32 p, const double *a,
+                            const double *b, double *c);
+void matrix_add_sc_scalar(u32 n, u32 m, const double *a,
+                          const double *b, double gamma, double *c);
+void matrix_transpose_scalar(u32 n, u32 m, const double *a, double *b);
+double vector_dot_scalar(u32 n, const double *a, const double *b);
+double vector_norm_scalar(u32 n, const double *a);
+void vector_add_sc_scalar(u32 n, const double *a, const double *b,
+                          double gamma, double *c);
+
+const char *linear_algebra_backend(void);
+const char *linear_algebra_simd(void);
+void linear_algebra_backend_report(void);
+
 #endif  /* LIBSWIFTNAV_LINEAR_ALGEBRA_H */
 
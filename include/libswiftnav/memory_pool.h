@@ -16,12 +16,64 @@
 #include <stddef.h>
 
 #include "common.h"
+#include "parallel.h"
 
 /* Type for elements of the memory pool, unfortunately typedef doesn't enforce
  * type safety and an opaque struct definition wouldn't be compatible with the
  * flexible member array in node_t. */
 typedef u8 element_t;
 
+/** Maximum element size in bytes supported by memory_pool_group_by_hash()
+ * and the product filter functions, which keep working copies of elements on
+ * the stack. */
+#define MEMORY_POOL_MAX_ELEMENT_SIZE 256
+/** Maximum size in bytes of the `x0` state of memory_pool_group_by_hash() and
+ * the product filter functions, which is copied onto the stack. */
+#define MEMORY_POOL_MAX_X_SIZE 1024
+
+/** Maximum number of threads used by the memory_pool_parallel_*() functions. */
+#define MEMORY_POOL_PAR_MAX_THREADS PARALLEL_MAX_THREADS
+/** Minimum number of elements per thread in the parallel functions. */
+#define MEMORY_POOL_PAR_MIN_CHUNK 32
+/** Maximum accumulator size in bytes folded in parallel by
+ * memory_pool_parallel_fold(), a multiple of eight. */
+#define MEMORY_POOL_PAR_MAX_FOLD_SIZE 256
+
+/** Size in bytes of the working area used by memory_pool_sort_key() on a
+ * collection of `n` elements, a key and node pointer pair per element twice
+ * over. */
+#define MEMORY_POOL_SORT_KEY_BUFF_SIZE(n) ((n) * 4 * sizeof(u64))
+/** Size in bytes of the working area used by memory_pool_group_by_hash() on a
+ * collection of `n` elements, a group (two pointers and a hash) per element
+ * and a hash table of up to `4 * n` slots. */
+#define MEMORY_POOL_GROUP_BY_HASH_BUFF_SIZE(n) \
+  ((n) * (3 * sizeof(void *) + 4 * sizeof(u32)))
+
+/** Number of bins in the per-operation timing histograms. */
+#define MEMORY_POOL_TIMING_BINS 32
+
+/** Operations timed by the memory pool instrumentation. */
+typedef enum {
+  MEMORY_POOL_OP_MAP = 0,
+  MEMORY_POOL_OP_FOLD,
+  MEMORY_POOL_OP_FILTER,
+  MEMORY_POOL_OP_SORT,
+  MEMORY_POOL_OP_GROUP_BY,
+  MEMORY_POOL_OP_PRODUCT,
+  MEMORY_POOL_N_OPS
+} memory_pool_op_t;
+
+/** Memory pool usage statistics, see memory_pool_get_stats(). */
+typedef struct {
+  u32 high_water;      /**< Maximum number of elements ever allocated. */
+  u32 n_adds;          /**< Number of elements added. */
+  u32 n_add_failures;  /**< Number of adds that failed as the pool was full. */
+  /** Histograms of operation durations in clock ticks. Bin 0 counts
+   * operations taking 0 ticks and bin `i` those taking `[2^(i-1), 2^i)` ticks,
+   * the last bin also counts anything longer. */
+  u32 op_time_hist[MEMORY_POOL_N_OPS][MEMORY_POOL_TIMING_BINS];
+} memory_pool_stats_t;
+
 typedef struct _memory_pool memory_pool_t;
 
 struct node;
@@ -43,6 +95,9 @@ struct _memory_pool {
   node_t *pool;
   node_t *free_nodes_head;
   node_t *allocated_nodes_head;
+  u32 n_allocated;
+  memory_pool_stats_t stats;
+  u64 (*clock)(void);
 };
 
 
@@ -54,6 +109,11 @@ s32 memory_pool_n_free(memory_pool_t *pool);
 s32 memory_pool_n_allocated(memory_pool_t *pool);
 u8 memory_pool_empty(memory_pool_t *pool);
 u32 memory_pool_n_elements(memory_pool_t *pool);
+s32 memory_pool_check(memory_pool_t *pool);
+
+void memory_pool_get_stats(memory_pool_t *pool, memory_pool_stats_t *stats);
+void memory_pool_reset_stats(memory_pool_t *pool);
+void memory_pool_set_clock(memory_pool_t *pool, u64 (*clock)(void));
 
 element_t *memory_pool_add(memory_pool_t *pool);
 s32 memory_pool_to_array(memory_pool_t *pool, void *array);
@@ -78,11 +138,41 @@ void memory_pool_group_by(memory_pool_t *pool, void *arg,
                           s32 (*cmp)(void *arg, element_t *a, element_t *b),
                           void *x0, size_t x_size,
                           void (*agg)(element_t *new, void *x, u32 n, element_t *elem));
+s32 memory_pool_sort_key(memory_pool_t *pool, void *arg,
+                         u64 (*key)(void *arg, element_t *elem), void *buff);
+s32 memory_pool_group_by_hash(memory_pool_t *pool, void *arg,
+                              u32 (*hash)(void *arg, element_t *elem),
+                              s32 (*cmp)(void *arg, element_t *a, element_t *b),
+                              void *x0, size_t x_size,
+                              void (*agg)(element_t *new, void *x, u32 n, element_t *elem),
+                              void *buff);
 s32 memory_pool_product(memory_pool_t *pool, void *xs, u32 max_xs, size_t x_size,
                         void (*prod)(element_t *new, void *x, u32 n_xs, u32 n, element_t *elem));
 s32 memory_pool_product_generator(memory_pool_t *pool, void *x0, u32 n_xs, size_t x_size,
                                   s8 (*next)(void *x, u32 n),
                                   void (*prod)(element_t *new, void *x, u32 n, element_t *elem));
+s32 memory_pool_product_filter(memory_pool_t *pool, void *xs, u32 n_xs,
+                               size_t x_size,
+                               void (*prod)(element_t *new, void *x, u32 n_xs, u32 n, element_t *elem),
+                               void *arg, s8 (*keep)(void *arg, element_t *elem));
+s32 memory_pool_product_generator_filter(memory_pool_t *pool, void *x0,
+                                         u32 max_xs, size_t x_size,
+                                         s8 (*next)(void *x, u32 n),
+                                         void (*prod)(element_t *new, void *x, u32 n, element_t *elem),
+                                         void *arg, s8 (*keep)(void *arg, element_t *elem));
+
+s32 memory_pool_parallel_map(memory_pool_t *pool, u32 n_threads, void *arg,
+                             void (*f)(void *arg, element_t *elem));
+s32 memory_pool_parallel_fold(memory_pool_t *pool, u32 n_threads,
+                              void *x0, size_t x_size,
+                              void (*f)(void *x, element_t *elem),
+                              void (*combine)(void *x, const void *y));
+double memory_pool_parallel_dfold(memory_pool_t *pool, u32 n_threads,
+                                  double x0,
+                                  double (*f)(double x, element_t *elem),
+                                  double (*combine)(double x, double y));
+s32 memory_pool_parallel_filter(memory_pool_t *pool, u32 n_threads, void *arg,
+                                s8 (*f)(void *arg, element_t *elem));
 
 #endif /* LIBSWIFTNAV_MEMORY_POOL_H */
 
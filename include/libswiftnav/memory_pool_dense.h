@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2014 Swift Navigation Inc.
+ * Contact: Fergus Noble <fergus@swift-nav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef LIBSWIFTNAV_MEMORY_POOL_DENSE_H
+#define LIBSWIFTNAV_MEMORY_POOL_DENSE_H
+
+#include <stddef.h>
+
+#include "common.h"
+#include "memory_pool.h"
+
+/** Handle returned for an invalid or stale element. */
+#define MEMORY_POOL_DENSE_INVALID 0xFFFFFFFF
+
+/** Size in bytes of the working area needed by memory_pool_dense_init(). */
+#define MEMORY_POOL_DENSE_BUFF_SIZE(n_elements, element_size) \
+  (MEMORY_POOL_DENSE_ELEMS_SIZE(n_elements, element_size) + \
+   2 * (n_elements) * sizeof(u32))
+
+/** Size of the element array, rounded up to keep the indices aligned. */
+#define MEMORY_POOL_DENSE_ELEMS_SIZE(n_elements, element_size) \
+  (((n_elements) * (element_size) + sizeof(u32) - 1) & ~(sizeof(u32) - 1))
+
+/** Densely packed memory pool.
+ * The live elements always occupy indices `0 ... n_allocated-1` of `elems`.
+ * Each element also has a handle which stays valid while it is in the pool,
+ * however it is moved. `handles` maps dense indices to handles, with the
+ * unused handles stacked above `n_allocated`, and `indices` maps handles back
+ * to dense indices. */
+typedef struct {
+  u32 n_elements;
+  size_t element_size;
+  u32 n_allocated;
+  element_t *elems;
+  u32 *handles;
+  u32 *indices;
+} memory_pool_dense_t;
+
+memory_pool_dense_t *memory_pool_dense_new(u32 n_elements, size_t element_size);
+s8 memory_pool_dense_init(memory_pool_dense_t *new_pool, u32 n_elements,
+                          size_t element_size, void *buff);
+void memory_pool_dense_destroy(memory_pool_dense_t *pool);
+u32 memory_pool_dense_n_free(memory_pool_dense_t *pool);
+u32 memory_pool_dense_n_allocated(memory_pool_dense_t *pool);
+u8 memory_pool_dense_empty(memory_pool_dense_t *pool);
+
+element_t *memory_pool_dense_add(memory_pool_dense_t *pool, u32 *handle);
+element_t *memory_pool_dense_get(memory_pool_dense_t *pool, u32 handle);
+element_t *memory_pool_dense_at(memory_pool_dense_t *pool, u32 index);
+u32 memory_pool_dense_handle(memory_pool_dense_t *pool, u32 index);
+s8 memory_pool_dense_remove(memory_pool_dense_t *pool, u32 handle);
+element_t *memory_pool_dense_array(memory_pool_dense_t *pool, u32 *n);
+
+s32 memory_pool_dense_map(memory_pool_dense_t *pool, void *arg,
+                          void (*f)(void *arg, element_t *elem));
+s32 memory_pool_dense_fold(memory_pool_dense_t *pool, void *x0,
+                           void (*f)(void *x, element_t *elem));
+double memory_pool_dense_dfold(memory_pool_dense_t *pool, double x0,
+                               double (*f)(double x, element_t *elem));
+s32 memory_pool_dense_filter(memory_pool_dense_t *pool, void *arg,
+                             s8 (*f)(void *arg, element_t *elem));
+void memory_pool_dense_clear(memory_pool_dense_t *pool);
+
+#endif /* LIBSWIFTNAV_MEMORY_POOL_DENSE_H */
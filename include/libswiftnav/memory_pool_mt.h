@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2014 Swift Navigation Inc.
+ * Contact: Fergus Noble <fergus@swift-nav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef LIBSWIFTNAV_MEMORY_POOL_MT_H
+#define LIBSWIFTNAV_MEMORY_POOL_MT_H
+
+#include <stddef.h>
+
+#include "common.h"
+#include "memory_pool.h"
+
+/** Maximum number of free elements held in a per-thread cache. */
+#define MEMORY_POOL_MT_CACHE_SIZE 16
+
+/** Node index marking the end of the free list. */
+#define MEMORY_POOL_MT_NIL 0xFFFFFFFF
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_8
+/** Defined when the shared free list is lock-free, i.e. the target has a
+ * 64-bit compare and swap. */
+#define MEMORY_POOL_MT_LOCK_FREE
+#endif
+
+typedef struct {
+  /* Index of the next free node, only meaningful while on the free list.
+   * Padded so elements keep 8 byte alignment on 32-bit targets. */
+  union {
+    u32 next;
+    u64 align;
+  };
+} memory_pool_mt_node_hdr_t;
+
+typedef struct {
+  memory_pool_mt_node_hdr_t hdr;
+  element_t elem[];
+} memory_pool_mt_node_t;
+
+/** Thread-safe memory pool.
+ * The free list is a lock-free (Treiber) stack whose head packs the index of
+ * the top node with a modification tag, updated with a single 64-bit compare
+ * and swap so a node being popped and pushed back between a load and the swap
+ * (the ABA problem) is detected. Targets without a 64-bit compare and swap
+ * take a spin lock around the free list instead, see
+ * ::MEMORY_POOL_MT_LOCK_FREE. */
+typedef struct {
+  u32 n_elements;
+  size_t element_size;
+  memory_pool_mt_node_t *pool;
+  u64 free_head;   /**< Tag in the upper 32 bits, node index in the lower. */
+  u32 n_free;      /**< Number of nodes on the shared free list. */
+#ifndef MEMORY_POOL_MT_LOCK_FREE
+  u8 lock;         /**< Free list lock. */
+#endif
+} memory_pool_mt_t;
+
+/** Per-thread cache of free elements.
+ * Each thread owns its own cache and allocates and releases elements through
+ * it, touching the shared free list only to refill or spill half a cache at a
+ * time. Elements may be released through a different cache (i.e. on a
+ * different thread) to the one they were allocated from. */
+typedef struct {
+  memory_pool_mt_t *pool;
+  u32 n;
+  u32 nodes[MEMORY_POOL_MT_CACHE_SIZE];
+} memory_pool_mt_cache_t;
+
+memory_pool_mt_t *memory_pool_mt_new(u32 n_elements, size_t element_size);
+s8 memory_pool_mt_init(memory_pool_mt_t *new_pool, u32 n_elements,
+                       size_t element_size, void *buff);
+void memory_pool_mt_destroy(memory_pool_mt_t *pool);
+u32 memory_pool_mt_n_free(memory_pool_mt_t *pool);
+
+element_t *memory_pool_mt_alloc(memory_pool_mt_t *pool);
+void memory_pool_mt_free(memory_pool_mt_t *pool, element_t *elem);
+
+void memory_pool_mt_cache_init(memory_pool_mt_cache_t *cache,
+                               memory_pool_mt_t *pool);
+element_t *memory_pool_mt_cache_alloc(memory_pool_mt_cache_t *cache);
+void memory_pool_mt_cache_free(memory_pool_mt_cache_t *cache,
+                               element_t *elem);
+void memory_pool_mt_cache_flush(memory_pool_mt_cache_t *cache);
+
+#endif /* LIBSWIFTNAV_MEMORY_POOL_MT_H */
@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2014 Swift Navigation Inc.
+ * Contact: Fergus Noble <fergus@swift-nav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef LIBSWIFTNAV_PARALLEL_H
+#define LIBSWIFTNAV_PARALLEL_H
+
+#include <stddef.h>
+
+#include "common.h"
+
+/** Maximum number of threads used by parallel_run(), including the calling
+ * thread. */
+#define PARALLEL_MAX_THREADS 16
+
+void parallel_run(void *tasks, u32 n_tasks, size_t task_size,
+                  void *(*fn)(void *task));
+
+#endif /* LIBSWIFTNAV_PARALLEL_H */
@@ -15,12 +15,136 @@
 
 #include "common.h"
 
+#include "ephemeris.h"
 #include "gpstime.h"
+#include "parallel.h"
 #include "track.h"
 
+#define RTCM3_PREAMBLE 0xD3 /**< RTCM v3 Frame sync / preamble byte. */
+/** Length of an RTCM v3 frame holding a data message of `len` bytes. */
+#define RTCM3_FRAME_LEN(len) ((len) + 6)
+/** Length of the longest RTCM v3 frame. */
+#define RTCM3_MAX_FRAME_LEN RTCM3_FRAME_LEN(1023)
+/** Message type to register an #rtcm3_framer_t callback for every frame. */
+#define RTCM3_ALL_MSG_TYPES 0
+
+/** Maximum number of satellites in an MSM message. */
+#define RTCM3_MSM_MAX_SATS 64
+/** Maximum number of cells (satellite and signal pairs) in an MSM message. */
+#define RTCM3_MSM_MAX_CELLS 64
+
+/** Maximum number of threads used by rtcm3_decode_obs_bulk_parallel(). */
+#define RTCM3_BULK_MAX_THREADS PARALLEL_MAX_THREADS
+/** Minimum number of bytes per thread in rtcm3_decode_obs_bulk_parallel(). */
+#define RTCM3_BULK_MIN_CHUNK 4096
+/** Size in bytes of the buffer used by an #rtcm3_obs_array_t of capacity `n`,
+ * see rtcm3_obs_array_init(). */
+#define RTCM3_OBS_ARRAY_BUFF_SIZE(n) \
+  ((n) * (3 * sizeof(double) + sizeof(float) + sizeof(u16) + sizeof(u8)))
+
+/** RTCM message callback, see rtcm3_framer_register_callback(). */
+typedef void (*rtcm3_msg_callback_t)(u16 msg_type, u8 msg[], u16 len,
+                                     void *context);
+
+/** RTCM message callback node.
+ * Forms a linked list of callbacks. */
+typedef struct rtcm3_msg_callbacks_node {
+  u16 msg_type;                          /**< Message type of callback. */
+  rtcm3_msg_callback_t cb;               /**< Pointer to callback function. */
+  void *context;                         /**< Pointer to a context. */
+  struct rtcm3_msg_callbacks_node *next; /**< Pointer to next node in list. */
+} rtcm3_msg_callbacks_node_t;
+
+/** State of an RTCM v3 stream framer, see rtcm3_framer_process(). */
+typedef struct {
+  u8 frame[RTCM3_MAX_FRAME_LEN]; /**< Frame split across chunks so far. */
+  u32 n_staged;                  /**< Number of bytes in `frame`. */
+  u32 n_checked;                 /**< Bytes of `frame` searched for inner
+                                      frames. */
+  u32 n_frames;                  /**< Number of valid frames received. */
+  u32 n_errors;                  /**< Number of candidate frames rejected. */
+  u32 n_skipped;                 /**< Number of bytes not in a valid frame. */
+  rtcm3_msg_callbacks_node_t *callbacks_head;
+} rtcm3_framer_t;
+
+/** Reference station antenna position, RTCM message types 1005 and 1006. */
+typedef struct {
+  u16 id;           /**< Reference station ID (DF003). */
+  u8 itrf;          /**< ITRF realization year (DF021). */
+  u8 gps;           /**< GPS indicator (DF022). */
+  u8 glo;           /**< GLONASS indicator (DF023). */
+  u8 gal;           /**< Galileo indicator (DF024). */
+  u8 ref_station;   /**< Reference station indicator (DF141). */
+  double pos[3];    /**< Antenna reference point ECEF X, Y and Z in meters
+                         (DF025, DF026, DF027). */
+  u8 osc;           /**< Single receiver oscillator indicator (DF142). */
+  u8 quarter_cycle; /**< Quarter cycle indicator (DF364). */
+  double height;    /**< Antenna height in meters, 1006 only (DF028). */
+} rtcm3_station_t;
+
+/** Satellite of an MSM message. */
+typedef struct {
+  u8 id;       /**< Satellite ID, 1-64, see DF394. */
+  u8 ext_info; /**< Extended satellite information, MSM7 only. */
+} rtcm3_msm_sat_t;
+
+/** Signal cell of an MSM message.
+ * Measurements not present in the message are NAN. */
+typedef struct {
+  u8 sat;             /**< Satellite ID, 1-64, see DF394. */
+  u8 sig;             /**< Signal ID, 1-32, see DF395. */
+  double pseudorange; /**< Pseudorange in meters. */
+  double phase_range; /**< Phase range in meters. */
+  double phase_rate;  /**< Phase range rate in m/s, MSM7 only. */
+  u16 lock;           /**< Lock time indicator (DF402 or DF407). */
+  u8 half_cycle;      /**< Half-cycle ambiguity indicator (DF420). */
+  double cnr;         /**< Carrier to noise ratio in dB-Hz. */
+} rtcm3_msm_cell_t;
+
+/** Multiple Signal Message, RTCM message types 1074, 1077, 1084, ... */
+typedef struct {
+  u16 msg_type;    /**< Message type number (DF002). */
+  u16 id;          /**< Reference station ID (DF003). */
+  u32 epoch;       /**< GNSS epoch time, format depends on the GNSS, e.g.
+                        GPS time of week in ms (DF004). */
+  u8 multiple;     /**< Multiple message bit (DF393). */
+  u8 iods;         /**< Issue of data station (DF409). */
+  u8 clk_steering; /**< Clock steering indicator (DF411). */
+  u8 ext_clk;      /**< External clock indicator (DF412). */
+  u8 div_free;     /**< Divergence-free smoothing indicator (DF417). */
+  u8 smooth;       /**< Smoothing interval (DF418). */
+  u8 n_sats;       /**< Number of satellites in `sats`. */
+  u8 n_cells;      /**< Number of cells in `cells`. */
+  /** Satellites, in ascending order of ID. */
+  rtcm3_msm_sat_t sats[RTCM3_MSM_MAX_SATS];
+  /** Cells, in ascending order of satellite ID then signal ID. */
+  rtcm3_msm_cell_t cells[RTCM3_MSM_MAX_CELLS];
+} rtcm3_msm_t;
+
+/** GPS L1 observations stored column by column, one entry per satellite per
+ * epoch, see rtcm3_decode_obs_bulk(). */
+typedef struct {
+  u32 n_obs;              /**< Number of observations in the arrays. */
+  u32 max_obs;            /**< Capacity of the arrays. */
+  u32 n_msgs;             /**< Number of observation messages decoded. */
+  u32 n_errors;           /**< Number of candidate frames rejected. */
+  double *tow;            /**< GPS time of week of the epoch in s (DF004). */
+  double *pseudorange;    /**< L1 pseudorange in m. */
+  double *carrier_phase;  /**< L1 carrier phase in cycles. */
+  float *cnr;             /**< L1 CNR in dB-Hz (DF015). */
+  u16 *lock_time;         /**< Minimum L1 lock time in s (DF013). */
+  u8 *prn;                /**< PRN, numbered from zero (DF009). */
+} rtcm3_obs_array_t;
+
 s16 rtcm3_check_frame(u8 *buff);
 s8 rtcm3_write_frame(u16 len, u8 *buff);
 
+void rtcm3_framer_init(rtcm3_framer_t *f);
+s8 rtcm3_framer_register_callback(rtcm3_framer_t *f, u16 msg_type,
+                                  rtcm3_msg_callback_t cb, void *context,
+                                  rtcm3_msg_callbacks_node_t *node);
+s32 rtcm3_framer_process(rtcm3_framer_t *f, const u8 *buf, u32 len);
+
 void rtcm3_write_header(u8 *buff, u16 type, u16 id, gps_time_t t,
                         u8 sync, u8 n_sat, u8 div_free, u8 smooth);
 void rtcm3_read_header(u8 *buff, u16 *type, u16 *id, double *tow,
@@ -30,5 +154,30 @@ u16 rtcm3_encode_1002(u8 *buff, u16 id, gps_time_t t, u8 n_sat,
                       navigation_measurement_t *nm, u8 sync);
 s8 rtcm3_decode_1002(u8 *buff, u16 *id, double *tow, u8 *n_sat,
                      navigation_measurement_t *nm, u8 *sync);
+u16 rtcm3_encode_1004(u8 *buff, u16 id, gps_time_t t, u8 n_sat,
+                      navigation_measurement_t *nm_l1,
+                      navigation_measurement_t *nm_l2, u8 sync);
+s8 rtcm3_decode_1004(u8 *buff, u16 *id, double *tow, u8 *n_sat,
+                     navigation_measurement_t *nm_l1,
+                     navigation_measurement_t *nm_l2, u8 *sync);
+
+u16 rtcm3_encode_1005(u8 *buff, const rtcm3_station_t *station);
+s8 rtcm3_decode_1005(u8 *buff, rtcm3_station_t *station);
+u16 rtcm3_encode_1006(u8 *buff, const rtcm3_station_t *station);
+s8 rtcm3_decode_1006(u8 *buff, rtcm3_station_t *station);
+
+u16 rtcm3_encode_1019(u8 *buff, u8 prn, const ephemeris_t *eph,
+                      u8 iode, u16 iodc);
+s8 rtcm3_decode_1019(u8 *buff, u8 *prn, ephemeris_t *eph,
+                     u8 *iode, u16 *iodc);
+
+u16 rtcm3_encode_msm(u8 *buff, const rtcm3_msm_t *msm);
+s8 rtcm3_decode_msm(u8 *buff, rtcm3_msm_t *msm);
+
+void rtcm3_obs_array_init(rtcm3_obs_array_t *a, u32 max_obs, void *buff);
+u32 rtcm3_obs_array_bound(u32 len);
+u32 rtcm3_decode_obs_bulk(rtcm3_obs_array_t *a, const u8 *buf, u32 len);
+u32 rtcm3_decode_obs_bulk_parallel(rtcm3_obs_array_t *a, u32 n_threads,
+                                   const u8 *buf, u32 len);
 
 #endif /* LIBSWIFTNAV_RTCM3_H */
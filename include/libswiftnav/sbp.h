@@ -34,11 +34,24 @@
 #define SBP_NULL_ERROR     -4
 
 
+/** Length of an SBP frame with a payload of `len` bytes. */
+#define SBP_FRAME_LEN(len) ((len) + 8)
+/** Length of the longest SBP frame. */
+#define SBP_MAX_FRAME_LEN SBP_FRAME_LEN(255)
+
+/** Number of buckets in the callback table, a power of two. */
+#define SBP_CALLBACK_TABLE_SIZE 64
+
 /** SBP callback function prototype definition. */
 typedef void (*sbp_msg_callback_t)(u16 sender_id, u8 len, u8 msg[], void *context);
 
+/** SBP callback function prototype for callbacks called for every message,
+ * see sbp_register_all_callback(). */
+typedef void (*sbp_msg_all_callback_t)(u16 msg_type, u16 sender_id, u8 len,
+                                       u8 msg[], void *context);
+
 /** SBP callback node.
- * Forms a linked list of callbacks.
+ * Forms a linked list of callbacks within a bucket of the callback table.
  * \note Must be statically allocated for use with sbp_register_callback().
  */
 typedef struct sbp_msg_callbacks_node {
@@ -48,6 +61,16 @@ typedef struct sbp_msg_callbacks_node {
   struct sbp_msg_callbacks_node *next; /**< Pointer to next node in list. */
 } sbp_msg_callbacks_node_t;
 
+/** SBP catch-all callback node.
+ * Forms a linked list of the callbacks called for every message.
+ * \note Must be statically allocated for use with sbp_register_all_callback().
+ */
+typedef struct sbp_msg_all_callbacks_node {
+  sbp_msg_all_callback_t cb;               /**< Pointer to callback function. */
+  void *context;                           /**< Pointer to a context */
+  struct sbp_msg_all_callbacks_node *next; /**< Pointer to next node in list. */
+} sbp_msg_all_callbacks_node_t;
+
 /** State structure for processing SBP messages. */
 typedef struct {
   enum {
@@ -65,20 +88,59 @@ typedef struct {
   u8 n_read;
   u8 msg_buff[256];
   void* io_context;
-  sbp_msg_callbacks_node_t* sbp_msg_callbacks_head;
+  u8 zero_copy;
+  /** Callback lists, hashed by message type. */
+  sbp_msg_callbacks_node_t* sbp_msg_callbacks[SBP_CALLBACK_TABLE_SIZE];
+  /** Callbacks called for every message. */
+  sbp_msg_all_callbacks_node_t* sbp_msg_callbacks_all;
 } sbp_state_t;
 
+/** Ring buffer of encoded SBP frames waiting to be sent.
+ * Lets many messages be written to the output stream at once, see
+ * sbp_tx_buffer_add() and sbp_tx_buffer_flush(). */
+typedef struct {
+  u8 *buff;      /**< Storage for the buffer. */
+  u32 size;      /**< Size of `buff` in bytes. */
+  u32 start;     /**< Index of the first pending byte. */
+  u32 n_pending; /**< Number of bytes waiting to be sent. */
+} sbp_tx_buffer_t;
+
+/** Contiguous region of pending data in an #sbp_tx_buffer_t. */
+typedef struct {
+  u8 *data; /**< Pointer to the start of the region. */
+  u32 len;  /**< Length of the region in bytes. */
+} sbp_tx_segment_t;
+
 /** \} */
 
 s8 sbp_register_callback(sbp_state_t* s, u16 msg_type, sbp_msg_callback_t cb, void* context,
                          sbp_msg_callbacks_node_t *node);
+s8 sbp_add_callback(sbp_state_t* s, u16 msg_type, sbp_msg_callback_t cb,
+                    void* context, sbp_msg_callbacks_node_t *node);
+s8 sbp_register_all_callback(sbp_state_t* s, sbp_msg_all_callback_t cb,
+                             void* context, sbp_msg_all_callbacks_node_t *node);
 void sbp_clear_callbacks(sbp_state_t* s);
 sbp_msg_callbacks_node_t* sbp_find_callback(sbp_state_t* s, u16 msg_type);
 void sbp_state_init(sbp_state_t *s);
 void sbp_state_set_io_context(sbp_state_t *s, void* context);
+void sbp_state_set_zero_copy(sbp_state_t *s, u8 zero_copy);
 s8 sbp_process(sbp_state_t *s, u32 (*read)(u8 *buff, u32 n, void* context));
+s32 sbp_process_buffer(sbp_state_t *s, const u8 *buf, u32 len, u32 *n_consumed);
 s8 sbp_send_message(sbp_state_t *s, u16 msg_type, u16 sender_id, u8 len, u8 *payload,
                     u32 (*write)(u8 *buff, u32 n, void* context));
+u32 sbp_encode_message(u16 msg_type, u16 sender_id, u8 len, const u8 *payload,
+                       u8 *frame);
+
+void sbp_tx_buffer_init(sbp_tx_buffer_t *b, u8 *buff, u32 size);
+u32 sbp_tx_buffer_pending(sbp_tx_buffer_t *b);
+u32 sbp_tx_buffer_space(sbp_tx_buffer_t *b);
+s8 sbp_tx_buffer_add(sbp_tx_buffer_t *b, u16 msg_type, u16 sender_id, u8 len,
+                     const u8 *payload);
+u8 sbp_tx_buffer_peek(sbp_tx_buffer_t *b, sbp_tx_segment_t seg[2]);
+void sbp_tx_buffer_consume(sbp_tx_buffer_t *b, u32 n);
+s8 sbp_tx_buffer_flush(sbp_tx_buffer_t *b,
+                       u32 (*write)(u8 *buff, u32 n, void* context),
+                       void* context);
 
 #endif /* LIBSWIFTNAV_SBP_H */
 
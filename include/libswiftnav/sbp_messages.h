@@ -17,8 +17,73 @@
 #ifndef LIBSWIFTNAV_SBP_MESSAGES_H
 #define LIBSWIFTNAV_SBP_MESSAGES_H
 
+#include <string.h>
+
 #include "common.h"
 
+/* Little-endian payload field access. Fields are packed and unpacked a byte
+ * at a time so the payload may be at any alignment and the host of either
+ * endianness, compilers turn these into single loads and stores where the
+ * target allows. */
+
+static inline void sbp_put_u8(u8 *p, u8 v) { p[0] = v; }
+static inline void sbp_put_u16(u8 *p, u16 v) { p[0] = v; p[1] = v >> 8; }
+static inline void sbp_put_u32(u8 *p, u32 v)
+{
+  sbp_put_u16(p, v);
+  sbp_put_u16(p + 2, v >> 16);
+}
+static inline void sbp_put_u64(u8 *p, u64 v)
+{
+  sbp_put_u32(p, v);
+  sbp_put_u32(p + 4, v >> 32);
+}
+static inline void sbp_put_s8(u8 *p, s8 v) { sbp_put_u8(p, (u8)v); }
+static inline void sbp_put_s16(u8 *p, s16 v) { sbp_put_u16(p, (u16)v); }
+static inline void sbp_put_s32(u8 *p, s32 v) { sbp_put_u32(p, (u32)v); }
+static inline void sbp_put_s64(u8 *p, s64 v) { sbp_put_u64(p, (u64)v); }
+static inline void sbp_put_float(u8 *p, float v)
+{
+  u32 u;
+  memcpy(&u, &v, sizeof(u));
+  sbp_put_u32(p, u);
+}
+static inline void sbp_put_double(u8 *p, double v)
+{
+  u64 u;
+  memcpy(&u, &v, sizeof(u));
+  sbp_put_u64(p, u);
+}
+
+static inline u8 sbp_get_u8(const u8 *p) { return p[0]; }
+static inline u16 sbp_get_u16(const u8 *p) { return p[0] | (p[1] << 8); }
+static inline u32 sbp_get_u32(const u8 *p)
+{
+  return sbp_get_u16(p) | ((u32)sbp_get_u16(p + 2) << 16);
+}
+static inline u64 sbp_get_u64(const u8 *p)
+{
+  return sbp_get_u32(p) | ((u64)sbp_get_u32(p + 4) << 32);
+}
+static inline s8 sbp_get_s8(const u8 *p) { return (s8)sbp_get_u8(p); }
+static inline s16 sbp_get_s16(const u8 *p) { return (s16)sbp_get_u16(p); }
+static inline s32 sbp_get_s32(const u8 *p) { return (s32)sbp_get_u32(p); }
+static inline s64 sbp_get_s64(const u8 *p) { return (s64)sbp_get_u64(p); }
+static inline float sbp_get_float(const u8 *p)
+{
+  u32 u = sbp_get_u32(p);
+  float v;
+  memcpy(&v, &u, sizeof(v));
+  return v;
+}
+static inline double sbp_get_double(const u8 *p)
+{
+  u64 u = sbp_get_u64(p);
+  double v;
+  memcpy(&v, &u, sizeof(v));
+  return v;
+}
+
 
 /** System start-up message
  * The system start-up message is sent once on system start-up. It is
@@ -32,6 +97,34 @@ typedef struct __attribute__((packed)) {
   u32 reserved; /**< Reserved */
 } sbp_startup_t;
 
+/** Length of an #sbp_startup_t payload in bytes. */
+#define SBP_STARTUP_LEN 4
+
+/** Encode an #sbp_startup_t into its payload of
+ * ::SBP_STARTUP_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_startup(u8 *buf, const sbp_startup_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->reserved);
+}
+
+/** Decode an #sbp_startup_t from its payload, check the payload
+ * with sbp_validate_startup() first. */
+static inline void sbp_decode_startup(sbp_startup_t *msg, const u8 *buf)
+{
+  msg->reserved = sbp_get_u32(&buf[0]);
+}
+
+/** Check an #sbp_startup_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_STARTUP_LEN.
+ */
+static inline s8 sbp_validate_startup(const u8 *buf, u8 len)
+{
+  (void)buf;
+  if (len != SBP_STARTUP_LEN)
+    return -1;
+  return 0;
+}
+
 
 /** System heartbeat message
  * The heartbeat message is sent periodically to inform the host or
@@ -50,6 +143,34 @@ typedef struct __attribute__((packed)) {
   u32 flags; /**< Status flags */
 } sbp_heartbeat_t;
 
+/** Length of an #sbp_heartbeat_t payload in bytes. */
+#define SBP_HEARTBEAT_LEN 4
+
+/** Encode an #sbp_heartbeat_t into its payload of
+ * ::SBP_HEARTBEAT_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_heartbeat(u8 *buf, const sbp_heartbeat_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->flags);
+}
+
+/** Decode an #sbp_heartbeat_t from its payload, check the payload
+ * with sbp_validate_heartbeat() first. */
+static inline void sbp_decode_heartbeat(sbp_heartbeat_t *msg, const u8 *buf)
+{
+  msg->flags = sbp_get_u32(&buf[0]);
+}
+
+/** Check an #sbp_heartbeat_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_HEARTBEAT_LEN.
+ */
+static inline s8 sbp_validate_heartbeat(const u8 *buf, u8 len)
+{
+  (void)buf;
+  if (len != SBP_HEARTBEAT_LEN)
+    return -1;
+  return 0;
+}
+
 
 /** GPS Time
  * GPS Time.
@@ -63,6 +184,40 @@ typedef struct __attribute__((packed)) {
   u8  flags; /**< Status flags (reserved) */
 } sbp_gps_time_t;
 
+/** Length of an #sbp_gps_time_t payload in bytes. */
+#define SBP_GPS_TIME_LEN 11
+
+/** Encode an #sbp_gps_time_t into its payload of
+ * ::SBP_GPS_TIME_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_gps_time(u8 *buf, const sbp_gps_time_t *msg)
+{
+  sbp_put_u16(&buf[0], msg->wn);
+  sbp_put_u32(&buf[2], msg->tow);
+  sbp_put_s32(&buf[6], msg->ns);
+  sbp_put_u8(&buf[10], msg->flags);
+}
+
+/** Decode an #sbp_gps_time_t from its payload, check the payload
+ * with sbp_validate_gps_time() first. */
+static inline void sbp_decode_gps_time(sbp_gps_time_t *msg, const u8 *buf)
+{
+  msg->wn = sbp_get_u16(&buf[0]);
+  msg->tow = sbp_get_u32(&buf[2]);
+  msg->ns = sbp_get_s32(&buf[6]);
+  msg->flags = sbp_get_u8(&buf[10]);
+}
+
+/** Check an #sbp_gps_time_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_GPS_TIME_LEN.
+ */
+static inline s8 sbp_validate_gps_time(const u8 *buf, u8 len)
+{
+  (void)buf;
+  if (len != SBP_GPS_TIME_LEN)
+    return -1;
+  return 0;
+}
+
 
 /** Dilution of Precision
  * Dilution of Precision.
@@ -78,6 +233,44 @@ typedef struct __attribute__((packed)) {
   u16 vdop; /**< Vertical Dilution of Precision [0.01] */
 } sbp_dops_t;
 
+/** Length of an #sbp_dops_t payload in bytes. */
+#define SBP_DOPS_LEN 14
+
+/** Encode an #sbp_dops_t into its payload of
+ * ::SBP_DOPS_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_dops(u8 *buf, const sbp_dops_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->tow);
+  sbp_put_u16(&buf[4], msg->gdop);
+  sbp_put_u16(&buf[6], msg->pdop);
+  sbp_put_u16(&buf[8], msg->tdop);
+  sbp_put_u16(&buf[10], msg->hdop);
+  sbp_put_u16(&buf[12], msg->vdop);
+}
+
+/** Decode an #sbp_dops_t from its payload, check the payload
+ * with sbp_validate_dops() first. */
+static inline void sbp_decode_dops(sbp_dops_t *msg, const u8 *buf)
+{
+  msg->tow = sbp_get_u32(&buf[0]);
+  msg->gdop = sbp_get_u16(&buf[4]);
+  msg->pdop = sbp_get_u16(&buf[6]);
+  msg->tdop = sbp_get_u16(&buf[8]);
+  msg->hdop = sbp_get_u16(&buf[10]);
+  msg->vdop = sbp_get_u16(&buf[12]);
+}
+
+/** Check an #sbp_dops_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_DOPS_LEN.
+ */
+static inline s8 sbp_validate_dops(const u8 *buf, u8 len)
+{
+  (void)buf;
+  if (len != SBP_DOPS_LEN)
+    return -1;
+  return 0;
+}
+
 
 /** Position in ECEF
  * Position solution in absolute Earth Centered Earth Fixed (ECEF) coordinates.
@@ -94,6 +287,48 @@ typedef struct __attribute__((packed)) {
   u8     flags;    /**< Status flags */
 } sbp_pos_ecef_t;
 
+/** Length of an #sbp_pos_ecef_t payload in bytes. */
+#define SBP_POS_ECEF_LEN 32
+
+/** Encode an #sbp_pos_ecef_t into its payload of
+ * ::SBP_POS_ECEF_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_pos_ecef(u8 *buf, const sbp_pos_ecef_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->tow);
+  sbp_put_double(&buf[4], msg->x);
+  sbp_put_double(&buf[12], msg->y);
+  sbp_put_double(&buf[20], msg->z);
+  sbp_put_u16(&buf[28], msg->accuracy);
+  sbp_put_u8(&buf[30], msg->n_sats);
+  sbp_put_u8(&buf[31], msg->flags);
+}
+
+/** Decode an #sbp_pos_ecef_t from its payload, check the payload
+ * with sbp_validate_pos_ecef() first. */
+static inline void sbp_decode_pos_ecef(sbp_pos_ecef_t *msg, const u8 *buf)
+{
+  msg->tow = sbp_get_u32(&buf[0]);
+  msg->x = sbp_get_double(&buf[4]);
+  msg->y = sbp_get_double(&buf[12]);
+  msg->z = sbp_get_double(&buf[20]);
+  msg->accuracy = sbp_get_u16(&buf[28]);
+  msg->n_sats = sbp_get_u8(&buf[30]);
+  msg->flags = sbp_get_u8(&buf[31]);
+}
+
+/** Check an #sbp_pos_ecef_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_POS_ECEF_LEN or
+ *         -2 if a bit field holds an undefined value.
+ */
+static inline s8 sbp_validate_pos_ecef(const u8 *buf, u8 len)
+{
+  if (len != SBP_POS_ECEF_LEN)
+    return -1;
+  if (!(1 & 0x3u >> ((sbp_get_u8(&buf[31]) >> 0) & 0x7)))
+    return -2;
+  return 0;
+}
+
 
 /** Geodetic Position
  * Geodetic position solution.
@@ -111,6 +346,50 @@ typedef struct __attribute__((packed)) {
   u8     flags;      /**< Status flags */
 } sbp_pos_llh_t;
 
+/** Length of an #sbp_pos_llh_t payload in bytes. */
+#define SBP_POS_LLH_LEN 34
+
+/** Encode an #sbp_pos_llh_t into its payload of
+ * ::SBP_POS_LLH_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_pos_llh(u8 *buf, const sbp_pos_llh_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->tow);
+  sbp_put_double(&buf[4], msg->lat);
+  sbp_put_double(&buf[12], msg->lon);
+  sbp_put_double(&buf[20], msg->height);
+  sbp_put_u16(&buf[28], msg->h_accuracy);
+  sbp_put_u16(&buf[30], msg->v_accuracy);
+  sbp_put_u8(&buf[32], msg->n_sats);
+  sbp_put_u8(&buf[33], msg->flags);
+}
+
+/** Decode an #sbp_pos_llh_t from its payload, check the payload
+ * with sbp_validate_pos_llh() first. */
+static inline void sbp_decode_pos_llh(sbp_pos_llh_t *msg, const u8 *buf)
+{
+  msg->tow = sbp_get_u32(&buf[0]);
+  msg->lat = sbp_get_double(&buf[4]);
+  msg->lon = sbp_get_double(&buf[12]);
+  msg->height = sbp_get_double(&buf[20]);
+  msg->h_accuracy = sbp_get_u16(&buf[28]);
+  msg->v_accuracy = sbp_get_u16(&buf[30]);
+  msg->n_sats = sbp_get_u8(&buf[32]);
+  msg->flags = sbp_get_u8(&buf[33]);
+}
+
+/** Check an #sbp_pos_llh_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_POS_LLH_LEN or
+ *         -2 if a bit field holds an undefined value.
+ */
+static inline s8 sbp_validate_pos_llh(const u8 *buf, u8 len)
+{
+  if (len != SBP_POS_LLH_LEN)
+    return -1;
+  if (!(1 & 0x3u >> ((sbp_get_u8(&buf[33]) >> 0) & 0x7)))
+    return -2;
+  return 0;
+}
+
 
 /** Baseline in ECEF
  * Baseline in Earth Centered Earth Fixed (ECEF) coordinates.
@@ -127,6 +406,48 @@ typedef struct __attribute__((packed)) {
   u8  flags;    /**< Status flags */
 } sbp_baseline_ecef_t;
 
+/** Length of an #sbp_baseline_ecef_t payload in bytes. */
+#define SBP_BASELINE_ECEF_LEN 20
+
+/** Encode an #sbp_baseline_ecef_t into its payload of
+ * ::SBP_BASELINE_ECEF_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_baseline_ecef(u8 *buf, const sbp_baseline_ecef_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->tow);
+  sbp_put_s32(&buf[4], msg->x);
+  sbp_put_s32(&buf[8], msg->y);
+  sbp_put_s32(&buf[12], msg->z);
+  sbp_put_u16(&buf[16], msg->accuracy);
+  sbp_put_u8(&buf[18], msg->n_sats);
+  sbp_put_u8(&buf[19], msg->flags);
+}
+
+/** Decode an #sbp_baseline_ecef_t from its payload, check the payload
+ * with sbp_validate_baseline_ecef() first. */
+static inline void sbp_decode_baseline_ecef(sbp_baseline_ecef_t *msg, const u8 *buf)
+{
+  msg->tow = sbp_get_u32(&buf[0]);
+  msg->x = sbp_get_s32(&buf[4]);
+  msg->y = sbp_get_s32(&buf[8]);
+  msg->z = sbp_get_s32(&buf[12]);
+  msg->accuracy = sbp_get_u16(&buf[16]);
+  msg->n_sats = sbp_get_u8(&buf[18]);
+  msg->flags = sbp_get_u8(&buf[19]);
+}
+
+/** Check an #sbp_baseline_ecef_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_BASELINE_ECEF_LEN or
+ *         -2 if a bit field holds an undefined value.
+ */
+static inline s8 sbp_validate_baseline_ecef(const u8 *buf, u8 len)
+{
+  if (len != SBP_BASELINE_ECEF_LEN)
+    return -1;
+  if (!(1 & 0x3u >> ((sbp_get_u8(&buf[19]) >> 0) & 0x7)))
+    return -2;
+  return 0;
+}
+
 
 /** Baseline in NED
  * Baseline in local North East Down (NED) coordinates.
@@ -144,6 +465,50 @@ typedef struct __attribute__((packed)) {
   u8  flags;      /**< Status flags */
 } sbp_baseline_ned_t;
 
+/** Length of an #sbp_baseline_ned_t payload in bytes. */
+#define SBP_BASELINE_NED_LEN 22
+
+/** Encode an #sbp_baseline_ned_t into its payload of
+ * ::SBP_BASELINE_NED_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_baseline_ned(u8 *buf, const sbp_baseline_ned_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->tow);
+  sbp_put_s32(&buf[4], msg->n);
+  sbp_put_s32(&buf[8], msg->e);
+  sbp_put_s32(&buf[12], msg->d);
+  sbp_put_u16(&buf[16], msg->h_accuracy);
+  sbp_put_u16(&buf[18], msg->v_accuracy);
+  sbp_put_u8(&buf[20], msg->n_sats);
+  sbp_put_u8(&buf[21], msg->flags);
+}
+
+/** Decode an #sbp_baseline_ned_t from its payload, check the payload
+ * with sbp_validate_baseline_ned() first. */
+static inline void sbp_decode_baseline_ned(sbp_baseline_ned_t *msg, const u8 *buf)
+{
+  msg->tow = sbp_get_u32(&buf[0]);
+  msg->n = sbp_get_s32(&buf[4]);
+  msg->e = sbp_get_s32(&buf[8]);
+  msg->d = sbp_get_s32(&buf[12]);
+  msg->h_accuracy = sbp_get_u16(&buf[16]);
+  msg->v_accuracy = sbp_get_u16(&buf[18]);
+  msg->n_sats = sbp_get_u8(&buf[20]);
+  msg->flags = sbp_get_u8(&buf[21]);
+}
+
+/** Check an #sbp_baseline_ned_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_BASELINE_NED_LEN or
+ *         -2 if a bit field holds an undefined value.
+ */
+static inline s8 sbp_validate_baseline_ned(const u8 *buf, u8 len)
+{
+  if (len != SBP_BASELINE_NED_LEN)
+    return -1;
+  if (!(1 & 0x3u >> ((sbp_get_u8(&buf[21]) >> 0) & 0x7)))
+    return -2;
+  return 0;
+}
+
 
 /** Velocity in ECEF
  * Velocity in Earth Centered Earth Fixed (ECEF) coordinates.
@@ -160,6 +525,46 @@ typedef struct __attribute__((packed)) {
   u8  flags;    /**< Status flags (reserved) */
 } sbp_vel_ecef_t;
 
+/** Length of an #sbp_vel_ecef_t payload in bytes. */
+#define SBP_VEL_ECEF_LEN 20
+
+/** Encode an #sbp_vel_ecef_t into its payload of
+ * ::SBP_VEL_ECEF_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_vel_ecef(u8 *buf, const sbp_vel_ecef_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->tow);
+  sbp_put_s32(&buf[4], msg->x);
+  sbp_put_s32(&buf[8], msg->y);
+  sbp_put_s32(&buf[12], msg->z);
+  sbp_put_u16(&buf[16], msg->accuracy);
+  sbp_put_u8(&buf[18], msg->n_sats);
+  sbp_put_u8(&buf[19], msg->flags);
+}
+
+/** Decode an #sbp_vel_ecef_t from its payload, check the payload
+ * with sbp_validate_vel_ecef() first. */
+static inline void sbp_decode_vel_ecef(sbp_vel_ecef_t *msg, const u8 *buf)
+{
+  msg->tow = sbp_get_u32(&buf[0]);
+  msg->x = sbp_get_s32(&buf[4]);
+  msg->y = sbp_get_s32(&buf[8]);
+  msg->z = sbp_get_s32(&buf[12]);
+  msg->accuracy = sbp_get_u16(&buf[16]);
+  msg->n_sats = sbp_get_u8(&buf[18]);
+  msg->flags = sbp_get_u8(&buf[19]);
+}
+
+/** Check an #sbp_vel_ecef_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_VEL_ECEF_LEN.
+ */
+static inline s8 sbp_validate_vel_ecef(const u8 *buf, u8 len)
+{
+  (void)buf;
+  if (len != SBP_VEL_ECEF_LEN)
+    return -1;
+  return 0;
+}
+
 
 /** Velocity in NED
  * Velocity in local North East Down (NED) coordinates.
@@ -177,6 +582,213 @@ typedef struct __attribute__((packed)) {
   u8  flags;      /**< Status flags (reserved) */
 } sbp_vel_ned_t;
 
+/** Length of an #sbp_vel_ned_t payload in bytes. */
+#define SBP_VEL_NED_LEN 22
+
+/** Encode an #sbp_vel_ned_t into its payload of
+ * ::SBP_VEL_NED_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_vel_ned(u8 *buf, const sbp_vel_ned_t *msg)
+{
+  sbp_put_u32(&buf[0], msg->tow);
+  sbp_put_s32(&buf[4], msg->n);
+  sbp_put_s32(&buf[8], msg->e);
+  sbp_put_s32(&buf[12], msg->d);
+  sbp_put_u16(&buf[16], msg->h_accuracy);
+  sbp_put_u16(&buf[18], msg->v_accuracy);
+  sbp_put_u8(&buf[20], msg->n_sats);
+  sbp_put_u8(&buf[21], msg->flags);
+}
+
+/** Decode an #sbp_vel_ned_t from its payload, check the payload
+ * with sbp_validate_vel_ned() first. */
+static inline void sbp_decode_vel_ned(sbp_vel_ned_t *msg, const u8 *buf)
+{
+  msg->tow = sbp_get_u32(&buf[0]);
+  msg->n = sbp_get_s32(&buf[4]);
+  msg->e = sbp_get_s32(&buf[8]);
+  msg->d = sbp_get_s32(&buf[12]);
+  msg->h_accuracy = sbp_get_u16(&buf[16]);
+  msg->v_accuracy = sbp_get_u16(&buf[18]);
+  msg->n_sats = sbp_get_u8(&buf[20]);
+  msg->flags = sbp_get_u8(&buf[21]);
+}
+
+/** Check an #sbp_vel_ned_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_VEL_NED_LEN.
+ */
+static inline s8 sbp_validate_vel_ned(const u8 *buf, u8 len)
+{
+  (void)buf;
+  if (len != SBP_VEL_NED_LEN)
+    return -1;
+  return 0;
+}
+
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+
+/** Compile-time properties of an SBP message struct, e.g.
+ * `sbp_msg_traits<sbp_gps_time_t>::size`. */
+template <typename T> struct sbp_msg_traits;
+
+template <> struct sbp_msg_traits<sbp_startup_t> {
+  static constexpr u16 id = SBP_STARTUP;
+  static constexpr u8 size = SBP_STARTUP_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 reserved = 0;
+  };
+};
+static_assert(sizeof(sbp_startup_t) == SBP_STARTUP_LEN,
+              "sbp_startup_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_heartbeat_t> {
+  static constexpr u16 id = SBP_HEARTBEAT;
+  static constexpr u8 size = SBP_HEARTBEAT_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 flags = 0;
+  };
+};
+static_assert(sizeof(sbp_heartbeat_t) == SBP_HEARTBEAT_LEN,
+              "sbp_heartbeat_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_gps_time_t> {
+  static constexpr u16 id = SBP_GPS_TIME;
+  static constexpr u8 size = SBP_GPS_TIME_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 wn = 0;
+    static constexpr u8 tow = 2;
+    static constexpr u8 ns = 6;
+    static constexpr u8 flags = 10;
+  };
+};
+static_assert(sizeof(sbp_gps_time_t) == SBP_GPS_TIME_LEN,
+              "sbp_gps_time_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_dops_t> {
+  static constexpr u16 id = SBP_DOPS;
+  static constexpr u8 size = SBP_DOPS_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 tow = 0;
+    static constexpr u8 gdop = 4;
+    static constexpr u8 pdop = 6;
+    static constexpr u8 tdop = 8;
+    static constexpr u8 hdop = 10;
+    static constexpr u8 vdop = 12;
+  };
+};
+static_assert(sizeof(sbp_dops_t) == SBP_DOPS_LEN,
+              "sbp_dops_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_pos_ecef_t> {
+  static constexpr u16 id = SBP_POS_ECEF;
+  static constexpr u8 size = SBP_POS_ECEF_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 tow = 0;
+    static constexpr u8 x = 4;
+    static constexpr u8 y = 12;
+    static constexpr u8 z = 20;
+    static constexpr u8 accuracy = 28;
+    static constexpr u8 n_sats = 30;
+    static constexpr u8 flags = 31;
+  };
+};
+static_assert(sizeof(sbp_pos_ecef_t) == SBP_POS_ECEF_LEN,
+              "sbp_pos_ecef_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_pos_llh_t> {
+  static constexpr u16 id = SBP_POS_LLH;
+  static constexpr u8 size = SBP_POS_LLH_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 tow = 0;
+    static constexpr u8 lat = 4;
+    static constexpr u8 lon = 12;
+    static constexpr u8 height = 20;
+    static constexpr u8 h_accuracy = 28;
+    static constexpr u8 v_accuracy = 30;
+    static constexpr u8 n_sats = 32;
+    static constexpr u8 flags = 33;
+  };
+};
+static_assert(sizeof(sbp_pos_llh_t) == SBP_POS_LLH_LEN,
+              "sbp_pos_llh_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_baseline_ecef_t> {
+  static constexpr u16 id = SBP_BASELINE_ECEF;
+  static constexpr u8 size = SBP_BASELINE_ECEF_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 tow = 0;
+    static constexpr u8 x = 4;
+    static constexpr u8 y = 8;
+    static constexpr u8 z = 12;
+    static constexpr u8 accuracy = 16;
+    static constexpr u8 n_sats = 18;
+    static constexpr u8 flags = 19;
+  };
+};
+static_assert(sizeof(sbp_baseline_ecef_t) == SBP_BASELINE_ECEF_LEN,
+              "sbp_baseline_ecef_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_baseline_ned_t> {
+  static constexpr u16 id = SBP_BASELINE_NED;
+  static constexpr u8 size = SBP_BASELINE_NED_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 tow = 0;
+    static constexpr u8 n = 4;
+    static constexpr u8 e = 8;
+    static constexpr u8 d = 12;
+    static constexpr u8 h_accuracy = 16;
+    static constexpr u8 v_accuracy = 18;
+    static constexpr u8 n_sats = 20;
+    static constexpr u8 flags = 21;
+  };
+};
+static_assert(sizeof(sbp_baseline_ned_t) == SBP_BASELINE_NED_LEN,
+              "sbp_baseline_ned_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_vel_ecef_t> {
+  static constexpr u16 id = SBP_VEL_ECEF;
+  static constexpr u8 size = SBP_VEL_ECEF_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 tow = 0;
+    static constexpr u8 x = 4;
+    static constexpr u8 y = 8;
+    static constexpr u8 z = 12;
+    static constexpr u8 accuracy = 16;
+    static constexpr u8 n_sats = 18;
+    static constexpr u8 flags = 19;
+  };
+};
+static_assert(sizeof(sbp_vel_ecef_t) == SBP_VEL_ECEF_LEN,
+              "sbp_vel_ecef_t does not match its payload");
+
+template <> struct sbp_msg_traits<sbp_vel_ned_t> {
+  static constexpr u16 id = SBP_VEL_NED;
+  static constexpr u8 size = SBP_VEL_NED_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+    static constexpr u8 tow = 0;
+    static constexpr u8 n = 4;
+    static constexpr u8 e = 8;
+    static constexpr u8 d = 12;
+    static constexpr u8 h_accuracy = 16;
+    static constexpr u8 v_accuracy = 18;
+    static constexpr u8 n_sats = 20;
+    static constexpr u8 flags = 21;
+  };
+};
+static_assert(sizeof(sbp_vel_ned_t) == SBP_VEL_NED_LEN,
+              "sbp_vel_ned_t does not match its payload");
+
+#endif /* __cplusplus */
 
 #endif /* LIBSWIFTNAV_SBP_MESSAGES_H */
 
@@ -0,0 +1,517 @@
+/*
+ * Copyright (C) 2014 Swift Navigation Inc.
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef LIBSWIFTNAV_SMALL_MATRIX_H
+#define LIBSWIFTNAV_SMALL_MATRIX_H
+
+#include <math.h>
+#include <string.h>
+
+#include "common.h"
+#include "constants.h"
+
+/** \defgroup small_matrix Small Matrix Kernels
+ * Fixed capacity dense matrix kernels for the DGNSS filters.
+ *
+ * Every matrix the ambiguity filters handle is at most 2 * MAX_CHANNELS wide,
+ * which is far below the size where BLAS / LAPACK blocking pays for its call
+ * overhead (and for the f2c translated reference LAPACK, its workspace
+ * juggling). These kernels are plain loops over contiguous row major storage
+ * (leading dimension equal to the number of columns), are inlined at the call
+ * site and never allocate: scratch space is sized by #SMAT_MAX_DIM on the
+ * stack.
+ *
+ * Results agree with the reference BLAS / LAPACK routines they replace to
+ * rounding error only; summation order differs.
+ * \{ */
+
+/** Largest row or column count any kernel in this file accepts. */
+#define SMAT_MAX_DIM (2 * MAX_CHANNELS)
+
+/** Dot product of two vectors, unrolled by four.
+ *
+ * \param n Length of the vectors
+ * \param a First vector
+ * \param b Second vector
+ * \return a . b
+ */
+static inline double smat_dot(u32 n, const double *a, const double *b)
+{
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  u32 i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s0 += a[i] * b[i];
+    s1 += a[i+1] * b[i+1];
+    s2 += a[i+2] * b[i+2];
+    s3 += a[i+3] * b[i+3];
+  }
+  for (; i < n; i++)
+    s0 += a[i] * b[i];
+  return (s0 + s1) + (s2 + s3);
+}
+
+/** General matrix vector product, \f$ y = \alpha A x + \beta y \f$.
+ * When beta is zero y is not read, matching BLAS DGEMV.
+ *
+ * \param m     Number of rows of A
+ * \param n     Number of columns of A
+ * \param alpha Scale applied to A x
+ * \param A     Matrix, m x n
+ * \param x     Vector of length n
+ * \param beta  Scale applied to y
+ * \param y     Vector of length m, updated in place
+ */
+static inline void smat_gemv(u32 m, u32 n, double alpha, const double *A,
+                             const double *x, double beta, double *y)
+{
+  for (u32 i = 0; i < m; i++) {
+    double ax = alpha * smat_dot(n, &A[i*n], x);
+    y[i] = (beta == 0) ? ax : ax + beta * y[i];
+  }
+}
+
+/** Symmetric matrix vector product, \f$ y = A x \f$.
+ * Only the upper triangle of A is read.
+ *
+ * \param n Dimension of A
+ * \param A Symmetric matrix, n x n
+ * \param x Vector of length n
+ * \param y Output vector of length n, must not alias x
+ */
+static inline void smat_symv_upper(u32 n, const double *A, const double *x,
+                                   double *y)
+{
+  for (u32 i = 0; i < n; i++) {
+    double s = 0;
+    for (u32 k = 0; k < i; k++)
+      s += A[k*n + i] * x[k];
+    y[i] = s + smat_dot(n - i, &A[i*n + i], &x[i]);
+  }
+}
+
+/** In place product with a unit upper triangular matrix, \f$ x := U x \f$.
+ * The diagonal and lower triangle of U are not read.
+ *
+ * \param n Dimension of U
+ * \param U Unit upper triangular matrix, n x n
+ * \param x Vector of length n, updated in place
+ */
+static inline void smat_trmv_unit_upper(u32 n, const double *U, double *x)
+{
+  for (u32 i = 0; i + 1 < n; i++)
+    x[i] += smat_dot(n - i - 1, &U[i*n + i + 1], &x[i + 1]);
+}
+
+/** In place product with the transpose of a unit upper triangular matrix,
+ * \f$ x := U^T x \f$.
+ * The diagonal and lower triangle of U are not read.
+ *
+ * \param n Dimension of U
+ * \param U Unit upper triangular matrix, n x n
+ * \param x Vector of length n, updated in place
+ */
+static inline void smat_trmv_unit_upper_t(u32 n, const double *U, double *x)
+{
+  for (u32 i = n; i-- > 1; ) {
+    double s = 0;
+    for (u32 k = 0; k < i; k++)
+      s += U[k*n + i] * x[k];
+    x[i] += s;
+  }
+}
+
+/** In place product with a unit upper triangular matrix from the left,
+ * \f$ B := U B \f$.
+ * The diagonal and lower triangle of U are not read.
+ *
+ * \param m Dimension of U and number of rows of B
+ * \param n Number of columns of B
+ * \param U Unit upper triangular matrix, m x m
+ * \param B Matrix, m x n, updated in place
+ */
+static inline void smat_trmm_unit_upper(u32 m, u32 n, const double *U,
+                                        double *B)
+{
+  for (u32 i = 0; i + 1 < m; i++) {
+    for (u32 k = i + 1; k < m; k++) {
+      double u = U[i*m + k];
+      if (u == 0)
+        continue;
+      for (u32 j = 0; j < n; j++)
+        B[i*n + j] += u * B[k*n + j];
+    }
+  }
+}
+
+/** In place inverse of a unit upper triangular matrix.
+ * The diagonal and lower triangle of U are neither read nor written.
+ *
+ * \param n Dimension of U
+ * \param U Unit upper triangular matrix, n x n, replaced by its inverse
+ */
+static inline void smat_trtri_unit_upper(u32 n, double *U)
+{
+  /* Column j of X = U^-1 satisfies X[i][j] = -sum_{i<=k<j} X[i][k] U[k][j],
+   * working down the column keeps the U[k][j] still needed intact. */
+  for (u32 j = 1; j < n; j++) {
+    for (u32 i = 0; i < j; i++) {
+      double s = U[i*n + j];
+      for (u32 k = i + 1; k < j; k++)
+        s += U[i*n + k] * U[k*n + j];
+      U[i*n + j] = -s;
+    }
+  }
+}
+
+/** Product with a symmetric matrix from the right, \f$ C = \alpha B A \f$.
+ * Only the upper triangle of A is read.
+ *
+ * \param m     Number of rows of B and C
+ * \param n     Dimension of A and number of columns of B and C
+ * \param alpha Scale applied to the product
+ * \param A     Symmetric matrix, n x n
+ * \param B     Matrix, m x n
+ * \param C     Output matrix, m x n, must not alias A or B
+ */
+static inline void smat_symm_right_upper(u32 m, u32 n, double alpha,
+                                         const double *A, const double *B,
+                                         double *C)
+{
+  for (u32 i = 0; i < m; i++) {
+    for (u32 j = 0; j < n; j++) {
+      double s = 0;
+      for (u32 k = 0; k < j; k++)
+        s += B[i*n + k] * A[k*n + j];
+      for (u32 k = j; k < n; k++)
+        s += B[i*n + k] * A[j*n + k];
+      C[i*n + j] = alpha * s;
+    }
+  }
+}
+
+/** Product with a transposed matrix, \f$ C = \alpha A B^T \f$.
+ *
+ * \param m     Number of rows of A and C
+ * \param n     Number of rows of B and columns of C
+ * \param k     Number of columns of A and B
+ * \param alpha Scale applied to the product
+ * \param A     Matrix, m x k
+ * \param B     Matrix, n x k
+ * \param C     Output matrix, m x n, must not alias A or B
+ */
+static inline void smat_gemm_nt(u32 m, u32 n, u32 k, double alpha,
+                                const double *A, const double *B, double *C)
+{
+  for (u32 i = 0; i < m; i++)
+    for (u32 j = 0; j < n; j++)
+      C[i*n + j] = alpha * smat_dot(k, &A[i*k], &B[j*k]);
+}
+
+/** In place Cholesky factorisation, \f$ A = L L^T \f$.
+ * Only the lower triangle of A is read and it is overwritten by L, the
+ * strictly upper triangle is left untouched.
+ *
+ * \param n Dimension of A
+ * \param A Symmetric positive definite matrix, n x n
+ * \return 0 on success, -1 if A is not positive definite
+ */
+static inline s8 smat_cholesky(u32 n, double *A)
+{
+  for (u32 j = 0; j < n; j++) {
+    double d = A[j*n + j] - smat_dot(j, &A[j*n], &A[j*n]);
+    if (!(d > 0))
+      return -1;
+    d = sqrt(d);
+    A[j*n + j] = d;
+    for (u32 i = j + 1; i < n; i++)
+      A[i*n + j] = (A[i*n + j] - smat_dot(j, &A[i*n], &A[j*n])) / d;
+  }
+  return 0;
+}
+
+/** In place inverse of a symmetric positive definite matrix via its Cholesky
+ * factorisation. Only the lower triangle of A is read, the full symmetric
+ * inverse is written.
+ *
+ * \param n Dimension of A, at most #SMAT_MAX_DIM
+ * \param A Symmetric positive definite matrix, n x n, replaced by its inverse
+ * \return 0 on success, -1 if A is not positive definite
+ */
+static inline s8 smat_spd_inverse(u32 n, double *A)
+{
+  if (smat_cholesky(n, A))
+    return -1;
+
+  /* Invert L in place (still lower triangular). */
+  for (u32 j = 0; j < n; j++) {
+    A[j*n + j] = 1.0 / A[j*n + j];
+    for (u32 i = j + 1; i < n; i++) {
+      double s = 0;
+      for (u32 k = j; k < i; k++)
+        s += A[i*n + k] * A[k*n + j];
+      A[i*n + j] = -s / A[i*n + i];
+    }
+  }
+
+  /* A^-1 = L^-T L^-1 */
+  double Linv[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  memcpy(Linv, A, n * n * sizeof(double));
+  for (u32 i = 0; i < n; i++) {
+    for (u32 j = i; j < n; j++) {
+      double s = 0;
+      for (u32 k = j; k < n; k++)
+        s += Linv[k*n + i] * Linv[k*n + j];
+      A[i*n + j] = s;
+      A[j*n + i] = s;
+    }
+  }
+  return 0;
+}
+
+/** In place Householder QR factorisation, \f$ A = Q R \f$.
+ * On exit R is stored in the upper triangle of A and the Householder vectors
+ * (with implicit unit leading element) below it, as in LAPACK DGEQRF.
+ *
+ * \param m   Number of rows of A
+ * \param n   Number of columns of A
+ * \param A   Matrix, m x n, overwritten by the factorisation
+ * \param tau Output Householder scalars, length min(m, n)
+ */
+static inline void smat_qr(u32 m, u32 n, double *A, double *tau)
+{
+  u32 k = MIN(m, n);
+  for (u32 j = 0; j < k; j++) {
+    double alpha = A[j*n + j];
+    double xnorm2 = 0;
+    for (u32 i = j + 1; i < m; i++)
+      xnorm2 += A[i*n + j] * A[i*n + j];
+    if (xnorm2 == 0) {
+      tau[j] = 0;
+      continue;
+    }
+    double beta = -copysign(sqrt(alpha * alpha + xnorm2), alpha);
+    tau[j] = (beta - alpha) / beta;
+    double scale = 1.0 / (alpha - beta);
+    for (u32 i = j + 1; i < m; i++)
+      A[i*n + j] *= scale;
+    A[j*n + j] = beta;
+
+    /* Apply H = I - tau v v^T to the trailing columns. */
+    for (u32 c = j + 1; c < n; c++) {
+      double w = A[j*n + c];
+      for (u32 i = j + 1; i < m; i++)
+        w += A[i*n + j] * A[i*n + c];
+      w *= tau[j];
+      A[j*n + c] -= w;
+      for (u32 i = j + 1; i < m; i++)
+        A[i*n + c] -= w * A[i*n + j];
+    }
+  }
+}
+
+/** Forms the full orthogonal factor of a smat_qr() factorisation.
+ *
+ * \param m   Number of rows of the factorised matrix
+ * \param n   Number of columns of the factorised matrix
+ * \param QR  Factorisation from smat_qr(), m x n
+ * \param tau Householder scalars from smat_qr()
+ * \param Q   Output orthogonal matrix, m x m
+ */
+static inline void smat_qr_q(u32 m, u32 n, const double *QR, const double *tau,
+                             double *Q)
+{
+  memset(Q, 0, m * m * sizeof(double));
+  for (u32 i = 0; i < m; i++)
+    Q[i*m + i] = 1;
+
+  /* Q = H_0 H_1 ... H_{k-1}, accumulated backwards so each reflector only
+   * touches the trailing block. */
+  for (u32 j = MIN(m, n); j-- > 0; ) {
+    if (tau[j] == 0)
+      continue;
+    for (u32 c = j; c < m; c++) {
+      double w = Q[j*m + c];
+      for (u32 i = j + 1; i < m; i++)
+        w += QR[i*n + j] * Q[i*m + c];
+      w *= tau[j];
+      Q[j*m + c] -= w;
+      for (u32 i = j + 1; i < m; i++)
+        Q[i*m + c] -= w * QR[i*n + j];
+    }
+  }
+}
+
+/** Linear least squares, minimises \f$ \| A x - b \| \f$ via Householder QR.
+ * For underdetermined systems (m < n) the minimum norm solution is returned.
+ * Columns whose diagonal of R falls below `1e-12 * max |R_ii|` are treated as
+ * rank deficient and their component of x is set to zero.
+ *
+ * \param m Number of rows of A
+ * \param n Number of columns of A
+ * \param A Matrix, m x n, both dimensions at most #SMAT_MAX_DIM
+ * \param b Right hand side, length m
+ * \param x Output solution, length n
+ * \return 0 on success, -1 if A is rank deficient
+ */
+static inline s8 smat_lstsq(u32 m, u32 n, const double *A, const double *b,
+                            double *x)
+{
+  double F[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double tau[SMAT_MAX_DIM];
+  double z[SMAT_MAX_DIM];
+  s8 ret = 0;
+
+  if (m >= n) {
+    memcpy(F, A, m * n * sizeof(double));
+    memcpy(z, b, m * sizeof(double));
+    smat_qr(m, n, F, tau);
+    /* z = Q^T b */
+    for (u32 j = 0; j < n; j++) {
+      double w = z[j];
+      for (u32 i = j + 1; i < m; i++)
+        w += F[i*n + j] * z[i];
+      w *= tau[j];
+      z[j] -= w;
+      for (u32 i = j + 1; i < m; i++)
+        z[i] -= w * F[i*n + j];
+    }
+    double r_max = 0;
+    for (u32 j = 0; j < n; j++)
+      r_max = MAX(r_max, fabs(F[j*n + j]));
+    /* R x = z */
+    for (u32 j = n; j-- > 0; ) {
+      if (fabs(F[j*n + j]) <= 1e-12 * r_max) {
+        x[j] = 0;
+        ret = -1;
+        continue;
+      }
+      double s = z[j];
+      for (u32 k = j + 1; k < n; k++)
+        s -= F[j*n + k] * x[k];
+      x[j] = s / F[j*n + j];
+    }
+    return ret;
+  }
+
+  /* Underdetermined: A^T = Q R so A = R^T Q^T, solve R^T y = b and set
+   * x = Q (y, 0). */
+  for (u32 i = 0; i < m; i++)
+    for (u32 j = 0; j < n; j++)
+      F[j*m + i] = A[i*n + j];
+  smat_qr(n, m, F, tau);
+  double r_max = 0;
+  for (u32 j = 0; j < m; j++)
+    r_max = MAX(r_max, fabs(F[j*m + j]));
+  memset(z, 0, n * sizeof(double));
+  for (u32 j = 0; j < m; j++) {
+    if (fabs(F[j*m + j]) <= 1e-12 * r_max) {
+      ret = -1;
+      continue;
+    }
+    double s = b[j];
+    for (u32 k = 0; k < j; k++)
+      s -= F[k*m + j] * z[k];
+    z[j] = s / F[j*m + j];
+  }
+  for (u32 j = m; j-- > 0; ) {
+    double w = z[j];
+    for (u32 i = j + 1; i < n; i++)
+      w += F[i*m + j] * z[i];
+    w *= tau[j];
+    z[j] -= w;
+    for (u32 i = j + 1; i < n; i++)
+      z[i] -= w * F[i*m + j];
+  }
+  memcpy(x, z, n * sizeof(double));
+  return ret;
+}
+
+/** In place LU factorisation with partial pivoting, \f$ P A = L U \f$.
+ * L (unit lower) and U share the storage of A, pivots are recorded LAPACK
+ * style: row j was interchanged with row piv[j].
+ *
+ * \param n   Dimension of A
+ * \param A   Matrix, n x n, overwritten by the factorisation
+ * \param piv Output pivot indices, length n
+ * \return 0 on success, -1 if A is singular
+ */
+static inline s8 smat_lu(u32 n, double *A, u8 *piv)
+{
+  for (u32 j = 0; j < n; j++) {
+    u32 p = j;
+    for (u32 i = j + 1; i < n; i++)
+      if (fabs(A[i*n + j]) > fabs(A[p*n + j]))
+        p = i;
+    piv[j] = p;
+    if (A[p*n + j] == 0)
+      return -1;
+    if (p != j) {
+      for (u32 c = 0; c < n; c++) {
+        double t = A[j*n + c];
+        A[j*n + c] = A[p*n + c];
+        A[p*n + c] = t;
+      }
+    }
+    double d = 1.0 / A[j*n + j];
+    for (u32 i = j + 1; i < n; i++) {
+      double l = A[i*n + j] * d;
+      A[i*n + j] = l;
+      for (u32 c = j + 1; c < n; c++)
+        A[i*n + c] -= l * A[j*n + c];
+    }
+  }
+  return 0;
+}
+
+/** Solves a linear system with a smat_lu() factorisation, either
+ * \f$ A x = b \f$ or \f$ A^T x = b \f$.
+ *
+ * \param n     Dimension of A
+ * \param LU    Factorisation from smat_lu(), n x n
+ * \param piv   Pivot indices from smat_lu()
+ * \param trans Nonzero to solve with A^T
+ * \param b     Right hand side, length n, replaced by the solution
+ */
+static inline void smat_lu_solve(u32 n, const double *LU, const u8 *piv,
+                                 u8 trans, double *b)
+{
+  if (!trans) {
+    for (u32 j = 0; j < n; j++) {
+      double t = b[j]; b[j] = b[piv[j]]; b[piv[j]] = t;
+    }
+    for (u32 i = 1; i < n; i++)
+      b[i] -= smat_dot(i, &LU[i*n], b);
+    for (u32 i = n; i-- > 0; )
+      b[i] = (b[i] - smat_dot(n - i - 1, &LU[i*n + i + 1], &b[i + 1]))
+             / LU[i*n + i];
+  } else {
+    /* A^T = U^T L^T P */
+    for (u32 i = 0; i < n; i++) {
+      double s = b[i];
+      for (u32 k = 0; k < i; k++)
+        s -= LU[k*n + i] * b[k];
+      b[i] = s / LU[i*n + i];
+    }
+    for (u32 i = n; i-- > 0; ) {
+      double s = b[i];
+      for (u32 k = i + 1; k < n; k++)
+        s -= LU[k*n + i] * b[k];
+      b[i] = s;
+    }
+    for (u32 j = n; j-- > 0; ) {
+      double t = b[j]; b[j] = b[piv[j]]; b[piv[j]] = t;
+    }
+  }
+}
+
+/** \} */
+
+#endif /* LIBSWIFTNAV_SMALL_MATRIX_H */
@@ -0,0 +1,66 @@
+/* Generated by sbp_generate/generate.py from sbp.yaml, do not edit. */
+
+#include <string.h>
+#include <check.h>
+
+#include <sbp_messages.h>
+((* for m in msgs *))
+START_TEST(test_sbp_(((m.name|lower))))
+{
+  const u8 payload[] = {
+((*- for l in m.test_payload *))
+    (((l))),
+((*- endfor *))
+  };
+  sbp_(((m.name|lower)))_t msg = {
+((*- for f in m.fields *))
+    .(((f.name))) = (((f.test_value))),
+((*- endfor *))
+  };
+  sbp_(((m.name|lower)))_t out;
+  u8 buf[SBP_(((m.name)))_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_(((m.name)))_LEN,
+    "SBP_(((m.name)))_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_(((m.name)))_LEN,
+    "sbp_(((m.name|lower)))_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_(((m.name|lower)))(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_(((m.name)))_LEN) == 0,
+    "sbp_encode_(((m.name|lower))) output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_(((m.name|lower)))(&out, &buf[1]);
+((*- for f in m.fields *))
+  fail_unless(out.(((f.name))) == msg.(((f.name))),
+    "sbp_decode_(((m.name|lower))) (((f.name))) does not match");
+((*- endfor *))
+
+  fail_unless(sbp_validate_(((m.name|lower)))(payload, SBP_(((m.name)))_LEN) == 0,
+    "sbp_validate_(((m.name|lower))) rejected a valid payload");
+  fail_unless(sbp_validate_(((m.name|lower)))(payload, SBP_(((m.name)))_LEN - 1) == -1,
+    "sbp_validate_(((m.name|lower))) accepted a short payload");
+((*- for c in m.checks *))
+
+  msg.(((c.field.name))) = (((c.test_invalid)));
+  sbp_encode_(((m.name|lower)))(buf, &msg);
+  fail_unless(sbp_validate_(((m.name|lower)))(buf, SBP_(((m.name)))_LEN) == -2,
+    "sbp_validate_(((m.name|lower))) accepted (((c.field.name))) = (((c.test_invalid)))");
+  msg.(((c.field.name))) = (((c.field.test_value)));
+((*- endfor *))
+}
+END_TEST
+((* endfor *))
+Suite* sbp_messages_suite(void)
+{
+  Suite *s = suite_create("SBP messages");
+
+  TCase *tc_core = tcase_create("Core");
+((* for m in msgs *))
+  tcase_add_test(tc_core, test_sbp_(((m.name|lower))));
+((*- endfor *))
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -1,8 +1,27 @@
 #!/usr/bin/env python
 
+# Generates the SBP message code and documentation from sbp.yaml, run from
+# this directory. Needs Python 2 with jinja2 and PyYAML.
+#
+# Usage: generate.py [OUT_ROOT]
+#
+# The code is written into the tree rooted at OUT_ROOT, by default the
+# repository itself in which case the PDF documentation is also built. The
+# check-sbp-generated build target generates into the build directory and
+# compares the result with the committed files.
+
+import os
+import sys
 import yaml
 import jinja2
 import re
+import struct
+
+out_root = sys.argv[1] if len(sys.argv) > 1 else '..'
+build_docs = len(sys.argv) <= 1
+
+def out_path(path):
+  return os.path.join(out_root, path)
 
 with open("sbp.yaml", 'r') as f:
   ds = yaml.load(f)
@@ -108,6 +127,58 @@ def rejig_bitfields(bfs):
         }))
     return new_bfs, n_with_values
 
+def add_checks(m):
+    """Find the bit fields which can hold values not listed in sbp.yaml, these
+    are checked by the generated validate functions."""
+    m['checks'] = []
+    for f in m['fields']:
+        f['checks'] = []
+        for bf in f.get('fields', []):
+            vals = [v['value'] for v in bf.get('vals', [])]
+            if vals and bf['len'] <= 5 and len(vals) < 2**bf['len']:
+                f['checks'].append({
+                    'field': f,
+                    'lsb': bf['lsb'],
+                    'mask': '0x%X' % (2**bf['len'] - 1),
+                    'valid': '0x%Xu' % sum(1 << v for v in vals),
+                    'vals': vals,
+                    'invalid': min(set(range(2**bf['len'])) - set(vals)),
+                })
+        m['checks'] += f['checks']
+
+def c_literal(t, v):
+    if t == 'float':
+        return repr(v) + 'f'
+    if t == 'double':
+        return repr(v)
+    if t[0] == 's' and v == -2**(8*sizes[t] - 1):
+        return '(%d - 1)' % (v + 1)
+    suffix = {'u32': 'u', 'u64': 'ULL', 's64': 'LL'}.get(t, '')
+    return str(v) + suffix
+
+def add_test_values(m):
+    """Choose a value for each field for the generated round-trip tests, and
+    work out the payload they should be encoded to."""
+    payload = []
+    for i, f in enumerate(m['fields']):
+        t = f['type']
+        code = '<' + pystruct_code[t]
+        if t in ('float', 'double'):
+            v = (i + 1) * 1234.5 * (-1 if i % 2 else 1)
+        elif f['checks']:
+            v = sum(max(c['vals']) << c['lsb'] for c in f['checks'])
+        else:
+            b = [((f['offset'] + k) * 37 + 0x81) & 0xFF for k in range(f['size'])]
+            v = struct.unpack(code, struct.pack('<%dB' % f['size'], *b))[0]
+        f['test_value'] = c_literal(t, v)
+        packed = struct.pack(code, v)
+        payload += struct.unpack('<%dB' % len(packed), packed)
+        for c in f['checks']:
+            bad = (v & ~(int(c['mask'], 16) << c['lsb'])) | (c['invalid'] << c['lsb'])
+            c['test_invalid'] = c_literal(t, bad)
+    m['test_payload'] = [', '.join('0x%02X' % b for b in payload[i:i+12])
+                         for i in range(0, len(payload), 12)]
+
 msgs = [[dict({'name': k}, **v) for k, v in d.iteritems()][0] for d in ds]
 for m in msgs:
     fields = []
@@ -133,21 +204,28 @@ for m in msgs:
     m['max_name_len'] = max_name_len
     m['fields'] = fields
     m['size'] = offset
+    add_checks(m)
+    add_test_values(m)
 
 latex_template = jenv.get_template('message_descs.tex')
-with open("sbp_out.tex", 'w') as f:
+with open(out_path("sbp_generate/sbp_out.tex"), 'w') as f:
     f.write(latex_template.render(msgs=msgs))
 
 c_template = jenv.get_template('sbp_messages_template.h')
-with open("../include/libswiftnav/sbp_messages.h", 'w') as f:
+with open(out_path("include/libswiftnav/sbp_messages.h"), 'w') as f:
     f.write(c_template.render(msgs=msgs))
 
+test_template = jenv.get_template('check_sbp_messages_template.c')
+with open(out_path("tests/check_sbp_messages.c"), 'w') as f:
+    f.write(test_template.render(msgs=msgs))
+
 py_template = jenv.get_template('sbp_messages_template.py')
-with open("sbp_messages.py", 'w') as f:
+with open(out_path("sbp_generate/sbp_messages.py"), 'w') as f:
     f.write(py_template.render(msgs=msgs))
 
-import subprocess
+if build_docs:
+  import subprocess
 
-subprocess.call(["pdflatex" , "sbp_out.tex"])
-subprocess.call(["mv" , "sbp_out.pdf", "../docs/sbp.pdf"])
+  subprocess.call(["pdflatex" , "sbp_out.tex"])
+  subprocess.call(["mv" , "sbp_out.pdf", "../docs/sbp.pdf"])
 
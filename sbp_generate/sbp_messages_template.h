@@ -17,8 +17,73 @@
 #ifndef LIBSWIFTNAV_SBP_MESSAGES_H
 #define LIBSWIFTNAV_SBP_MESSAGES_H
 
+#include <string.h>
+
 #include "common.h"
 
+/* Little-endian payload field access. Fields are packed and unpacked a byte
+ * at a time so the payload may be at any alignment and the host of either
+ * endianness, compilers turn these into single loads and stores where the
+ * target allows. */
+
+static inline void sbp_put_u8(u8 *p, u8 v) { p[0] = v; }
+static inline void sbp_put_u16(u8 *p, u16 v) { p[0] = v; p[1] = v >> 8; }
+static inline void sbp_put_u32(u8 *p, u32 v)
+{
+  sbp_put_u16(p, v);
+  sbp_put_u16(p + 2, v >> 16);
+}
+static inline void sbp_put_u64(u8 *p, u64 v)
+{
+  sbp_put_u32(p, v);
+  sbp_put_u32(p + 4, v >> 32);
+}
+static inline void sbp_put_s8(u8 *p, s8 v) { sbp_put_u8(p, (u8)v); }
+static inline void sbp_put_s16(u8 *p, s16 v) { sbp_put_u16(p, (u16)v); }
+static inline void sbp_put_s32(u8 *p, s32 v) { sbp_put_u32(p, (u32)v); }
+static inline void sbp_put_s64(u8 *p, s64 v) { sbp_put_u64(p, (u64)v); }
+static inline void sbp_put_float(u8 *p, float v)
+{
+  u32 u;
+  memcpy(&u, &v, sizeof(u));
+  sbp_put_u32(p, u);
+}
+static inline void sbp_put_double(u8 *p, double v)
+{
+  u64 u;
+  memcpy(&u, &v, sizeof(u));
+  sbp_put_u64(p, u);
+}
+
+static inline u8 sbp_get_u8(const u8 *p) { return p[0]; }
+static inline u16 sbp_get_u16(const u8 *p) { return p[0] | (p[1] << 8); }
+static inline u32 sbp_get_u32(const u8 *p)
+{
+  return sbp_get_u16(p) | ((u32)sbp_get_u16(p + 2) << 16);
+}
+static inline u64 sbp_get_u64(const u8 *p)
+{
+  return sbp_get_u32(p) | ((u64)sbp_get_u32(p + 4) << 32);
+}
+static inline s8 sbp_get_s8(const u8 *p) { return (s8)sbp_get_u8(p); }
+static inline s16 sbp_get_s16(const u8 *p) { return (s16)sbp_get_u16(p); }
+static inline s32 sbp_get_s32(const u8 *p) { return (s32)sbp_get_u32(p); }
+static inline s64 sbp_get_s64(const u8 *p) { return (s64)sbp_get_u64(p); }
+static inline float sbp_get_float(const u8 *p)
+{
+  u32 u = sbp_get_u32(p);
+  float v;
+  memcpy(&v, &u, sizeof(v));
+  return v;
+}
+static inline double sbp_get_double(const u8 *p)
+{
+  u64 u = sbp_get_u64(p);
+  double v;
+  memcpy(&v, &u, sizeof(v));
+  return v;
+}
+
 ((* for m in msgs *))
 /** (((m.short_desc)))
 (((m.desc|commentify)))
@@ -31,7 +96,67 @@ typedef struct __attribute__((packed)) {
 ((*- endfor *))
 } sbp_(((m.name|lower)))_t;
 
+/** Length of an #sbp_(((m.name|lower)))_t payload in bytes. */
+#define SBP_(((m.name)))_LEN (((m.size)))
+
+/** Encode an #sbp_(((m.name|lower)))_t into its payload of
+ * ::SBP_(((m.name)))_LEN bytes, e.g. for sbp_send_message(). */
+static inline void sbp_encode_(((m.name|lower)))(u8 *buf, const sbp_(((m.name|lower)))_t *msg)
+{
+((*- for f in m.fields *))
+  sbp_put_(((f.type)))(&buf[(((f.offset)))], msg->(((f.name))));
+((*- endfor *))
+}
+
+/** Decode an #sbp_(((m.name|lower)))_t from its payload, check the payload
+ * with sbp_validate_(((m.name|lower)))() first. */
+static inline void sbp_decode_(((m.name|lower)))(sbp_(((m.name|lower)))_t *msg, const u8 *buf)
+{
+((*- for f in m.fields *))
+  msg->(((f.name))) = sbp_get_(((f.type)))(&buf[(((f.offset)))]);
+((*- endfor *))
+}
+
+/** Check an #sbp_(((m.name|lower)))_t payload.
+ * \return 0 if valid, -1 if `len` is not ::SBP_(((m.name)))_LEN((* if m.checks *)) or
+ *         -2 if a bit field holds an undefined value((* endif *)).
+ */
+static inline s8 sbp_validate_(((m.name|lower)))(const u8 *buf, u8 len)
+{
+((*- if not m.checks *))
+  (void)buf;
+((*- endif *))
+  if (len != SBP_(((m.name)))_LEN)
+    return -1;
+((*- for c in m.checks *))
+  if (!(1 & (((c.valid))) >> ((sbp_get_(((c.field.type)))(&buf[(((c.field.offset)))]) >> (((c.lsb)))) & (((c.mask))))))
+    return -2;
+((*- endfor *))
+  return 0;
+}
+
+((* endfor *))
+#if defined(__cplusplus) && __cplusplus >= 201103L
+
+/** Compile-time properties of an SBP message struct, e.g.
+ * `sbp_msg_traits<sbp_gps_time_t>::size`. */
+template <typename T> struct sbp_msg_traits;
+((* for m in msgs *))
+template <> struct sbp_msg_traits<sbp_(((m.name|lower)))_t> {
+  static constexpr u16 id = SBP_(((m.name)));
+  static constexpr u8 size = SBP_(((m.name)))_LEN;
+  /** Offsets of the fields in the payload in bytes. */
+  struct offset {
+((*- for f in m.fields *))
+    static constexpr u8 (((f.name))) = (((f.offset)));
+((*- endfor *))
+  };
+};
+static_assert(sizeof(sbp_(((m.name|lower)))_t) == SBP_(((m.name)))_LEN,
+              "sbp_(((m.name|lower)))_t does not match its payload");
 ((* endfor *))
+#endif /* __cplusplus */
+
 #endif /* LIBSWIFTNAV_SBP_MESSAGES_H */
 
 
@@ -18,11 +18,9 @@
 
 #include <string.h>
 #include <stdio.h>
-#include <cblas.h>
-#include <clapack.h>
-// #include <lapacke.h>
 #include <math.h>
 #include <linear_algebra.h>
+#include "small_matrix.h"
 #include "constants.h"
 #include "track.h"
 #include "almanac.h"
@@ -47,7 +45,7 @@ void incorporate_scalar_measurement(u32 state_dim, double *h, double R,
     printf("<INCORPORATE_SCALAR_MEASUREMENT>\n");
     VEC_PRINTF(h, state_dim);
     printf("R = %.16f", R);
-    if (abs(R) == 0) {
+    if (fabs(R) == 0) {
       printf(" \t (R == 0 exactly)\n");
     }
     else {
@@ -55,14 +53,12 @@ void incorporate_scalar_measurement(u32 state_dim, double *h, double R,
     }
   }
 
-  double f[state_dim]; // f = U^T * h
+  double f[MAX_STATE_DIM]; // f = U^T * h
   memcpy(f, h, state_dim * sizeof(double));
-  cblas_dtrmv(CblasRowMajor, CblasUpper, CblasTrans, CblasUnit, //CBLAS_ORDER, CBLAS_UPLO, CBLAS_TRANSPOSE transA, CBLAS_DIAG
-              state_dim, U, //int N, double *A
-              state_dim, f, 1); // int lda, double *X, int incX
+  smat_trmv_unit_upper_t(state_dim, U, f);
 
 
-  double g[state_dim]; // g = diag(D) * f
+  double g[MAX_STATE_DIM]; // g = diag(D) * f
   double alpha = R; // alpha = f * g + R = f^T * diag(D) * f + R
   for (u32 i=0; i<state_dim; i++) {
     g[i] = D[i] * f[i];
@@ -72,7 +68,7 @@ void incorporate_scalar_measurement(u32 state_dim, double *h, double R,
     VEC_PRINTF(f, state_dim);
     VEC_PRINTF(g, state_dim);
     printf("alpha = %.16f", alpha);
-    if (abs(alpha) == 0) {
+    if (fabs(alpha) == 0) {
       printf(" \t (alpha == 0 exactly)\n");
     }
     else {
@@ -80,9 +76,9 @@ void incorporate_scalar_measurement(u32 state_dim, double *h, double R,
     }
   }
 
-  double gamma[state_dim];
-  double U_bar[state_dim * state_dim];
-  double D_bar[state_dim];
+  double gamma[MAX_STATE_DIM];
+  double U_bar[MAX_STATE_DIM * MAX_STATE_DIM];
+  double D_bar[MAX_STATE_DIM];
 
   memset(gamma, 0,             state_dim * sizeof(double));
   memset(U_bar, 0, state_dim * state_dim * sizeof(double));
@@ -160,7 +156,7 @@ void incorporate_obs(nkf_t *kf, double *decor_obs)
   for (u32 i=0; i<kf->obs_dim; i++) {
     double *h = &kf->decor_obs_mtx[kf->state_dim * i]; //vector of length kf->state_dim
     double R = kf->decor_obs_cov[i]; //scalar
-    double k[kf->state_dim]; // vector of length kf->state_dim
+    double k[MAX_STATE_DIM]; // vector of length kf->state_dim
     // printf("i=%i\n", i);
     // VEC_PRINTF(h, kf->state_dim);
 
@@ -190,11 +186,9 @@ void incorporate_obs(nkf_t *kf, double *decor_obs)
 void make_residual_measurements(nkf_t *kf, double *measurements, double *resid_measurements)
 {
   u8 constraint_dim = MAX(kf->state_dim, 3) - 3;
-  cblas_dgemv (CblasRowMajor, CblasNoTrans, //Order, TransA
-               constraint_dim, kf->state_dim, // M, N
-               1, kf->null_basis_Q, kf->state_dim, // alpha A, lda
-               measurements, 1, // X, incX
-               0, resid_measurements, 1); // beta, Y, incY
+  smat_gemv(constraint_dim, kf->state_dim,
+            1, kf->null_basis_Q,
+            measurements, 0, resid_measurements);
   for (u8 i=0; i< kf->state_dim; i++) {
     resid_measurements[i+constraint_dim] = measurements[i] - measurements[i+kf->state_dim] / GPS_L1_LAMBDA_NO_VAC;
   }
@@ -215,16 +209,14 @@ void nkf_update(nkf_t *kf, double *measurements)
   if (DEBUG_AMB_KF) {
     printf("<NKF_UPDATE>\n");
   }
-  double resid_measurements[kf->obs_dim];
+  double resid_measurements[MAX_OBS_DIM];
   make_residual_measurements(kf, measurements, resid_measurements);
   // VEC_PRINTF(measurements, kf->obs_dim);
   // MAT_PRINTF(kf->decor_obs_mtx, kf->obs_dim, kf->state_dim);
   // MAT_PRINTF(kf->obs_cov_root_inv, kf->obs_dim, kf->obs_dim);
 
   // replaces residual measurements by their decorrelated version
-  cblas_dtrmv(CblasRowMajor, CblasUpper, CblasNoTrans, CblasUnit, // Order, Uplo, TransA, Diag
-              kf->obs_dim, kf->decor_mtx, kf->obs_dim, // N, A, lda
-              resid_measurements, 1); // X, incX
+  smat_trmv_unit_upper(kf->obs_dim, kf->decor_mtx, resid_measurements);
 
   // predict_forward(kf);
   diffuse_state(kf);
@@ -354,17 +346,11 @@ void least_squares_solve_b(nkf_t *kf, sdiff_t *sdiffs_with_ref_first,
   if (DEBUG_AMB_KF) {
     printf("<LEAST_SQUARES_SOLVE_B>\n");
   }
-  integer num_dds = kf->state_dim;
-  double DE[num_dds * 3];
+  u8 num_dds = kf->state_dim;
+  double DE[MAX_STATE_DIM * 3];
   assign_de_mtx(num_dds+1, sdiffs_with_ref_first, ref_ecef, DE);
-  double DET[num_dds * 3];
-  for (u8 i=0; i<num_dds; i++) { //TODO this transposition is stupid and unnecessary
-    DET[              i] = DE[i*3 + 0];
-    DET[    num_dds + i] = DE[i*3 + 1];
-    DET[2 * num_dds + i] = DE[i*3 + 2];
-  }
 
-  double phase_ranges[MAX(num_dds,3)];
+  double phase_ranges[MAX_STATE_DIM];
   for (u8 i=0; i< num_dds; i++) {
     phase_ranges[i] = dd_measurements[i] - kf->state_mean[i];
   }
@@ -377,37 +363,11 @@ void least_squares_solve_b(nkf_t *kf, sdiff_t *sdiffs_with_ref_first,
     printf("\t}\n");
   }
 
-  /* TODO could use plain old DGELS here */
-
-  s32 ldb = (s32) MAX(num_dds,3);
-  double s[3];
-  double rcond = 1e-12;
-  s32 rank;
-  double w[1]; //try 25 + 10*num_sats
-  s32 lwork = -1;
-  s32 info;
-  s32 three = 3;
-  s32 one = 1;
-  dgelss_(&num_dds, &three, &one, //M, N, NRHS
-          DET, &num_dds, //A, LDA
-          phase_ranges, &ldb, //B, LDB
-          s, &rcond, // S, RCOND
-          &rank, //RANK
-          w, &lwork, // WORK, LWORK
-          &info); //INFO
-  lwork = round(w[0]);
-
-  double work[lwork];
-  dgelss_(&num_dds, &three, &one, //M, N, NRHS
-          DET, &num_dds, //A, LDA
-          phase_ranges, &ldb, //B, LDB
-          s, &rcond, // S, RCOND
-          &rank, //RANK
-          work, &lwork, // WORK, LWORK
-          &info); //INFO
-  b[0] = phase_ranges[0] * GPS_L1_LAMBDA_NO_VAC;
-  b[1] = phase_ranges[1] * GPS_L1_LAMBDA_NO_VAC;
-  b[2] = phase_ranges[2] * GPS_L1_LAMBDA_NO_VAC;
+  double b_cycles[3];
+  smat_lstsq(num_dds, 3, DE, phase_ranges, b_cycles);
+  b[0] = b_cycles[0] * GPS_L1_LAMBDA_NO_VAC;
+  b[1] = b_cycles[1] * GPS_L1_LAMBDA_NO_VAC;
+  b[2] = b_cycles[2] * GPS_L1_LAMBDA_NO_VAC;
   if (DEBUG_AMB_KF) {
     printf("b = {%f, %f, %f}\n", b[0]*100, b[1]*100, b[2]*100); // units --> cm
     printf("</LEAST_SQUARES_SOLVE_B>\n");
@@ -422,15 +382,9 @@ void least_squares_solve_b(nkf_t *kf, sdiff_t *sdiffs_with_ref_first,
  */
 void least_squares_solve_b_external_ambs(u8 num_dds_u8, double *ambs, sdiff_t *sdiffs_with_ref_first, double *dd_measurements, double ref_ecef[3], double b[3])
 {
-  integer num_dds = num_dds_u8;
-  double DE[num_dds * 3];
+  u8 num_dds = num_dds_u8;
+  double DE[MAX_STATE_DIM * 3];
   assign_de_mtx(num_dds+1, sdiffs_with_ref_first, ref_ecef, DE);
-  double DET[num_dds * 3];
-  for (u8 i=0; i<num_dds; i++) { //TODO this transposition is stupid and unnecessary
-    DET[              i] = DE[i*3 + 0];
-    DET[    num_dds + i] = DE[i*3 + 1];
-    DET[2 * num_dds + i] = DE[i*3 + 2];
-  }
 
   // double fake_ints[num_dds];
   // for (u8 i=0; i< num_dds; i++) {
@@ -440,45 +394,17 @@ void least_squares_solve_b_external_ambs(u8 num_dds_u8, double *ambs, sdiff_t *s
   // lesq_solution_b(kf->state_dim, dd_measurements, kf->state_mean, DE, b, resid);
   // lesq_solution_b(kf->state_dim, dd_measurements, fake_ints, DE, b, resid);
 
-  double phase_ranges[MAX(num_dds,3)];
+  double phase_ranges[MAX_STATE_DIM];
   for (u8 i=0; i< num_dds; i++) {
     phase_ranges[i] = dd_measurements[i] - ambs[i];
     // phase_ranges[i] = dd_measurements[i] - (i+1)*10;
   }
 
-  //TODO could use plain old DGELS here
-
-  s32 ldb = (s32) MAX(num_dds,3);
-  double s[3];
-  double rcond = 1e-12;
-  s32 rank;
-  double w[1]; //try 25 + 10*num_sats
-  s32 lwork = -1;
-  s32 info;
-  s32 three = 3;
-  s32 one = 1;
-  dgelss_(&num_dds, &three, &one, //M, N, NRHS
-          DET, &num_dds, //A, LDA
-          phase_ranges, &ldb, //B, LDB
-          s, &rcond, // S, RCOND
-          &rank, //RANK
-          w, &lwork, // WORK, LWORK
-          &info); //INFO
-  lwork = round(w[0]);
-
-  double work[lwork];
-  dgelss_(&num_dds, &three, &one, //M, N, NRHS
-          DET, &num_dds, //A, LDA
-          phase_ranges, &ldb, //B, LDB
-          s, &rcond, // S, RCOND
-          &rank, //RANK
-          work, &lwork, // WORK, LWORK
-          &info); //INFO
-
-  memcpy(b, phase_ranges, 3 * sizeof(double));
-  b[0] = phase_ranges[0] * GPS_L1_LAMBDA_NO_VAC;
-  b[1] = phase_ranges[1] * GPS_L1_LAMBDA_NO_VAC;
-  b[2] = phase_ranges[2] * GPS_L1_LAMBDA_NO_VAC;
+  double b_cycles[3];
+  smat_lstsq(num_dds, 3, DE, phase_ranges, b_cycles);
+  b[0] = b_cycles[0] * GPS_L1_LAMBDA_NO_VAC;
+  b[1] = b_cycles[1] * GPS_L1_LAMBDA_NO_VAC;
+  b[2] = b_cycles[2] * GPS_L1_LAMBDA_NO_VAC;
 }
 
 
@@ -496,66 +422,21 @@ void initialize_state(nkf_t *kf, double *dd_measurements, double init_var)
   matrix_eye(num_dds, kf->state_cov_U);
 }
 
-void QR_part1(integer m, integer n, double *A, double *tau)
-{
-  double w[1];
-  integer lwork = -1;
-  integer info;
-  integer jpvt[3];
-  memset(jpvt, 0, 3 * sizeof(integer));
-  dgeqp3_(&m, &n,
-          A, &m,
-          jpvt,
-          tau,
-          w, &lwork, &info);
-  lwork = round(w[0]);
-  double work[lwork];
-  dgeqp3_(&m, &n,
-          A, &m,
-          jpvt,
-          tau,
-          work, &lwork, &info); //set A = QR(A)
-}
-
-void QR_part2(integer m, integer n, double *A, double *tau)
-{
-  double w[1];
-  integer lwork = -1;
-  integer info;
-  dorgqr_(&m, &m, &n,
-          A, &m,
-          tau,
-          w, &lwork, &info);
-  lwork = round(w[0]);
-  double work[lwork];
-  dorgqr_(&m, &m, &n,
-          A, &m,
-          tau,
-          work, &lwork, &info);
-}
-
 void assign_phase_obs_null_basis(u8 num_dds, double *DE_mtx, double *q)
 {
-  // use either GEQRF or GEQP3. GEQP3 is the version with pivoting
-  // int dgeqrf_(__CLPK_integer *m, __CLPK_integer *n, __CLPK_doublereal *a, __CLPK_integer *
-  //       lda, __CLPK_doublereal *tau, __CLPK_doublereal *work, __CLPK_integer *lwork, __CLPK_integer *info)
-  // int dgeqp3_(__CLPK_integer *m, __CLPK_integer *n, __CLPK_doublereal *a, __CLPK_integer *
-  //       lda, __CLPK_integer *jpvt, __CLPK_doublereal *tau, __CLPK_doublereal *work, __CLPK_integer *lwork,
-  //        __CLPK_integer *info)
-
-  //DE is num_sats-1 by 3, need to transpose it to column major
-  double A[num_dds * num_dds];
-  for (u8 i=0; i < num_dds; i++) {
-    for (u8 j=0; j<3; j++) {
-      A[j*num_dds + i] = DE_mtx[i*3 + j]; //set A = Transpose(DE_mtx)
+  /* The trailing num_dds - 3 columns of the full Q of DE = Q R span the left
+   * null space of DE. */
+  double A[MAX_STATE_DIM * 3];
+  memcpy(A, DE_mtx, num_dds * 3 * sizeof(double));
+  double tau[3];
+  smat_qr(num_dds, 3, A, tau);
+  double Q[MAX_STATE_DIM * MAX_STATE_DIM];
+  smat_qr_q(num_dds, 3, A, tau, Q);
+  for (u8 i=0; i + 3 < num_dds; i++) {
+    for (u8 j=0; j < num_dds; j++) {
+      q[i*num_dds + j] = Q[j*num_dds + i + 3];
     }
   }
-  integer m = num_dds;
-  integer n = 3;
-  double tau[3];
-  QR_part1(m, n, A, tau);
-  QR_part2(m, n, A, tau);
-  memcpy(q, &A[3*num_dds], (MAX(3, num_dds) - 3) * num_dds * sizeof(double));
 }
 
 void assign_dd_obs_cov(u8 num_dds, double phase_var, double code_var, double *dd_obs_cov) //TODO this could be made more efficient, if it matters
@@ -578,12 +459,12 @@ void assign_dd_obs_cov(u8 num_dds, double phase_var, double code_var, double *dd
 
 void assign_residual_obs_cov(u8 num_dds, double phase_var, double code_var, double *q, double *r_cov) //TODO make this more efficient (e.g. via pages 3/6.2-3/2014 of ian's notebook)
 {
-  double dd_obs_cov[4 * num_dds * num_dds];
+  double dd_obs_cov[4 * MAX_STATE_DIM * MAX_STATE_DIM];
   assign_dd_obs_cov(num_dds, phase_var, code_var, dd_obs_cov);
-  integer nullspace_dim = MAX(num_dds, 3) - 3;;
-  integer dd_dim = 2*num_dds;
-  integer res_dim = num_dds + nullspace_dim;
-  double q_tilde[res_dim * dd_dim];
+  u8 nullspace_dim = MAX(num_dds, 3) - 3;
+  u8 dd_dim = 2*num_dds;
+  u8 res_dim = num_dds + nullspace_dim;
+  double q_tilde[MAX_OBS_DIM * 2 * MAX_STATE_DIM];
   memset(q_tilde, 0, res_dim * dd_dim * sizeof(double));
   // MAT_PRINTF(obs_cov, dd_dim, dd_dim);
 
@@ -599,32 +480,18 @@ void assign_residual_obs_cov(u8 num_dds, double phase_var, double code_var, doub
   // MAT_PRINTF(q_tilde, res_dim, dd_dim);
 
   //TODO make more efficient via the structure of q_tilde, and it's relation to the I + 1*1^T structure of the obs cov mtx
-  double QC[res_dim * dd_dim];
-  cblas_dsymm(CblasRowMajor, CblasRight, CblasUpper, //CBLAS_ORDER, CBLAS_SIDE, CBLAS_UPLO
-              res_dim, dd_dim, // int M, int N
-              1, dd_obs_cov, dd_dim, // double alpha, double *A, int lda
-              q_tilde, dd_dim, // double *B, int ldb
-              0, QC, dd_dim); // double beta, double *C, int ldc
+  double QC[MAX_OBS_DIM * 2 * MAX_STATE_DIM];
+  smat_symm_right_upper(res_dim, dd_dim, 1, dd_obs_cov, q_tilde, QC);
   // MAT_PRINTF(QC, res_dim, dd_dim);
 
   //TODO make more efficient via the structure of q_tilde, and it's relation to the I + 1*1^T structure of the obs cov mtx
-  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, // CBLAS_ORDER, CBLAS_TRANSPOSE transA, cBLAS_TRANSPOSE transB
-              res_dim, res_dim, dd_dim, // int M, int N, int K
-              1, QC, dd_dim, // double alpha, double *A, int lda
-              q_tilde, dd_dim, //double *B, int ldb
-              0, r_cov, res_dim); //beta, double *C, int ldc
+  smat_gemm_nt(res_dim, res_dim, dd_dim, 1, QC, q_tilde, r_cov);
   // MAT_PRINTF(r_cov_inv, res_dim, res_dim);
 }
 
 void invert_U(u8 res_dim, double *U) // in place inversion of U
 {
-  char uplo = 'U'; //upper triangular
-  char diag = 'U'; //unit triangular
-  integer dim = res_dim;
-  integer lda = res_dim;
-  integer info;
-  dtrtri_(&uplo, &diag,
-          &dim, U, &lda, &info);
+  smat_trtri_unit_upper(res_dim, U);
 }
 
 void assign_simple_sig(u8 num_dds, double var, double *simple_cov)
@@ -657,10 +524,7 @@ void assign_H_prime(u8 res_dim, u8 constraint_dim, u8 num_dds,
   matrix_eye(num_dds, &H_prime[constraint_dim * num_dds]);
 
   // multiply H_prime by U_inv to make it the actual H_prime
-  cblas_dtrmm(CblasRowMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasUnit, // CBLAS_ORDER, CBLAS_SIDE, CBLAS_UPLO, CBLAS_TRANSPOSE, CBLAS_DIAG
-              res_dim, num_dds, //M, N
-              1, U_inv, res_dim, //alpha, A, lda
-              H_prime, num_dds); //B, ldb
+  smat_trmm_unit_upper(res_dim, num_dds, U_inv, H_prime);
 }
 
 // y = H * x
@@ -693,11 +557,11 @@ void get_kf_matrices(u8 num_sdiffs, sdiff_t *sdiffs_with_ref_first,
   u8 constraint_dim = MAX(num_dds, 3) - 3;;
   u8 res_dim = num_dds + constraint_dim;
 
-  double Sig[res_dim * res_dim];
+  double Sig[MAX_OBS_DIM * MAX_OBS_DIM];
 
   //assign Sig and H
   if (constraint_dim > 0) {
-    double DE[num_dds * 3];
+    double DE[MAX_STATE_DIM * 3];
     assign_de_mtx(num_sdiffs, sdiffs_with_ref_first, ref_ecef, DE);
     assign_phase_obs_null_basis(num_dds, DE, null_basis_Q);
     assign_residual_obs_cov(num_dds, phase_var, code_var, null_basis_Q, Sig);
@@ -780,7 +644,7 @@ void rebase_mean_N(double *mean, u8 num_sats, u8 *old_prns, u8 *new_prns)
   u8 old_ref = old_prns[0];
   u8 new_ref = new_prns[0];
 
-  double new_mean[num_sats-1];
+  double new_mean[MAX_STATE_DIM];
   s32 index_of_new_ref_in_old = find_index_of_element_in_u8s(num_sats, new_ref, &old_prns[1]);
   double val_for_new_ref_in_old_basis = mean[index_of_new_ref_in_old];
   for (u8 i=0; i<num_sats-1; i++) {
@@ -819,31 +683,23 @@ void assign_state_rebase_mtx(u8 num_sats, u8 *old_prns, u8 *new_prns, double *re
 void rebase_covariance_sigma(double *state_cov, u8 num_sats, u8 *old_prns, u8 *new_prns)
 {
   u8 state_dim = num_sats - 1;
-  double rebase_mtx[state_dim * state_dim];
+  double rebase_mtx[MAX_STATE_DIM * MAX_STATE_DIM];
   assign_state_rebase_mtx(num_sats, old_prns, new_prns, rebase_mtx);
 
-  double intermediate_cov[state_dim * state_dim];
+  double intermediate_cov[MAX_STATE_DIM * MAX_STATE_DIM];
   //TODO make more efficient via structure of rebase_mtx
-  cblas_dsymm(CblasRowMajor, CblasRight, CblasUpper, //CBLAS_ORDER, CBLAS_SIDE, CBLAS_UPLO
-              state_dim, state_dim, // int M, int N
-              1, state_cov, state_dim, // double alpha, double *A, int lda
-              rebase_mtx, state_dim, // double *B, int ldb
-              0, intermediate_cov, state_dim); // double beta, double *C, int ldc
+  smat_symm_right_upper(state_dim, state_dim, 1, state_cov, rebase_mtx, intermediate_cov);
   // MAT_PRINTF(intermediate_cov, state_dim, state_dim);
 
   //TODO make more efficient via the structure of rebase_mtx
-  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, // CBLAS_ORDER, CBLAS_TRANSPOSE transA, cBLAS_TRANSPOSE transB
-              state_dim, state_dim, state_dim, // int M, int N, int K
-              1, intermediate_cov, state_dim, // double alpha, double *A, int lda
-              rebase_mtx, state_dim, //double *B, int ldb
-              0, state_cov, state_dim); //beta, double *C, int ldc
+  smat_gemm_nt(state_dim, state_dim, state_dim, 1, intermediate_cov, rebase_mtx, state_cov);
   // MAT_PRINTF(state_cov, state_dim, state_dim);
 }
 
 void rebase_covariance_udu(double *state_cov_U, double *state_cov_D, u8 num_sats, u8 *old_prns, u8 *new_prns)
 {
   u8 state_dim = num_sats - 1;
-  double state_cov[state_dim * state_dim];
+  double state_cov[MAX_STATE_DIM * MAX_STATE_DIM];
   matrix_reconstruct_udu(state_dim, state_cov_U, state_cov_D, state_cov);
   rebase_covariance_sigma(state_cov, num_sats, old_prns, new_prns);
   matrix_udu(state_dim, state_cov, state_cov_U, state_cov_D);
@@ -862,13 +718,13 @@ void nkf_state_projection(nkf_t *kf,
                                     u8 *ndx_of_new_sat_in_old)
 {
   u8 old_state_dim = num_old_non_ref_sats;
-  double old_cov[old_state_dim * old_state_dim];
+  double old_cov[MAX_STATE_DIM * MAX_STATE_DIM];
   matrix_reconstruct_udu(old_state_dim, kf->state_cov_U, kf->state_cov_D, old_cov);
   /*MAT_PRINTF(old_cov, old_state_dim, old_state_dim);*/
 
   u8 new_state_dim = num_new_non_ref_sats;
-  double new_cov[new_state_dim * new_state_dim];
-  double new_mean[new_state_dim];
+  double new_cov[MAX_STATE_DIM * MAX_STATE_DIM];
+  double new_mean[MAX_STATE_DIM];
 
   for (u8 i=0; i<num_new_non_ref_sats; i++) {
     u8 ndxi = ndx_of_new_sat_in_old[i];
@@ -893,13 +749,13 @@ void nkf_state_inclusion(nkf_t *kf,
                                    double int_init_var)
 {
   u8 old_state_dim = num_old_non_ref_sats;
-  double old_cov[old_state_dim * old_state_dim];
+  double old_cov[MAX_STATE_DIM * MAX_STATE_DIM];
   matrix_reconstruct_udu(old_state_dim, kf->state_cov_U, kf->state_cov_D, old_cov);
 
   u8 new_state_dim = num_new_non_ref_sats;
-  double new_cov[new_state_dim * new_state_dim];
+  double new_cov[MAX_STATE_DIM * MAX_STATE_DIM];
   memset(new_cov, 0, new_state_dim * new_state_dim * sizeof(double));
-  double new_mean[new_state_dim];
+  double new_mean[MAX_STATE_DIM];
   // initialize_state(kf, dd_measurements, amb_init_var); //TODO do we really want to initialize new states this way?
   memset(new_mean, 0, new_state_dim * sizeof(double));
   for (u8 i=0; i<num_new_non_ref_sats; i++) {
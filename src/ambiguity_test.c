@@ -10,15 +10,14 @@
  * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
  */
 
-#include <clapack.h>
 #include <inttypes.h>
-#include <cblas.h>
 #include <stdio.h>
 #include <string.h>
 #include "ambiguity_test.h"
 #include "common.h"
 #include "constants.h"
 #include "linear_algebra.h"
+#include "small_matrix.h"
 #include "single_diff.h"
 #include "amb_kf.h"
 #include "lambda.h"
@@ -171,18 +170,17 @@ void print_s32_mtx(u32 m, u32 n, s32 *mat)
  */
 void print_s32_gemv(u32 m, u32 n, s32 *M, s32 *v)
 {
-  s32 mv[m];
-  memset(mv, 0, m * sizeof(s32));
   printf("[");
   for (u32 i=0; i < m; i++) {
+    s32 mv = 0;
     for (u32 j=0; j < n; j++) {
-      mv[i] += M[i*n + j] * v[j];
+      mv += M[i*n + j] * v[j];
     }
     if (i+1 == m) {
-      printf("%"PRId32" ]\n", mv[i]);
+      printf("%"PRId32" ]\n", mv);
     }
     else {
-      printf("%"PRId32", ", mv[i]);
+      printf("%"PRId32", ", mv);
     }
   }
 }
@@ -326,7 +324,7 @@ void init_ambiguity_test(ambiguity_test_t *amb_test, u8 state_dim, u8 *float_prn
 {
   (void) sdiffs;
   u8 num_dds = state_dim;
-  double float_cov_N[num_dds * num_dds];
+  double float_cov_N[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
 
   /* Re-shape float_cov to contain just ambiguity states. */
   for (u8 i=0; i<num_dds; i++) {
@@ -343,9 +341,9 @@ void init_ambiguity_test(ambiguity_test_t *amb_test, u8 state_dim, u8 *float_prn
   /* Start with ll = 0, just for the sake of argument. */
   empty_element->ll = 0; // only in init
   amb_test->sats.num_sats = 0; // only in init
-  s32 Z_inv[num_dds * num_dds];
-  s32 lower_bounds[num_dds];
-  s32 upper_bounds[num_dds];
+  s32 Z_inv[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
+  s32 lower_bounds[MAX_CHANNELS-1];
+  s32 upper_bounds[MAX_CHANNELS-1];
   u8 num_dds_to_add;
   s8 add_any_sats =  determine_sats_addition(amb_test,
                                              float_cov_N, num_dds, &float_mean[6],
@@ -398,8 +396,8 @@ void update_ambiguity_test(double ref_ecef[3], double phase_var, double code_var
     return;
   }
 
-  sdiff_t ambiguity_sdiffs[amb_test->sats.num_sats];
-  double ambiguity_dd_measurements[2*(amb_test->sats.num_sats-1)];
+  sdiff_t ambiguity_sdiffs[MAX_CHANNELS];
+  double ambiguity_dd_measurements[2*(MAX_CHANNELS-1)];
   s8 valid_sdiffs = make_ambiguity_dd_measurements_and_sdiffs(
       amb_test, num_sdiffs, sdiffs, ambiguity_dd_measurements, ambiguity_sdiffs);
 
@@ -415,9 +413,9 @@ void update_ambiguity_test(double ref_ecef[3], double phase_var, double code_var
   }
 
   if (1 == 1 || changed_sats == 1) { //TODO add logic about when to update DE
-    double DE_mtx[(amb_test->sats.num_sats-1) * 3];
+    double DE_mtx[(MAX_CHANNELS-1) * 3];
     assign_de_mtx(amb_test->sats.num_sats, ambiguity_sdiffs, ref_ecef, DE_mtx);
-    double obs_cov[(amb_test->sats.num_sats-1) * (amb_test->sats.num_sats-1) * 4];
+    double obs_cov[(MAX_CHANNELS-1) * (MAX_CHANNELS-1) * 4];
     memset(obs_cov, 0, (amb_test->sats.num_sats-1) * (amb_test->sats.num_sats-1) * 4 * sizeof(double));
     u8 num_dds = amb_test->sats.num_sats-1;
     for (u8 i=0; i<num_dds; i++) {
@@ -480,7 +478,7 @@ typedef struct {
 void update_and_get_max_ll(void *x_, element_t *elem) {
   hyp_filter_t *x = (hyp_filter_t *) x_;
   hypothesis_t *hyp = (hypothesis_t *) elem;
-  double hypothesis_N[x->num_dds];
+  double hypothesis_N[MAX_CHANNELS-1];
 
   for (u8 i=0; i < x->num_dds; i++) {
     hypothesis_N[i] = hyp->N[i];
@@ -786,7 +784,7 @@ s8 make_ambiguity_resolved_dd_measurements_and_sdiffs(
 
   u8 ref_prn = amb_test->sats.prns[0];
   u8 num_dds = amb_test->amb_check.num_matching_ndxs;
-  u8 non_ref_prns[num_dds];
+  u8 non_ref_prns[MAX_CHANNELS-1];
   for (u8 i=0; i < num_dds; i++) {
     non_ref_prns[i] = amb_test->sats.prns[1 + amb_test->amb_check.matching_ndxs[i]];
     if (DEBUG_AMBIGUITY_TEST) {
@@ -906,7 +904,7 @@ void rebase_hypothesis(void *arg, element_t *elem) //TODO make it so it doesn't
   u8 old_ref = old_prns[0];
   u8 new_ref = new_prns[0];
 
-  s32 new_N[num_sats-1];
+  s32 new_N[MAX_CHANNELS-1];
   s32 index_of_new_ref_in_old = find_index_of_element_in_u8s(num_sats, new_ref, &old_prns[1]);
   s32 val_for_new_ref_in_old_basis = hypothesis->N[index_of_new_ref_in_old];
   for (u8 i=0; i<num_sats-1; i++) {
@@ -928,7 +926,7 @@ u8 ambiguity_update_reference(ambiguity_test_t *amb_test, u8 num_sdiffs, sdiff_t
     printf("<AMBIGUITY_UPDATE_REFERENCE>\n");
   }
   u8 changed_ref = 0;
-  u8 old_prns[amb_test->sats.num_sats];
+  u8 old_prns[MAX_CHANNELS];
   memcpy(old_prns, amb_test->sats.prns, amb_test->sats.num_sats * sizeof(u8));
 
   // print_sats_management_short(&amb_test->sats);
@@ -939,7 +937,7 @@ u8 ambiguity_update_reference(ambiguity_test_t *amb_test, u8 num_sdiffs, sdiff_t
       printf("updating iar reference sat\n");
     }
     changed_ref = 1;
-    u8 new_prns[amb_test->sats.num_sats];
+    u8 new_prns[MAX_CHANNELS];
     memcpy(new_prns, amb_test->sats.prns, amb_test->sats.num_sats * sizeof(u8));
 
     rebase_prns_t prns = {.num_sats = amb_test->sats.num_sats};
@@ -984,6 +982,20 @@ s32 projection_comparator(void *arg, element_t *a, element_t *b)
   return 0;
 }
 
+static u32 projection_hash(void *arg, element_t *a)
+{
+  intersection_ndxs_t *intersection_struct = (intersection_ndxs_t *) arg;
+  hypothesis_t *hyp_a = (hypothesis_t *) a;
+
+  /* FNV-1a style hash of the projected ambiguities. */
+  u32 h = 2166136261u;
+  for (u8 i=0; i<intersection_struct->num_ndxs; i++) {
+    h ^= (u32)hyp_a->N[intersection_struct->intersection_ndxs[i]];
+    h *= 16777619u;
+  }
+  return h;
+}
+
 void projection_aggregator(element_t *new_, void *x_, u32 n, element_t *elem_)
 {
   intersection_ndxs_t *x = (intersection_ndxs_t *)x_;
@@ -1004,7 +1016,26 @@ void projection_aggregator(element_t *new_, void *x_, u32 n, element_t *elem_)
 
 }
 
-u8 ambiguity_sat_projection(ambiguity_test_t *amb_test, u8 num_dds_in_intersection, u8 *dd_intersection_ndxs)
+/* The projection aggregates hypotheses on the stack in the hash group by. */
+_Static_assert(sizeof(hypothesis_t) <= MEMORY_POOL_MAX_ELEMENT_SIZE,
+               "hypothesis_t too large for memory_pool_group_by_hash()");
+_Static_assert(sizeof(intersection_ndxs_t) <= MEMORY_POOL_MAX_X_SIZE,
+               "intersection_ndxs_t too large for memory_pool_group_by_hash()");
+
+/** Projects the hypotheses onto a subset of the satellites.
+ * Hypotheses that agree on the ambiguities of the remaining satellites are
+ * merged, summing their likelihoods. The merged hypotheses are not sorted,
+ * they come out in the reverse of the order in which the first hypothesis of
+ * each group appeared in the pool.
+ *
+ * \param amb_test                The ambiguity test to project.
+ * \param num_dds_in_intersection The number of DDs kept.
+ * \param dd_intersection_ndxs    The indices of the kept DDs.
+ * \return 1 if the hypotheses were projected, 0 if there was nothing to drop
+ *         or -1 if the hypotheses could not be grouped (the ambiguity test is
+ *         left unchanged).
+ */
+s8 ambiguity_sat_projection(ambiguity_test_t *amb_test, u8 num_dds_in_intersection, u8 *dd_intersection_ndxs)
 {
   if (DEBUG_AMBIGUITY_TEST) {
     printf("<AMBIGUITY_SAT_PROJECTION>\n");
@@ -1023,10 +1054,20 @@ u8 ambiguity_sat_projection(ambiguity_test_t *amb_test, u8 num_dds_in_intersecti
 
   printf("IAR: %"PRIu32" hypotheses before projection\n", memory_pool_n_allocated(amb_test->pool));
   /*memory_pool_map(amb_test->pool, &num_dds_before_proj, &print_hyp);*/
-  memory_pool_group_by(amb_test->pool,
-                       &intersection, &projection_comparator,
-                       &intersection, sizeof(intersection),
-                       &projection_aggregator);
+  /* Group with a hash table in the amb_test's working area, dgnss_update()
+   * must not touch the heap. */
+  if (memory_pool_group_by_hash(amb_test->pool,
+                                &intersection, &projection_hash,
+                                &projection_comparator,
+                                &intersection, sizeof(intersection),
+                                &projection_aggregator,
+                                amb_test->group_buff) < 0) {
+    printf("IAR: projection failed\n");
+    if (DEBUG_AMBIGUITY_TEST) {
+      printf("</AMBIGUITY_SAT_PROJECTION>\n");
+    }
+    return -1;
+  }
   printf("IAR: updates to %"PRIu32"\n", memory_pool_n_allocated(amb_test->pool));
   /*memory_pool_map(amb_test->pool, &num_dds_in_intersection, &print_hyp);*/
   u8 work_prns[MAX_CHANNELS];
@@ -1056,21 +1097,21 @@ u8 ambiguity_sat_inclusion(ambiguity_test_t *amb_test, u8 num_dds_in_intersectio
   }
 
   u32 state_dim = float_sats->num_sats-1;
-  double float_cov[state_dim * state_dim];
+  double float_cov[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
   matrix_reconstruct_udu(state_dim, float_cov_U, float_cov_D, float_cov);
-  u8 float_prns[float_sats->num_sats];
+  u8 float_prns[MAX_CHANNELS];
   memcpy(float_prns, float_sats->prns, float_sats->num_sats * sizeof(u8));
-  double N_mean[float_sats->num_sats-1];
+  double N_mean[MAX_CHANNELS-1];
   memcpy(N_mean, float_mean, (float_sats->num_sats-1) * sizeof(double));
   if (amb_test->sats.num_sats >= 2 && amb_test->sats.prns[0] != float_sats->prns[0]) {
-    u8 old_prns[float_sats->num_sats];
+    u8 old_prns[MAX_CHANNELS];
     memcpy(old_prns, float_sats->prns, float_sats->num_sats * sizeof(u8));
     // memcpy(N_mean, &float_mean[6], (float_sats->num_sats-1) * sizeof(double));
     set_reference_sat_of_prns(amb_test->sats.prns[0], float_sats->num_sats, float_prns);
     rebase_mean_N(N_mean, float_sats->num_sats, old_prns, float_prns);
     rebase_covariance_sigma(float_cov, float_sats->num_sats, old_prns, float_prns);
   }
-  double N_cov[(float_sats->num_sats-1) * (float_sats->num_sats-1)];
+  double N_cov[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
   memcpy(N_cov, float_cov, state_dim * state_dim * sizeof(double)); //TODO we can just use N_cov throughout
   //by now float_prns has the correct reference, as do N_cov and N_mean
 
@@ -1117,8 +1158,8 @@ u8 ambiguity_sat_inclusion(ambiguity_test_t *amb_test, u8 num_dds_in_intersectio
     }
   }
 
-  double addible_float_cov[num_addible_dds * num_addible_dds];
-  double addible_float_mean[num_addible_dds];
+  double addible_float_cov[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
+  double addible_float_mean[MAX_CHANNELS-1];
   for (i=0; i < num_addible_dds; i++) {
     for (j=0; j < num_addible_dds; j++) {
       addible_float_cov[i*num_addible_dds + j] = N_cov[ndxs_of_new_dds_in_float[i]*(float_sats->num_sats-1) + ndxs_of_new_dds_in_float[j]];
@@ -1128,9 +1169,9 @@ u8 ambiguity_sat_inclusion(ambiguity_test_t *amb_test, u8 num_dds_in_intersectio
   // MAT_PRINTF(addible_float_cov, num_addible_dds, num_addible_dds);
   /*VEC_PRINTF(addible_float_mean, num_addible_dds);*/
 
-  s32 Z_inv[num_addible_dds * num_addible_dds];
-  s32 lower_bounds[num_addible_dds];
-  s32 upper_bounds[num_addible_dds];
+  s32 Z_inv[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
+  s32 lower_bounds[MAX_CHANNELS-1];
+  s32 upper_bounds[MAX_CHANNELS-1];
   u8 num_dds_to_add;
   s8 add_any_sats =  determine_sats_addition(amb_test,
                                              addible_float_cov, num_addible_dds, addible_float_mean,
@@ -1156,10 +1197,11 @@ u32 float_to_decor(ambiguity_test_t *amb_test,
                    double *addible_float_cov, u8 num_addible_dds,
                    double *addible_float_mean,
                    u8 num_dds_to_add,
-                   s32 *lower_bounds, s32 *upper_bounds, double *Z)
+                   s32 *lower_bounds, s32 *upper_bounds, double *Z,
+                   double *Z_inv)
 {
   (void) amb_test;
-  double added_float_cov[num_dds_to_add * num_dds_to_add];
+  double added_float_cov[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
   for (u8 i=0; i<num_dds_to_add; i++) {
     for (u8 j=0; j<num_dds_to_add; j++) {
       added_float_cov[i*num_dds_to_add + j] = addible_float_cov[i*num_addible_dds + j];
@@ -1171,10 +1213,14 @@ u32 float_to_decor(ambiguity_test_t *amb_test,
     }
   }
 
-  // double Z[num_dds_to_add * num_dds_to_add];
-  lambda_reduction(num_dds_to_add, added_float_cov, Z);
+  /* The reduction tracks Z^-1 exactly, so no general matrix inverse (and
+   * none of the n-sized VLAs of lambda_reduction() and matrix_inverse()) is
+   * needed on this path. */
+  lambda_workspace_t ws;
+  lambda_reduction_ws(&ws, num_dds_to_add, added_float_cov, Z);
+  memcpy(Z_inv, ws.Zi, num_dds_to_add * num_dds_to_add * sizeof(double));
 
-  double decor_float_cov_diag[num_dds_to_add];
+  double decor_float_cov_diag[MAX_CHANNELS-1];
 
   memset(decor_float_cov_diag, 0, num_dds_to_add * sizeof(double));
 
@@ -1189,7 +1235,7 @@ u32 float_to_decor(ambiguity_test_t *amb_test,
     #endif
   }
 
-  double decor_float_mean[num_dds_to_add];
+  double decor_float_mean[MAX_CHANNELS-1];
   memset(decor_float_mean, 0, num_dds_to_add * sizeof(double));
   for (u8 i=0; i < num_dds_to_add; i++) {
     for (u8 j=0; j < num_dds_to_add; j++) {
@@ -1234,17 +1280,16 @@ s8 determine_sats_addition(ambiguity_test_t *amb_test,
   // printf("\n");
 
   *num_dds_to_add = num_float_dds;
-  double Z[num_float_dds * num_float_dds];
+  double Z[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
+  double Z_inv_[(MAX_CHANNELS-1) * (MAX_CHANNELS-1)];
   while (*num_dds_to_add >= min_dds_to_add) {
     u32 new_hyp_set_cardinality = float_to_decor(amb_test,
                                                  float_N_cov, num_float_dds,
                                                  float_N_mean,
                                                  *num_dds_to_add,
-                                                 lower_bounds, upper_bounds, Z);
+                                                 lower_bounds, upper_bounds,
+                                                 Z, Z_inv_);
     if (new_hyp_set_cardinality <= max_new_hyps_cardinality) {
-      double Z_inv_[*num_dds_to_add * *num_dds_to_add];
-      matrix_inverse(*num_dds_to_add, Z, Z_inv_);
-      /* TODO: Check return value of matrix_inverse to handle singular matrix. */
       for (u8 i=0; i < *num_dds_to_add; i++) {
         for (u8 j=0; j < *num_dds_to_add; j++) {
           Z_inv[i* *num_dds_to_add + j] = lround(Z_inv_[i* *num_dds_to_add + j]);
@@ -1284,7 +1329,7 @@ u8 ambiguity_update_sats(ambiguity_test_t *amb_test, u8 num_sdiffs, sdiff_t *sdi
   //if the sats are the same, we're good
   u8 changed_sats = 0;
   if (!sats_match(amb_test, num_sdiffs, sdiffs)) {
-    sdiff_t sdiffs_with_ref_first[num_sdiffs];
+    sdiff_t sdiffs_with_ref_first[MAX_CHANNELS];
     if (amb_test->sats.num_sats >= 2) {
       if (ambiguity_update_reference(amb_test, num_sdiffs, sdiffs, sdiffs_with_ref_first)) {
        changed_sats=1;
@@ -1293,7 +1338,7 @@ u8 ambiguity_update_sats(ambiguity_test_t *amb_test, u8 num_sdiffs, sdiff_t *sdi
       create_ambiguity_test(amb_test);//we don't have what we need
     }
 
-    u8 intersection_ndxs[num_sdiffs];
+    u8 intersection_ndxs[MAX_CHANNELS];
     u8 num_dds_in_intersection = find_indices_of_intersection_sats(amb_test, num_sdiffs, sdiffs_with_ref_first, intersection_ndxs);
 
     if (amb_test->sats.num_sats > 1 && num_dds_in_intersection == 0) {
@@ -1301,7 +1346,14 @@ u8 ambiguity_update_sats(ambiguity_test_t *amb_test, u8 num_sdiffs, sdiff_t *sdi
     }
 
     // u8 num_dds_in_intersection = ambiguity_order_sdiffs_with_intersection(amb_test, sdiffs, float_cov, intersection_ndxs);
-    if (ambiguity_sat_projection(amb_test, num_dds_in_intersection, intersection_ndxs)) {
+    s8 projected = ambiguity_sat_projection(amb_test, num_dds_in_intersection,
+                                            intersection_ndxs);
+    if (projected < 0) {
+      /* The hypotheses still include the dropped sats, start over. */
+      create_ambiguity_test(amb_test);
+      num_dds_in_intersection = 0;
+    }
+    if (projected) {
       changed_sats = 1;
     }
     if (ambiguity_sat_inclusion(amb_test, num_dds_in_intersection,
@@ -1496,7 +1548,7 @@ void recorrelate_added_sats(void *arg, element_t *elem_)
    * shape (num_added_dds, num_added_dds) and I has shape
    * (num_old_dds, num_old_dds) */
 
-  s32 recorrelated_N[params->num_added_dds];
+  s32 recorrelated_N[MAX_CHANNELS-1];
   memset(recorrelated_N, 0, params->num_added_dds * sizeof(s32));
   for (u8 i=0; i<params->num_added_dds; i++) {
     for (u8 j=0; j<params->num_added_dds; j++) {
@@ -1547,7 +1599,7 @@ void add_sats(ambiguity_test_t *amb_test,
   u8 i = 0;
   u8 j = 0;
   u8 k = 0;
-  u8 old_prns[x0.num_old_dds];
+  u8 old_prns[MAX_CHANNELS-1];
   memcpy(old_prns, &amb_test->sats.prns[1], x0.num_old_dds * sizeof(u8));
   while (k < x0.num_old_dds + num_added_dds) { //TODO should this be one less, since its just DDs?
     if (j == x0.num_added_dds || (old_prns[i] < added_prns[j] && i != x0.num_old_dds)) {
@@ -1673,10 +1725,10 @@ void init_residual_matrices(residual_mtxs_t *res_mtxs, u8 num_dds, double *DE_mt
 
 void assign_residual_covariance_inverse(u8 num_dds, double *obs_cov, double *q, double *r_cov_inv) //TODO make this more efficient (e.g. via page 3/6.2-3/2014 of ian's notebook)
 {
-  integer dd_dim = 2*num_dds;
-  integer res_dim = num_dds + MAX(3, num_dds) - 3;
+  u8 dd_dim = 2*num_dds;
+  u8 res_dim = num_dds + MAX(3, num_dds) - 3;
   u32 nullspace_dim = MAX(3, num_dds) - 3;
-  double q_tilde[res_dim * dd_dim];
+  double q_tilde[(2*MAX_CHANNELS-5) * 2 * (MAX_CHANNELS-1)];
   memset(q_tilde, 0, res_dim * dd_dim * sizeof(double));
   // MAT_PRINTF(obs_cov, dd_dim, dd_dim);
 
@@ -1692,48 +1744,23 @@ void assign_residual_covariance_inverse(u8 num_dds, double *obs_cov, double *q,
   // MAT_PRINTF(q_tilde, res_dim, dd_dim);
 
   //TODO make more efficient via the structure of q_tilde, and it's relation to the I + 1*1^T structure of the obs cov mtx
-  double QC[res_dim * dd_dim];
-  cblas_dsymm(CblasRowMajor, CblasRight, CblasUpper, //CBLAS_ORDER, CBLAS_SIDE, CBLAS_UPLO
-              res_dim, dd_dim, // int M, int N
-              1, obs_cov, dd_dim, // double alpha, double *A, int lda
-              q_tilde, dd_dim, // double *B, int ldb
-              0, QC, dd_dim); // double beta, double *C, int ldc
+  double QC[(2*MAX_CHANNELS-5) * 2 * (MAX_CHANNELS-1)];
+  smat_symm_right_upper(res_dim, dd_dim, 1, obs_cov, q_tilde, QC);
   // MAT_PRINTF(QC, res_dim, dd_dim);
 
   //TODO make more efficient via the structure of q_tilde, and it's relation to the I + 1*1^T structure of the obs cov mtx
-  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, // CBLAS_ORDER, CBLAS_TRANSPOSE transA, cBLAS_TRANSPOSE transB
-              res_dim, res_dim, dd_dim, // int M, int N, int K
-              2, QC, dd_dim, // double alpha, double *A, int lda
-              q_tilde, dd_dim, //double *B, int ldb
-              0, r_cov_inv, res_dim); //beta, double *C, int ldc
+  smat_gemm_nt(res_dim, res_dim, dd_dim, 2, QC, q_tilde, r_cov_inv);
   // MAT_PRINTF(r_cov_inv, res_dim, res_dim);
 
-  // dpotrf_(char *uplo, __CLPK_integer *n, __CLPK_doublereal *a, __CLPK_integer *
-  //       lda, __CLPK_integer *info)
-  //dpotri_(char *uplo, __CLPK_integer *n, __CLPK_doublereal *a, __CLPK_integer *
-  //        lda, __CLPK_integer *info)
-  char uplo = 'L'; //actually this makes it upper. the lapack stuff is all column major, but we're good since we're operiating on symmetric matrices
-  integer info;
-  dpotrf_(&uplo, &res_dim, r_cov_inv, &res_dim, &info);
-  // printf("info: %i\n", (int) info);
-  // MAT_PRINTF(r_cov_inv, res_dim, res_dim);
-  dpotri_(&uplo, &res_dim, r_cov_inv, &res_dim, &info);
-  for (u8 i=0; i < res_dim; i++) {
-    for (u8 j=0; j < i; j++) {
-      r_cov_inv[i*res_dim + j] = r_cov_inv[j*res_dim + i];
-    }
-  }
-  // printf("info: %i\n", (int) info);
+  smat_spd_inverse(res_dim, r_cov_inv);
   // MAT_PRINTF(r_cov_inv, res_dim, res_dim);
 }
 
 void assign_r_vec(residual_mtxs_t *res_mtxs, u8 num_dds, double *dd_measurements, double *r_vec)
 {
-  cblas_dgemv(CblasRowMajor, CblasNoTrans,
-              res_mtxs->null_space_dim, num_dds,
-              1, res_mtxs->null_projector, num_dds,
-              dd_measurements, 1,
-              0, r_vec, 1);
+  smat_gemv(res_mtxs->null_space_dim, num_dds,
+            1, res_mtxs->null_projector,
+            dd_measurements, 0, r_vec);
   for (u8 i=0; i< num_dds; i++) {
     r_vec[i + res_mtxs->null_space_dim] = dd_measurements[i] - dd_measurements[i+num_dds] / GPS_L1_LAMBDA_NO_VAC;
   }
@@ -1741,30 +1768,25 @@ void assign_r_vec(residual_mtxs_t *res_mtxs, u8 num_dds, double *dd_measurements
 
 void assign_r_mean(residual_mtxs_t *res_mtxs, u8 num_dds, double *hypothesis, double *r_mean)
 {
-  cblas_dgemv(CblasRowMajor, CblasNoTrans,
-              res_mtxs->null_space_dim, num_dds,
-              1, res_mtxs->null_projector, num_dds,
-              hypothesis, 1,
-              0, r_mean, 1);
+  smat_gemv(res_mtxs->null_space_dim, num_dds,
+            1, res_mtxs->null_projector,
+            hypothesis, 0, r_mean);
   memcpy(&r_mean[res_mtxs->null_space_dim], hypothesis, num_dds * sizeof(double));
 }
 
 double get_quadratic_term(residual_mtxs_t *res_mtxs, u8 num_dds, double *hypothesis, double *r_vec)
 {
   // VEC_PRINTF(r_vec, res_mtxs->res_dim);
-  double r[res_mtxs->res_dim];
+  double r[2*MAX_CHANNELS-5];
   assign_r_mean(res_mtxs, num_dds, hypothesis, r);
   // VEC_PRINTF(r, res_mtxs->res_dim);
   for (u32 i=0; i<res_mtxs->res_dim; i++) {
     r[i] = r_vec[i] - r[i];
   }
   // VEC_PRINTF(r, res_mtxs->res_dim);
-  double half_sig_dot_r[res_mtxs->res_dim];
-  cblas_dsymv(CblasRowMajor, CblasUpper,
-                 res_mtxs->res_dim,
-                 1, res_mtxs->half_res_cov_inv, res_mtxs->res_dim,
-                 r, 1,
-                 0, half_sig_dot_r, 1);
+  double half_sig_dot_r[2*MAX_CHANNELS-5];
+  smat_symv_upper(res_mtxs->res_dim, res_mtxs->half_res_cov_inv, r,
+                  half_sig_dot_r);
   // VEC_PRINTF(half_sig_dot_r, res_mtxs->res_dim);
   double quad_term = 0;
   for (u32 i=0; i<res_mtxs->res_dim; i++) {
@@ -10,30 +10,78 @@
  * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
  */
 
+#include <string.h>
+
 #include "bits.h"
 
 /** \defgroup bits Bit Utils
  * Bit field packing, unpacking and utility functions.
  * \{ */
 
+/** Load the bytes holding a bit field into a word.
+ * Only the bytes containing bits `pos ... pos+len-1` are read, the first
+ * into the most significant occupied byte of the word.
+ *
+ * \param pos Position in buffer of start of bit field in bits.
+ * \param len Length of bit field in bits, `0 < len <= 32`.
+ * \param shift Output, position of the least significant bit of the field
+ *              in the returned word.
+ * \return Word holding the bytes spanned by the bit field.
+ */
+static inline u64 load_span(const u8 *buff, u32 pos, u32 len, u32 *shift)
+{
+  const u8 *p = &buff[pos / 8];
+  u32 n_bytes = (pos % 8 + len + 7) / 8;
+  u64 word = 0;
+
+  for (u32 i = 0; i < n_bytes; i++)
+    word = (word << 8) | p[i];
+
+  *shift = 8*n_bytes - pos % 8 - len;
+  return word;
+}
+
+/** Load 8 bytes as a big-endian word. */
+static inline u64 load_be64(const u8 *p)
+{
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  u64 word;
+  memcpy(&word, p, sizeof(word));
+  return __builtin_bswap64(word);
+#else
+  u64 word = 0;
+  for (u32 i = 0; i < 8; i++)
+    word = (word << 8) | p[i];
+  return word;
+#endif
+}
+
 /** Get bit field from buffer as an unsigned integer.
  * Unpacks `len` bits at bit position `pos` from the start of the buffer.
  * Maximum bit field length is 32 bits, i.e. `len <= 32`.
  *
+ * The bytes spanned by the field are loaded into a word at once rather than
+ * extracting one bit at a time, only those bytes are read.
+ *
  * \param pos Position in buffer of start of bit field in bits.
  * \param len Length of bit field in bits.
  * \return Bit field as an unsigned value.
  */
 u32 getbitu(const u8 *buff, u32 pos, u8 len)
 {
-    u32 bits = 0;
+  if (len == 0)
+    return 0;
 
-    for (u32 i = pos; i < pos + len; i++) {
-      bits = (bits << 1) +
-             ((buff[i/8] >> (7 - i%8)) & 1u);
-    }
+  /* Longer fields are truncated to their last 32 bits. */
+  if (len > 32) {
+    pos += len - 32;
+    len = 32;
+  }
 
-    return bits;
+  u32 shift;
+  u64 word = load_span(buff, pos, len, &shift);
+  return (word >> shift) & (0xFFFFFFFFu >> (32 - len));
 }
 
 /** Get bit field from buffer as a signed integer.
@@ -48,36 +96,40 @@ u32 getbitu(const u8 *buff, u32 pos, u8 len)
  */
 s32 getbits(const u8 *buff, u32 pos, u8 len)
 {
-    s32 bits = (s32)getbitu(buff, pos, len);
+    u32 bits = getbitu(buff, pos, len);
 
     /* Sign extend, taken from:
      * http://graphics.stanford.edu/~seander/bithacks.html#VariableSignExtend
+     * Done unsigned to avoid overflow when `len` is 32.
      */
-    s32 m = 1u << (len - 1);
-    return (bits ^ m) - m;
+    u32 m = 1u << (len - 1);
+    return (s32)((bits ^ m) - m);
 }
 
 /** Set bit field in buffer from an unsigned integer.
  * Packs `len` bits into bit position `pos` from the start of the buffer.
  * Maximum bit field length is 32 bits, i.e. `len <= 32`.
  *
+ * Only the bytes spanned by the bit field are read and written, the other
+ * bits in those bytes are left unchanged.
+ *
  * \param pos Position in buffer of start of bit field in bits.
  * \param len Length of bit field in bits.
  * \param data Unsigned integer to be packed into bit field.
  */
 void setbitu(u8 *buff, u32 pos, u32 len, u32 data)
 {
-  u32 mask = 1u << (len - 1);
-
   if (len <= 0 || 32 < len)
     return;
 
-  for (u32 i = pos; i < pos + len; i++, mask >>= 1) {
-    if (data & mask)
-      buff[i/8] |= 1u << (7 - i % 8);
-    else
-      buff[i/8] &= ~(1u << (7 - i % 8));
-  }
+  u32 shift;
+  u64 word = load_span(buff, pos, len, &shift);
+  u64 mask = (u64)(0xFFFFFFFFu >> (32 - len)) << shift;
+  word = (word & ~mask) | (((u64)data << shift) & mask);
+
+  u8 *p = &buff[pos / 8];
+  for (s32 i = (pos % 8 + len + 7) / 8 - 1; i >= 0; i--, word >>= 8)
+    p[i] = word & 0xFF;
 }
 
 /** Set bit field in buffer from a signed integer.
@@ -93,5 +145,174 @@ void setbits(u8 *buff, u32 pos, u32 len, s32 data)
   setbitu(buff, pos, len, (u32)data);
 }
 
+/** Initialize a #bit_reader_t to read sequential bit fields from a buffer.
+ *
+ * \param r   Bit reader to initialize.
+ * \param buff Buffer to read from.
+ * \param len Length of the buffer in bytes, nothing past it is read.
+ * \param pos Position in buffer of the first bit field in bits.
+ */
+void bit_reader_init(bit_reader_t *r, const u8 *buff, u32 len, u32 pos)
+{
+  r->buff = buff;
+  r->len = len;
+  r->byte_pos = pos / 8;
+  r->cache = 0;
+  r->n_cached = 0;
+  r->overrun = 0;
+  bit_reader_getu(r, pos % 8);
+}
+
+/** Get the next bit field as an unsigned integer.
+ * The reader keeps up to 64 bits of the buffer cached so most fields are
+ * read with a shift and no memory access.
+ *
+ * Reading past the end of the buffer sets the `overrun` flag of the reader
+ * and returns zeros for the missing bits.
+ *
+ * \param r   Bit reader.
+ * \param len Length of bit field in bits, `len <= 32`.
+ * \return Bit field as an unsigned value.
+ */
+u32 bit_reader_getu(bit_reader_t *r, u8 len)
+{
+  if (len == 0 || len > 32)
+    return 0;
+
+  if (r->n_cached < len && r->byte_pos + 8 <= r->len) {
+    /* Top up the cache with whole bytes from an 8 byte load. Any bits of a
+     * partly loaded byte are loaded again by the next top up, harmlessly as
+     * they are ORed into the same positions. */
+    u32 n_bytes = (64 - r->n_cached) / 8;
+    r->cache |= load_be64(&r->buff[r->byte_pos]) >> r->n_cached;
+    r->byte_pos += n_bytes;
+    r->n_cached += 8*n_bytes;
+  }
+
+  if (r->n_cached < len) {
+    /* Near the end of the buffer, top up the cache a byte at a time. */
+    while (r->n_cached <= 56 && r->byte_pos < r->len) {
+      r->cache |= (u64)r->buff[r->byte_pos++] << (56 - r->n_cached);
+      r->n_cached += 8;
+    }
+    if (r->n_cached < len) {
+      r->overrun = 1;
+      r->n_cached = len;
+    }
+  }
+
+  u32 bits = r->cache >> (64 - len);
+  r->cache <<= len;
+  r->n_cached -= len;
+  return bits;
+}
+
+/** Get the next bit field as a signed integer.
+ * Sign extends the `len` bit field to a signed 32 bit integer, see
+ * bit_reader_getu().
+ *
+ * \param r   Bit reader.
+ * \param len Length of bit field in bits, `0 < len <= 32`.
+ * \return Bit field as a signed value.
+ */
+s32 bit_reader_gets(bit_reader_t *r, u8 len)
+{
+  u32 bits = bit_reader_getu(r, len);
+  u32 m = 1u << (len - 1);
+  return (s32)((bits ^ m) - m);
+}
+
+/** Position of the next bit field to be read, in bits from the start of the
+ * buffer. */
+u32 bit_reader_pos(bit_reader_t *r)
+{
+  return 8*r->byte_pos - r->n_cached;
+}
+
+/** Initialize a #bit_writer_t to write sequential bit fields into a buffer.
+ * Bits before `pos` in its byte are preserved.
+ *
+ * \param w   Bit writer to initialize.
+ * \param buff Buffer to write to.
+ * \param len Length of the buffer in bytes, nothing past it is written.
+ * \param pos Position in buffer of the first bit field in bits.
+ */
+void bit_writer_init(bit_writer_t *w, u8 *buff, u32 len, u32 pos)
+{
+  w->buff = buff;
+  w->len = len;
+  w->byte_pos = pos / 8;
+  w->n_cached = pos % 8;
+  w->cache = 0;
+  w->overrun = 0;
+  if (w->n_cached && w->byte_pos < len)
+    w->cache = (u64)(buff[w->byte_pos] >> (8 - w->n_cached))
+               << (64 - w->n_cached);
+}
+
+/** Write the next bit field from an unsigned integer.
+ * Whole bytes are written to the buffer as they are completed, call
+ * bit_writer_flush() to write out a final partial byte.
+ *
+ * Writing past the end of the buffer sets the `overrun` flag of the writer
+ * and the bits that don't fit are dropped.
+ *
+ * \param w    Bit writer.
+ * \param len  Length of bit field in bits, `len <= 32`.
+ * \param data Unsigned integer to be packed into bit field.
+ */
+void bit_writer_setu(bit_writer_t *w, u8 len, u32 data)
+{
+  if (len == 0 || len > 32)
+    return;
+
+  data &= 0xFFFFFFFFu >> (32 - len);
+  w->cache |= (u64)data << (64 - w->n_cached - len);
+  w->n_cached += len;
+
+  for (; w->n_cached >= 8; w->n_cached -= 8, w->cache <<= 8) {
+    if (w->byte_pos < w->len)
+      w->buff[w->byte_pos++] = w->cache >> 56;
+    else
+      w->overrun = 1;
+  }
+}
+
+/** Write the next bit field from a signed integer, see bit_writer_setu().
+ *
+ * \param w    Bit writer.
+ * \param len  Length of bit field in bits, `len <= 32`.
+ * \param data Signed integer to be packed into bit field.
+ */
+void bit_writer_sets(bit_writer_t *w, u8 len, s32 data)
+{
+  bit_writer_setu(w, len, (u32)data);
+}
+
+/** Write out any final partial byte.
+ * The bits after the last bit field in that byte are preserved. Writing may
+ * continue afterwards.
+ *
+ * \param w Bit writer.
+ */
+void bit_writer_flush(bit_writer_t *w)
+{
+  if (w->n_cached == 0)
+    return;
+
+  if (w->byte_pos < w->len)
+    w->buff[w->byte_pos] = (w->cache >> 56) |
+                           (w->buff[w->byte_pos] & (0xFF >> w->n_cached));
+  else
+    w->overrun = 1;
+}
+
+/** Position of the next bit field to be written, in bits from the start of
+ * the buffer. */
+u32 bit_writer_pos(bit_writer_t *w)
+{
+  return 8*w->byte_pos + w->n_cached;
+}
+
 /** \} */
 
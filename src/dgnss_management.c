@@ -110,7 +110,7 @@ void dgnss_init(u8 num_sats, sdiff_t *sdiffs, double reciever_ecef[3])
   if (DEBUG_DGNSS_MANAGEMENT) {
       printf("<DGNSS_INIT>\n");
   }
-  sdiff_t corrected_sdiffs[num_sats];
+  sdiff_t corrected_sdiffs[MAX_CHANNELS];
   init_sats_management(&sats_management, num_sats, sdiffs, corrected_sdiffs);
 
   create_ambiguity_test(&ambiguity_test);
@@ -122,7 +122,7 @@ void dgnss_init(u8 num_sats, sdiff_t *sdiffs, double reciever_ecef[3])
     return;
   }
 
-  double dd_measurements[2*(num_sats-1)];
+  double dd_measurements[2*(MAX_CHANNELS-1)];
   make_measurements(num_sats-1, corrected_sdiffs, dd_measurements);
 
   set_nkf(
@@ -143,7 +143,7 @@ void dgnss_start_over(u8 num_sats, sdiff_t *sdiffs, double reciever_ecef[3])
   if (DEBUG_DGNSS_MANAGEMENT) {
       printf("<DGNSS_START_OVER>\n");
   }
-  sdiff_t corrected_sdiffs[num_sats];
+  sdiff_t corrected_sdiffs[MAX_CHANNELS];
   init_sats_management(&sats_management, num_sats, sdiffs, corrected_sdiffs);
 
   reset_ambiguity_test(&ambiguity_test);
@@ -154,7 +154,7 @@ void dgnss_start_over(u8 num_sats, sdiff_t *sdiffs, double reciever_ecef[3])
     }
     return;
   }
-  double dd_measurements[2*(num_sats-1)];
+  double dd_measurements[2*(MAX_CHANNELS-1)];
   make_measurements(num_sats-1, corrected_sdiffs, dd_measurements);
 
   set_nkf(
@@ -207,15 +207,15 @@ void dgnss_update_sats(u8 num_sdiffs, double reciever_ecef[3], sdiff_t *sdiffs_w
     printf("<DGNSS_UPDATE_SATS>\n");
   }
   (void)dd_measurements;
-  u8 new_prns[num_sdiffs];
+  u8 new_prns[MAX_CHANNELS];
   sdiffs_to_prns(num_sdiffs, sdiffs_with_ref_first, new_prns);
 
   u8 old_prns[MAX_CHANNELS];
   memcpy(old_prns, sats_management.prns, sats_management.num_sats * sizeof(u8));
 
   if (!prns_match(&old_prns[1], num_sdiffs-1, &sdiffs_with_ref_first[1])) {
-    u8 ndx_of_intersection_in_old[sats_management.num_sats];
-    u8 ndx_of_intersection_in_new[sats_management.num_sats];
+    u8 ndx_of_intersection_in_old[MAX_CHANNELS];
+    u8 ndx_of_intersection_in_new[MAX_CHANNELS];
     ndx_of_intersection_in_old[0] = 0;
     ndx_of_intersection_in_new[0] = 0;
     u8 num_intersection_sats = dgnss_intersect_sats(
@@ -317,7 +317,7 @@ void dgnss_update(u8 num_sats, sdiff_t *sdiffs, double reciever_ecef[3])
     dgnss_start_over(num_sats, sdiffs, reciever_ecef);
   }
 
-  sdiff_t sdiffs_with_ref_first[num_sats];
+  sdiff_t sdiffs_with_ref_first[MAX_CHANNELS];
 
   u8 old_prns[MAX_CHANNELS];
   memcpy(old_prns, sats_management.prns, sats_management.num_sats * sizeof(u8));
@@ -326,7 +326,7 @@ void dgnss_update(u8 num_sats, sdiff_t *sdiffs, double reciever_ecef[3])
    * (permutes sdiffs_with_ref_first accordingly) */
   dgnss_rebase_ref(num_sats, sdiffs, reciever_ecef, old_prns, sdiffs_with_ref_first);
 
-  double dd_measurements[2*(num_sats-1)];
+  double dd_measurements[2*(MAX_CHANNELS-1)];
   make_measurements(num_sats-1, sdiffs_with_ref_first, dd_measurements);
 
   /* all the added/dropped sat stuff */
@@ -386,6 +386,22 @@ u32 dgnss_iar_num_hyps(void)
   }
 }
 
+/** Get the usage statistics of the IAR hypothesis pool.
+ * The high water mark and add failures show how close the ambiguity test
+ * comes to its #MAX_HYPOTHESES limit.
+ *
+ * \param stats Pointer to a ::memory_pool_stats_t to fill in, zeroed if the
+ *              ambiguity test has not been initialised.
+ */
+void dgnss_iar_pool_stats(memory_pool_stats_t *stats)
+{
+  if (ambiguity_test.pool == NULL) {
+    memset(stats, 0, sizeof(memory_pool_stats_t));
+  } else {
+    memory_pool_get_stats(ambiguity_test.pool, stats);
+  }
+}
+
 u32 dgnss_iar_num_sats(void)
 {
   return ambiguity_test.sats.num_sats;
@@ -394,7 +410,7 @@ u32 dgnss_iar_num_sats(void)
 s8 dgnss_iar_get_single_hyp(double *dhyp)
 {
   u8 num_dds = ambiguity_test.sats.num_sats;
-  s32 hyp[num_dds];
+  s32 hyp[MAX_CHANNELS-1];
   s8 ret = get_single_hypothesis(&ambiguity_test, hyp);
   for (u8 i=0; i<num_dds; i++) {
     dhyp[i] = hyp[i];
@@ -407,7 +423,7 @@ void dgnss_new_float_baseline(u8 num_sats, sdiff_t *sdiffs, double receiver_ecef
   if (DEBUG_DGNSS_MANAGEMENT) {
     printf("<DGNSS_NEW_FLOAT_BASELINE>\n");
   }
-  sdiff_t corrected_sdiffs[num_sats];
+  sdiff_t corrected_sdiffs[MAX_CHANNELS];
 
   u8 old_prns[MAX_CHANNELS];
   memcpy(old_prns, sats_management.prns, sats_management.num_sats * sizeof(u8));
@@ -415,7 +431,7 @@ void dgnss_new_float_baseline(u8 num_sats, sdiff_t *sdiffs, double receiver_ecef
    * (permutes corrected_sdiffs accordingly) */
   dgnss_rebase_ref(num_sats, sdiffs, receiver_ecef, old_prns, corrected_sdiffs);
 
-  double dd_measurements[2*(num_sats-1)];
+  double dd_measurements[2*(MAX_CHANNELS-1)];
   make_measurements(num_sats-1, corrected_sdiffs, dd_measurements);
 
   least_squares_solve_b(&nkf, corrected_sdiffs, dd_measurements, receiver_ecef, b);
@@ -429,11 +445,11 @@ void dgnss_fixed_baseline(u8 n, sdiff_t *sdiffs, double ref_ecef[3],
                           u8 *num_used, double b[3])
 {
   if (dgnss_iar_resolved()) {
-    sdiff_t ambiguity_sdiffs[ambiguity_test.sats.num_sats];
-    double dd_meas[2*(ambiguity_test.sats.num_sats-1)];
+    sdiff_t ambiguity_sdiffs[MAX_CHANNELS];
+    double dd_meas[2*(MAX_CHANNELS-1)];
     make_ambiguity_dd_measurements_and_sdiffs(&ambiguity_test, n, sdiffs,
         dd_meas, ambiguity_sdiffs);
-    double DE[(ambiguity_test.sats.num_sats-1) * 3];
+    double DE[(MAX_CHANNELS-1) * 3];
     assign_de_mtx(ambiguity_test.sats.num_sats, ambiguity_sdiffs, ref_ecef, DE);
     hypothesis_t *hyp = (hypothesis_t*)ambiguity_test.pool->allocated_nodes_head->elem;
     *num_used = ambiguity_test.sats.num_sats;
@@ -451,14 +467,14 @@ s8 dgnss_fixed_baseline2(u8 num_sdiffs, sdiff_t *sdiffs, double ref_ecef[3],
                          u8 *num_used, double b[3])
 {
   if (ambiguity_iar_can_solve(&ambiguity_test)) {
-    sdiff_t ambiguity_sdiffs[ambiguity_test.amb_check.num_matching_ndxs+1];
-    double dd_meas[2 * ambiguity_test.amb_check.num_matching_ndxs];
+    sdiff_t ambiguity_sdiffs[MAX_CHANNELS];
+    double dd_meas[2 * (MAX_CHANNELS-1)];
     s8 valid_sdiffs = make_ambiguity_resolved_dd_measurements_and_sdiffs(&ambiguity_test, num_sdiffs, sdiffs,
         dd_meas, ambiguity_sdiffs);
     /* At this point, sdiffs should be valid due to dgnss_update
      * Return code not equal to 0 signals an error. */
     if (valid_sdiffs == 0) {
-      double DE[ambiguity_test.amb_check.num_matching_ndxs * 3];
+      double DE[(MAX_CHANNELS-1) * 3];
       assign_de_mtx(ambiguity_test.amb_check.num_matching_ndxs + 1, ambiguity_sdiffs, ref_ecef, DE);
       *num_used = ambiguity_test.amb_check.num_matching_ndxs + 1;
       lesq_solution(ambiguity_test.amb_check.num_matching_ndxs, dd_meas, ambiguity_test.amb_check.ambs, DE, b, 0);
@@ -541,8 +557,8 @@ s8 _dgnss_low_latency_float_baseline(u8 num_sdiffs, sdiff_t *sdiffs,
     }
     return -1;
   }
-  double float_dd_measurements[2 * (sats_management.num_sats - 1)];
-  sdiff_t float_sdiffs[sats_management.num_sats];
+  double float_dd_measurements[2 * (MAX_CHANNELS - 1)];
+  sdiff_t float_sdiffs[MAX_CHANNELS];
   s8 can_make_obs = make_dd_measurements_and_sdiffs(sats_management.prns[0],
              &sats_management.prns[1], sats_management.num_sats - 1,
              num_sdiffs, sdiffs,
@@ -593,18 +609,18 @@ s8 _dgnss_low_latency_IAR_baseline(u8 num_sdiffs, sdiff_t *sdiffs,
     printf("<DGNSS_LOW_LATENCY_IAR_BASELINE>\n");
   }
   if (ambiguity_iar_can_solve(&ambiguity_test)) {
-    sdiff_t ambiguity_sdiffs[ambiguity_test.amb_check.num_matching_ndxs+1];
-    double dd_meas[2 * ambiguity_test.amb_check.num_matching_ndxs];
+    sdiff_t ambiguity_sdiffs[MAX_CHANNELS];
+    double dd_meas[2 * (MAX_CHANNELS-1)];
     s8 valid_sdiffs = make_ambiguity_resolved_dd_measurements_and_sdiffs(
         &ambiguity_test, num_sdiffs, sdiffs, dd_meas, ambiguity_sdiffs);
     if (valid_sdiffs == 0) {
+      u8 num_dds = ambiguity_test.amb_check.num_matching_ndxs;
+      s32 *ambs = ambiguity_test.amb_check.ambs;
       //TODO: check internals of this if's content and abstract it from the KF
-      double DE[ambiguity_test.amb_check.num_matching_ndxs * 3];
-      assign_de_mtx(ambiguity_test.amb_check.num_matching_ndxs + 1,
-                    ambiguity_sdiffs, ref_ecef, DE);
-      *num_used = ambiguity_test.amb_check.num_matching_ndxs + 1;
-      lesq_solution(ambiguity_test.amb_check.num_matching_ndxs,
-                    dd_meas, ambiguity_test.amb_check.ambs, DE, b, 0);
+      double DE[(MAX_CHANNELS-1) * 3];
+      assign_de_mtx(num_dds + 1, ambiguity_sdiffs, ref_ecef, DE);
+      *num_used = num_dds + 1;
+      lesq_solution(num_dds, dd_meas, ambs, DE, b, 0);
       if (DEBUG_DGNSS_MANAGEMENT) {
         printf("</DGNSS_LOW_LATENCY_IAR_BASELINE>\n");
       }
@@ -683,7 +699,7 @@ void dgnss_init_known_baseline(u8 num_sats, sdiff_t *sdiffs, double receiver_ece
   ref_ecef[1] = receiver_ecef[1] + 0.5 * b[1];
   ref_ecef[2] = receiver_ecef[2] + 0.5 * b[2];
 
-  sdiff_t corrected_sdiffs[num_sats];
+  sdiff_t corrected_sdiffs[MAX_CHANNELS];
 
   u8 old_prns[MAX_CHANNELS];
   memcpy(old_prns, sats_management.prns, sats_management.num_sats * sizeof(u8));
@@ -691,10 +707,10 @@ void dgnss_init_known_baseline(u8 num_sats, sdiff_t *sdiffs, double receiver_ece
    * (permutes corrected_sdiffs accordingly) */
   dgnss_rebase_ref(num_sats, sdiffs, ref_ecef, old_prns, corrected_sdiffs);
 
-  double dds[2*(num_sats-1)];
+  double dds[2*(MAX_CHANNELS-1)];
   make_measurements(num_sats-1, corrected_sdiffs, dds);
 
-  double DE[(num_sats-1)*3];
+  double DE[(MAX_CHANNELS-1)*3];
   assign_de_mtx(num_sats, corrected_sdiffs, ref_ecef, DE);
 
   dgnss_reset_iar();
@@ -704,7 +720,7 @@ void dgnss_init_known_baseline(u8 num_sats, sdiff_t *sdiffs, double receiver_ece
   hyp->ll = 0;
   amb_from_baseline(num_sats, DE, dds, b, hyp->N);
 
-  double obs_cov[(num_sats-1) * (num_sats-1) * 4];
+  double obs_cov[(MAX_CHANNELS-1) * (MAX_CHANNELS-1) * 4];
   memset(obs_cov, 0, (num_sats-1) * (num_sats-1) * 4 * sizeof(double));
   u8 num_dds = num_sats-1;
   for (u8 i=0; i<num_dds; i++) {
@@ -737,7 +753,7 @@ void dgnss_init_known_baseline2(u8 num_sats, sdiff_t *sdiffs, double receiver_ec
   ref_ecef[1] = receiver_ecef[1] + 0.5 * b[1];
   ref_ecef[2] = receiver_ecef[2] + 0.5 * b[2];
 
-  sdiff_t corrected_sdiffs[num_sats];
+  sdiff_t corrected_sdiffs[MAX_CHANNELS];
 
   u8 old_prns[MAX_CHANNELS];
   memcpy(old_prns, sats_management.prns, sats_management.num_sats * sizeof(u8));
@@ -745,11 +761,11 @@ void dgnss_init_known_baseline2(u8 num_sats, sdiff_t *sdiffs, double receiver_ec
    * (permutes corrected_sdiffs accordingly) */
   dgnss_rebase_ref(num_sats, sdiffs, ref_ecef, old_prns, corrected_sdiffs);
 
-  double dds[2*(num_sats-1)];
+  double dds[2*(MAX_CHANNELS-1)];
   make_measurements(num_sats-1, corrected_sdiffs, dds);
 
-  double DE[(num_sats-1)*3];
-  s32 N[num_sats-1];
+  double DE[(MAX_CHANNELS-1)*3];
+  s32 N[MAX_CHANNELS-1];
   assign_de_mtx(num_sats, corrected_sdiffs, ref_ecef, DE);
   amb_from_baseline(num_sats, DE, dds, b, N);
 
@@ -759,7 +775,7 @@ void dgnss_init_known_baseline2(u8 num_sats, sdiff_t *sdiffs, double receiver_ec
   printf("]\n");
 
   /* Construct fake state means. */
-  double state_mean[num_sats-1+6];
+  double state_mean[MAX_CHANNELS-1+6];
   memcpy(&state_mean[0], b, 3 * sizeof(double));
   memset(&state_mean[3], 0, 3 * sizeof(double));
   for (u8 i=0; i<num_sats-1; i++) {
@@ -767,10 +783,10 @@ void dgnss_init_known_baseline2(u8 num_sats, sdiff_t *sdiffs, double receiver_ec
   }
 
   /* Construct fake covariance U factor (just identity). */
-  double state_cov_U[(num_sats-1+6)*(num_sats-1+6)];
+  double state_cov_U[(MAX_CHANNELS-1+6)*(MAX_CHANNELS-1+6)];
   matrix_eye(num_sats-1+6, state_cov_U);
 
-  double state_cov_D[num_sats-1+6];
+  double state_cov_D[MAX_CHANNELS-1+6];
   memset(state_cov_D, 0, 6 * sizeof(double));
   for (u8 i=0; i<num_sats-1; i++) {
     state_cov_D[i+6] = 1.0 / 64.0;
@@ -814,11 +830,11 @@ void measure_amb_kf_b(double reciever_ecef[3],
   if (DEBUG_DGNSS_MANAGEMENT) {
     printf("<MEASURE_AMB_KF_B>\n");
   }
-  sdiff_t sdiffs_with_ref_first[num_sdiffs];
+  sdiff_t sdiffs_with_ref_first[MAX_CHANNELS];
   /* We require the sats updating has already been done with these sdiffs */
   u8 ref_prn = sats_management.prns[0];
   copy_sdiffs_put_ref_first(ref_prn, num_sdiffs, sdiffs, sdiffs_with_ref_first);
-  double dd_measurements[2*(num_sdiffs-1)];
+  double dd_measurements[2*(MAX_CHANNELS-1)];
   make_measurements(num_sdiffs - 1, sdiffs_with_ref_first, dd_measurements);
   double b_old[3] = {0, 0, 0};
   double ref_ecef[3];
@@ -849,11 +865,11 @@ void measure_b_with_external_ambs(double reciever_ecef[3],
   if (DEBUG_DGNSS_MANAGEMENT) {
     printf("<MEASURE_B_WITH_EXTERNAL_AMBS>\n");
   }
-  sdiff_t sdiffs_with_ref_first[num_sdiffs];
+  sdiff_t sdiffs_with_ref_first[MAX_CHANNELS];
   /* We assume the sats updating has already been done with these sdiffs */
   u8 ref_prn = sats_management.prns[0];
   copy_sdiffs_put_ref_first(ref_prn, num_sdiffs, sdiffs, sdiffs_with_ref_first);
-  double dd_measurements[2*(num_sdiffs-1)];
+  double dd_measurements[2*(MAX_CHANNELS-1)];
   make_measurements(num_sdiffs - 1, sdiffs_with_ref_first, dd_measurements);
   double b_old[3] = {0, 0, 0};
   double ref_ecef[3];
@@ -883,9 +899,9 @@ void measure_iar_b_with_external_ambs(double reciever_ecef[3],
   if (DEBUG_DGNSS_MANAGEMENT) {
       printf("<MEASURE_IAR_B_WITH_EXTERNAL_AMBS>\n");
   }
-  sdiff_t sdiffs_with_ref_first[num_sdiffs];
+  sdiff_t sdiffs_with_ref_first[MAX_CHANNELS];
   match_sdiffs_to_sats_man(&ambiguity_test.sats, num_sdiffs, sdiffs, sdiffs_with_ref_first);
-  double dd_measurements[2*(num_sdiffs-1)];
+  double dd_measurements[2*(MAX_CHANNELS-1)];
   make_measurements(num_sdiffs - 1, sdiffs_with_ref_first, dd_measurements);
   double b_old[3] = {0, 0, 0};
   double ref_ecef[3];
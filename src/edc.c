@@ -12,51 +12,313 @@
 
 #include "edc.h"
 
+/* Carry-less multiply CRC folding, compiled in on x86-64 and used if the CPU
+ * supports PCLMULQDQ, see crc_clmul_fold(). */
+#if defined(LIBSWIFTNAV_ENABLE_SIMD) && defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define EDC_CLMUL
+/** Shortest buffer worth folding, below this slicing-by-8 is as fast. */
+#define EDC_CLMUL_MIN_LEN 64
+#endif
+
 /** \defgroup edc Error Detection and Correction
  * Error detection and correction functions.
  * \{ */
 
 /** \defgroup crc CRC
  * Cyclic redundancy checks.
+ *
+ * Each CRC has three implementations giving identical results:
+ *  - a byte at a time table lookup, e.g. crc16_ccitt_bytewise(), the
+ *    reference implementation,
+ *  - slicing-by-8, e.g. crc16_ccitt_slice8(), which processes eight bytes per
+ *    iteration using eight tables, `tab[k][b]` being the CRC of byte `b`
+ *    followed by `k` zero bytes,
+ *  - carry-less multiply folding, used by e.g. crc16_ccitt() on long buffers
+ *    when the CPU supports it, which reduces the buffer 64 bytes at a time
+ *    to a 16 byte block with the same CRC.
+ *
+ * crc16_ccitt() and crc24q() pick the fastest available at runtime.
  * \{ */
 
 /* CRC16 implementation acording to CCITT standards */
-static const u16 crc16tab[256] = {
-  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
-  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
-  0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
-  0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
-  0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
-  0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
-  0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
-  0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
-  0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
-  0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
-  0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
-  0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
-  0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
-  0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
-  0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
-  0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
-  0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
-  0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
-  0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
-  0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
-  0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
-  0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
-  0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
-  0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
-  0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
-  0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
-  0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
-  0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
-  0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
-  0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
-  0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
-  0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+static const u16 crc16tab[8][256] = {
+  {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+  },
+  {
+    0x0000, 0x3331, 0x6662, 0x5553, 0xCCC4, 0xFFF5, 0xAAA6, 0x9997,
+    0x89A9, 0xBA98, 0xEFCB, 0xDCFA, 0x456D, 0x765C, 0x230F, 0x103E,
+    0x0373, 0x3042, 0x6511, 0x5620, 0xCFB7, 0xFC86, 0xA9D5, 0x9AE4,
+    0x8ADA, 0xB9EB, 0xECB8, 0xDF89, 0x461E, 0x752F, 0x207C, 0x134D,
+    0x06E6, 0x35D7, 0x6084, 0x53B5, 0xCA22, 0xF913, 0xAC40, 0x9F71,
+    0x8F4F, 0xBC7E, 0xE92D, 0xDA1C, 0x438B, 0x70BA, 0x25E9, 0x16D8,
+    0x0595, 0x36A4, 0x63F7, 0x50C6, 0xC951, 0xFA60, 0xAF33, 0x9C02,
+    0x8C3C, 0xBF0D, 0xEA5E, 0xD96F, 0x40F8, 0x73C9, 0x269A, 0x15AB,
+    0x0DCC, 0x3EFD, 0x6BAE, 0x589F, 0xC108, 0xF239, 0xA76A, 0x945B,
+    0x8465, 0xB754, 0xE207, 0xD136, 0x48A1, 0x7B90, 0x2EC3, 0x1DF2,
+    0x0EBF, 0x3D8E, 0x68DD, 0x5BEC, 0xC27B, 0xF14A, 0xA419, 0x9728,
+    0x8716, 0xB427, 0xE174, 0xD245, 0x4BD2, 0x78E3, 0x2DB0, 0x1E81,
+    0x0B2A, 0x381B, 0x6D48, 0x5E79, 0xC7EE, 0xF4DF, 0xA18C, 0x92BD,
+    0x8283, 0xB1B2, 0xE4E1, 0xD7D0, 0x4E47, 0x7D76, 0x2825, 0x1B14,
+    0x0859, 0x3B68, 0x6E3B, 0x5D0A, 0xC49D, 0xF7AC, 0xA2FF, 0x91CE,
+    0x81F0, 0xB2C1, 0xE792, 0xD4A3, 0x4D34, 0x7E05, 0x2B56, 0x1867,
+    0x1B98, 0x28A9, 0x7DFA, 0x4ECB, 0xD75C, 0xE46D, 0xB13E, 0x820F,
+    0x9231, 0xA100, 0xF453, 0xC762, 0x5EF5, 0x6DC4, 0x3897, 0x0BA6,
+    0x18EB, 0x2BDA, 0x7E89, 0x4DB8, 0xD42F, 0xE71E, 0xB24D, 0x817C,
+    0x9142, 0xA273, 0xF720, 0xC411, 0x5D86, 0x6EB7, 0x3BE4, 0x08D5,
+    0x1D7E, 0x2E4F, 0x7B1C, 0x482D, 0xD1BA, 0xE28B, 0xB7D8, 0x84E9,
+    0x94D7, 0xA7E6, 0xF2B5, 0xC184, 0x5813, 0x6B22, 0x3E71, 0x0D40,
+    0x1E0D, 0x2D3C, 0x786F, 0x4B5E, 0xD2C9, 0xE1F8, 0xB4AB, 0x879A,
+    0x97A4, 0xA495, 0xF1C6, 0xC2F7, 0x5B60, 0x6851, 0x3D02, 0x0E33,
+    0x1654, 0x2565, 0x7036, 0x4307, 0xDA90, 0xE9A1, 0xBCF2, 0x8FC3,
+    0x9FFD, 0xACCC, 0xF99F, 0xCAAE, 0x5339, 0x6008, 0x355B, 0x066A,
+    0x1527, 0x2616, 0x7345, 0x4074, 0xD9E3, 0xEAD2, 0xBF81, 0x8CB0,
+    0x9C8E, 0xAFBF, 0xFAEC, 0xC9DD, 0x504A, 0x637B, 0x3628, 0x0519,
+    0x10B2, 0x2383, 0x76D0, 0x45E1, 0xDC76, 0xEF47, 0xBA14, 0x8925,
+    0x991B, 0xAA2A, 0xFF79, 0xCC48, 0x55DF, 0x66EE, 0x33BD, 0x008C,
+    0x13C1, 0x20F0, 0x75A3, 0x4692, 0xDF05, 0xEC34, 0xB967, 0x8A56,
+    0x9A68, 0xA959, 0xFC0A, 0xCF3B, 0x56AC, 0x659D, 0x30CE, 0x03FF
+  },
+  {
+    0x0000, 0x3730, 0x6E60, 0x5950, 0xDCC0, 0xEBF0, 0xB2A0, 0x8590,
+    0xA9A1, 0x9E91, 0xC7C1, 0xF0F1, 0x7561, 0x4251, 0x1B01, 0x2C31,
+    0x4363, 0x7453, 0x2D03, 0x1A33, 0x9FA3, 0xA893, 0xF1C3, 0xC6F3,
+    0xEAC2, 0xDDF2, 0x84A2, 0xB392, 0x3602, 0x0132, 0x5862, 0x6F52,
+    0x86C6, 0xB1F6, 0xE8A6, 0xDF96, 0x5A06, 0x6D36, 0x3466, 0x0356,
+    0x2F67, 0x1857, 0x4107, 0x7637, 0xF3A7, 0xC497, 0x9DC7, 0xAAF7,
+    0xC5A5, 0xF295, 0xABC5, 0x9CF5, 0x1965, 0x2E55, 0x7705, 0x4035,
+    0x6C04, 0x5B34, 0x0264, 0x3554, 0xB0C4, 0x87F4, 0xDEA4, 0xE994,
+    0x1DAD, 0x2A9D, 0x73CD, 0x44FD, 0xC16D, 0xF65D, 0xAF0D, 0x983D,
+    0xB40C, 0x833C, 0xDA6C, 0xED5C, 0x68CC, 0x5FFC, 0x06AC, 0x319C,
+    0x5ECE, 0x69FE, 0x30AE, 0x079E, 0x820E, 0xB53E, 0xEC6E, 0xDB5E,
+    0xF76F, 0xC05F, 0x990F, 0xAE3F, 0x2BAF, 0x1C9F, 0x45CF, 0x72FF,
+    0x9B6B, 0xAC5B, 0xF50B, 0xC23B, 0x47AB, 0x709B, 0x29CB, 0x1EFB,
+    0x32CA, 0x05FA, 0x5CAA, 0x6B9A, 0xEE0A, 0xD93A, 0x806A, 0xB75A,
+    0xD808, 0xEF38, 0xB668, 0x8158, 0x04C8, 0x33F8, 0x6AA8, 0x5D98,
+    0x71A9, 0x4699, 0x1FC9, 0x28F9, 0xAD69, 0x9A59, 0xC309, 0xF439,
+    0x3B5A, 0x0C6A, 0x553A, 0x620A, 0xE79A, 0xD0AA, 0x89FA, 0xBECA,
+    0x92FB, 0xA5CB, 0xFC9B, 0xCBAB, 0x4E3B, 0x790B, 0x205B, 0x176B,
+    0x7839, 0x4F09, 0x1659, 0x2169, 0xA4F9, 0x93C9, 0xCA99, 0xFDA9,
+    0xD198, 0xE6A8, 0xBFF8, 0x88C8, 0x0D58, 0x3A68, 0x6338, 0x5408,
+    0xBD9C, 0x8AAC, 0xD3FC, 0xE4CC, 0x615C, 0x566C, 0x0F3C, 0x380C,
+    0x143D, 0x230D, 0x7A5D, 0x4D6D, 0xC8FD, 0xFFCD, 0xA69D, 0x91AD,
+    0xFEFF, 0xC9CF, 0x909F, 0xA7AF, 0x223F, 0x150F, 0x4C5F, 0x7B6F,
+    0x575E, 0x606E, 0x393E, 0x0E0E, 0x8B9E, 0xBCAE, 0xE5FE, 0xD2CE,
+    0x26F7, 0x11C7, 0x4897, 0x7FA7, 0xFA37, 0xCD07, 0x9457, 0xA367,
+    0x8F56, 0xB866, 0xE136, 0xD606, 0x5396, 0x64A6, 0x3DF6, 0x0AC6,
+    0x6594, 0x52A4, 0x0BF4, 0x3CC4, 0xB954, 0x8E64, 0xD734, 0xE004,
+    0xCC35, 0xFB05, 0xA255, 0x9565, 0x10F5, 0x27C5, 0x7E95, 0x49A5,
+    0xA031, 0x9701, 0xCE51, 0xF961, 0x7CF1, 0x4BC1, 0x1291, 0x25A1,
+    0x0990, 0x3EA0, 0x67F0, 0x50C0, 0xD550, 0xE260, 0xBB30, 0x8C00,
+    0xE352, 0xD462, 0x8D32, 0xBA02, 0x3F92, 0x08A2, 0x51F2, 0x66C2,
+    0x4AF3, 0x7DC3, 0x2493, 0x13A3, 0x9633, 0xA103, 0xF853, 0xCF63
+  },
+  {
+    0x0000, 0x76B4, 0xED68, 0x9BDC, 0xCAF1, 0xBC45, 0x2799, 0x512D,
+    0x85C3, 0xF377, 0x68AB, 0x1E1F, 0x4F32, 0x3986, 0xA25A, 0xD4EE,
+    0x1BA7, 0x6D13, 0xF6CF, 0x807B, 0xD156, 0xA7E2, 0x3C3E, 0x4A8A,
+    0x9E64, 0xE8D0, 0x730C, 0x05B8, 0x5495, 0x2221, 0xB9FD, 0xCF49,
+    0x374E, 0x41FA, 0xDA26, 0xAC92, 0xFDBF, 0x8B0B, 0x10D7, 0x6663,
+    0xB28D, 0xC439, 0x5FE5, 0x2951, 0x787C, 0x0EC8, 0x9514, 0xE3A0,
+    0x2CE9, 0x5A5D, 0xC181, 0xB735, 0xE618, 0x90AC, 0x0B70, 0x7DC4,
+    0xA92A, 0xDF9E, 0x4442, 0x32F6, 0x63DB, 0x156F, 0x8EB3, 0xF807,
+    0x6E9C, 0x1828, 0x83F4, 0xF540, 0xA46D, 0xD2D9, 0x4905, 0x3FB1,
+    0xEB5F, 0x9DEB, 0x0637, 0x7083, 0x21AE, 0x571A, 0xCCC6, 0xBA72,
+    0x753B, 0x038F, 0x9853, 0xEEE7, 0xBFCA, 0xC97E, 0x52A2, 0x2416,
+    0xF0F8, 0x864C, 0x1D90, 0x6B24, 0x3A09, 0x4CBD, 0xD761, 0xA1D5,
+    0x59D2, 0x2F66, 0xB4BA, 0xC20E, 0x9323, 0xE597, 0x7E4B, 0x08FF,
+    0xDC11, 0xAAA5, 0x3179, 0x47CD, 0x16E0, 0x6054, 0xFB88, 0x8D3C,
+    0x4275, 0x34C1, 0xAF1D, 0xD9A9, 0x8884, 0xFE30, 0x65EC, 0x1358,
+    0xC7B6, 0xB102, 0x2ADE, 0x5C6A, 0x0D47, 0x7BF3, 0xE02F, 0x969B,
+    0xDD38, 0xAB8C, 0x3050, 0x46E4, 0x17C9, 0x617D, 0xFAA1, 0x8C15,
+    0x58FB, 0x2E4F, 0xB593, 0xC327, 0x920A, 0xE4BE, 0x7F62, 0x09D6,
+    0xC69F, 0xB02B, 0x2BF7, 0x5D43, 0x0C6E, 0x7ADA, 0xE106, 0x97B2,
+    0x435C, 0x35E8, 0xAE34, 0xD880, 0x89AD, 0xFF19, 0x64C5, 0x1271,
+    0xEA76, 0x9CC2, 0x071E, 0x71AA, 0x2087, 0x5633, 0xCDEF, 0xBB5B,
+    0x6FB5, 0x1901, 0x82DD, 0xF469, 0xA544, 0xD3F0, 0x482C, 0x3E98,
+    0xF1D1, 0x8765, 0x1CB9, 0x6A0D, 0x3B20, 0x4D94, 0xD648, 0xA0FC,
+    0x7412, 0x02A6, 0x997A, 0xEFCE, 0xBEE3, 0xC857, 0x538B, 0x253F,
+    0xB3A4, 0xC510, 0x5ECC, 0x2878, 0x7955, 0x0FE1, 0x943D, 0xE289,
+    0x3667, 0x40D3, 0xDB0F, 0xADBB, 0xFC96, 0x8A22, 0x11FE, 0x674A,
+    0xA803, 0xDEB7, 0x456B, 0x33DF, 0x62F2, 0x1446, 0x8F9A, 0xF92E,
+    0x2DC0, 0x5B74, 0xC0A8, 0xB61C, 0xE731, 0x9185, 0x0A59, 0x7CED,
+    0x84EA, 0xF25E, 0x6982, 0x1F36, 0x4E1B, 0x38AF, 0xA373, 0xD5C7,
+    0x0129, 0x779D, 0xEC41, 0x9AF5, 0xCBD8, 0xBD6C, 0x26B0, 0x5004,
+    0x9F4D, 0xE9F9, 0x7225, 0x0491, 0x55BC, 0x2308, 0xB8D4, 0xCE60,
+    0x1A8E, 0x6C3A, 0xF7E6, 0x8152, 0xD07F, 0xA6CB, 0x3D17, 0x4BA3
+  },
+  {
+    0x0000, 0xAA51, 0x4483, 0xEED2, 0x8906, 0x2357, 0xCD85, 0x67D4,
+    0x022D, 0xA87C, 0x46AE, 0xECFF, 0x8B2B, 0x217A, 0xCFA8, 0x65F9,
+    0x045A, 0xAE0B, 0x40D9, 0xEA88, 0x8D5C, 0x270D, 0xC9DF, 0x638E,
+    0x0677, 0xAC26, 0x42F4, 0xE8A5, 0x8F71, 0x2520, 0xCBF2, 0x61A3,
+    0x08B4, 0xA2E5, 0x4C37, 0xE666, 0x81B2, 0x2BE3, 0xC531, 0x6F60,
+    0x0A99, 0xA0C8, 0x4E1A, 0xE44B, 0x839F, 0x29CE, 0xC71C, 0x6D4D,
+    0x0CEE, 0xA6BF, 0x486D, 0xE23C, 0x85E8, 0x2FB9, 0xC16B, 0x6B3A,
+    0x0EC3, 0xA492, 0x4A40, 0xE011, 0x87C5, 0x2D94, 0xC346, 0x6917,
+    0x1168, 0xBB39, 0x55EB, 0xFFBA, 0x986E, 0x323F, 0xDCED, 0x76BC,
+    0x1345, 0xB914, 0x57C6, 0xFD97, 0x9A43, 0x3012, 0xDEC0, 0x7491,
+    0x1532, 0xBF63, 0x51B1, 0xFBE0, 0x9C34, 0x3665, 0xD8B7, 0x72E6,
+    0x171F, 0xBD4E, 0x539C, 0xF9CD, 0x9E19, 0x3448, 0xDA9A, 0x70CB,
+    0x19DC, 0xB38D, 0x5D5F, 0xF70E, 0x90DA, 0x3A8B, 0xD459, 0x7E08,
+    0x1BF1, 0xB1A0, 0x5F72, 0xF523, 0x92F7, 0x38A6, 0xD674, 0x7C25,
+    0x1D86, 0xB7D7, 0x5905, 0xF354, 0x9480, 0x3ED1, 0xD003, 0x7A52,
+    0x1FAB, 0xB5FA, 0x5B28, 0xF179, 0x96AD, 0x3CFC, 0xD22E, 0x787F,
+    0x22D0, 0x8881, 0x6653, 0xCC02, 0xABD6, 0x0187, 0xEF55, 0x4504,
+    0x20FD, 0x8AAC, 0x647E, 0xCE2F, 0xA9FB, 0x03AA, 0xED78, 0x4729,
+    0x268A, 0x8CDB, 0x6209, 0xC858, 0xAF8C, 0x05DD, 0xEB0F, 0x415E,
+    0x24A7, 0x8EF6, 0x6024, 0xCA75, 0xADA1, 0x07F0, 0xE922, 0x4373,
+    0x2A64, 0x8035, 0x6EE7, 0xC4B6, 0xA362, 0x0933, 0xE7E1, 0x4DB0,
+    0x2849, 0x8218, 0x6CCA, 0xC69B, 0xA14F, 0x0B1E, 0xE5CC, 0x4F9D,
+    0x2E3E, 0x846F, 0x6ABD, 0xC0EC, 0xA738, 0x0D69, 0xE3BB, 0x49EA,
+    0x2C13, 0x8642, 0x6890, 0xC2C1, 0xA515, 0x0F44, 0xE196, 0x4BC7,
+    0x33B8, 0x99E9, 0x773B, 0xDD6A, 0xBABE, 0x10EF, 0xFE3D, 0x546C,
+    0x3195, 0x9BC4, 0x7516, 0xDF47, 0xB893, 0x12C2, 0xFC10, 0x5641,
+    0x37E2, 0x9DB3, 0x7361, 0xD930, 0xBEE4, 0x14B5, 0xFA67, 0x5036,
+    0x35CF, 0x9F9E, 0x714C, 0xDB1D, 0xBCC9, 0x1698, 0xF84A, 0x521B,
+    0x3B0C, 0x915D, 0x7F8F, 0xD5DE, 0xB20A, 0x185B, 0xF689, 0x5CD8,
+    0x3921, 0x9370, 0x7DA2, 0xD7F3, 0xB027, 0x1A76, 0xF4A4, 0x5EF5,
+    0x3F56, 0x9507, 0x7BD5, 0xD184, 0xB650, 0x1C01, 0xF2D3, 0x5882,
+    0x3D7B, 0x972A, 0x79F8, 0xD3A9, 0xB47D, 0x1E2C, 0xF0FE, 0x5AAF
+  },
+  {
+    0x0000, 0x45A0, 0x8B40, 0xCEE0, 0x06A1, 0x4301, 0x8DE1, 0xC841,
+    0x0D42, 0x48E2, 0x8602, 0xC3A2, 0x0BE3, 0x4E43, 0x80A3, 0xC503,
+    0x1A84, 0x5F24, 0x91C4, 0xD464, 0x1C25, 0x5985, 0x9765, 0xD2C5,
+    0x17C6, 0x5266, 0x9C86, 0xD926, 0x1167, 0x54C7, 0x9A27, 0xDF87,
+    0x3508, 0x70A8, 0xBE48, 0xFBE8, 0x33A9, 0x7609, 0xB8E9, 0xFD49,
+    0x384A, 0x7DEA, 0xB30A, 0xF6AA, 0x3EEB, 0x7B4B, 0xB5AB, 0xF00B,
+    0x2F8C, 0x6A2C, 0xA4CC, 0xE16C, 0x292D, 0x6C8D, 0xA26D, 0xE7CD,
+    0x22CE, 0x676E, 0xA98E, 0xEC2E, 0x246F, 0x61CF, 0xAF2F, 0xEA8F,
+    0x6A10, 0x2FB0, 0xE150, 0xA4F0, 0x6CB1, 0x2911, 0xE7F1, 0xA251,
+    0x6752, 0x22F2, 0xEC12, 0xA9B2, 0x61F3, 0x2453, 0xEAB3, 0xAF13,
+    0x7094, 0x3534, 0xFBD4, 0xBE74, 0x7635, 0x3395, 0xFD75, 0xB8D5,
+    0x7DD6, 0x3876, 0xF696, 0xB336, 0x7B77, 0x3ED7, 0xF037, 0xB597,
+    0x5F18, 0x1AB8, 0xD458, 0x91F8, 0x59B9, 0x1C19, 0xD2F9, 0x9759,
+    0x525A, 0x17FA, 0xD91A, 0x9CBA, 0x54FB, 0x115B, 0xDFBB, 0x9A1B,
+    0x459C, 0x003C, 0xCEDC, 0x8B7C, 0x433D, 0x069D, 0xC87D, 0x8DDD,
+    0x48DE, 0x0D7E, 0xC39E, 0x863E, 0x4E7F, 0x0BDF, 0xC53F, 0x809F,
+    0xD420, 0x9180, 0x5F60, 0x1AC0, 0xD281, 0x9721, 0x59C1, 0x1C61,
+    0xD962, 0x9CC2, 0x5222, 0x1782, 0xDFC3, 0x9A63, 0x5483, 0x1123,
+    0xCEA4, 0x8B04, 0x45E4, 0x0044, 0xC805, 0x8DA5, 0x4345, 0x06E5,
+    0xC3E6, 0x8646, 0x48A6, 0x0D06, 0xC547, 0x80E7, 0x4E07, 0x0BA7,
+    0xE128, 0xA488, 0x6A68, 0x2FC8, 0xE789, 0xA229, 0x6CC9, 0x2969,
+    0xEC6A, 0xA9CA, 0x672A, 0x228A, 0xEACB, 0xAF6B, 0x618B, 0x242B,
+    0xFBAC, 0xBE0C, 0x70EC, 0x354C, 0xFD0D, 0xB8AD, 0x764D, 0x33ED,
+    0xF6EE, 0xB34E, 0x7DAE, 0x380E, 0xF04F, 0xB5EF, 0x7B0F, 0x3EAF,
+    0xBE30, 0xFB90, 0x3570, 0x70D0, 0xB891, 0xFD31, 0x33D1, 0x7671,
+    0xB372, 0xF6D2, 0x3832, 0x7D92, 0xB5D3, 0xF073, 0x3E93, 0x7B33,
+    0xA4B4, 0xE114, 0x2FF4, 0x6A54, 0xA215, 0xE7B5, 0x2955, 0x6CF5,
+    0xA9F6, 0xEC56, 0x22B6, 0x6716, 0xAF57, 0xEAF7, 0x2417, 0x61B7,
+    0x8B38, 0xCE98, 0x0078, 0x45D8, 0x8D99, 0xC839, 0x06D9, 0x4379,
+    0x867A, 0xC3DA, 0x0D3A, 0x489A, 0x80DB, 0xC57B, 0x0B9B, 0x4E3B,
+    0x91BC, 0xD41C, 0x1AFC, 0x5F5C, 0x971D, 0xD2BD, 0x1C5D, 0x59FD,
+    0x9CFE, 0xD95E, 0x17BE, 0x521E, 0x9A5F, 0xDFFF, 0x111F, 0x54BF
+  },
+  {
+    0x0000, 0xB861, 0x60E3, 0xD882, 0xC1C6, 0x79A7, 0xA125, 0x1944,
+    0x93AD, 0x2BCC, 0xF34E, 0x4B2F, 0x526B, 0xEA0A, 0x3288, 0x8AE9,
+    0x377B, 0x8F1A, 0x5798, 0xEFF9, 0xF6BD, 0x4EDC, 0x965E, 0x2E3F,
+    0xA4D6, 0x1CB7, 0xC435, 0x7C54, 0x6510, 0xDD71, 0x05F3, 0xBD92,
+    0x6EF6, 0xD697, 0x0E15, 0xB674, 0xAF30, 0x1751, 0xCFD3, 0x77B2,
+    0xFD5B, 0x453A, 0x9DB8, 0x25D9, 0x3C9D, 0x84FC, 0x5C7E, 0xE41F,
+    0x598D, 0xE1EC, 0x396E, 0x810F, 0x984B, 0x202A, 0xF8A8, 0x40C9,
+    0xCA20, 0x7241, 0xAAC3, 0x12A2, 0x0BE6, 0xB387, 0x6B05, 0xD364,
+    0xDDEC, 0x658D, 0xBD0F, 0x056E, 0x1C2A, 0xA44B, 0x7CC9, 0xC4A8,
+    0x4E41, 0xF620, 0x2EA2, 0x96C3, 0x8F87, 0x37E6, 0xEF64, 0x5705,
+    0xEA97, 0x52F6, 0x8A74, 0x3215, 0x2B51, 0x9330, 0x4BB2, 0xF3D3,
+    0x793A, 0xC15B, 0x19D9, 0xA1B8, 0xB8FC, 0x009D, 0xD81F, 0x607E,
+    0xB31A, 0x0B7B, 0xD3F9, 0x6B98, 0x72DC, 0xCABD, 0x123F, 0xAA5E,
+    0x20B7, 0x98D6, 0x4054, 0xF835, 0xE171, 0x5910, 0x8192, 0x39F3,
+    0x8461, 0x3C00, 0xE482, 0x5CE3, 0x45A7, 0xFDC6, 0x2544, 0x9D25,
+    0x17CC, 0xAFAD, 0x772F, 0xCF4E, 0xD60A, 0x6E6B, 0xB6E9, 0x0E88,
+    0xABF9, 0x1398, 0xCB1A, 0x737B, 0x6A3F, 0xD25E, 0x0ADC, 0xB2BD,
+    0x3854, 0x8035, 0x58B7, 0xE0D6, 0xF992, 0x41F3, 0x9971, 0x2110,
+    0x9C82, 0x24E3, 0xFC61, 0x4400, 0x5D44, 0xE525, 0x3DA7, 0x85C6,
+    0x0F2F, 0xB74E, 0x6FCC, 0xD7AD, 0xCEE9, 0x7688, 0xAE0A, 0x166B,
+    0xC50F, 0x7D6E, 0xA5EC, 0x1D8D, 0x04C9, 0xBCA8, 0x642A, 0xDC4B,
+    0x56A2, 0xEEC3, 0x3641, 0x8E20, 0x9764, 0x2F05, 0xF787, 0x4FE6,
+    0xF274, 0x4A15, 0x9297, 0x2AF6, 0x33B2, 0x8BD3, 0x5351, 0xEB30,
+    0x61D9, 0xD9B8, 0x013A, 0xB95B, 0xA01F, 0x187E, 0xC0FC, 0x789D,
+    0x7615, 0xCE74, 0x16F6, 0xAE97, 0xB7D3, 0x0FB2, 0xD730, 0x6F51,
+    0xE5B8, 0x5DD9, 0x855B, 0x3D3A, 0x247E, 0x9C1F, 0x449D, 0xFCFC,
+    0x416E, 0xF90F, 0x218D, 0x99EC, 0x80A8, 0x38C9, 0xE04B, 0x582A,
+    0xD2C3, 0x6AA2, 0xB220, 0x0A41, 0x1305, 0xAB64, 0x73E6, 0xCB87,
+    0x18E3, 0xA082, 0x7800, 0xC061, 0xD925, 0x6144, 0xB9C6, 0x01A7,
+    0x8B4E, 0x332F, 0xEBAD, 0x53CC, 0x4A88, 0xF2E9, 0x2A6B, 0x920A,
+    0x2F98, 0x97F9, 0x4F7B, 0xF71A, 0xEE5E, 0x563F, 0x8EBD, 0x36DC,
+    0xBC35, 0x0454, 0xDCD6, 0x64B7, 0x7DF3, 0xC592, 0x1D10, 0xA571
+  },
+  {
+    0x0000, 0x47D3, 0x8FA6, 0xC875, 0x0F6D, 0x48BE, 0x80CB, 0xC718,
+    0x1EDA, 0x5909, 0x917C, 0xD6AF, 0x11B7, 0x5664, 0x9E11, 0xD9C2,
+    0x3DB4, 0x7A67, 0xB212, 0xF5C1, 0x32D9, 0x750A, 0xBD7F, 0xFAAC,
+    0x236E, 0x64BD, 0xACC8, 0xEB1B, 0x2C03, 0x6BD0, 0xA3A5, 0xE476,
+    0x7B68, 0x3CBB, 0xF4CE, 0xB31D, 0x7405, 0x33D6, 0xFBA3, 0xBC70,
+    0x65B2, 0x2261, 0xEA14, 0xADC7, 0x6ADF, 0x2D0C, 0xE579, 0xA2AA,
+    0x46DC, 0x010F, 0xC97A, 0x8EA9, 0x49B1, 0x0E62, 0xC617, 0x81C4,
+    0x5806, 0x1FD5, 0xD7A0, 0x9073, 0x576B, 0x10B8, 0xD8CD, 0x9F1E,
+    0xF6D0, 0xB103, 0x7976, 0x3EA5, 0xF9BD, 0xBE6E, 0x761B, 0x31C8,
+    0xE80A, 0xAFD9, 0x67AC, 0x207F, 0xE767, 0xA0B4, 0x68C1, 0x2F12,
+    0xCB64, 0x8CB7, 0x44C2, 0x0311, 0xC409, 0x83DA, 0x4BAF, 0x0C7C,
+    0xD5BE, 0x926D, 0x5A18, 0x1DCB, 0xDAD3, 0x9D00, 0x5575, 0x12A6,
+    0x8DB8, 0xCA6B, 0x021E, 0x45CD, 0x82D5, 0xC506, 0x0D73, 0x4AA0,
+    0x9362, 0xD4B1, 0x1CC4, 0x5B17, 0x9C0F, 0xDBDC, 0x13A9, 0x547A,
+    0xB00C, 0xF7DF, 0x3FAA, 0x7879, 0xBF61, 0xF8B2, 0x30C7, 0x7714,
+    0xAED6, 0xE905, 0x2170, 0x66A3, 0xA1BB, 0xE668, 0x2E1D, 0x69CE,
+    0xFD81, 0xBA52, 0x7227, 0x35F4, 0xF2EC, 0xB53F, 0x7D4A, 0x3A99,
+    0xE35B, 0xA488, 0x6CFD, 0x2B2E, 0xEC36, 0xABE5, 0x6390, 0x2443,
+    0xC035, 0x87E6, 0x4F93, 0x0840, 0xCF58, 0x888B, 0x40FE, 0x072D,
+    0xDEEF, 0x993C, 0x5149, 0x169A, 0xD182, 0x9651, 0x5E24, 0x19F7,
+    0x86E9, 0xC13A, 0x094F, 0x4E9C, 0x8984, 0xCE57, 0x0622, 0x41F1,
+    0x9833, 0xDFE0, 0x1795, 0x5046, 0x975E, 0xD08D, 0x18F8, 0x5F2B,
+    0xBB5D, 0xFC8E, 0x34FB, 0x7328, 0xB430, 0xF3E3, 0x3B96, 0x7C45,
+    0xA587, 0xE254, 0x2A21, 0x6DF2, 0xAAEA, 0xED39, 0x254C, 0x629F,
+    0x0B51, 0x4C82, 0x84F7, 0xC324, 0x043C, 0x43EF, 0x8B9A, 0xCC49,
+    0x158B, 0x5258, 0x9A2D, 0xDDFE, 0x1AE6, 0x5D35, 0x9540, 0xD293,
+    0x36E5, 0x7136, 0xB943, 0xFE90, 0x3988, 0x7E5B, 0xB62E, 0xF1FD,
+    0x283F, 0x6FEC, 0xA799, 0xE04A, 0x2752, 0x6081, 0xA8F4, 0xEF27,
+    0x7039, 0x37EA, 0xFF9F, 0xB84C, 0x7F54, 0x3887, 0xF0F2, 0xB721,
+    0x6EE3, 0x2930, 0xE145, 0xA696, 0x618E, 0x265D, 0xEE28, 0xA9FB,
+    0x4D8D, 0x0A5E, 0xC22B, 0x85F8, 0x42E0, 0x0533, 0xCD46, 0x8A95,
+    0x5357, 0x1484, 0xDCF1, 0x9B22, 0x5C3A, 0x1BE9, 0xD39C, 0x944F
+  }
 };
 
-/** Calculate CCITT 16-bit Cyclical Redundancy Check (CRC16).
+/** Calculate CCITT 16-bit Cyclical Redundancy Check (CRC16), one byte at a
+ * time.
  *
  * This implementation uses parameters used by XMODEM i.e. polynomial is:
  * \f[
@@ -71,49 +333,310 @@ static const u16 crc16tab[256] = {
  *
  * \return CRC16 value
  */
-u16 crc16_ccitt(const u8 *buf, u32 len, u16 crc)
+u16 crc16_ccitt_bytewise(const u8 *buf, u32 len, u16 crc)
 {
   for (u32 i = 0; i < len; i++)
-    crc = (crc << 8) ^ crc16tab[((crc >> 8) ^ *buf++) & 0x00FF];
+    crc = (crc << 8) ^ crc16tab[0][((crc >> 8) ^ *buf++) & 0x00FF];
   return crc;
 }
 
-static const u32 crc24qtab[256] = {
-  0x000000, 0x864CFB, 0x8AD50D, 0x0C99F6, 0x93E6E1, 0x15AA1A, 0x1933EC, 0x9F7F17,
-  0xA18139, 0x27CDC2, 0x2B5434, 0xAD18CF, 0x3267D8, 0xB42B23, 0xB8B2D5, 0x3EFE2E,
-  0xC54E89, 0x430272, 0x4F9B84, 0xC9D77F, 0x56A868, 0xD0E493, 0xDC7D65, 0x5A319E,
-  0x64CFB0, 0xE2834B, 0xEE1ABD, 0x685646, 0xF72951, 0x7165AA, 0x7DFC5C, 0xFBB0A7,
-  0x0CD1E9, 0x8A9D12, 0x8604E4, 0x00481F, 0x9F3708, 0x197BF3, 0x15E205, 0x93AEFE,
-  0xAD50D0, 0x2B1C2B, 0x2785DD, 0xA1C926, 0x3EB631, 0xB8FACA, 0xB4633C, 0x322FC7,
-  0xC99F60, 0x4FD39B, 0x434A6D, 0xC50696, 0x5A7981, 0xDC357A, 0xD0AC8C, 0x56E077,
-  0x681E59, 0xEE52A2, 0xE2CB54, 0x6487AF, 0xFBF8B8, 0x7DB443, 0x712DB5, 0xF7614E,
-  0x19A3D2, 0x9FEF29, 0x9376DF, 0x153A24, 0x8A4533, 0x0C09C8, 0x00903E, 0x86DCC5,
-  0xB822EB, 0x3E6E10, 0x32F7E6, 0xB4BB1D, 0x2BC40A, 0xAD88F1, 0xA11107, 0x275DFC,
-  0xDCED5B, 0x5AA1A0, 0x563856, 0xD074AD, 0x4F0BBA, 0xC94741, 0xC5DEB7, 0x43924C,
-  0x7D6C62, 0xFB2099, 0xF7B96F, 0x71F594, 0xEE8A83, 0x68C678, 0x645F8E, 0xE21375,
-  0x15723B, 0x933EC0, 0x9FA736, 0x19EBCD, 0x8694DA, 0x00D821, 0x0C41D7, 0x8A0D2C,
-  0xB4F302, 0x32BFF9, 0x3E260F, 0xB86AF4, 0x2715E3, 0xA15918, 0xADC0EE, 0x2B8C15,
-  0xD03CB2, 0x567049, 0x5AE9BF, 0xDCA544, 0x43DA53, 0xC596A8, 0xC90F5E, 0x4F43A5,
-  0x71BD8B, 0xF7F170, 0xFB6886, 0x7D247D, 0xE25B6A, 0x641791, 0x688E67, 0xEEC29C,
-  0x3347A4, 0xB50B5F, 0xB992A9, 0x3FDE52, 0xA0A145, 0x26EDBE, 0x2A7448, 0xAC38B3,
-  0x92C69D, 0x148A66, 0x181390, 0x9E5F6B, 0x01207C, 0x876C87, 0x8BF571, 0x0DB98A,
-  0xF6092D, 0x7045D6, 0x7CDC20, 0xFA90DB, 0x65EFCC, 0xE3A337, 0xEF3AC1, 0x69763A,
-  0x578814, 0xD1C4EF, 0xDD5D19, 0x5B11E2, 0xC46EF5, 0x42220E, 0x4EBBF8, 0xC8F703,
-  0x3F964D, 0xB9DAB6, 0xB54340, 0x330FBB, 0xAC70AC, 0x2A3C57, 0x26A5A1, 0xA0E95A,
-  0x9E1774, 0x185B8F, 0x14C279, 0x928E82, 0x0DF195, 0x8BBD6E, 0x872498, 0x016863,
-  0xFAD8C4, 0x7C943F, 0x700DC9, 0xF64132, 0x693E25, 0xEF72DE, 0xE3EB28, 0x65A7D3,
-  0x5B59FD, 0xDD1506, 0xD18CF0, 0x57C00B, 0xC8BF1C, 0x4EF3E7, 0x426A11, 0xC426EA,
-  0x2AE476, 0xACA88D, 0xA0317B, 0x267D80, 0xB90297, 0x3F4E6C, 0x33D79A, 0xB59B61,
-  0x8B654F, 0x0D29B4, 0x01B042, 0x87FCB9, 0x1883AE, 0x9ECF55, 0x9256A3, 0x141A58,
-  0xEFAAFF, 0x69E604, 0x657FF2, 0xE33309, 0x7C4C1E, 0xFA00E5, 0xF69913, 0x70D5E8,
-  0x4E2BC6, 0xC8673D, 0xC4FECB, 0x42B230, 0xDDCD27, 0x5B81DC, 0x57182A, 0xD154D1,
-  0x26359F, 0xA07964, 0xACE092, 0x2AAC69, 0xB5D37E, 0x339F85, 0x3F0673, 0xB94A88,
-  0x87B4A6, 0x01F85D, 0x0D61AB, 0x8B2D50, 0x145247, 0x921EBC, 0x9E874A, 0x18CBB1,
-  0xE37B16, 0x6537ED, 0x69AE1B, 0xEFE2E0, 0x709DF7, 0xF6D10C, 0xFA48FA, 0x7C0401,
-  0x42FA2F, 0xC4B6D4, 0xC82F22, 0x4E63D9, 0xD11CCE, 0x575035, 0x5BC9C3, 0xDD8538
+/** Calculate CCITT 16-bit Cyclical Redundancy Check (CRC16), eight bytes at
+ * a time.
+ * Gives the same result as crc16_ccitt_bytewise().
+ *
+ * \param buf Array of data to calculate CRC for
+ * \param len Length of data array
+ * \param crc Initial CRC value
+ *
+ * \return CRC16 value
+ */
+u16 crc16_ccitt_slice8(const u8 *buf, u32 len, u16 crc)
+{
+  for (; len >= 8; len -= 8, buf += 8)
+    crc = crc16tab[7][buf[0] ^ (crc >> 8)] ^ crc16tab[6][buf[1] ^ (crc & 0xFF)] ^
+          crc16tab[5][buf[2]] ^ crc16tab[4][buf[3]] ^
+          crc16tab[3][buf[4]] ^ crc16tab[2][buf[5]] ^
+          crc16tab[1][buf[6]] ^ crc16tab[0][buf[7]];
+  return crc16_ccitt_bytewise(buf, len, crc);
+}
+
+static const u32 crc24qtab[8][256] = {
+  {
+    0x000000, 0x864CFB, 0x8AD50D, 0x0C99F6, 0x93E6E1, 0x15AA1A, 0x1933EC, 0x9F7F17,
+    0xA18139, 0x27CDC2, 0x2B5434, 0xAD18CF, 0x3267D8, 0xB42B23, 0xB8B2D5, 0x3EFE2E,
+    0xC54E89, 0x430272, 0x4F9B84, 0xC9D77F, 0x56A868, 0xD0E493, 0xDC7D65, 0x5A319E,
+    0x64CFB0, 0xE2834B, 0xEE1ABD, 0x685646, 0xF72951, 0x7165AA, 0x7DFC5C, 0xFBB0A7,
+    0x0CD1E9, 0x8A9D12, 0x8604E4, 0x00481F, 0x9F3708, 0x197BF3, 0x15E205, 0x93AEFE,
+    0xAD50D0, 0x2B1C2B, 0x2785DD, 0xA1C926, 0x3EB631, 0xB8FACA, 0xB4633C, 0x322FC7,
+    0xC99F60, 0x4FD39B, 0x434A6D, 0xC50696, 0x5A7981, 0xDC357A, 0xD0AC8C, 0x56E077,
+    0x681E59, 0xEE52A2, 0xE2CB54, 0x6487AF, 0xFBF8B8, 0x7DB443, 0x712DB5, 0xF7614E,
+    0x19A3D2, 0x9FEF29, 0x9376DF, 0x153A24, 0x8A4533, 0x0C09C8, 0x00903E, 0x86DCC5,
+    0xB822EB, 0x3E6E10, 0x32F7E6, 0xB4BB1D, 0x2BC40A, 0xAD88F1, 0xA11107, 0x275DFC,
+    0xDCED5B, 0x5AA1A0, 0x563856, 0xD074AD, 0x4F0BBA, 0xC94741, 0xC5DEB7, 0x43924C,
+    0x7D6C62, 0xFB2099, 0xF7B96F, 0x71F594, 0xEE8A83, 0x68C678, 0x645F8E, 0xE21375,
+    0x15723B, 0x933EC0, 0x9FA736, 0x19EBCD, 0x8694DA, 0x00D821, 0x0C41D7, 0x8A0D2C,
+    0xB4F302, 0x32BFF9, 0x3E260F, 0xB86AF4, 0x2715E3, 0xA15918, 0xADC0EE, 0x2B8C15,
+    0xD03CB2, 0x567049, 0x5AE9BF, 0xDCA544, 0x43DA53, 0xC596A8, 0xC90F5E, 0x4F43A5,
+    0x71BD8B, 0xF7F170, 0xFB6886, 0x7D247D, 0xE25B6A, 0x641791, 0x688E67, 0xEEC29C,
+    0x3347A4, 0xB50B5F, 0xB992A9, 0x3FDE52, 0xA0A145, 0x26EDBE, 0x2A7448, 0xAC38B3,
+    0x92C69D, 0x148A66, 0x181390, 0x9E5F6B, 0x01207C, 0x876C87, 0x8BF571, 0x0DB98A,
+    0xF6092D, 0x7045D6, 0x7CDC20, 0xFA90DB, 0x65EFCC, 0xE3A337, 0xEF3AC1, 0x69763A,
+    0x578814, 0xD1C4EF, 0xDD5D19, 0x5B11E2, 0xC46EF5, 0x42220E, 0x4EBBF8, 0xC8F703,
+    0x3F964D, 0xB9DAB6, 0xB54340, 0x330FBB, 0xAC70AC, 0x2A3C57, 0x26A5A1, 0xA0E95A,
+    0x9E1774, 0x185B8F, 0x14C279, 0x928E82, 0x0DF195, 0x8BBD6E, 0x872498, 0x016863,
+    0xFAD8C4, 0x7C943F, 0x700DC9, 0xF64132, 0x693E25, 0xEF72DE, 0xE3EB28, 0x65A7D3,
+    0x5B59FD, 0xDD1506, 0xD18CF0, 0x57C00B, 0xC8BF1C, 0x4EF3E7, 0x426A11, 0xC426EA,
+    0x2AE476, 0xACA88D, 0xA0317B, 0x267D80, 0xB90297, 0x3F4E6C, 0x33D79A, 0xB59B61,
+    0x8B654F, 0x0D29B4, 0x01B042, 0x87FCB9, 0x1883AE, 0x9ECF55, 0x9256A3, 0x141A58,
+    0xEFAAFF, 0x69E604, 0x657FF2, 0xE33309, 0x7C4C1E, 0xFA00E5, 0xF69913, 0x70D5E8,
+    0x4E2BC6, 0xC8673D, 0xC4FECB, 0x42B230, 0xDDCD27, 0x5B81DC, 0x57182A, 0xD154D1,
+    0x26359F, 0xA07964, 0xACE092, 0x2AAC69, 0xB5D37E, 0x339F85, 0x3F0673, 0xB94A88,
+    0x87B4A6, 0x01F85D, 0x0D61AB, 0x8B2D50, 0x145247, 0x921EBC, 0x9E874A, 0x18CBB1,
+    0xE37B16, 0x6537ED, 0x69AE1B, 0xEFE2E0, 0x709DF7, 0xF6D10C, 0xFA48FA, 0x7C0401,
+    0x42FA2F, 0xC4B6D4, 0xC82F22, 0x4E63D9, 0xD11CCE, 0x575035, 0x5BC9C3, 0xDD8538
+  },
+  {
+    0x000000, 0x668F48, 0xCD1E90, 0xAB91D8, 0x1C71DB, 0x7AFE93, 0xD16F4B, 0xB7E003,
+    0x38E3B6, 0x5E6CFE, 0xF5FD26, 0x93726E, 0x24926D, 0x421D25, 0xE98CFD, 0x8F03B5,
+    0x71C76C, 0x174824, 0xBCD9FC, 0xDA56B4, 0x6DB6B7, 0x0B39FF, 0xA0A827, 0xC6276F,
+    0x4924DA, 0x2FAB92, 0x843A4A, 0xE2B502, 0x555501, 0x33DA49, 0x984B91, 0xFEC4D9,
+    0xE38ED8, 0x850190, 0x2E9048, 0x481F00, 0xFFFF03, 0x99704B, 0x32E193, 0x546EDB,
+    0xDB6D6E, 0xBDE226, 0x1673FE, 0x70FCB6, 0xC71CB5, 0xA193FD, 0x0A0225, 0x6C8D6D,
+    0x9249B4, 0xF4C6FC, 0x5F5724, 0x39D86C, 0x8E386F, 0xE8B727, 0x4326FF, 0x25A9B7,
+    0xAAAA02, 0xCC254A, 0x67B492, 0x013BDA, 0xB6DBD9, 0xD05491, 0x7BC549, 0x1D4A01,
+    0x41514B, 0x27DE03, 0x8C4FDB, 0xEAC093, 0x5D2090, 0x3BAFD8, 0x903E00, 0xF6B148,
+    0x79B2FD, 0x1F3DB5, 0xB4AC6D, 0xD22325, 0x65C326, 0x034C6E, 0xA8DDB6, 0xCE52FE,
+    0x309627, 0x56196F, 0xFD88B7, 0x9B07FF, 0x2CE7FC, 0x4A68B4, 0xE1F96C, 0x877624,
+    0x087591, 0x6EFAD9, 0xC56B01, 0xA3E449, 0x14044A, 0x728B02, 0xD91ADA, 0xBF9592,
+    0xA2DF93, 0xC450DB, 0x6FC103, 0x094E4B, 0xBEAE48, 0xD82100, 0x73B0D8, 0x153F90,
+    0x9A3C25, 0xFCB36D, 0x5722B5, 0x31ADFD, 0x864DFE, 0xE0C2B6, 0x4B536E, 0x2DDC26,
+    0xD318FF, 0xB597B7, 0x1E066F, 0x788927, 0xCF6924, 0xA9E66C, 0x0277B4, 0x64F8FC,
+    0xEBFB49, 0x8D7401, 0x26E5D9, 0x406A91, 0xF78A92, 0x9105DA, 0x3A9402, 0x5C1B4A,
+    0x82A296, 0xE42DDE, 0x4FBC06, 0x29334E, 0x9ED34D, 0xF85C05, 0x53CDDD, 0x354295,
+    0xBA4120, 0xDCCE68, 0x775FB0, 0x11D0F8, 0xA630FB, 0xC0BFB3, 0x6B2E6B, 0x0DA123,
+    0xF365FA, 0x95EAB2, 0x3E7B6A, 0x58F422, 0xEF1421, 0x899B69, 0x220AB1, 0x4485F9,
+    0xCB864C, 0xAD0904, 0x0698DC, 0x601794, 0xD7F797, 0xB178DF, 0x1AE907, 0x7C664F,
+    0x612C4E, 0x07A306, 0xAC32DE, 0xCABD96, 0x7D5D95, 0x1BD2DD, 0xB04305, 0xD6CC4D,
+    0x59CFF8, 0x3F40B0, 0x94D168, 0xF25E20, 0x45BE23, 0x23316B, 0x88A0B3, 0xEE2FFB,
+    0x10EB22, 0x76646A, 0xDDF5B2, 0xBB7AFA, 0x0C9AF9, 0x6A15B1, 0xC18469, 0xA70B21,
+    0x280894, 0x4E87DC, 0xE51604, 0x83994C, 0x34794F, 0x52F607, 0xF967DF, 0x9FE897,
+    0xC3F3DD, 0xA57C95, 0x0EED4D, 0x686205, 0xDF8206, 0xB90D4E, 0x129C96, 0x7413DE,
+    0xFB106B, 0x9D9F23, 0x360EFB, 0x5081B3, 0xE761B0, 0x81EEF8, 0x2A7F20, 0x4CF068,
+    0xB234B1, 0xD4BBF9, 0x7F2A21, 0x19A569, 0xAE456A, 0xC8CA22, 0x635BFA, 0x05D4B2,
+    0x8AD707, 0xEC584F, 0x47C997, 0x2146DF, 0x96A6DC, 0xF02994, 0x5BB84C, 0x3D3704,
+    0x207D05, 0x46F24D, 0xED6395, 0x8BECDD, 0x3C0CDE, 0x5A8396, 0xF1124E, 0x979D06,
+    0x189EB3, 0x7E11FB, 0xD58023, 0xB30F6B, 0x04EF68, 0x626020, 0xC9F1F8, 0xAF7EB0,
+    0x51BA69, 0x373521, 0x9CA4F9, 0xFA2BB1, 0x4DCBB2, 0x2B44FA, 0x80D522, 0xE65A6A,
+    0x6959DF, 0x0FD697, 0xA4474F, 0xC2C807, 0x752804, 0x13A74C, 0xB83694, 0xDEB9DC
+  },
+  {
+    0x000000, 0x8309D7, 0x805F55, 0x035682, 0x86F251, 0x05FB86, 0x06AD04, 0x85A4D3,
+    0x8BA859, 0x08A18E, 0x0BF70C, 0x88FEDB, 0x0D5A08, 0x8E53DF, 0x8D055D, 0x0E0C8A,
+    0x911C49, 0x12159E, 0x11431C, 0x924ACB, 0x17EE18, 0x94E7CF, 0x97B14D, 0x14B89A,
+    0x1AB410, 0x99BDC7, 0x9AEB45, 0x19E292, 0x9C4641, 0x1F4F96, 0x1C1914, 0x9F10C3,
+    0xA47469, 0x277DBE, 0x242B3C, 0xA722EB, 0x228638, 0xA18FEF, 0xA2D96D, 0x21D0BA,
+    0x2FDC30, 0xACD5E7, 0xAF8365, 0x2C8AB2, 0xA92E61, 0x2A27B6, 0x297134, 0xAA78E3,
+    0x356820, 0xB661F7, 0xB53775, 0x363EA2, 0xB39A71, 0x3093A6, 0x33C524, 0xB0CCF3,
+    0xBEC079, 0x3DC9AE, 0x3E9F2C, 0xBD96FB, 0x383228, 0xBB3BFF, 0xB86D7D, 0x3B64AA,
+    0xCEA429, 0x4DADFE, 0x4EFB7C, 0xCDF2AB, 0x485678, 0xCB5FAF, 0xC8092D, 0x4B00FA,
+    0x450C70, 0xC605A7, 0xC55325, 0x465AF2, 0xC3FE21, 0x40F7F6, 0x43A174, 0xC0A8A3,
+    0x5FB860, 0xDCB1B7, 0xDFE735, 0x5CEEE2, 0xD94A31, 0x5A43E6, 0x591564, 0xDA1CB3,
+    0xD41039, 0x5719EE, 0x544F6C, 0xD746BB, 0x52E268, 0xD1EBBF, 0xD2BD3D, 0x51B4EA,
+    0x6AD040, 0xE9D997, 0xEA8F15, 0x6986C2, 0xEC2211, 0x6F2BC6, 0x6C7D44, 0xEF7493,
+    0xE17819, 0x6271CE, 0x61274C, 0xE22E9B, 0x678A48, 0xE4839F, 0xE7D51D, 0x64DCCA,
+    0xFBCC09, 0x78C5DE, 0x7B935C, 0xF89A8B, 0x7D3E58, 0xFE378F, 0xFD610D, 0x7E68DA,
+    0x706450, 0xF36D87, 0xF03B05, 0x7332D2, 0xF69601, 0x759FD6, 0x76C954, 0xF5C083,
+    0x1B04A9, 0x980D7E, 0x9B5BFC, 0x18522B, 0x9DF6F8, 0x1EFF2F, 0x1DA9AD, 0x9EA07A,
+    0x90ACF0, 0x13A527, 0x10F3A5, 0x93FA72, 0x165EA1, 0x955776, 0x9601F4, 0x150823,
+    0x8A18E0, 0x091137, 0x0A47B5, 0x894E62, 0x0CEAB1, 0x8FE366, 0x8CB5E4, 0x0FBC33,
+    0x01B0B9, 0x82B96E, 0x81EFEC, 0x02E63B, 0x8742E8, 0x044B3F, 0x071DBD, 0x84146A,
+    0xBF70C0, 0x3C7917, 0x3F2F95, 0xBC2642, 0x398291, 0xBA8B46, 0xB9DDC4, 0x3AD413,
+    0x34D899, 0xB7D14E, 0xB487CC, 0x378E1B, 0xB22AC8, 0x31231F, 0x32759D, 0xB17C4A,
+    0x2E6C89, 0xAD655E, 0xAE33DC, 0x2D3A0B, 0xA89ED8, 0x2B970F, 0x28C18D, 0xABC85A,
+    0xA5C4D0, 0x26CD07, 0x259B85, 0xA69252, 0x233681, 0xA03F56, 0xA369D4, 0x206003,
+    0xD5A080, 0x56A957, 0x55FFD5, 0xD6F602, 0x5352D1, 0xD05B06, 0xD30D84, 0x500453,
+    0x5E08D9, 0xDD010E, 0xDE578C, 0x5D5E5B, 0xD8FA88, 0x5BF35F, 0x58A5DD, 0xDBAC0A,
+    0x44BCC9, 0xC7B51E, 0xC4E39C, 0x47EA4B, 0xC24E98, 0x41474F, 0x4211CD, 0xC1181A,
+    0xCF1490, 0x4C1D47, 0x4F4BC5, 0xCC4212, 0x49E6C1, 0xCAEF16, 0xC9B994, 0x4AB043,
+    0x71D4E9, 0xF2DD3E, 0xF18BBC, 0x72826B, 0xF726B8, 0x742F6F, 0x7779ED, 0xF4703A,
+    0xFA7CB0, 0x797567, 0x7A23E5, 0xF92A32, 0x7C8EE1, 0xFF8736, 0xFCD1B4, 0x7FD863,
+    0xE0C8A0, 0x63C177, 0x6097F5, 0xE39E22, 0x663AF1, 0xE53326, 0xE665A4, 0x656C73,
+    0x6B60F9, 0xE8692E, 0xEB3FAC, 0x68367B, 0xED92A8, 0x6E9B7F, 0x6DCDFD, 0xEEC42A
+  },
+  {
+    0x000000, 0x360952, 0x6C12A4, 0x5A1BF6, 0xD82548, 0xEE2C1A, 0xB437EC, 0x823EBE,
+    0x36066B, 0x000F39, 0x5A14CF, 0x6C1D9D, 0xEE2323, 0xD82A71, 0x823187, 0xB438D5,
+    0x6C0CD6, 0x5A0584, 0x001E72, 0x361720, 0xB4299E, 0x8220CC, 0xD83B3A, 0xEE3268,
+    0x5A0ABD, 0x6C03EF, 0x361819, 0x00114B, 0x822FF5, 0xB426A7, 0xEE3D51, 0xD83403,
+    0xD819AC, 0xEE10FE, 0xB40B08, 0x82025A, 0x003CE4, 0x3635B6, 0x6C2E40, 0x5A2712,
+    0xEE1FC7, 0xD81695, 0x820D63, 0xB40431, 0x363A8F, 0x0033DD, 0x5A282B, 0x6C2179,
+    0xB4157A, 0x821C28, 0xD807DE, 0xEE0E8C, 0x6C3032, 0x5A3960, 0x002296, 0x362BC4,
+    0x821311, 0xB41A43, 0xEE01B5, 0xD808E7, 0x5A3659, 0x6C3F0B, 0x3624FD, 0x002DAF,
+    0x367FA3, 0x0076F1, 0x5A6D07, 0x6C6455, 0xEE5AEB, 0xD853B9, 0x82484F, 0xB4411D,
+    0x0079C8, 0x36709A, 0x6C6B6C, 0x5A623E, 0xD85C80, 0xEE55D2, 0xB44E24, 0x824776,
+    0x5A7375, 0x6C7A27, 0x3661D1, 0x006883, 0x82563D, 0xB45F6F, 0xEE4499, 0xD84DCB,
+    0x6C751E, 0x5A7C4C, 0x0067BA, 0x366EE8, 0xB45056, 0x825904, 0xD842F2, 0xEE4BA0,
+    0xEE660F, 0xD86F5D, 0x8274AB, 0xB47DF9, 0x364347, 0x004A15, 0x5A51E3, 0x6C58B1,
+    0xD86064, 0xEE6936, 0xB472C0, 0x827B92, 0x00452C, 0x364C7E, 0x6C5788, 0x5A5EDA,
+    0x826AD9, 0xB4638B, 0xEE787D, 0xD8712F, 0x5A4F91, 0x6C46C3, 0x365D35, 0x005467,
+    0xB46CB2, 0x8265E0, 0xD87E16, 0xEE7744, 0x6C49FA, 0x5A40A8, 0x005B5E, 0x36520C,
+    0x6CFF46, 0x5AF614, 0x00EDE2, 0x36E4B0, 0xB4DA0E, 0x82D35C, 0xD8C8AA, 0xEEC1F8,
+    0x5AF92D, 0x6CF07F, 0x36EB89, 0x00E2DB, 0x82DC65, 0xB4D537, 0xEECEC1, 0xD8C793,
+    0x00F390, 0x36FAC2, 0x6CE134, 0x5AE866, 0xD8D6D8, 0xEEDF8A, 0xB4C47C, 0x82CD2E,
+    0x36F5FB, 0x00FCA9, 0x5AE75F, 0x6CEE0D, 0xEED0B3, 0xD8D9E1, 0x82C217, 0xB4CB45,
+    0xB4E6EA, 0x82EFB8, 0xD8F44E, 0xEEFD1C, 0x6CC3A2, 0x5ACAF0, 0x00D106, 0x36D854,
+    0x82E081, 0xB4E9D3, 0xEEF225, 0xD8FB77, 0x5AC5C9, 0x6CCC9B, 0x36D76D, 0x00DE3F,
+    0xD8EA3C, 0xEEE36E, 0xB4F898, 0x82F1CA, 0x00CF74, 0x36C626, 0x6CDDD0, 0x5AD482,
+    0xEEEC57, 0xD8E505, 0x82FEF3, 0xB4F7A1, 0x36C91F, 0x00C04D, 0x5ADBBB, 0x6CD2E9,
+    0x5A80E5, 0x6C89B7, 0x369241, 0x009B13, 0x82A5AD, 0xB4ACFF, 0xEEB709, 0xD8BE5B,
+    0x6C868E, 0x5A8FDC, 0x00942A, 0x369D78, 0xB4A3C6, 0x82AA94, 0xD8B162, 0xEEB830,
+    0x368C33, 0x008561, 0x5A9E97, 0x6C97C5, 0xEEA97B, 0xD8A029, 0x82BBDF, 0xB4B28D,
+    0x008A58, 0x36830A, 0x6C98FC, 0x5A91AE, 0xD8AF10, 0xEEA642, 0xB4BDB4, 0x82B4E6,
+    0x829949, 0xB4901B, 0xEE8BED, 0xD882BF, 0x5ABC01, 0x6CB553, 0x36AEA5, 0x00A7F7,
+    0xB49F22, 0x829670, 0xD88D86, 0xEE84D4, 0x6CBA6A, 0x5AB338, 0x00A8CE, 0x36A19C,
+    0xEE959F, 0xD89CCD, 0x82873B, 0xB48E69, 0x36B0D7, 0x00B985, 0x5AA273, 0x6CAB21,
+    0xD893F4, 0xEE9AA6, 0xB48150, 0x828802, 0x00B6BC, 0x36BFEE, 0x6CA418, 0x5AAD4A
+  },
+  {
+    0x000000, 0xD9FE8C, 0x35B1E3, 0xEC4F6F, 0x6B63C6, 0xB29D4A, 0x5ED225, 0x872CA9,
+    0xD6C78C, 0x0F3900, 0xE3766F, 0x3A88E3, 0xBDA44A, 0x645AC6, 0x8815A9, 0x51EB25,
+    0x2BC3E3, 0xF23D6F, 0x1E7200, 0xC78C8C, 0x40A025, 0x995EA9, 0x7511C6, 0xACEF4A,
+    0xFD046F, 0x24FAE3, 0xC8B58C, 0x114B00, 0x9667A9, 0x4F9925, 0xA3D64A, 0x7A28C6,
+    0x5787C6, 0x8E794A, 0x623625, 0xBBC8A9, 0x3CE400, 0xE51A8C, 0x0955E3, 0xD0AB6F,
+    0x81404A, 0x58BEC6, 0xB4F1A9, 0x6D0F25, 0xEA238C, 0x33DD00, 0xDF926F, 0x066CE3,
+    0x7C4425, 0xA5BAA9, 0x49F5C6, 0x900B4A, 0x1727E3, 0xCED96F, 0x229600, 0xFB688C,
+    0xAA83A9, 0x737D25, 0x9F324A, 0x46CCC6, 0xC1E06F, 0x181EE3, 0xF4518C, 0x2DAF00,
+    0xAF0F8C, 0x76F100, 0x9ABE6F, 0x4340E3, 0xC46C4A, 0x1D92C6, 0xF1DDA9, 0x282325,
+    0x79C800, 0xA0368C, 0x4C79E3, 0x95876F, 0x12ABC6, 0xCB554A, 0x271A25, 0xFEE4A9,
+    0x84CC6F, 0x5D32E3, 0xB17D8C, 0x688300, 0xEFAFA9, 0x365125, 0xDA1E4A, 0x03E0C6,
+    0x520BE3, 0x8BF56F, 0x67BA00, 0xBE448C, 0x396825, 0xE096A9, 0x0CD9C6, 0xD5274A,
+    0xF8884A, 0x2176C6, 0xCD39A9, 0x14C725, 0x93EB8C, 0x4A1500, 0xA65A6F, 0x7FA4E3,
+    0x2E4FC6, 0xF7B14A, 0x1BFE25, 0xC200A9, 0x452C00, 0x9CD28C, 0x709DE3, 0xA9636F,
+    0xD34BA9, 0x0AB525, 0xE6FA4A, 0x3F04C6, 0xB8286F, 0x61D6E3, 0x8D998C, 0x546700,
+    0x058C25, 0xDC72A9, 0x303DC6, 0xE9C34A, 0x6EEFE3, 0xB7116F, 0x5B5E00, 0x82A08C,
+    0xD853E3, 0x01AD6F, 0xEDE200, 0x341C8C, 0xB33025, 0x6ACEA9, 0x8681C6, 0x5F7F4A,
+    0x0E946F, 0xD76AE3, 0x3B258C, 0xE2DB00, 0x65F7A9, 0xBC0925, 0x50464A, 0x89B8C6,
+    0xF39000, 0x2A6E8C, 0xC621E3, 0x1FDF6F, 0x98F3C6, 0x410D4A, 0xAD4225, 0x74BCA9,
+    0x25578C, 0xFCA900, 0x10E66F, 0xC918E3, 0x4E344A, 0x97CAC6, 0x7B85A9, 0xA27B25,
+    0x8FD425, 0x562AA9, 0xBA65C6, 0x639B4A, 0xE4B7E3, 0x3D496F, 0xD10600, 0x08F88C,
+    0x5913A9, 0x80ED25, 0x6CA24A, 0xB55CC6, 0x32706F, 0xEB8EE3, 0x07C18C, 0xDE3F00,
+    0xA417C6, 0x7DE94A, 0x91A625, 0x4858A9, 0xCF7400, 0x168A8C, 0xFAC5E3, 0x233B6F,
+    0x72D04A, 0xAB2EC6, 0x4761A9, 0x9E9F25, 0x19B38C, 0xC04D00, 0x2C026F, 0xF5FCE3,
+    0x775C6F, 0xAEA2E3, 0x42ED8C, 0x9B1300, 0x1C3FA9, 0xC5C125, 0x298E4A, 0xF070C6,
+    0xA19BE3, 0x78656F, 0x942A00, 0x4DD48C, 0xCAF825, 0x1306A9, 0xFF49C6, 0x26B74A,
+    0x5C9F8C, 0x856100, 0x692E6F, 0xB0D0E3, 0x37FC4A, 0xEE02C6, 0x024DA9, 0xDBB325,
+    0x8A5800, 0x53A68C, 0xBFE9E3, 0x66176F, 0xE13BC6, 0x38C54A, 0xD48A25, 0x0D74A9,
+    0x20DBA9, 0xF92525, 0x156A4A, 0xCC94C6, 0x4BB86F, 0x9246E3, 0x7E098C, 0xA7F700,
+    0xF61C25, 0x2FE2A9, 0xC3ADC6, 0x1A534A, 0x9D7FE3, 0x44816F, 0xA8CE00, 0x71308C,
+    0x0B184A, 0xD2E6C6, 0x3EA9A9, 0xE75725, 0x607B8C, 0xB98500, 0x55CA6F, 0x8C34E3,
+    0xDDDFC6, 0x04214A, 0xE86E25, 0x3190A9, 0xB6BC00, 0x6F428C, 0x830DE3, 0x5AF36F
+  },
+  {
+    0x000000, 0x36EB3D, 0x6DD67A, 0x5B3D47, 0xDBACF4, 0xED47C9, 0xB67A8E, 0x8091B3,
+    0x311513, 0x07FE2E, 0x5CC369, 0x6A2854, 0xEAB9E7, 0xDC52DA, 0x876F9D, 0xB184A0,
+    0x622A26, 0x54C11B, 0x0FFC5C, 0x391761, 0xB986D2, 0x8F6DEF, 0xD450A8, 0xE2BB95,
+    0x533F35, 0x65D408, 0x3EE94F, 0x080272, 0x8893C1, 0xBE78FC, 0xE545BB, 0xD3AE86,
+    0xC4544C, 0xF2BF71, 0xA98236, 0x9F690B, 0x1FF8B8, 0x291385, 0x722EC2, 0x44C5FF,
+    0xF5415F, 0xC3AA62, 0x989725, 0xAE7C18, 0x2EEDAB, 0x180696, 0x433BD1, 0x75D0EC,
+    0xA67E6A, 0x909557, 0xCBA810, 0xFD432D, 0x7DD29E, 0x4B39A3, 0x1004E4, 0x26EFD9,
+    0x976B79, 0xA18044, 0xFABD03, 0xCC563E, 0x4CC78D, 0x7A2CB0, 0x2111F7, 0x17FACA,
+    0x0EE463, 0x380F5E, 0x633219, 0x55D924, 0xD54897, 0xE3A3AA, 0xB89EED, 0x8E75D0,
+    0x3FF170, 0x091A4D, 0x52270A, 0x64CC37, 0xE45D84, 0xD2B6B9, 0x898BFE, 0xBF60C3,
+    0x6CCE45, 0x5A2578, 0x01183F, 0x37F302, 0xB762B1, 0x81898C, 0xDAB4CB, 0xEC5FF6,
+    0x5DDB56, 0x6B306B, 0x300D2C, 0x06E611, 0x8677A2, 0xB09C9F, 0xEBA1D8, 0xDD4AE5,
+    0xCAB02F, 0xFC5B12, 0xA76655, 0x918D68, 0x111CDB, 0x27F7E6, 0x7CCAA1, 0x4A219C,
+    0xFBA53C, 0xCD4E01, 0x967346, 0xA0987B, 0x2009C8, 0x16E2F5, 0x4DDFB2, 0x7B348F,
+    0xA89A09, 0x9E7134, 0xC54C73, 0xF3A74E, 0x7336FD, 0x45DDC0, 0x1EE087, 0x280BBA,
+    0x998F1A, 0xAF6427, 0xF45960, 0xC2B25D, 0x4223EE, 0x74C8D3, 0x2FF594, 0x191EA9,
+    0x1DC8C6, 0x2B23FB, 0x701EBC, 0x46F581, 0xC66432, 0xF08F0F, 0xABB248, 0x9D5975,
+    0x2CDDD5, 0x1A36E8, 0x410BAF, 0x77E092, 0xF77121, 0xC19A1C, 0x9AA75B, 0xAC4C66,
+    0x7FE2E0, 0x4909DD, 0x12349A, 0x24DFA7, 0xA44E14, 0x92A529, 0xC9986E, 0xFF7353,
+    0x4EF7F3, 0x781CCE, 0x232189, 0x15CAB4, 0x955B07, 0xA3B03A, 0xF88D7D, 0xCE6640,
+    0xD99C8A, 0xEF77B7, 0xB44AF0, 0x82A1CD, 0x02307E, 0x34DB43, 0x6FE604, 0x590D39,
+    0xE88999, 0xDE62A4, 0x855FE3, 0xB3B4DE, 0x33256D, 0x05CE50, 0x5EF317, 0x68182A,
+    0xBBB6AC, 0x8D5D91, 0xD660D6, 0xE08BEB, 0x601A58, 0x56F165, 0x0DCC22, 0x3B271F,
+    0x8AA3BF, 0xBC4882, 0xE775C5, 0xD19EF8, 0x510F4B, 0x67E476, 0x3CD931, 0x0A320C,
+    0x132CA5, 0x25C798, 0x7EFADF, 0x4811E2, 0xC88051, 0xFE6B6C, 0xA5562B, 0x93BD16,
+    0x2239B6, 0x14D28B, 0x4FEFCC, 0x7904F1, 0xF99542, 0xCF7E7F, 0x944338, 0xA2A805,
+    0x710683, 0x47EDBE, 0x1CD0F9, 0x2A3BC4, 0xAAAA77, 0x9C414A, 0xC77C0D, 0xF19730,
+    0x401390, 0x76F8AD, 0x2DC5EA, 0x1B2ED7, 0x9BBF64, 0xAD5459, 0xF6691E, 0xC08223,
+    0xD778E9, 0xE193D4, 0xBAAE93, 0x8C45AE, 0x0CD41D, 0x3A3F20, 0x610267, 0x57E95A,
+    0xE66DFA, 0xD086C7, 0x8BBB80, 0xBD50BD, 0x3DC10E, 0x0B2A33, 0x501774, 0x66FC49,
+    0xB552CF, 0x83B9F2, 0xD884B5, 0xEE6F88, 0x6EFE3B, 0x581506, 0x032841, 0x35C37C,
+    0x8447DC, 0xB2ACE1, 0xE991A6, 0xDF7A9B, 0x5FEB28, 0x690015, 0x323D52, 0x04D66F
+  },
+  {
+    0x000000, 0x3B918C, 0x772318, 0x4CB294, 0xEE4630, 0xD5D7BC, 0x996528, 0xA2F4A4,
+    0x5AC09B, 0x615117, 0x2DE383, 0x16720F, 0xB486AB, 0x8F1727, 0xC3A5B3, 0xF8343F,
+    0xB58136, 0x8E10BA, 0xC2A22E, 0xF933A2, 0x5BC706, 0x60568A, 0x2CE41E, 0x177592,
+    0xEF41AD, 0xD4D021, 0x9862B5, 0xA3F339, 0x01079D, 0x3A9611, 0x762485, 0x4DB509,
+    0xED4E97, 0xD6DF1B, 0x9A6D8F, 0xA1FC03, 0x0308A7, 0x38992B, 0x742BBF, 0x4FBA33,
+    0xB78E0C, 0x8C1F80, 0xC0AD14, 0xFB3C98, 0x59C83C, 0x6259B0, 0x2EEB24, 0x157AA8,
+    0x58CFA1, 0x635E2D, 0x2FECB9, 0x147D35, 0xB68991, 0x8D181D, 0xC1AA89, 0xFA3B05,
+    0x020F3A, 0x399EB6, 0x752C22, 0x4EBDAE, 0xEC490A, 0xD7D886, 0x9B6A12, 0xA0FB9E,
+    0x5CD1D5, 0x674059, 0x2BF2CD, 0x106341, 0xB297E5, 0x890669, 0xC5B4FD, 0xFE2571,
+    0x06114E, 0x3D80C2, 0x713256, 0x4AA3DA, 0xE8577E, 0xD3C6F2, 0x9F7466, 0xA4E5EA,
+    0xE950E3, 0xD2C16F, 0x9E73FB, 0xA5E277, 0x0716D3, 0x3C875F, 0x7035CB, 0x4BA447,
+    0xB39078, 0x8801F4, 0xC4B360, 0xFF22EC, 0x5DD648, 0x6647C4, 0x2AF550, 0x1164DC,
+    0xB19F42, 0x8A0ECE, 0xC6BC5A, 0xFD2DD6, 0x5FD972, 0x6448FE, 0x28FA6A, 0x136BE6,
+    0xEB5FD9, 0xD0CE55, 0x9C7CC1, 0xA7ED4D, 0x0519E9, 0x3E8865, 0x723AF1, 0x49AB7D,
+    0x041E74, 0x3F8FF8, 0x733D6C, 0x48ACE0, 0xEA5844, 0xD1C9C8, 0x9D7B5C, 0xA6EAD0,
+    0x5EDEEF, 0x654F63, 0x29FDF7, 0x126C7B, 0xB098DF, 0x8B0953, 0xC7BBC7, 0xFC2A4B,
+    0xB9A3AA, 0x823226, 0xCE80B2, 0xF5113E, 0x57E59A, 0x6C7416, 0x20C682, 0x1B570E,
+    0xE36331, 0xD8F2BD, 0x944029, 0xAFD1A5, 0x0D2501, 0x36B48D, 0x7A0619, 0x419795,
+    0x0C229C, 0x37B310, 0x7B0184, 0x409008, 0xE264AC, 0xD9F520, 0x9547B4, 0xAED638,
+    0x56E207, 0x6D738B, 0x21C11F, 0x1A5093, 0xB8A437, 0x8335BB, 0xCF872F, 0xF416A3,
+    0x54ED3D, 0x6F7CB1, 0x23CE25, 0x185FA9, 0xBAAB0D, 0x813A81, 0xCD8815, 0xF61999,
+    0x0E2DA6, 0x35BC2A, 0x790EBE, 0x429F32, 0xE06B96, 0xDBFA1A, 0x97488E, 0xACD902,
+    0xE16C0B, 0xDAFD87, 0x964F13, 0xADDE9F, 0x0F2A3B, 0x34BBB7, 0x780923, 0x4398AF,
+    0xBBAC90, 0x803D1C, 0xCC8F88, 0xF71E04, 0x55EAA0, 0x6E7B2C, 0x22C9B8, 0x195834,
+    0xE5727F, 0xDEE3F3, 0x925167, 0xA9C0EB, 0x0B344F, 0x30A5C3, 0x7C1757, 0x4786DB,
+    0xBFB2E4, 0x842368, 0xC891FC, 0xF30070, 0x51F4D4, 0x6A6558, 0x26D7CC, 0x1D4640,
+    0x50F349, 0x6B62C5, 0x27D051, 0x1C41DD, 0xBEB579, 0x8524F5, 0xC99661, 0xF207ED,
+    0x0A33D2, 0x31A25E, 0x7D10CA, 0x468146, 0xE475E2, 0xDFE46E, 0x9356FA, 0xA8C776,
+    0x083CE8, 0x33AD64, 0x7F1FF0, 0x448E7C, 0xE67AD8, 0xDDEB54, 0x9159C0, 0xAAC84C,
+    0x52FC73, 0x696DFF, 0x25DF6B, 0x1E4EE7, 0xBCBA43, 0x872BCF, 0xCB995B, 0xF008D7,
+    0xBDBDDE, 0x862C52, 0xCA9EC6, 0xF10F4A, 0x53FBEE, 0x686A62, 0x24D8F6, 0x1F497A,
+    0xE77D45, 0xDCECC9, 0x905E5D, 0xABCFD1, 0x093B75, 0x32AAF9, 0x7E186D, 0x4589E1
+  },
+  {
+    0x000000, 0xF50BAF, 0x6C5BA5, 0x99500A, 0xD8B74A, 0x2DBCE5, 0xB4ECEF, 0x41E740,
+    0x37226F, 0xC229C0, 0x5B79CA, 0xAE7265, 0xEF9525, 0x1A9E8A, 0x83CE80, 0x76C52F,
+    0x6E44DE, 0x9B4F71, 0x021F7B, 0xF714D4, 0xB6F394, 0x43F83B, 0xDAA831, 0x2FA39E,
+    0x5966B1, 0xAC6D1E, 0x353D14, 0xC036BB, 0x81D1FB, 0x74DA54, 0xED8A5E, 0x1881F1,
+    0xDC89BC, 0x298213, 0xB0D219, 0x45D9B6, 0x043EF6, 0xF13559, 0x686553, 0x9D6EFC,
+    0xEBABD3, 0x1EA07C, 0x87F076, 0x72FBD9, 0x331C99, 0xC61736, 0x5F473C, 0xAA4C93,
+    0xB2CD62, 0x47C6CD, 0xDE96C7, 0x2B9D68, 0x6A7A28, 0x9F7187, 0x06218D, 0xF32A22,
+    0x85EF0D, 0x70E4A2, 0xE9B4A8, 0x1CBF07, 0x5D5847, 0xA853E8, 0x3103E2, 0xC4084D,
+    0x3F5F83, 0xCA542C, 0x530426, 0xA60F89, 0xE7E8C9, 0x12E366, 0x8BB36C, 0x7EB8C3,
+    0x087DEC, 0xFD7643, 0x642649, 0x912DE6, 0xD0CAA6, 0x25C109, 0xBC9103, 0x499AAC,
+    0x511B5D, 0xA410F2, 0x3D40F8, 0xC84B57, 0x89AC17, 0x7CA7B8, 0xE5F7B2, 0x10FC1D,
+    0x663932, 0x93329D, 0x0A6297, 0xFF6938, 0xBE8E78, 0x4B85D7, 0xD2D5DD, 0x27DE72,
+    0xE3D63F, 0x16DD90, 0x8F8D9A, 0x7A8635, 0x3B6175, 0xCE6ADA, 0x573AD0, 0xA2317F,
+    0xD4F450, 0x21FFFF, 0xB8AFF5, 0x4DA45A, 0x0C431A, 0xF948B5, 0x6018BF, 0x951310,
+    0x8D92E1, 0x78994E, 0xE1C944, 0x14C2EB, 0x5525AB, 0xA02E04, 0x397E0E, 0xCC75A1,
+    0xBAB08E, 0x4FBB21, 0xD6EB2B, 0x23E084, 0x6207C4, 0x970C6B, 0x0E5C61, 0xFB57CE,
+    0x7EBF06, 0x8BB4A9, 0x12E4A3, 0xE7EF0C, 0xA6084C, 0x5303E3, 0xCA53E9, 0x3F5846,
+    0x499D69, 0xBC96C6, 0x25C6CC, 0xD0CD63, 0x912A23, 0x64218C, 0xFD7186, 0x087A29,
+    0x10FBD8, 0xE5F077, 0x7CA07D, 0x89ABD2, 0xC84C92, 0x3D473D, 0xA41737, 0x511C98,
+    0x27D9B7, 0xD2D218, 0x4B8212, 0xBE89BD, 0xFF6EFD, 0x0A6552, 0x933558, 0x663EF7,
+    0xA236BA, 0x573D15, 0xCE6D1F, 0x3B66B0, 0x7A81F0, 0x8F8A5F, 0x16DA55, 0xE3D1FA,
+    0x9514D5, 0x601F7A, 0xF94F70, 0x0C44DF, 0x4DA39F, 0xB8A830, 0x21F83A, 0xD4F395,
+    0xCC7264, 0x3979CB, 0xA029C1, 0x55226E, 0x14C52E, 0xE1CE81, 0x789E8B, 0x8D9524,
+    0xFB500B, 0x0E5BA4, 0x970BAE, 0x620001, 0x23E741, 0xD6ECEE, 0x4FBCE4, 0xBAB74B,
+    0x41E085, 0xB4EB2A, 0x2DBB20, 0xD8B08F, 0x9957CF, 0x6C5C60, 0xF50C6A, 0x0007C5,
+    0x76C2EA, 0x83C945, 0x1A994F, 0xEF92E0, 0xAE75A0, 0x5B7E0F, 0xC22E05, 0x3725AA,
+    0x2FA45B, 0xDAAFF4, 0x43FFFE, 0xB6F451, 0xF71311, 0x0218BE, 0x9B48B4, 0x6E431B,
+    0x188634, 0xED8D9B, 0x74DD91, 0x81D63E, 0xC0317E, 0x353AD1, 0xAC6ADB, 0x596174,
+    0x9D6939, 0x686296, 0xF1329C, 0x043933, 0x45DE73, 0xB0D5DC, 0x2985D6, 0xDC8E79,
+    0xAA4B56, 0x5F40F9, 0xC610F3, 0x331B5C, 0x72FC1C, 0x87F7B3, 0x1EA7B9, 0xEBAC16,
+    0xF32DE7, 0x062648, 0x9F7642, 0x6A7DED, 0x2B9AAD, 0xDE9102, 0x47C108, 0xB2CAA7,
+    0xC40F88, 0x310427, 0xA8542D, 0x5D5F82, 0x1CB8C2, 0xE9B36D, 0x70E367, 0x85E8C8
+  }
 };
 
-/** Calculate Qualcomm 24-bit Cyclical Redundancy Check (CRC-24Q).
+/** Calculate Qualcomm 24-bit Cyclical Redundancy Check (CRC-24Q), one byte at
+ * a time.
  *
  * The CRC polynomial used is:
  * \f[
@@ -128,13 +651,208 @@ static const u32 crc24qtab[256] = {
  *
  * \return CRC-24Q value
  */
-u32 crc24q(const u8 *buf, u32 len, u32 crc)
+u32 crc24q_bytewise(const u8 *buf, u32 len, u32 crc)
 {
   for (u32 i = 0; i < len; i++)
-    crc = ((crc << 8) & 0xFFFFFF) ^ crc24qtab[(crc >> 16) ^ buf[i]];
+    crc = ((crc << 8) & 0xFFFFFF) ^ crc24qtab[0][(crc >> 16) ^ buf[i]];
   return crc;
 }
 
+/** Calculate Qualcomm 24-bit Cyclical Redundancy Check (CRC-24Q), eight bytes
+ * at a time.
+ * Gives the same result as crc24q_bytewise().
+ *
+ * \param buf Array of data to calculate CRC for
+ * \param len Length of data array
+ * \param crc Initial CRC value
+ *
+ * \return CRC-24Q value
+ */
+u32 crc24q_slice8(const u8 *buf, u32 len, u32 crc)
+{
+  for (; len >= 8; len -= 8, buf += 8)
+    crc = crc24qtab[7][buf[0] ^ (crc >> 16)] ^
+          crc24qtab[6][buf[1] ^ ((crc >> 8) & 0xFF)] ^
+          crc24qtab[5][buf[2] ^ (crc & 0xFF)] ^
+          crc24qtab[4][buf[3]] ^ crc24qtab[3][buf[4]] ^
+          crc24qtab[2][buf[5]] ^ crc24qtab[1][buf[6]] ^
+          crc24qtab[0][buf[7]];
+  return crc24q_bytewise(buf, len, crc);
+}
+
+#ifdef EDC_CLMUL
+
+/* Folding constants x^d mod P for d = 128, 192, 256, ..., 576. */
+static const u64 crc16_clmul_k[8] = {
+  0xAEFC, 0x650B, 0x8E29, 0x26AA, 0xCDE2, 0x2535, 0x13FC, 0x8832
+};
+static const u64 crc24q_clmul_k[8] = {
+  0x6243DA, 0xB22B31, 0xCB800E, 0xD15ED7, 0x01CD94, 0x3B20E3, 0x7DB43E, 0xB937A7
+};
+
+/* CPU support for the folding, resolved on first use. */
+static enum {
+  EDC_CLMUL_UNKNOWN = 0,
+  EDC_CLMUL_UNSUPPORTED,
+  EDC_CLMUL_SUPPORTED
+} edc_clmul_support;
+
+__attribute__((noinline, cold))
+static u8 edc_detect_clmul(void)
+{
+  __builtin_cpu_init();
+  u8 have = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+  /* Racing first calls all store the same value. */
+  __atomic_store_n(&edc_clmul_support,
+                   have ? EDC_CLMUL_SUPPORTED : EDC_CLMUL_UNSUPPORTED,
+                   __ATOMIC_RELAXED);
+  return have;
+}
+
+static inline u8 edc_have_clmul(void)
+{
+  switch (__atomic_load_n(&edc_clmul_support, __ATOMIC_RELAXED)) {
+    case EDC_CLMUL_SUPPORTED: return 1;
+    case EDC_CLMUL_UNSUPPORTED: return 0;
+    default: return edc_detect_clmul();
+  }
+}
+
+/* Load 16 bytes as a polynomial, the first byte holding the highest powers. */
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i clmul_load(const u8 *p)
+{
+  const __m128i rev = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                   8, 9, 10, 11, 12, 13, 14, 15);
+  return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), rev);
+}
+
+/* Multiply a by x^d modulo P, where k holds x^(d+64) mod P in its high half
+ * and x^d mod P in its low half. The result is congruent, not reduced. */
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i clmul_fold(__m128i a, __m128i k)
+{
+  return _mm_xor_si128(_mm_clmulepi64_si128(a, k, 0x11),
+                       _mm_clmulepi64_si128(a, k, 0x00));
+}
+
+/** Fold a buffer down to a 16 byte block with the same CRC.
+ * A CRC only depends on the message modulo the CRC polynomial P, so any part
+ * of the message followed by `d` bits may be replaced by its product with
+ * x^d mod P. Four 16 byte accumulators are folded forward over the buffer 64
+ * bytes at a time and then into one.
+ *
+ * \param buf   Array of data, at least #EDC_CLMUL_MIN_LEN long
+ * \param len   Length of data array
+ * \param crc   Initial CRC value
+ * \param width Width of the CRC in bits
+ * \param k     Folding constants x^d mod P for d = 128, 192, ..., 576
+ * \param rem   Output, the 16 byte block to take the CRC of with initial
+ *              value 0 in place of the first `n` bytes of `buf`
+ * \return `n`, the number of bytes folded, a multiple of 16
+ */
+__attribute__((target("pclmul,ssse3")))
+static u32 crc_clmul_fold(const u8 *buf, u32 len, u32 crc, u32 width,
+                          const u64 k[8], u8 rem[16])
+{
+  const __m128i rev = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                   8, 9, 10, 11, 12, 13, 14, 15);
+  const __m128i k128 = _mm_set_epi64x(k[1], k[0]);
+  const __m128i k256 = _mm_set_epi64x(k[3], k[2]);
+  const __m128i k384 = _mm_set_epi64x(k[5], k[4]);
+  const __m128i k512 = _mm_set_epi64x(k[7], k[6]);
+
+  /* The initial CRC value is equivalent to XORing it into the first bits of
+   * the message. */
+  __m128i a0 = _mm_xor_si128(clmul_load(buf),
+                             _mm_set_epi64x((u64)crc << (64 - width), 0));
+  __m128i a1 = clmul_load(buf + 16);
+  __m128i a2 = clmul_load(buf + 32);
+  __m128i a3 = clmul_load(buf + 48);
+
+  u32 n;
+  for (n = 64; n + 64 <= len; n += 64) {
+    a0 = _mm_xor_si128(clmul_fold(a0, k512), clmul_load(buf + n));
+    a1 = _mm_xor_si128(clmul_fold(a1, k512), clmul_load(buf + n + 16));
+    a2 = _mm_xor_si128(clmul_fold(a2, k512), clmul_load(buf + n + 32));
+    a3 = _mm_xor_si128(clmul_fold(a3, k512), clmul_load(buf + n + 48));
+  }
+
+  a0 = _mm_xor_si128(_mm_xor_si128(clmul_fold(a0, k384), clmul_fold(a1, k256)),
+                     _mm_xor_si128(clmul_fold(a2, k128), a3));
+  for (; n + 16 <= len; n += 16)
+    a0 = _mm_xor_si128(clmul_fold(a0, k128), clmul_load(buf + n));
+
+  _mm_storeu_si128((__m128i *)rem, _mm_shuffle_epi8(a0, rev));
+  return n;
+}
+
+#endif /* EDC_CLMUL */
+
+/** Calculate CCITT 16-bit Cyclical Redundancy Check (CRC16).
+ *
+ * This implementation uses parameters used by XMODEM i.e. polynomial is:
+ * \f[
+ *   x^{16} + x^{12} + x^5 + 1
+ * \f]
+ * Mask 0x11021, not reversed, not XOR'd
+ * (there are several slight variants on the CCITT CRC-16).
+ *
+ * Uses carry-less multiply folding on long buffers if the CPU supports it and
+ * slicing-by-8 otherwise.
+ *
+ * \param buf Array of data to calculate CRC for
+ * \param len Length of data array
+ * \param crc Initial CRC value
+ *
+ * \return CRC16 value
+ */
+u16 crc16_ccitt(const u8 *buf, u32 len, u16 crc)
+{
+#ifdef EDC_CLMUL
+  if (len >= EDC_CLMUL_MIN_LEN && edc_have_clmul()) {
+    u8 rem[16];
+    u32 n = crc_clmul_fold(buf, len, crc, 16, crc16_clmul_k, rem);
+    crc = crc16_ccitt_slice8(rem, sizeof(rem), 0);
+    buf += n;
+    len -= n;
+  }
+#endif
+  return crc16_ccitt_slice8(buf, len, crc);
+}
+
+/** Calculate Qualcomm 24-bit Cyclical Redundancy Check (CRC-24Q).
+ *
+ * The CRC polynomial used is:
+ * \f[
+ *   x^{24} + x^{23} + x^{18} + x^{17} + x^{14} + x^{11} + x^{10} +
+ *   x^7    + x^6    + x^5    + x^4    + x^3    + x+1
+ * \f]
+ * Mask 0x1864CFB, not reversed, not XOR'd
+ *
+ * Uses carry-less multiply folding on long buffers if the CPU supports it and
+ * slicing-by-8 otherwise.
+ *
+ * \param buf Array of data to calculate CRC for
+ * \param len Length of data array
+ * \param crc Initial CRC value
+ *
+ * \return CRC-24Q value
+ */
+u32 crc24q(const u8 *buf, u32 len, u32 crc)
+{
+#ifdef EDC_CLMUL
+  if (len >= EDC_CLMUL_MIN_LEN && edc_have_clmul()) {
+    u8 rem[16];
+    u32 n = crc_clmul_fold(buf, len, crc, 24, crc24q_clmul_k, rem);
+    crc = crc24q_slice8(rem, sizeof(rem), 0);
+    buf += n;
+    len -= n;
+  }
+#endif
+  return crc24q_slice8(buf, len, crc);
+}
+
 /** \} */
 
 /** \} */
@@ -17,9 +17,10 @@
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
-#include <cblas.h>
-#include <clapack.h>
 #include "amb_kf.h"
+#include "lambda.h"
+#include "parallel.h"
+#include "small_matrix.h"
 
 /* constants/macros ----------------------------------------------------------*/
 
@@ -76,11 +77,10 @@ static s8 udu2(u32 n, double *M, double *U, double *D) //todo: replace with DSYT
 
 
 /* LD factorization (Q=L'*diag(D)*L) -----------------------------------------*/
-int LD(int n, const double *Q, double *L, double *D)
+static int LD_work(int n, const double *Q, double *L, double *D, double *A)
 {
     int i,j,k,info=0;
     double a;
-    double A[n*n];
     memset(L, 0, sizeof(double)*n*n);
     memset(D, 0, sizeof(double)*n);
 
@@ -92,26 +92,43 @@ int LD(int n, const double *Q, double *L, double *D)
         for (j=0;j<=i-1;j++) for (k=0;k<=j;k++) A[j+k*n]-=L[i+k*n]*L[i+j*n];
         for (j=0;j<=i;j++) L[i+j*n]/=L[i+i*n];
     }
+    if (info) {
+        /* trying UD from Gibbs (col major UD = LD) */
+        memcpy(A, Q, n * n * sizeof(double));
+        udu2(n, A, L, D);
+    }
+    return info;
+}
+int LD(int n, const double *Q, double *L, double *D)
+{
+    double A[n*n];
+    int info=LD_work(n,Q,L,D,A);
+
     if (info) {
         printf("%s : LD factorization error, trying UD from Gibbs (col major UD = LD)\n",__FILE__);
-        double Qcopy[n * n];
-        memcpy(Qcopy, Q, n * n * sizeof(double));
-        udu2(n, Qcopy, L, D);
     }
     return info;
 }
 /* integer gauss transformation ----------------------------------------------*/
-void gauss(int n, double *L, double *Z, int i, int j)
+/* if Zi is not NULL it holds Z^-1 and is kept up to date: Z=Z*G implies
+ * Zi=G^-1*Zi, i.e. row i of Zi gets mu times row j added to it. */
+static void gauss_work(int n, double *L, double *Z, double *Zi, int i, int j)
 {
     int k,mu;
 
     if ((mu=(int)ROUND(L[i+j*n]))!=0) {
         for (k=i;k<n;k++) L[k+n*j]-=(double)mu*L[k+i*n];
         for (k=0;k<n;k++) Z[k+n*j]-=(double)mu*Z[k+i*n];
+        if (Zi) for (k=0;k<n;k++) Zi[i+n*k]+=(double)mu*Zi[j+n*k];
     }
 }
+void gauss(int n, double *L, double *Z, int i, int j)
+{
+    gauss_work(n,L,Z,NULL,i,j);
+}
 /* permutations --------------------------------------------------------------*/
-void perm(int n, double *L, double *D, int j, double del, double *Z)
+static void perm_work(int n, double *L, double *D, int j, double del,
+                      double *Z, double *Zi)
 {
     int k;
     double eta,lam,a0,a1;
@@ -127,41 +144,101 @@ void perm(int n, double *L, double *D, int j, double del, double *Z)
     L[j+1+j*n]=lam;
     for (k=j+2;k<n;k++) SWAP(L[k+j*n],L[k+(j+1)*n]);
     for (k=0;k<n;k++) SWAP(Z[k+j*n],Z[k+(j+1)*n]);
+    /* column swap of Z is a row swap of Z^-1 */
+    if (Zi) for (k=0;k<n;k++) SWAP(Zi[j+k*n],Zi[j+1+k*n]);
+}
+void perm(int n, double *L, double *D, int j, double del, double *Z)
+{
+    perm_work(n,L,D,j,del,Z,NULL);
 }
 /* lambda reduction (z=Z'*a, Qz=Z'*Q*Z=L'*diag(D)*L) (ref.[1]) ---------------*/
-void reduction(int n, double *L, double *D, double *Z)
+static void reduction_work(int n, double *L, double *D, double *Z, double *Zi)
 {
     int i,j,k;
     double del;
 
     j=n-2; k=n-2;
     while (j>=0) {
-        if (j<=k) for (i=j+1;i<n;i++) gauss(n,L,Z,i,j);
+        if (j<=k) for (i=j+1;i<n;i++) gauss_work(n,L,Z,Zi,i,j);
         del=D[j]+L[j+1+j*n]*L[j+1+j*n]*D[j+1];
         if (del+1E-6<D[j+1]) { /* compared considering numerical error */
-            perm(n,L,D,j,del,Z);
+            perm_work(n,L,D,j,del,Z,Zi);
             k=j; j=n-2;
         }
         else j--;
     }
 }
+void reduction(int n, double *L, double *D, double *Z)
+{
+    reduction_work(n,L,D,Z,NULL);
+}
 /* modified lambda (mlambda) search (ref. [2]) -------------------------------*/
-static int search(int n, int m, const double *L, const double *D,
-                  const double *zs, double *zn, double *s)
+/* search control. maxdist is the initial search radius (chi^2). if ratio is
+ * positive the radius is additionally shrunk to ratio times the best residual
+ * found so far, candidates outside of that cannot change the outcome of a
+ * ratio test with that threshold. the search stops early once max_leaves
+ * candidates have been evaluated (0:no limit).
+ *
+ * for the parallel search the tree searched is a subtree whose fixed upper
+ * levels contribute offset to every residual, and bound (if not NULL) is a
+ * radius shared with the other subtrees: it is read at every node and
+ * tightened whenever this subtree can prove a smaller one.
+ *
+ * nodes, leaves and n_cands are outputs. */
+typedef struct {
+    double maxdist;
+    double ratio;
+    int loopmax;
+    int max_leaves;
+    double offset;
+    u64 *bound;
+    int nodes;
+    int leaves;
+    int n_cands;
+} search_ctl_t;
+
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+/* the shared radius is a non-negative double, whose IEEE-754 bit pattern
+ * orders the same way as the corresponding u64, so it can be kept in a u64
+ * and lowered with a plain integer compare-and-swap. */
+static inline double bound_load(u64 *bound)
 {
-    int i,j,k,c,nn=0,imax=0;
-    double newdist,maxdist=1E99,y;
-    double S[n*n];
-    double dist[n];
-    double zb[n];
-    double z[n];
-    double step[n];
+    union {u64 u; double d;} b;
+    b.u=__atomic_load_n(bound,__ATOMIC_RELAXED);
+    return b.d;
+}
+static inline void bound_lower(u64 *bound, double d)
+{
+    union {u64 u; double d;} b;
+    u64 old=__atomic_load_n(bound,__ATOMIC_RELAXED);
+    b.d=d;
+    while (b.u<old&&!__atomic_compare_exchange_n(bound,&old,b.u,1,
+                                                 __ATOMIC_RELAXED,
+                                                 __ATOMIC_RELAXED));
+}
+#else
+static inline double bound_load(u64 *bound) {(void)bound; return 1E99;}
+static inline void bound_lower(u64 *bound, double d) {(void)bound; (void)d;}
+#endif
+
+/* S (n x n), dist, zb, z and step (n x 1) are caller supplied work arrays. */
+static int search_ctl(int n, int m, const double *L, const double *D,
+                      const double *zs, double *zn, double *s,
+                      double *S, double *dist, double *zb, double *z,
+                      double *step, search_ctl_t *ctl)
+{
+    int i,j,k,c,nn=0,imax=0,leaves=0;
+    double newdist,maxdist=ctl->maxdist,sbest=1E99,y,b;
     memset(S, 0, sizeof(double)*n*n);
 
     k=n-1; dist[k]=0.0;
     zb[k]=zs[k];
     z[k]=ROUND(zb[k]); y=zb[k]-z[k]; step[k]=SGN(y);
-    for (c=0;c<LOOPMAX;c++) {
+    for (c=0;c<ctl->loopmax;c++) {
+        if (ctl->bound) {
+            b=bound_load(ctl->bound)-ctl->offset;
+            if (b<maxdist) maxdist=b;
+        }
         newdist=dist[k]+y*y/D[k];
         if (newdist<maxdist) {
             if (k!=0) {
@@ -172,6 +249,7 @@ static int search(int n, int m, const double *L, const double *D,
                 z[k]=ROUND(zb[k]); y=zb[k]-z[k]; step[k]=SGN(y);
             }
             else {
+                leaves++;
                 if (nn<m) {
                     if (nn==0||newdist>s[imax]) imax=nn;
                     for (i=0;i<n;i++) zn[i+nn*n]=z[i];
@@ -185,6 +263,16 @@ static int search(int n, int m, const double *L, const double *D,
                     }
                     maxdist=s[imax];
                 }
+                if (ctl->ratio>0.0) {
+                    if (newdist<sbest) sbest=newdist;
+                    b=ctl->ratio*(sbest+ctl->offset)-ctl->offset;
+                    if (b<maxdist) maxdist=b;
+                }
+                if (ctl->bound) {
+                    b=nn==m&&s[imax]<maxdist?s[imax]:maxdist;
+                    bound_lower(ctl->bound,b+ctl->offset);
+                }
+                if (ctl->max_leaves&&leaves>=ctl->max_leaves) break;
                 z[0]+=step[0]; y=zb[0]-z[0]; step[0]=-step[0]-SGN(step[0]);
             }
         }
@@ -196,15 +284,39 @@ static int search(int n, int m, const double *L, const double *D,
             }
         }
     }
-    for (i=0;i<m-1;i++) { /* sort by s */
-        for (j=i+1;j<m;j++) {
+    for (i=0;i<nn-1;i++) { /* sort by s */
+        for (j=i+1;j<nn;j++) {
             if (s[i]<s[j]) continue;
             SWAP(s[i],s[j]);
             for (k=0;k<n;k++) SWAP(zn[k+i*n],zn[k+j*n]);
         }
     }
+    ctl->nodes=c;
+    ctl->leaves=leaves;
+    ctl->n_cands=nn;
+
+    if (c>=ctl->loopmax) return -1;
+    return 0;
+}
+static int search_work(int n, int m, const double *L, const double *D,
+                       const double *zs, double *zn, double *s,
+                       double *S, double *dist, double *zb, double *z,
+                       double *step)
+{
+    search_ctl_t ctl={1E99,0.0,LOOPMAX,0,0.0,NULL,0,0,0};
+
+    return search_ctl(n,m,L,D,zs,zn,s,S,dist,zb,z,step,&ctl);
+}
+static int search(int n, int m, const double *L, const double *D,
+                  const double *zs, double *zn, double *s)
+{
+    double S[n*n];
+    double dist[n];
+    double zb[n];
+    double z[n];
+    double step[n];
 
-    if (c>=LOOPMAX) {
+    if (search_work(n,m,L,D,zs,zn,s,S,dist,zb,z,step)) {
         fprintf(stderr,"%s : search loop count overflow\n",__FILE__);
         return -1;
     }
@@ -246,25 +358,6 @@ int lambda_reduction(int n, const double *Q, double *Z)
     return info;
 }
 
-/* multiply matrix (wrapper of blas dgemm) -------------------------------------
-* multiply matrix by matrix (C=alpha*A*B+beta*C)
-* args   : char   *tr       I  transpose flags ("N":normal,"T":transpose)
-*          int    n,k,m     I  size of (transposed) matrix A,B
-*          double alpha     I  alpha
-*          double *A,*B     I  (transposed) matrix A (n x m), B (m x k)
-*          double beta      I  beta
-*          double *C        IO matrix C (n x k)
-* return : none
-*-----------------------------------------------------------------------------*/
-void matmul(const char *tr, integer n, integer k, integer m, double alpha,
-                   const double *A, const double *B, double beta, double *C)
-{
-    integer lda=tr[0]=='T'?m:n,ldb=tr[1]=='T'?k:m;
-
-    dgemm_((char *)tr,(char *)tr+1,&n,&k,&m,&alpha,(double *)A,&lda,(double *)B,
-           &ldb,&beta,C,&n);
-}
-
 /* solve linear equation -------------------------------------------------------
 * solve linear equation (X=A\Y or X=A'\Y)
 * args   : char   *tr       I   transpose flag ("N":normal,"T":transpose)
@@ -276,18 +369,19 @@ void matmul(const char *tr, integer n, integer k, integer m, double alpha,
 * notes  : matirix stored by column-major order (fortran convention)
 *          X can be same as Y
 *-----------------------------------------------------------------------------*/
-int solve(const char *tr, const double *A, const double *Y, integer n,
-                 integer m, double *X)
+int solve(const char *tr, const double *A, const double *Y, int n,
+                 int m, double *X)
 {
     double B[n*n];
-    integer info;
-    integer ipiv[n];
+    u8 ipiv[n];
+    int j;
 
+    /* column-major A is row-major A', so the transposes swap over */
     memcpy(B, A, sizeof(double)*n*n);
     memcpy(X, Y, sizeof(double)*n*m);
-    dgetrf_(&n,&n,B,&n,ipiv,&info);
-    if (!info) dgetrs_((char *)tr,&n,&m,B,&n,ipiv,X,&n,&info);
-    return info;
+    if (smat_lu(n,B,ipiv)) return -1;
+    for (j=0;j<m;j++) smat_lu_solve(n,B,ipiv,tr[0]!='T',X+j*n);
+    return 0;
 }
 
 
@@ -328,7 +422,7 @@ int lambda_solution(int n, int m, const double *a, const double *Q, double *F,
 
         /* lambda reduction */
         reduction(n,L,D,Z);
-        matmul("TN",n,1,n,1.0,Z,a,0.0,z); /* z=Z'*a */
+        smat_gemv(n,n,1.0,Z,a,0.0,z); /* z=Z'*a */
 
         /* mlambda search */
         if (!(info=search(n,m,L,D,z,E,s))) {
@@ -338,3 +432,502 @@ int lambda_solution(int n, int m, const double *a, const double *Q, double *F,
     }
     return info;
 }
+
+/* z=Z'*a for n x n column-major Z ---------------------------------------------*/
+static inline void mat_tvec(int n, const double *Z, const double *a, double *z)
+{
+    int i,k;
+
+    for (i=0;i<n;i++) {
+        double acc=0.0;
+        const double *Zc=Z+i*n;
+        for (k=0;k<n;k++) acc+=Zc[k]*a[k];
+        z[i]=acc;
+    }
+}
+
+/* workspace lambda reduction --------------------------------------------------
+* same as lambda_reduction() but all working storage comes from ws, no VLAs are
+* used and nothing is printed. Z^-1 is tracked exactly (Z is unimodular)
+* alongside Z and left in ws->Zi, so callers never need a general inverse.
+* args   : lambda_workspace_t *ws I work area (ws->Zi O Z^-1 (n x n))
+*          int    n      I  number of float parameters (n<=LAMBDA_MAX_DIM)
+*          double *Q     I  covariance matrix of float parameters (n x n)
+*          double *Z     O  decorrelating transformation (n x n)
+* return : status (0:ok,other:error)
+*-----------------------------------------------------------------------------*/
+int lambda_reduction_ws(lambda_workspace_t *ws, int n, const double *Q,
+                        double *Z)
+{
+    int info;
+
+    if (n<=0||n>LAMBDA_MAX_DIM) return -1;
+
+    memset(Z, 0, sizeof(double)*n*n);
+    memset(ws->Zi, 0, sizeof(double)*n*n);
+    for (int i=0; i<n; i++) {
+      Z[i+n*i] = 1;
+      ws->Zi[i+n*i] = 1;
+    }
+
+    if (!(info=LD_work(n,Q,ws->L,ws->D,ws->A))) {
+        reduction_work(n,ws->L,ws->D,Z,ws->Zi);
+    }
+    return info;
+}
+
+/* workspace lambda/mlambda integer least-square estimation --------------------
+* same as lambda_solution() but all working storage comes from ws. no VLAs,
+* BLAS or LAPACK are used: z=Z'*a is a plain inlined kernel and F=Z'\E is
+* formed from Z^-1, which is tracked exactly (Z is unimodular) alongside Z
+* during the reduction, so no general linear solve is required.
+* args : lambda_workspace_t *ws I work area
+*        int n I number of float parameters (n<=LAMBDA_MAX_DIM)
+*        int m I number of fixed solutions (m<=LAMBDA_MAX_CANDS)
+*        double *a I float parameters (n x 1)
+*        double *Q I covariance matrix of float parameters (n x n)
+*        double *F O fixed solutions (n x m)
+*        double *s O sum of squared residulas of fixed solutions (1 x m)
+* return : status (0:ok,other:error)
+* notes : matrix stored by column-major order (fortran convension)
+*-----------------------------------------------------------------------------*/
+int lambda_solution_ws(lambda_workspace_t *ws, int n, int m, const double *a,
+                       const double *Q, double *F, double *s)
+{
+    int info,i,j,k;
+
+    if (n<=0||m<=0||n>LAMBDA_MAX_DIM||m>LAMBDA_MAX_CANDS) return -1;
+
+    /* Z = eye(n), Zi = eye(n) */
+    memset(ws->Z, 0, sizeof(double)*n*n);
+    memset(ws->Zi, 0, sizeof(double)*n*n);
+    for (i=0; i<n; i++) {
+      ws->Z[i+n*i] = 1;
+      ws->Zi[i+n*i] = 1;
+    }
+
+    if ((info=LD_work(n,Q,ws->L,ws->D,ws->A))) return info;
+
+    reduction_work(n,ws->L,ws->D,ws->Z,ws->Zi);
+    mat_tvec(n,ws->Z,a,ws->z); /* z=Z'*a */
+
+    /* the LD scratch matrix A is free again and doubles as S for the search */
+    if ((info=search_work(n,m,ws->L,ws->D,ws->z,ws->E,s,
+                          ws->A,ws->dist,ws->zb,ws->zc,ws->step))) {
+        return info;
+    }
+
+    /* F=Z'\E=Zi'*E */
+    for (j=0;j<m;j++) {
+        for (i=0;i<n;i++) {
+            double acc=0.0;
+            for (k=0;k<n;k++) acc+=ws->Zi[k+i*n]*ws->E[k+j*n];
+            F[i+j*n]=acc;
+        }
+    }
+    return 0;
+}
+
+/* bootstrapped success rate of a single conditional ambiguity ----------------
+* P(|e|<0.5) for e~N(0,d), i.e. 2*Phi(1/(2*sqrt(d)))-1 (ref. [1])
+*-----------------------------------------------------------------------------*/
+static double success_rate_1(double d)
+{
+    if (d<=0.0) return 1.0;
+    return erf(0.5/sqrt(2.0*d));
+}
+
+/* prepare the extended search ------------------------------------------------
+* LD factorization, reduction and choice of the fixed subset z[k..n-1] for
+* lambda_search_ws() and lambda_search_parallel(). the trailing p x p block of
+* L is copied to ws->Lp. returns the LD status, sets *k and fills the subset
+* fields of st.
+*-----------------------------------------------------------------------------*/
+static int search_prepare(lambda_workspace_t *ws, int n, const double *a,
+                          const double *Q, const lambda_search_params_t *params,
+                          int *k, lambda_search_stats_t *st)
+{
+    int info,i,j,p;
+    double ps=1.0;
+
+    memset(ws->Z, 0, sizeof(double)*n*n);
+    memset(ws->Zi, 0, sizeof(double)*n*n);
+    for (i=0; i<n; i++) {
+      ws->Z[i+n*i] = 1;
+      ws->Zi[i+n*i] = 1;
+    }
+
+    if ((info=LD_work(n,Q,ws->L,ws->D,ws->A))) return info;
+
+    reduction_work(n,ws->L,ws->D,ws->Z,ws->Zi);
+    mat_tvec(n,ws->Z,a,ws->z); /* z=Z'*a */
+
+    *k=n;
+    if (params->min_success_rate>0.0) {
+        while (*k>0&&ps*success_rate_1(ws->D[*k-1])>=params->min_success_rate) {
+            ps*=success_rate_1(ws->D[--(*k)]);
+        }
+    }
+    else {
+        for (i=0;i<n;i++) ps*=success_rate_1(ws->D[i]);
+        *k=0;
+    }
+    p=n-*k;
+    st->n_fixed=p;
+    st->success_rate=p?ps:0.0;
+
+    /* marginal of z[k..n-1] is given by the trailing blocks of L and D */
+    for (i=0;i<p;i++) for (j=0;j<p;j++) ws->Lp[i+j*p]=ws->L[*k+i+(*k+j)*n];
+    return 0;
+}
+
+/* ratio test statistics of a finished search ---------------------------------*/
+static void search_ratio(const lambda_search_params_t *params, const double *s,
+                         int info, lambda_search_stats_t *st)
+{
+    if (st->n_cands>=2) {
+        st->ratio=s[0]>0.0?s[1]/s[0]:1E99;
+        st->ratio_passed=params->ratio>0.0&&st->ratio>=params->ratio;
+    }
+    else if (st->n_cands==1&&params->ratio>0.0&&!info) {
+        st->ratio=params->ratio;
+        st->ratio_passed=1;
+    }
+}
+
+/* map the fixed subset candidates in ws->E back to the float parameters -----*/
+static void search_finish(lambda_workspace_t *ws, int n, int k, int m,
+                          const double *a, double *F, double *s)
+{
+    int i,j,r,p=n-k;
+    double *Lp=ws->Lp,*y=ws->dist;
+
+    if (p==0) {
+        for (j=0;j<m;j++) {
+            memcpy(F+j*n,a,sizeof(double)*n);
+            s[j]=0.0;
+        }
+        return;
+    }
+    for (j=0;j<m;j++) {
+        double *Ej=ws->E+j*p;
+        /* conditioned z[0..k-1]: z1-L21'*inv(L22')*(z2-z2fix) */
+        for (i=p-1;i>=0;i--) {
+            y[i]=ws->z[k+i]-Ej[i];
+            for (r=i+1;r<p;r++) y[i]-=Lp[r+i*p]*y[r];
+        }
+        for (i=0;i<k;i++) {
+            ws->zc[i]=ws->z[i];
+            for (r=0;r<p;r++) ws->zc[i]-=ws->L[k+r+i*n]*y[r];
+        }
+        for (i=0;i<p;i++) ws->zc[k+i]=Ej[i];
+        /* F=Z'\zc=Zi'*zc */
+        for (i=0;i<n;i++) {
+            double acc=0.0;
+            for (r=0;r<n;r++) acc+=ws->Zi[r+i*n]*ws->zc[r];
+            F[i+j*n]=acc;
+        }
+    }
+}
+
+/* extended lambda/mlambda search ----------------------------------------------
+* integer least-square estimation with partial ambiguity resolution, ratio
+* test driven pruning and a node budget.
+*
+* partial ambiguity resolution: after the reduction the bootstrapped success
+* rate of the last k decorrelated ambiguities is prod(P(D[i])), and these are
+* the best determined ones. the largest trailing subset whose success rate is
+* at least params->min_success_rate is fixed, the remaining float parameters
+* are conditioned on it. with min_success_rate<=0 all n are fixed.
+*
+* ratio pruning: with params->ratio>0 the search radius is kept at
+* ratio*s[0], so only candidates that could make the ratio test fail are ever
+* expanded. if only one candidate survives, the ratio test has passed and
+* stats->ratio reports the threshold as a lower bound.
+*
+* args : lambda_workspace_t *ws I work area
+*        int n I number of float parameters (n<=LAMBDA_MAX_DIM)
+*        double *a I float parameters (n x 1)
+*        double *Q I covariance matrix of float parameters (n x n)
+*        lambda_search_params_t *params I search options
+*        double *F O (partially) fixed solutions (n x params->m)
+*        double *s O sum of squared residuals of fixed subset (1 x params->m)
+*        lambda_search_stats_t *stats O search statistics (may be NULL)
+* return : status (0:ok,-1:bad args or node budget exhausted,other:error)
+* notes : only the first stats->n_cands columns of F and entries of s are
+*         valid. if no subset reaches the success rate, n_fixed=0 and F holds
+*         the float solution.
+*-----------------------------------------------------------------------------*/
+int lambda_search_ws(lambda_workspace_t *ws, int n, const double *a,
+                     const double *Q, const lambda_search_params_t *params,
+                     double *F, double *s, lambda_search_stats_t *stats)
+{
+    int info,k,p,m=params->m;
+    search_ctl_t ctl={1E99,0.0,LOOPMAX,0,0.0,NULL,0,0,0};
+    lambda_search_stats_t st;
+
+    memset(&st, 0, sizeof(st));
+    if (stats) *stats=st;
+    if (n<=0||m<=0||n>LAMBDA_MAX_DIM||m>LAMBDA_MAX_CANDS) return -1;
+
+    if ((info=search_prepare(ws,n,a,Q,params,&k,&st))) return info;
+    p=n-k;
+
+    if (p==0) {
+        search_finish(ws,n,k,m,a,F,s);
+        st.n_cands=m;
+        if (stats) *stats=st;
+        return 0;
+    }
+
+    ctl.ratio=params->ratio;
+    if (params->max_nodes>0) ctl.loopmax=(int)params->max_nodes;
+    info=search_ctl(p,m,ws->Lp,ws->D+k,ws->z+k,ws->E,s,
+                    ws->A,ws->dist,ws->zb,ws->zc,ws->step,&ctl);
+    st.nodes=ctl.nodes;
+    st.leaves=ctl.leaves;
+    st.n_cands=ctl.n_cands;
+    search_ratio(params,s,info,&st);
+    if (stats) *stats=st;
+    if (info) return info;
+
+    search_finish(ws,n,k,ctl.n_cands,a,F,s);
+    return 0;
+}
+
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+
+/* insert candidate z (n x 1, residual d) into the sorted list zn/s of at most
+ * m entries, ignoring duplicates ---------------------------------------------*/
+static void cand_insert(int n, int m, double *zn, double *s, int *nn,
+                        const double *z, double d)
+{
+    int i,j;
+
+    for (i=0;i<*nn;i++) {
+        if (!memcmp(zn+i*n,z,sizeof(double)*n)) return;
+    }
+    for (i=*nn;i>0&&s[i-1]>d;i--) {
+        if (i<m) {
+            s[i]=s[i-1];
+            memcpy(zn+i*n,zn+(i-1)*n,sizeof(double)*n);
+        }
+    }
+    if (i>=m) return;
+    s[i]=d;
+    for (j=0;j<n;j++) zn[j+i*n]=z[j];
+    if (*nn<m) (*nn)++;
+}
+
+/* a subtree with its upper LAMBDA_PAR_SPLIT levels fixed */
+typedef struct {
+    double zs[LAMBDA_MAX_DIM];       /* conditioned centres of free levels */
+    double zfix[LAMBDA_PAR_SPLIT];   /* values of the fixed levels */
+    double offset;                   /* residual of the fixed levels */
+} par_task_t;
+
+typedef struct {
+    int n,m,nf;                      /* dimension, candidates, free levels */
+    const double *D;
+    double Lf[LAMBDA_MAX_DIM*LAMBDA_MAX_DIM]; /* leading nf x nf block of L */
+    double ratio;
+    int loopmax;
+    par_task_t tasks[LAMBDA_PAR_MAX_TASKS];
+    int n_tasks;
+    int next_task;
+    u64 bound;
+} par_job_t;
+
+typedef struct {
+    par_job_t *job;
+    double S[LAMBDA_MAX_DIM*LAMBDA_MAX_DIM];
+    double dist[LAMBDA_MAX_DIM],zb[LAMBDA_MAX_DIM],z[LAMBDA_MAX_DIM];
+    double step[LAMBDA_MAX_DIM];
+    double E[LAMBDA_MAX_DIM*LAMBDA_MAX_CANDS],s[LAMBDA_MAX_CANDS];
+    double zn[LAMBDA_MAX_DIM*LAMBDA_MAX_CANDS],sn[LAMBDA_MAX_CANDS];
+    double zfull[LAMBDA_MAX_DIM];
+    int nn,nodes,leaves,info;
+} par_worker_t;
+
+/* enumerate the subtrees below level k whose residual is within radius ------*/
+static int par_enum(par_job_t *job, const double *L, int k, int depth,
+                    const double *zc, double dist, double radius,
+                    double *zfix)
+{
+    int i,n=job->n;
+    double c=zc[k],v=ROUND(c),y=c-v,step=SGN(y),d,zc1[LAMBDA_MAX_DIM];
+
+    while ((d=dist+y*y/job->D[k])<radius) {
+        for (i=0;i<k;i++) zc1[i]=zc[i]-L[k+i*n]*(c-v);
+        zfix[depth]=v;
+        if (depth+1==LAMBDA_PAR_SPLIT||k==1) {
+            par_task_t *t;
+            if (job->n_tasks>=LAMBDA_PAR_MAX_TASKS) return -1;
+            t=&job->tasks[job->n_tasks++];
+            memcpy(t->zs,zc1,sizeof(double)*k);
+            memset(t->zfix,0,sizeof(t->zfix));
+            memcpy(t->zfix,zfix,sizeof(double)*(depth+1));
+            t->offset=d;
+        }
+        else if (par_enum(job,L,k-1,depth+1,zc1,d,radius,zfix)) return -1;
+        v+=step; y=c-v; step=-step-SGN(step);
+    }
+    return 0;
+}
+
+static void *par_worker(void *arg)
+{
+    par_worker_t *w=(par_worker_t *)arg;
+    par_job_t *job=w->job;
+    int i,j,t,nf=job->nf,nfix=job->n-nf;
+
+    while ((t=__atomic_fetch_add(&job->next_task,1,__ATOMIC_RELAXED))<
+           job->n_tasks) {
+        par_task_t *task=&job->tasks[t];
+        search_ctl_t ctl={1E99,job->ratio,job->loopmax,0,task->offset,
+                          &job->bound,0,0,0};
+        int info;
+
+        /* tasks are sorted by offset, none of the rest can improve on bound */
+        if (task->offset>=bound_load(&job->bound)) break;
+
+        info=search_ctl(nf,job->m,job->Lf,job->D,task->zs,w->E,w->s,
+                        w->S,w->dist,w->zb,w->z,w->step,&ctl);
+        w->nodes+=ctl.nodes;
+        w->leaves+=ctl.leaves;
+        if (info) w->info=info;
+        for (j=0;j<ctl.n_cands;j++) {
+            memcpy(w->zfull,w->E+j*nf,sizeof(double)*nf);
+            for (i=0;i<nfix;i++) w->zfull[job->n-1-i]=task->zfix[i];
+            cand_insert(job->n,job->m,w->zn,w->sn,&w->nn,w->zfull,
+                        w->s[j]+task->offset);
+        }
+    }
+    return NULL;
+}
+
+/* parallel mlambda search of the p x p problem (L,D,zs) ----------------------
+* the first m leaves are found serially to get a finite radius, the subtrees
+* below the upper LAMBDA_PAR_SPLIT levels within that radius become tasks
+* which worker threads take in order of increasing residual, all sharing one
+* atomically lowered radius. returns as search_ctl(), or 1 if the tree could
+* not be split, in which case the caller falls back to the serial search.
+*-----------------------------------------------------------------------------*/
+static int par_search(int p, int m, const double *L, const double *D,
+                      const double *zs, const lambda_search_params_t *params,
+                      u32 n_threads, lambda_workspace_t *ws, double *zn,
+                      double *s, lambda_search_stats_t *st)
+{
+    par_job_t job;
+    par_worker_t workers[LAMBDA_PAR_MAX_THREADS];
+    search_ctl_t ctl={1E99,params->ratio,LOOPMAX,m,0.0,NULL,0,0,0};
+    double zfix[LAMBDA_PAR_SPLIT],radius;
+    int i,j,info,nn;
+
+    if (params->max_nodes>0) ctl.loopmax=(int)params->max_nodes;
+    info=search_ctl(p,m,L,D,zs,zn,s,ws->A,ws->dist,ws->zb,ws->zc,ws->step,
+                    &ctl);
+    st->nodes=ctl.nodes;
+    st->leaves=ctl.leaves;
+    st->n_cands=nn=ctl.n_cands;
+    if (info||ctl.leaves<m) return info; /* failed or exhausted the tree */
+
+    radius=s[nn-1];
+    if (params->ratio>0.0&&params->ratio*s[0]<radius) radius=params->ratio*s[0];
+
+    job.n=p;
+    job.m=m;
+    job.nf=p-LAMBDA_PAR_SPLIT;
+    if (job.nf<1) job.nf=1;
+    job.D=D;
+    for (i=0;i<job.nf;i++) for (j=0;j<job.nf;j++) job.Lf[i+j*job.nf]=L[i+j*p];
+    job.ratio=params->ratio;
+    job.loopmax=ctl.loopmax;
+    job.n_tasks=0;
+    job.next_task=0;
+    {
+        union {u64 u; double d;} b;
+        b.d=radius;
+        job.bound=b.u;
+    }
+    if (par_enum(&job,L,p-1,0,zs,0.0,radius,zfix)) return 1;
+
+    /* insertion sort tasks by offset */
+    for (i=1;i<job.n_tasks;i++) {
+        par_task_t t=job.tasks[i];
+        for (j=i;j>0&&job.tasks[j-1].offset>t.offset;j--) {
+            job.tasks[j]=job.tasks[j-1];
+        }
+        job.tasks[j]=t;
+    }
+
+    if (n_threads>LAMBDA_PAR_MAX_THREADS) n_threads=LAMBDA_PAR_MAX_THREADS;
+    for (i=0;i<(int)n_threads;i++) {
+        workers[i].job=&job;
+        workers[i].nn=workers[i].nodes=workers[i].leaves=workers[i].info=0;
+    }
+    parallel_run(workers,n_threads,sizeof(par_worker_t),par_worker);
+    for (i=0;i<(int)n_threads;i++) {
+        st->nodes+=workers[i].nodes;
+        st->leaves+=workers[i].leaves;
+        if (workers[i].info) info=workers[i].info;
+        for (j=0;j<workers[i].nn;j++) {
+            cand_insert(p,m,zn,s,&nn,workers[i].zn+j*p,workers[i].sn[j]);
+        }
+    }
+    st->n_cands=nn;
+    return info;
+}
+
+#endif /* LIBSWIFTNAV_ENABLE_PTHREADS */
+
+/* parallel extended lambda/mlambda search -------------------------------------
+* same as lambda_search_ws() but the integer search is split into subtrees
+* below the upper LAMBDA_PAR_SPLIT levels of the (fixed subset of the) search
+* tree, which are searched on n_threads worker threads sharing one atomically
+* updated search radius. intended for high dimensional problems, for small
+* ones the thread start-up costs more than the search.
+*
+* the library must be built with LIBSWIFTNAV_ENABLE_PTHREADS, otherwise (and
+* for n_threads<=1 or trees that are too shallow or too wide to split) this
+* is lambda_search_ws(). stats->nodes and stats->leaves sum over all threads.
+* args : as lambda_search_ws()
+*        u32 n_threads I number of worker threads (<=LAMBDA_PAR_MAX_THREADS)
+* return : status (0:ok,-1:bad args or node budget exhausted,other:error)
+*-----------------------------------------------------------------------------*/
+int lambda_search_parallel(lambda_workspace_t *ws, int n, const double *a,
+                           const double *Q,
+                           const lambda_search_params_t *params,
+                           u32 n_threads, double *F, double *s,
+                           lambda_search_stats_t *stats)
+{
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+    int info,k,p,m=params->m;
+    lambda_search_stats_t st;
+
+    if (n_threads<=1||n<=LAMBDA_PAR_SPLIT)
+        return lambda_search_ws(ws,n,a,Q,params,F,s,stats);
+
+    memset(&st, 0, sizeof(st));
+    if (stats) *stats=st;
+    if (n<=0||m<=0||n>LAMBDA_MAX_DIM||m>LAMBDA_MAX_CANDS) return -1;
+
+    if ((info=search_prepare(ws,n,a,Q,params,&k,&st))) return info;
+    p=n-k;
+    if (p<=LAMBDA_PAR_SPLIT)
+        return lambda_search_ws(ws,n,a,Q,params,F,s,stats);
+
+    info=par_search(p,m,ws->Lp,ws->D+k,ws->z+k,params,n_threads,ws,
+                    ws->E,s,&st);
+    if (info==1) return lambda_search_ws(ws,n,a,Q,params,F,s,stats);
+    search_ratio(params,s,info,&st);
+    if (stats) *stats=st;
+    if (info) return info;
+
+    search_finish(ws,n,k,st.n_cands,a,F,s);
+    return 0;
+#else
+    (void)n_threads;
+    return lambda_search_ws(ws,n,a,Q,params,F,s,stats);
+#endif
+}
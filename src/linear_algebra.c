@@ -18,20 +18,76 @@
 
 #include "linear_algebra.h"
 
+/* SIMD vector extensions, selected at compile time from the target flags
+ * (set by OptimizeForArchitecture on host builds). `vd_*' operate on
+ * LINALG_SIMD_WIDTH doubles and `v2d_*' on pairs, used for the 2x2 transpose
+ * blocks. Only AArch64 NEON has double precision lanes. */
+#ifdef LIBSWIFTNAV_ENABLE_SIMD
+#if defined(__AVX__)
+#include <immintrin.h>
+#define LINALG_SIMD "AVX"
+#define LINALG_SIMD_WIDTH 4
+typedef __m256d vd_t;
+#define vd_zero()       _mm256_setzero_pd()
+#define vd_set1(x)      _mm256_set1_pd(x)
+#define vd_load(p)      _mm256_loadu_pd(p)
+#define vd_store(p, v)  _mm256_storeu_pd(p, v)
+#define vd_add(a, b)    _mm256_add_pd(a, b)
+#ifdef __FMA__
+#define vd_madd(a, b, c) _mm256_fmadd_pd(a, b, c)
+#else
+#define vd_madd(a, b, c) _mm256_add_pd(_mm256_mul_pd(a, b), c)
+#endif
+static inline double vd_hsum(vd_t v)
+{
+  __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v),
+                         _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LINALG_SIMD "SSE2"
+#define LINALG_SIMD_WIDTH 2
+typedef __m128d vd_t;
+#define vd_zero()       _mm_setzero_pd()
+#define vd_set1(x)      _mm_set1_pd(x)
+#define vd_load(p)      _mm_loadu_pd(p)
+#define vd_store(p, v)  _mm_storeu_pd(p, v)
+#define vd_add(a, b)    _mm_add_pd(a, b)
+#define vd_madd(a, b, c) _mm_add_pd(_mm_mul_pd(a, b), c)
+static inline double vd_hsum(vd_t v)
+{
+  return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LINALG_SIMD "NEON"
+#define LINALG_SIMD_WIDTH 2
+typedef float64x2_t vd_t;
+#define vd_zero()       vdupq_n_f64(0)
+#define vd_set1(x)      vdupq_n_f64(x)
+#define vd_load(p)      vld1q_f64(p)
+#define vd_store(p, v)  vst1q_f64(p, v)
+#define vd_add(a, b)    vaddq_f64(a, b)
+#define vd_madd(a, b, c) vfmaq_f64(c, a, b)
+#define vd_hsum(v)      vaddvq_f64(v)
+#endif
+#endif /* LIBSWIFTNAV_ENABLE_SIMD */
+
+#if defined(LINALG_SIMD_WIDTH) && defined(__SSE2__)
+typedef __m128d v2d_t;
+#define v2d_load(p)        _mm_loadu_pd(p)
+#define v2d_store(p, v)    _mm_storeu_pd(p, v)
+#define v2d_unpacklo(a, b) _mm_unpacklo_pd(a, b)
+#define v2d_unpackhi(a, b) _mm_unpackhi_pd(a, b)
+#elif defined(LINALG_SIMD_WIDTH)
+typedef float64x2_t v2d_t;
+#define v2d_load(p)        vld1q_f64(p)
+#define v2d_store(p, v)    vst1q_f64(p, v)
+#define v2d_unpacklo(a, b) vzip1q_f64(a, b)
+#define v2d_unpackhi(a, b) vzip2q_f64(a, b)
+#endif
 
-/* Todo(MP) -- Implement fast linear solve (all-in-one) with Cholesky
- * decomposition: we want to solve $A^{T} W A \hat{x} = A^{T} W y
- *
- * This should be implemented below the functions that explicitly
- * calculate the pseudoinverse: we have a function that computes the
- * Cholesky decomposition, a function that performs back-substitution
- * for the linear solve and then a whole slew of interface functions
- * for least-squares and least-norm solves.  Separate functions are
- * required for testing against; a separate "fast" weighted linear
- * least-squares operation should perform all operations in one
- * function (lazily or orderedly accessing elements from A and W to
- * form A W A^T as we go).
- */
 
 /** \defgroup linear_algebra Linear Algebra
  * Basic linear algebra routines.
@@ -51,6 +107,9 @@
  * singular and error out.
  */
 #define MATRIX_EPSILON (1e-60)
+/* Relative pivot size below which a least-squares problem is treated as rank
+ * deficient, i.e. a condition number bound on the factorised matrix. */
+#define MATRIX_RANK_TOL (1e-12)
 
 
 
@@ -526,13 +585,10 @@ static int rref(u32 order, u32 cols, double *m) {
  *  \return     -1 if a is singular; 0 otherwise.
  */
 inline int matrix_inverse(u32 n, const double *const a, double *b){
-  /* This function is currently only used to do a linear least-squares
-   * solve for x, y, z and t in the navigation filter.  Gauss-Jordan
-   * elimination is not the most efficient way to do this.  In the
-   * ideal case, we'd use the Cholesky decomposition to compute the
-   * least-squares fit.  (This may apply also to a least-norm fit if
-   * we have too few satellites.)  The Cholesky decomposition becomes
-   * even more important for unscented filters. */
+  /* Least-squares problems should not come through here: use
+   * solve_normal_equations() or weighted_least_squares(), which never
+   * form an explicit inverse. This remains for general (non-symmetric)
+   * matrices. */
   int res;
   u32 i, j, k, cols = n*2;
   double m[n*cols];
@@ -627,11 +683,15 @@ int matrix_pseudoinverse(u32 n, u32 m, const double *a, double *b) {
  *  Compute \f$ B := (A^{T} W A)^{-1} A^{T} \f$, where \f$ A \f$ is a
  *  matrix on \f$\mathbb{R}^{n \times m}\f$, \f$ W \f$ is a diagonal
  *  weighting matrix on \f$\mathbb{R}^{n \times n}\f$ and \f$B\f$ is
- *  (therefore) a matrix on \f$\mathbb{R}^{m \times m}\f$, for \f$ n >
+ *  (therefore) a matrix on \f$\mathbb{R}^{m \times n}\f$, for \f$ n >
  *  m \f$.
  *
+ *  \f$ A^{T} W A \f$ is factorised with matrix_cholesky() and each
+ *  column of \f$ B \f$ found by substitution, no explicit inverse is
+ *  formed.
+ *
  *  \param n            Number of rows in a
- *  \param m            Number of columns in a and rows and columns in b
+ *  \param m            Number of columns in a and rows in b
  *  \param a            Input matrix
  *  \param w            Diagonal vector of weighting matrix
  *  \param b            Output matrix
@@ -640,35 +700,21 @@ int matrix_pseudoinverse(u32 n, u32 m, const double *a, double *b) {
  */
 inline int matrix_atwaiat(u32 n, u32 m, const double *a,
                           const double *w, double *b) {
-  u32 i, j, k;
-  double c[m*m], inv[m*m];
+  u32 i, j;
+  double c[m*m], l[m*m], at_col[m], b_col[m];
   /* Check to make sure we're doing the right operation */
   if (n <= m) return -1;
 
-  /* The resulting matrix is symmetric, so compute both halves at
-   * once */
-  for (i = 0; i < m; i++)
-    for (j = i; j < m; j++) {
-      c[m*i + j] = 0;
-      if (i == j) {
-        /* If this is a diagonal element, just sum the squares of the
-         * column of A weighted by the weighting vector. */
-        for (k = 0; k < n; k++)
-          c[m*i + j] += w[k]*a[m*k + j]*a[m*k + j];
-      } else {
-        /* Otherwise, assign both off-diagonal elements at once. */
-        for (k = 0; k < n; k++)
-          c[m*i + j] = c[m*j + i] = w[k]*a[m*k + j]*a[m*k + i];
-        c[m*j + i] = c[m*i + j];
-      }
-    }
-  if (matrix_inverse(m, c, inv) < 0) return -1;
-  for (i = 0; i < m; i++)
-    for (j = 0; j < n; j++) {
-      b[n*i + j] = 0;
-      for (k = 0; k < m; k++)
-        b[n*i + j] += inv[n*i+k] * a[m*j + k];
-    }
+  matrix_atwa(n, m, a, w, c);
+  if (matrix_cholesky(m, c, l) < 0) return -1;
+  for (j = 0; j < n; j++) {
+    /* Column j of A^{T} is row j of A. */
+    for (i = 0; i < m; i++)
+      at_col[i] = a[m*j + i];
+    matrix_cholesky_solve(m, l, at_col, b_col);
+    for (i = 0; i < m; i++)
+      b[n*i + j] = b_col[i];
+  }
   return 0;
 }
 
@@ -676,78 +722,67 @@ inline int matrix_atwaiat(u32 n, u32 m, const double *a,
  *  Compute \f$ B := A^T (A W A^{T})^{-1} \f$, where \f$ A \f$ is a
  *  matrix on \f$\mathbb{R}^{n \times m}\f$, \f$ W \f$ is a diagonal
  *  weighting matrix on \f$\mathbb{R}^{m \times m}\f$ and \f$B\f$ is
- *  (therefore) a matrix on \f$\mathbb{R}^{n \times n}\f$, for \f$ n <
+ *  (therefore) a matrix on \f$\mathbb{R}^{m \times n}\f$, for \f$ n <
  *  m \f$.
  *
- *  \param n            Number of rows in a and rows and columns in b
- *  \param m            Number of columns in a
+ *  \param n            Number of rows in a and columns in b
+ *  \param m            Number of columns in a and rows in b
  *  \param a            Input matrix
  *  \param w            Diagonal vector of weighting matrix
  *  \param b            Output matrix
  *
- *  \return     -1 if n <= m or singular; 0 otherwise
+ *  \return     -1 if n >= m or singular; 0 otherwise
  */
 inline int matrix_atawati(u32 n, u32 m, const double *a,
                           const double *w, double *b) {
   u32 i, j, k;
-  double c[m*m], inv[m*m];
+  double c[n*n], l[n*n], e[n], row[n];
   /* Check to make sure we're doing the right operation */
-  if (n <= m) return -1;
+  if (n >= m) return -1;
 
-  /* TODO(MP) -- implement! */
-  /* The resulting matrix is symmetric, so compute both halves at
-   * once */
-  for (i = 0; i < m; i++)
-    for (j = i; j < m; j++) {
-      c[m*i + j] = 0;
-      if (i == j) {
-        /* If this is a diagonal element, just sum the squares of the
-         * column of A weighted by the weighting vector. */
-        for (k = 0; k < n; k++)
-          c[m*i + j] += w[k]*a[m*k + j]*a[m*k + j];
-      } else {
-        /* Otherwise, assign both off-diagonal elements at once. */
-        for (k = 0; k < n; k++)
-          c[m*i + j] = c[m*j + i] = w[k]*a[m*k + j]*a[m*k + i];
-        c[m*j + i] = c[m*i + j];
-      }
-    }
-  if (matrix_inverse(m, c, inv) < 0) return -1;
-  for (i = 0; i < m; i++)
-    for (j = 0; j < n; j++) {
-      b[n*i + j] = 0;
+  /* C := A W A^{T}, symmetric so compute one half and mirror it. */
+  for (i = 0; i < n; i++)
+    for (j = i; j < n; j++) {
+      double sum = 0;
       for (k = 0; k < m; k++)
-        b[n*i + j] += inv[n*i+k] * a[m*j + k];
+        sum += a[m*i + k] * w[k] * a[m*j + k];
+      c[n*i + j] = c[n*j + i] = sum;
     }
+  if (matrix_cholesky(n, c, l) < 0) return -1;
+  /* Row k of B solves C B_k^{T} = A_k where A_k is column k of A (C is
+   * symmetric). */
+  for (k = 0; k < m; k++) {
+    for (i = 0; i < n; i++)
+      e[i] = a[m*i + k];
+    matrix_cholesky_solve(n, l, e, row);
+    memcpy(&b[n*k], row, n * sizeof(double));
+  }
   return 0;
 }
 
 /** Compute \f$ B := (A^{T} A)^{-1} A^{T} \f$.
  *  Compute \f$ B := (A^{T} A)^{-1} A^{T} \f$, where \f$ A \f$ is a
  *  matrix on \f$\mathbb{R}^{n \times m}\f$ and \f$B\f$ is (therefore)
- *  a matrix on \f$\mathbb{R}^{m \times m}\f$, for \f$ n > m \f$.
+ *  a matrix on \f$\mathbb{R}^{m \times n}\f$, for \f$ n > m \f$.
  *
  *  \param n            Number of rows in a
- *  \param m            Number of columns in a and rows and columns in b
+ *  \param m            Number of columns in a and rows in b
  *  \param a            Input matrix
  *  \param b            Output matrix
  *
- *  \return     -1 if n < m; 0 otherwise
+ *  \return     -1 if n <= m or singular; 0 otherwise
  */
 inline int matrix_ataiat(u32 n, u32 m, const double *a, double *b) {
-  u32 i;
-  double w[n];
-  for (i = 0; i < n; i++) w[i] = 1;
-  return matrix_atwaiat(n, m, a, w, b);
+  return matrix_atwaiat(n, m, a, NULL, b);
 }
 
 /** Compute \f$ B := A^{T} (A A^{T})^{-1} \f$.
  *  Compute \f$ B := A^{T} (A A^{T})^{-1} \f$, where \f$ A \f$ is a
  *  matrix on \f$\mathbb{R}^{n \times m}\f$ and \f$B\f$ is (therefore)
- *  a matrix on \f$\mathbb{R}^{n \times n}\f$, for \f$ n < m \f$.
+ *  a matrix on \f$\mathbb{R}^{m \times n}\f$, for \f$ n < m \f$.
  *
- *  \param n            Number of rows in a and rows and columns in b
- *  \param m            Number of columns in a
+ *  \param n            Number of rows in a and columns in b
+ *  \param m            Number of columns in a and rows in b
  *  \param a            Input matrix
  *  \param b            Output matrix
  *
@@ -755,11 +790,247 @@ inline int matrix_ataiat(u32 n, u32 m, const double *a, double *b) {
  */
 inline int matrix_ataati(u32 n, u32 m, const double *a, double *b) {
   u32 i;
-  double w[n];
-  for (i = 0; i < n; i++) w[i] = 1;
+  double w[m];
+  for (i = 0; i < m; i++) w[i] = 1;
   return matrix_atawati(n, m, a, w, b);
 }
 
+/** Compute \f$ C := A^{T} W A \f$.
+ *  Compute the (weighted) normal matrix \f$ C := A^{T} W A \f$, where
+ *  \f$ A \f$ is a matrix on \f$\mathbb{R}^{n \times m}\f$, \f$ W \f$
+ *  is a diagonal weighting matrix on \f$\mathbb{R}^{n \times n}\f$ and
+ *  \f$ C \f$ is (therefore) a symmetric matrix on \f$\mathbb{R}^{m
+ *  \times m}\f$.
+ *
+ *  \param n            Number of rows in a
+ *  \param m            Number of columns in a
+ *  \param a            Input matrix
+ *  \param w            Diagonal vector of weighting matrix, or NULL
+ *                      for \f$ W = I \f$
+ *  \param c            Output matrix
+ */
+void matrix_atwa(u32 n, u32 m, const double *a, const double *w,
+                 double *c) {
+  u32 i, j, k;
+  /* The result is symmetric, so compute one half and mirror it. */
+  for (i = 0; i < m; i++)
+    for (j = i; j < m; j++) {
+      double sum = 0;
+      if (w) {
+        for (k = 0; k < n; k++)
+          sum += w[k] * a[m*k + i] * a[m*k + j];
+      } else {
+        for (k = 0; k < n; k++)
+          sum += a[m*k + i] * a[m*k + j];
+      }
+      c[m*i + j] = c[m*j + i] = sum;
+    }
+}
+
+/** Cholesky decomposition of a symmetric positive definite matrix.
+ *  Compute \f$ A = L L^{T} \f$, where \f$ A \f$ is a symmetric
+ *  positive definite matrix on \f$\mathbb{R}^{n \times n}\f$ and \f$ L
+ *  \f$ is (therefore) a lower-triangular matrix on
+ *  \f$\mathbb{R}^{n \times n}\f$. Only the lower triangle of \f$ A \f$
+ *  is read and the strictly upper triangle of \f$ L \f$ is zeroed.
+ *
+ *  \param n            The size of a and l
+ *  \param a            The matrix to decompose (input)
+ *  \param l            \f$ L \f$ (output), may be the same as a
+ *
+ *  \return     -1 if a is not positive definite; 0 otherwise.
+ */
+s32 matrix_cholesky(u32 n, const double *a, double *l) {
+  u32 i, j, k;
+  for (j = 0; j < n; j++) {
+    double d = a[n*j + j];
+    for (k = 0; k < j; k++)
+      d -= l[n*j + k] * l[n*j + k];
+    if (d <= MATRIX_EPSILON || d <= MATRIX_RANK_TOL * a[n*j + j])
+      return -1;
+    d = sqrt(d);
+    l[n*j + j] = d;
+    for (i = j + 1; i < n; i++) {
+      double sum = a[n*i + j];
+      for (k = 0; k < j; k++)
+        sum -= l[n*i + k] * l[n*j + k];
+      l[n*i + j] = sum / d;
+    }
+    for (i = j + 1; i < n; i++)
+      l[n*j + i] = 0;
+  }
+  return 0;
+}
+
+/** Solve a linear system given its Cholesky decomposition.
+ *  Solve \f$ L L^{T} x = b \f$ for \f$ x \in \mathbb{R}^{n} \f$ by
+ *  forward then backward substitution. It is safe to pass the same
+ *  pointer for \f$ b \f$ and \f$ x \f$.
+ *
+ *  \param n            The size of l
+ *  \param l            Lower-triangular \f$ L \f$ from matrix_cholesky()
+ *  \param b            Vector \f$ b \f$ (input)
+ *  \param x            Solution vector \f$ x \f$ (output)
+ */
+void matrix_cholesky_solve(u32 n, const double *l, const double *b,
+                           double *x) {
+  s32 i, j;
+  double sum;
+  for (i = 0; i < (s32) n; i++) {
+    sum = b[i];
+    for (j = 0; j < i; j++) sum -= l[n*i + j]*x[j];
+    x[i] = sum / l[n*i + i];
+  }
+  for (i = n - 1; i >= 0; i--) {
+    sum = x[i];
+    for (j = i + 1; j < (s32) n; j++) sum -= l[n*j + i]*x[j];
+    x[i] = sum / l[n*i + i];
+  }
+}
+
+/** Invert a matrix given its Cholesky decomposition.
+ *  Compute \f$ B := (L L^{T})^{-1} = L^{-T} L^{-1} \f$, where \f$ L \f$
+ *  is the lower-triangular factor from matrix_cholesky(), for when the
+ *  inverse itself is wanted (e.g. as a covariance matrix). The inverse
+ *  is built in place in b, without any working storage.
+ *
+ *  \param n            The size of l and b
+ *  \param l            Lower-triangular \f$ L \f$ from matrix_cholesky()
+ *  \param b            Where to put the inverse (output), may be the
+ *                      same as l
+ */
+void matrix_cholesky_inverse(u32 n, const double *l, double *b) {
+  u32 i, j, k;
+  /* Lower triangle of b := L^{-1}. Column j only reads columns >= j of
+   * L, so it can overwrite column j of L. */
+  for (j = 0; j < n; j++) {
+    b[n*j + j] = 1.0 / l[n*j + j];
+    for (i = j + 1; i < n; i++) {
+      double sum = 0;
+      for (k = j; k < i; k++)
+        sum += l[n*i + k] * b[n*k + j];
+      b[n*i + j] = -sum / l[n*i + i];
+    }
+  }
+  /* B := L^{-T} L^{-1}, symmetric. Element (i, j) only reads rows >= j
+   * of columns i and j of L^{-1}, none of which are needed again once it
+   * is written. */
+  for (i = 0; i < n; i++)
+    for (j = i; j < n; j++) {
+      double sum = 0;
+      for (k = j; k < n; k++)
+        sum += b[n*k + i] * b[n*k + j];
+      b[n*i + j] = b[n*j + i] = sum;
+    }
+}
+
+/** Solve a (weighted) linear least-squares problem via the normal
+ *  equations.
+ *  Find \f$ \hat{x} = \underset{x}{min} \|W^{1/2} (A x - y)\|_{2} \f$
+ *  by solving \f$ A^{T} W A \hat{x} = A^{T} W y \f$ with the Cholesky
+ *  decomposition, where \f$ A \f$ is a matrix on \f$\mathbb{R}^{n
+ *  \times m}\f$ with \f$ n \ge m \f$ and full column rank, and \f$ W
+ *  \f$ is a diagonal weighting matrix on \f$\mathbb{R}^{n \times
+ *  n}\f$.
+ *
+ *  The Cholesky factor of \f$ A^{T} W A \f$ can optionally be returned
+ *  so the caller can solve further right hand sides with the same
+ *  geometry (matrix_cholesky_solve()) or recover the covariance
+ *  \f$ (A^{T} W A)^{-1} \f$ (matrix_cholesky_inverse()).
+ *
+ *  \param n            Number of rows in a
+ *  \param m            Number of columns in a
+ *  \param a            Matrix \f$ A \f$ (input)
+ *  \param w            Diagonal vector of weighting matrix, or NULL
+ *                      for \f$ W = I \f$
+ *  \param y            Vector \f$ y \f$ (input)
+ *  \param x            Solution vector \f$ \hat{x} \f$ (output)
+ *  \param l            Cholesky factor of \f$ A^{T} W A \f$ (output),
+ *                      may be NULL
+ *
+ *  \return     -1 if n < m or a is rank deficient; 0 otherwise.
+ */
+s32 solve_normal_equations(u32 n, u32 m, const double *a, const double *w,
+                           const double *y, double *x, double *l) {
+  u32 i, k;
+  double c[m*m], l_[m*m], aty[m];
+  if (n < m) return -1;
+  if (!l) l = l_;
+
+  matrix_atwa(n, m, a, w, c);
+  if (matrix_cholesky(m, c, l) < 0) return -1;
+  for (i = 0; i < m; i++) {
+    aty[i] = 0;
+    for (k = 0; k < n; k++)
+      aty[i] += a[m*k + i] * (w ? w[k] * y[k] : y[k]);
+  }
+  matrix_cholesky_solve(m, l, aty, x);
+  return 0;
+}
+
+/** Solve a (weighted) linear least-squares problem via QR.
+ *  Find \f$ \hat{x} = \underset{x}{min} \|W^{1/2} (A x - y)\|_{2} \f$
+ *  with a Householder QR decomposition of \f$ W^{1/2} A \f$. Same
+ *  contract as solve_normal_equations() but without squaring the
+ *  condition number of \f$ A \f$, for poorly conditioned geometries.
+ *
+ *  \param n            Number of rows in a
+ *  \param m            Number of columns in a
+ *  \param a            Matrix \f$ A \f$ (input)
+ *  \param w            Diagonal vector of weighting matrix (all
+ *                      elements positive), or NULL for \f$ W = I \f$
+ *  \param y            Vector \f$ y \f$ (input)
+ *  \param x            Solution vector \f$ \hat{x} \f$ (output)
+ *
+ *  \return     -1 if n < m or a is rank deficient; 0 otherwise.
+ */
+s32 weighted_least_squares(u32 n, u32 m, const double *a, const double *w,
+                           const double *y, double *x) {
+  u32 i, j, k;
+  double r[n*m], z[n], col_norm[m];
+  if (n < m) return -1;
+
+  for (i = 0; i < n; i++) {
+    double sw = w ? sqrt(w[i]) : 1.0;
+    for (j = 0; j < m; j++)
+      r[m*i + j] = sw * a[m*i + j];
+    z[i] = sw * y[i];
+  }
+  for (j = 0; j < m; j++) {
+    col_norm[j] = 0;
+    for (i = 0; i < n; i++) col_norm[j] += r[m*i + j]*r[m*i + j];
+    col_norm[j] = sqrt(col_norm[j]);
+  }
+
+  /* Householder reflections, each applied to R and z as we go. */
+  for (k = 0; k < m; k++) {
+    double norm = 0;
+    for (i = k; i < n; i++) norm += r[m*i + k]*r[m*i + k];
+    norm = sqrt(norm);
+    if (norm <= MATRIX_EPSILON || norm <= MATRIX_RANK_TOL * col_norm[k])
+      return -1;
+    double alpha = -copysign(norm, r[m*k + k]);
+    /* v := column k below the diagonal minus alpha e_k, stored in place */
+    r[m*k + k] -= alpha;
+    double vtv = 0;
+    for (i = k; i < n; i++) vtv += r[m*i + k]*r[m*i + k];
+    for (j = k + 1; j < m; j++) {
+      double s = 0;
+      for (i = k; i < n; i++) s += r[m*i + k]*r[m*i + j];
+      s *= 2 / vtv;
+      for (i = k; i < n; i++) r[m*i + j] -= s*r[m*i + k];
+    }
+    double s = 0;
+    for (i = k; i < n; i++) s += r[m*i + k]*z[i];
+    s *= 2 / vtv;
+    for (i = k; i < n; i++) z[i] -= s*r[m*i + k];
+    r[m*k + k] = alpha;
+  }
+
+  rsolve(r, m, m, z, x);
+  return 0;
+}
+
 /** Multiply two matrices.
  *  Multiply two matrices: \f$ C := AB \f$, where \f$ A \f$ is a
  *  matrix on \f$\mathbb{R}^{n \times m}\f$, \f$B\f$ is a matrix on
@@ -775,6 +1046,31 @@ inline int matrix_ataati(u32 n, u32 m, const double *a, double *b) {
  */
 inline void matrix_multiply(u32 n, u32 m, u32 p, const double *a,
                             const double *b, double *c) {
+#ifdef LINALG_SIMD_WIDTH
+  u32 i, j, k;
+  for (i = 0; i < n; i++) {
+    /* Accumulate LINALG_SIMD_WIDTH elements of row i of C at a time, summing
+     * over k in the same order as the scalar loop. */
+    for (j = 0; j + LINALG_SIMD_WIDTH <= p; j += LINALG_SIMD_WIDTH) {
+      vd_t acc = vd_zero();
+      for (k = 0; k < m; k++)
+        acc = vd_madd(vd_set1(a[m*i + k]), vd_load(&b[p*k + j]), acc);
+      vd_store(&c[p*i + j], acc);
+    }
+    for (; j < p; j++) {
+      c[p*i + j] = 0;
+      for (k = 0; k < m; k++)
+        c[p*i + j] += a[m*i+k] * b[p*k + j];
+    }
+  }
+#else
+  matrix_multiply_scalar(n, m, p, a, b, c);
+#endif
+}
+
+/** Portable reference implementation of matrix_multiply(). */
+void matrix_multiply_scalar(u32 n, u32 m, u32 p, const double *a,
+                            const double *b, double *c) {
   u32 i, j, k;
   for (i = 0; i < n; i++)
     for (j = 0; j < p; j++) {
@@ -919,6 +1215,13 @@ void matrix_reconstruct_udu(u32 n, double *U, double *D, double *M)
  */
 void matrix_add_sc(u32 n, u32 m, const double *a,
                    const double *b, double gamma, double *c) {
+  /* The matrices are dense, so this is an elementwise vector operation. */
+  vector_add_sc(n * m, a, b, gamma, c);
+}
+
+/** Portable reference implementation of matrix_add_sc(). */
+void matrix_add_sc_scalar(u32 n, u32 m, const double *a,
+                          const double *b, double gamma, double *c) {
   u32 i, j;
   for (i = 0; i < n; i++)
     for (j = 0; j < m; j++)
@@ -937,6 +1240,32 @@ void matrix_add_sc(u32 n, u32 m, const double *a,
  */
 void matrix_transpose(u32 n, u32 m,
                       const double *a, double *b) {
+#ifdef LINALG_SIMD_WIDTH
+  u32 i, j;
+  /* Transpose 2x2 blocks in registers, then mop up the odd row / column. */
+  for (i = 0; i + 2 <= n; i += 2) {
+    for (j = 0; j + 2 <= m; j += 2) {
+      v2d_t r0 = v2d_load(&a[m*i + j]);
+      v2d_t r1 = v2d_load(&a[m*(i+1) + j]);
+      v2d_store(&b[n*j + i], v2d_unpacklo(r0, r1));
+      v2d_store(&b[n*(j+1) + i], v2d_unpackhi(r0, r1));
+    }
+    for (; j < m; j++) {
+      b[n*j + i] = a[m*i + j];
+      b[n*j + i+1] = a[m*(i+1) + j];
+    }
+  }
+  for (; i < n; i++)
+    for (j = 0; j < m; j++)
+      b[n*j+i] = a[m*i+j];
+#else
+  matrix_transpose_scalar(n, m, a, b);
+#endif
+}
+
+/** Portable reference implementation of matrix_transpose(). */
+void matrix_transpose_scalar(u32 n, u32 m,
+                             const double *a, double *b) {
   u32 i, j;
   for (i = 0; i < n; i++)
     for (j = 0; j < m; j++)
@@ -979,6 +1308,32 @@ void matrix_copy(u32 n, u32 m, const double *a,
  */
 double vector_dot(u32 n, const double *a,
                   const double *b) {
+#ifdef LINALG_SIMD_WIDTH
+  u32 i = 0;
+  double out;
+  /* Two accumulators to hide the add latency. */
+  vd_t acc0 = vd_zero(), acc1 = vd_zero();
+  for (; i + 2*LINALG_SIMD_WIDTH <= n; i += 2*LINALG_SIMD_WIDTH) {
+    acc0 = vd_madd(vd_load(&a[i]), vd_load(&b[i]), acc0);
+    acc1 = vd_madd(vd_load(&a[i + LINALG_SIMD_WIDTH]),
+                   vd_load(&b[i + LINALG_SIMD_WIDTH]), acc1);
+  }
+  if (i + LINALG_SIMD_WIDTH <= n) {
+    acc0 = vd_madd(vd_load(&a[i]), vd_load(&b[i]), acc0);
+    i += LINALG_SIMD_WIDTH;
+  }
+  out = vd_hsum(vd_add(acc0, acc1));
+  for (; i < n; i++)
+    out += a[i]*b[i];
+  return out;
+#else
+  return vector_dot_scalar(n, a, b);
+#endif
+}
+
+/** Portable reference implementation of vector_dot(). */
+double vector_dot_scalar(u32 n, const double *a,
+                         const double *b) {
   u32 i;
   double out = 0;
   for (i = 0; i < n; i++)
@@ -996,6 +1351,11 @@ double vector_dot(u32 n, const double *a,
  *  \return     The 2-norm of a
  */
 double vector_norm(u32 n, const double *a) {
+  return sqrt(vector_dot(n, a, a));
+}
+
+/** Portable reference implementation of vector_norm(). */
+double vector_norm_scalar(u32 n, const double *a) {
   u32 i;
   double out = 0;
   for (i = 0; i < n; i++)
@@ -1047,6 +1407,22 @@ void vector_normalize(u32 n, double *a) {
 void vector_add_sc(u32 n, const double *a,
                    const double *b, double gamma,
                    double *c) {
+#ifdef LINALG_SIMD_WIDTH
+  u32 i = 0;
+  vd_t g = vd_set1(gamma);
+  for (; i + LINALG_SIMD_WIDTH <= n; i += LINALG_SIMD_WIDTH)
+    vd_store(&c[i], vd_madd(g, vd_load(&b[i]), vd_load(&a[i])));
+  for (; i < n; i++)
+    c[i] = a[i] + gamma * b[i];
+#else
+  vector_add_sc_scalar(n, a, b, gamma, c);
+#endif
+}
+
+/** Portable reference implementation of vector_add_sc(). */
+void vector_add_sc_scalar(u32 n, const double *a,
+                          const double *b, double gamma,
+                          double *c) {
   u32 i;
   for (i = 0; i < n; i++)
     c[i] = a[i] + gamma * b[i];
@@ -1097,5 +1473,75 @@ void vector_cross(const double a[3], const double b[3],
 }
 
 /* \} */
+
+/** \defgroup linalg_backend BLAS/LAPACK Backend
+ * Reporting of the BLAS/LAPACK implementation the library is running on.
+ * The backend is chosen at build time with the LIBSWIFTNAV_BLAS_BACKEND CMake
+ * option. A shared system BLAS/LAPACK can also be swapped at run time (e.g.
+ * via LD_LIBRARY_PATH or the distribution's alternatives system), so the
+ * implementation is detected at run time where possible.
+ * \{ */
+
+#if defined(__GNUC__) && defined(LIBSWIFTNAV_SYSTEM_BLAS)
+/* Version queries of common optimised implementations, resolved only if the
+ * linked BLAS/LAPACK provides them. */
+extern char *openblas_get_config(void) __attribute__((weak));
+extern char *bli_info_get_version_str(void) __attribute__((weak));
+extern void MKL_Get_Version_String(char *buf, int len) __attribute__((weak));
+#endif
+
+/** Describe the BLAS/LAPACK backend in use.
+ *
+ * \return A static, human readable description of the backend.
+ */
+const char *linear_algebra_backend(void)
+{
+#ifdef LIBSWIFTNAV_SYSTEM_BLAS
+#ifdef __GNUC__
+  static char desc[128];
+  if (openblas_get_config) {
+    snprintf(desc, sizeof(desc), "system OpenBLAS (%s)", openblas_get_config());
+    return desc;
+  }
+  if (bli_info_get_version_str) {
+    snprintf(desc, sizeof(desc), "system BLIS %s", bli_info_get_version_str());
+    return desc;
+  }
+  if (MKL_Get_Version_String) {
+    char ver[96];
+    MKL_Get_Version_String(ver, sizeof(ver));
+    snprintf(desc, sizeof(desc), "system MKL (%s)", ver);
+    return desc;
+  }
+#endif
+  return "system BLAS/LAPACK";
+#else
+  return "vendored reference CBLAS/CLAPACK 3.2.1";
+#endif
+}
+
+/** Describe the SIMD extension used by the vector and matrix primitives.
+ *
+ * \return "AVX", "SSE2", "NEON" or "none".
+ */
+const char *linear_algebra_simd(void)
+{
+#ifdef LINALG_SIMD
+  return LINALG_SIMD;
+#else
+  return "none";
+#endif
+}
+
+/** Print the BLAS/LAPACK backend and SIMD extension in use.
+ * Intended to be called once at application startup. */
+void linear_algebra_backend_report(void)
+{
+  printf("libswiftnav: BLAS/LAPACK backend: %s\n", linear_algebra_backend());
+  printf("libswiftnav: linear algebra SIMD: %s\n", linear_algebra_simd());
+}
+
+/* \} */
+
 /* \} */
 
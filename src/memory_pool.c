@@ -14,6 +14,7 @@
 #include <string.h>
 
 #include "memory_pool.h"
+#include "parallel.h"
 
 inline static size_t calc_node_size(size_t element_size)
 {
@@ -25,6 +26,27 @@ inline static node_t *get_node_n(memory_pool_t *pool, node_t *head, u32 n)
   return (node_t *)((u8 *)head + calc_node_size(pool->element_size) * n);
 }
 
+/* Start timing an operation, see memory_pool_set_clock(). */
+inline static u64 op_start(memory_pool_t *pool)
+{
+  return pool->clock ? pool->clock() : 0;
+}
+
+/* Record the duration of an operation in its timing histogram. */
+static void op_end(memory_pool_t *pool, memory_pool_op_t op, u64 t0)
+{
+  if (!pool->clock)
+    return;
+
+  u64 dt = pool->clock() - t0;
+  u32 bin = 0;
+  while (dt && bin < MEMORY_POOL_TIMING_BINS - 1) {
+    dt >>= 1;
+    bin++;
+  }
+  pool->stats.op_time_hist[op][bin]++;
+}
+
 /** \defgroup memory_pool Functional Memory Pool
  * Simple fixed size memory pool collection supporting functional operations.
  *
@@ -38,6 +60,10 @@ inline static node_t *get_node_n(memory_pool_t *pool, node_t *head, u32 n)
  * Allocation and deallocation from the pool are guaranteed constant time and
  * map and fold are O(N).
  *
+ * Each pool keeps usage statistics for sizing it from real workloads, see
+ * memory_pool_get_stats(). Timing of the bulk operations is off unless a
+ * clock is supplied with memory_pool_set_clock().
+ *
  * \{ */
 
 /** Create a new memory pool.
@@ -131,6 +157,10 @@ s8 memory_pool_init(memory_pool_t *new_pool, u32 n_elements,
 
   /* No nodes currently allocated. */
   new_pool->allocated_nodes_head = NULL;
+  new_pool->n_allocated = 0;
+
+  memset(&new_pool->stats, 0, sizeof(new_pool->stats));
+  new_pool->clock = NULL;
 
   return 0;
 }
@@ -147,53 +177,71 @@ void memory_pool_destroy(memory_pool_t *pool)
   free(pool);
 }
 
-/** Calculates the number of free (unallocated) elements remaining in the
- * collection.
- * This operation is O(N) in the number of free elements.
+/** Number of free (unallocated) elements remaining in the pool.
+ * This operation is O(1), use memory_pool_check() to verify the count against
+ * the pool's free list.
  *
  * \param pool Pointer to a memory pool
- * \returns Number of free elements or `< 0` on an error.
+ * \returns Number of free elements
  */
 s32 memory_pool_n_free(memory_pool_t *pool)
 {
-  u32 count = 0;
+  return pool->n_elements - pool->n_allocated;
+}
+
+/** Number of elements allocated in the collection.
+ * This operation is O(1), use memory_pool_check() to verify the count against
+ * the collection.
+ *
+ * \param pool Pointer to a memory pool
+ * \returns Number of allocated elements
+ */
+s32 memory_pool_n_allocated(memory_pool_t *pool)
+{
+  return pool->n_allocated;
+}
 
-  node_t *p = pool->free_nodes_head;
+/* Count the nodes of a list, returning -1 if it is longer than the pool. */
+static s32 list_length(memory_pool_t *pool, node_t *p)
+{
+  u32 count = 0;
   while (p && count <= pool->n_elements) {
     p = p->hdr.next;
     count++;
   }
 
   if (count == pool->n_elements && p)
-    /* The list of free elements is larger than the pool,
-     * something has gone horribly wrong. */
+    /* The list is larger than the pool, something has gone horribly wrong. */
     return -1;
 
   return count;
 }
 
-/** Calculates the number of elements already allocated in the collection.
- * This operation is O(N) in the number of allocated elements.
+/** Check the consistency of a memory pool.
+ * Walks both the collection and the free list, checking that neither is
+ * longer than the pool and that together they account for every element of
+ * the pool and agree with the O(1) element counters.
+ * This operation is O(N) in the size of the pool.
  *
  * \param pool Pointer to a memory pool
- * \returns Number of allocated elements or `< 0` on an error.
+ * \returns Number of allocated elements or `< 0` if the pool is corrupt.
  */
-s32 memory_pool_n_allocated(memory_pool_t *pool)
+s32 memory_pool_check(memory_pool_t *pool)
 {
-  u32 count = 0;
+  s32 n_allocated = list_length(pool, pool->allocated_nodes_head);
+  s32 n_free = list_length(pool, pool->free_nodes_head);
 
-  node_t *p = pool->allocated_nodes_head;
-  while (p && count <= pool->n_elements) {
-    p = p->hdr.next;
-    count++;
-  }
-
-  if (count == pool->n_elements && p)
-    /* The list of free elements is larger than the pool,
-     * something has gone horribly wrong. */
+  if (n_allocated < 0 || n_free < 0)
     return -1;
 
-  return count;
+  if ((u32)(n_allocated + n_free) != pool->n_elements)
+    /* Elements have been lost. */
+    return -2;
+
+  if ((u32)n_allocated != pool->n_allocated)
+    return -3;
+
+  return n_allocated;
 }
 
 /** Check if the memory pool is empty.
@@ -213,6 +261,46 @@ u32 memory_pool_n_elements(memory_pool_t *pool)
 {
   return pool->n_elements;
 }
+
+/** Get the usage statistics of a memory pool.
+ * The statistics are accumulated from when the pool was initialised or last
+ * reset with memory_pool_reset_stats(). Elements added internally by
+ * memory_pool_group_by() and memory_pool_product() are included, so the high
+ * water mark reflects the peak usage during those operations too.
+ *
+ * \param pool Pointer to a memory pool
+ * \param stats Pointer to a ::memory_pool_stats_t to fill in
+ */
+void memory_pool_get_stats(memory_pool_t *pool, memory_pool_stats_t *stats)
+{
+  memcpy(stats, &pool->stats, sizeof(memory_pool_stats_t));
+}
+
+/** Reset the usage statistics of a memory pool.
+ * The high water mark is reset to the current number of allocated elements.
+ *
+ * \param pool Pointer to a memory pool
+ */
+void memory_pool_reset_stats(memory_pool_t *pool)
+{
+  memset(&pool->stats, 0, sizeof(pool->stats));
+  pool->stats.high_water = pool->n_allocated;
+}
+
+/** Set the clock used to time the operations on a memory pool.
+ * When a clock is set, the duration of each map, fold, filter, sort, group by
+ * and product operation is recorded in the ::memory_pool_stats_t timing
+ * histograms. Any monotonic tick counter can be used, e.g. nanoseconds from
+ * `clock_gettime()` or a hardware cycle counter.
+ *
+ * \param pool Pointer to a memory pool
+ * \param clock Function returning the current time in ticks, or NULL to turn
+ *              timing off.
+ */
+void memory_pool_set_clock(memory_pool_t *pool, u64 (*clock)(void))
+{
+  pool->clock = clock;
+}
 /** Write all of the elements of a collection to an array.
  * To determine how much space is needed in the destination array you must call
  * memory_pool_n_allocated(). The required space is:
@@ -258,6 +346,7 @@ element_t *memory_pool_add(memory_pool_t *pool)
 
   if (!pool->free_nodes_head) {
     /* free_nodes_head is NULL, no free nodes available, pool is full. */
+    pool->stats.n_add_failures++;
     return NULL;
   }
 
@@ -267,6 +356,11 @@ element_t *memory_pool_add(memory_pool_t *pool)
   new_node->hdr.next = pool->allocated_nodes_head;
   pool->allocated_nodes_head = new_node;
 
+  pool->n_allocated++;
+  pool->stats.n_adds++;
+  if (pool->n_allocated > pool->stats.high_water)
+    pool->stats.high_water = pool->n_allocated;
+
   return new_node->elem;
 }
 
@@ -278,6 +372,7 @@ element_t *memory_pool_add(memory_pool_t *pool)
  */
 s32 memory_pool_map(memory_pool_t *pool, void *arg, void (*f)(void *arg, element_t *elem))
 {
+  u64 t0 = op_start(pool);
   u32 count = 0;
 
   node_t *p = pool->allocated_nodes_head;
@@ -287,6 +382,8 @@ s32 memory_pool_map(memory_pool_t *pool, void *arg, void (*f)(void *arg, element
     count++;
   }
 
+  op_end(pool, MEMORY_POOL_OP_MAP, t0);
+
   if (count == pool->n_elements && p)
     /* The list of elements is larger than the pool,
      * something has gone horribly wrong. */
@@ -308,6 +405,7 @@ s32 memory_pool_map(memory_pool_t *pool, void *arg, void (*f)(void *arg, element
 s32 memory_pool_fold(memory_pool_t *pool, void *x0,
                      void (*f)(void *x, element_t *elem))
 {
+  u64 t0 = op_start(pool);
   u32 count = 0;
 
   node_t *p = pool->allocated_nodes_head;
@@ -317,6 +415,8 @@ s32 memory_pool_fold(memory_pool_t *pool, void *x0,
     count++;
   }
 
+  op_end(pool, MEMORY_POOL_OP_FOLD, t0);
+
   if (count == pool->n_elements && p)
     /* The list of elements is larger than the pool,
      * something has gone horribly wrong. */
@@ -338,6 +438,7 @@ s32 memory_pool_fold(memory_pool_t *pool, void *x0,
 double memory_pool_dfold(memory_pool_t *pool, double x0,
                          double (*f)(double x, element_t *elem))
 {
+  u64 t0 = op_start(pool);
   u32 count = 0;
   double x = x0;
 
@@ -348,6 +449,7 @@ double memory_pool_dfold(memory_pool_t *pool, double x0,
     count++;
   }
 
+  op_end(pool, MEMORY_POOL_OP_FOLD, t0);
   return x;
 }
 
@@ -364,6 +466,7 @@ double memory_pool_dfold(memory_pool_t *pool, double x0,
 float memory_pool_ffold(memory_pool_t *pool, float x0,
                         float (*f)(float x, element_t *elem))
 {
+  u64 t0 = op_start(pool);
   u32 count = 0;
   float x = x0;
 
@@ -374,6 +477,7 @@ float memory_pool_ffold(memory_pool_t *pool, float x0,
     count++;
   }
 
+  op_end(pool, MEMORY_POOL_OP_FOLD, t0);
   return x;
 }
 
@@ -390,6 +494,7 @@ float memory_pool_ffold(memory_pool_t *pool, float x0,
 s32 memory_pool_ifold(memory_pool_t *pool, s32 x0,
                       s32 (*f)(s32 x, element_t *elem))
 {
+  u64 t0 = op_start(pool);
   u32 count = 0;
   s32 x = x0;
 
@@ -400,6 +505,7 @@ s32 memory_pool_ifold(memory_pool_t *pool, s32 x0,
     count++;
   }
 
+  op_end(pool, MEMORY_POOL_OP_FOLD, t0);
   return x;
 }
 
@@ -413,6 +519,7 @@ s32 memory_pool_ifold(memory_pool_t *pool, s32 x0,
  */
 s32 memory_pool_filter(memory_pool_t *pool, void *arg, s8 (*f)(void *arg, element_t *elem))
 {
+  u64 t0 = op_start(pool);
   u32 count = 0;
 
   /* Construct a fake 'previous' node for the head of the list, this eliminates
@@ -444,6 +551,9 @@ s32 memory_pool_filter(memory_pool_t *pool, void *arg, s8 (*f)(void *arg, elemen
 
   /* Use our fake previous node to update the head pointer. */
   pool->allocated_nodes_head = fake_head_node_prev.hdr.next;
+  pool->n_allocated = count;
+
+  op_end(pool, MEMORY_POOL_OP_FILTER, t0);
 
   if (count == pool->n_elements && p)
     /* The list of elements is larger than the pool,
@@ -483,6 +593,7 @@ s32 memory_pool_clear(memory_pool_t *pool)
   p->hdr.next = pool->free_nodes_head;
   pool->free_nodes_head = pool->allocated_nodes_head;
   pool->allocated_nodes_head = NULL;
+  pool->n_allocated = 0;
 
   return 0;
 }
@@ -539,6 +650,7 @@ void memory_pool_sort(memory_pool_t *pool, void *arg,
   if (!pool->allocated_nodes_head)
     return;
 
+  u64 t0 = op_start(pool);
   u32 insize = 1;
 
   while (1) {
@@ -598,8 +710,10 @@ void memory_pool_sort(memory_pool_t *pool, void *arg,
     tail->hdr.next = NULL;
 
     /* If we have done only one merge, we're finished. */
-    if (nmerges <= 1)   /* allow for nmerges==0, the empty list case */
+    if (nmerges <= 1) {  /* allow for nmerges==0, the empty list case */
+      op_end(pool, MEMORY_POOL_OP_SORT, t0);
       return;
+    }
 
     /* Otherwise repeat, merging lists twice the size */
     insize *= 2;
@@ -650,6 +764,8 @@ void memory_pool_group_by(memory_pool_t *pool, void *arg,
   if (!pool->allocated_nodes_head)
     return;
 
+  u64 t0 = op_start(pool);
+
   /* First sort the existing list using the compare function. */
   memory_pool_sort(pool, arg, cmp);
 
@@ -657,9 +773,13 @@ void memory_pool_group_by(memory_pool_t *pool, void *arg,
    * aggregated data will be added. */
   node_t *old_head = pool->allocated_nodes_head;
   pool->allocated_nodes_head = NULL;
+  pool->n_allocated = 0;
 
-  /* Allocate working area for the fold function. */
+  /* Allocate working areas for the fold function and the aggregate, which is
+   * only added to the collection once its group has been returned to the
+   * pool so a full pool can always be reduced. */
   u8 x_work[x_size];
+  u8 agg_work[pool->element_size];
 
   u32 count = 0;
 
@@ -675,15 +795,12 @@ void memory_pool_group_by(memory_pool_t *pool, void *arg,
     if (x_size)
       memcpy(x_work, x0, x_size);
 
-    /* Create a new element to hold the aggregate of this group. */
-    element_t *new_elem = memory_pool_add(pool);
-
-    /* Initialize the new element to the first element in the group. */
-    memcpy(new_elem, p->elem, pool->element_size);
+    /* Initialize the aggregate to the first element in the group. */
+    memcpy(agg_work, p->elem, pool->element_size);
 
     /* Aggregate this group. */
     do {
-      agg(new_elem, (void *)x_work, group_count, p->elem);
+      agg(agg_work, (void *)x_work, group_count, p->elem);
       group_count++;
 
       /* Store pointer to next node to process. */
@@ -696,8 +813,238 @@ void memory_pool_group_by(memory_pool_t *pool, void *arg,
       p = next_p;
     } while(p && cmp(arg, group_head->elem, p->elem) == 0);
 
+    /* Add the aggregate of this group to the collection. */
+    memcpy(memory_pool_add(pool), agg_work, pool->element_size);
+
     count++;
   }
+
+  op_end(pool, MEMORY_POOL_OP_GROUP_BY, t0);
+}
+
+/* Key and node pair used by memory_pool_sort_key(). */
+typedef struct {
+  u64 key;
+  node_t *node;
+} pool_sort_item_t;
+
+/** Sort the elements in a collection by an integer key.
+ * An alternative to memory_pool_sort() for orderings that can be expressed
+ * as an unsigned integer key, elements with a smaller key are placed first.
+ * The key function is called exactly once per element. The keys are copied
+ * into a contiguous array and sorted there with a stable least significant
+ * digit radix sort. The list is then relinked in a single pass. This is
+ * O(N) in time and avoids both the O(N log N) indirect comparison calls and
+ * the pointer chasing of the linked list merge sort.
+ *
+ * Byte positions that are the same in every key are skipped, so small keys
+ * cost no more than a couple of passes. Signed keys can be used by flipping
+ * their sign bit, e.g. `(u64)(u32)x ^ 0x80000000` for an `s32 x`.
+ *
+ * \param pool Pointer to a memory pool
+ * \param arg Arbitrary argument passed through to the key function
+ * \param key Function returning the sort key of an element
+ * \param buff Working area of at least
+ *             ::MEMORY_POOL_SORT_KEY_BUFF_SIZE(N) bytes, or NULL to malloc()
+ *             one for the duration of the call.
+ * \return Number of elements sorted or `< 0` on an error, in which case the
+ *         collection is unchanged.
+ */
+s32 memory_pool_sort_key(memory_pool_t *pool, void *arg,
+                         u64 (*key)(void *arg, element_t *elem), void *buff)
+{
+  s32 n = memory_pool_n_allocated(pool);
+  if (n <= 1)
+    return n;
+
+  u64 t0 = op_start(pool);
+  pool_sort_item_t *work_area = buff;
+  if (!buff && !(work_area = malloc(2 * n * sizeof(pool_sort_item_t))))
+    return -2;
+  pool_sort_item_t *items = work_area, *work = work_area + n;
+
+  /* Extract the keys, building the histograms of all eight bytes at once. */
+  u32 counts[8][256];
+  memset(counts, 0, sizeof(counts));
+  node_t *p = pool->allocated_nodes_head;
+  for (s32 i = 0; i < n; i++, p = p->hdr.next) {
+    u64 k = key(arg, p->elem);
+    items[i].key = k;
+    items[i].node = p;
+    for (u8 b = 0; b < 8; b++)
+      counts[b][(k >> (8 * b)) & 0xFF]++;
+  }
+
+  for (u8 b = 0; b < 8; b++) {
+    u8 first = items[0].key >> (8 * b);
+    if (counts[b][first] == (u32)n)
+      /* Every key has the same value in this byte. */
+      continue;
+
+    u32 offset = 0;
+    for (u32 j = 0; j < 256; j++) {
+      u32 c = counts[b][j];
+      counts[b][j] = offset;
+      offset += c;
+    }
+    for (s32 i = 0; i < n; i++)
+      work[counts[b][(items[i].key >> (8 * b)) & 0xFF]++] = items[i];
+
+    pool_sort_item_t *tmp = items;
+    items = work;
+    work = tmp;
+  }
+
+  /* Relink the list in sorted order. */
+  pool->allocated_nodes_head = items[0].node;
+  for (s32 i = 0; i < n - 1; i++)
+    items[i].node->hdr.next = items[i + 1].node;
+  items[n - 1].node->hdr.next = NULL;
+
+  if (!buff)
+    free(work_area);
+
+  op_end(pool, MEMORY_POOL_OP_SORT, t0);
+  return n;
+}
+
+/* One group of memory_pool_group_by_hash(), a list of nodes in collection
+ * order. */
+typedef struct {
+  node_t *head;
+  node_t *tail;
+  u32 hash;
+} pool_group_t;
+
+#define GROUP_SLOT_EMPTY 0xFFFFFFFF
+
+/** Perform a groupby type reduction on a collection without sorting it.
+ * The same reduction as memory_pool_group_by() except that the groups are
+ * found with a hash table rather than by sorting the collection, so the cost
+ * is O(N) calls to `hash` and on average one call to `cmp` per element.
+ *
+ * `hash` must return the same value for any two elements that `cmp` puts in
+ * the same group. `cmp` is only used to test for equality and need not define
+ * an ordering. Within each group the elements are passed to `agg` in their
+ * collection order, exactly as memory_pool_group_by() would pass them. The
+ * aggregated elements are not sorted. Like all new elements they are added
+ * at the head of the collection, so they end up in the reverse of the order
+ * in which the first element of each group appeared.
+ *
+ * The aggregate and the `x0` working state are kept on the stack, so the
+ * pool's element size must be at most ::MEMORY_POOL_MAX_ELEMENT_SIZE and
+ * `x_size` at most ::MEMORY_POOL_MAX_X_SIZE.
+ *
+ * \param pool Pointer to a memory pool
+ * \param arg Arbitrary argument passed through to the hash and comparison
+ *            functions
+ * \param hash Hash function of the grouping key of an element
+ * \param cmp Comparison function returning `0` for elements in the same group
+ * \param x0 Arbitrary argument passed to the aggregation function, reset to
+ *           this value on each new group.
+ * \param x_size The size in bytes of the `x0` argument
+ * \param agg The aggregation function
+ * \param buff Working area of at least
+ *             ::MEMORY_POOL_GROUP_BY_HASH_BUFF_SIZE(N) bytes, or NULL to
+ *             malloc() one for the duration of the call.
+ * \return Number of groups, `-2` if the working area could not be allocated
+ *         or `-3` if the element or `x0` is too large. On an error the
+ *         collection is unchanged.
+ */
+s32 memory_pool_group_by_hash(memory_pool_t *pool, void *arg,
+                              u32 (*hash)(void *arg, element_t *elem),
+                              s32 (*cmp)(void *arg, element_t *a, element_t *b),
+                              void *x0, size_t x_size,
+                              void (*agg)(element_t *new, void *x, u32 n, element_t *elem),
+                              void *buff)
+{
+  if (pool->element_size > MEMORY_POOL_MAX_ELEMENT_SIZE ||
+      x_size > MEMORY_POOL_MAX_X_SIZE)
+    return -3;
+
+  s32 n = memory_pool_n_allocated(pool);
+  if (n <= 0)
+    return n;
+
+  u64 t0 = op_start(pool);
+
+  /* Open addressing table at most half full. */
+  u32 n_slots = 1;
+  while (n_slots < 2 * (u32)n)
+    n_slots <<= 1;
+
+  pool_group_t *groups = buff;
+  if (!buff && !(groups = malloc(n * sizeof(pool_group_t) +
+                                 n_slots * sizeof(u32))))
+    return -2;
+  u32 *slots = (u32 *)(groups + n);
+  memset(slots, 0xFF, n_slots * sizeof(u32));
+
+  /* Split the collection into one list per group, in order of each group's
+   * first element. */
+  u32 n_groups = 0;
+  node_t *p = pool->allocated_nodes_head;
+  while (p) {
+    node_t *next = p->hdr.next;
+    p->hdr.next = NULL;
+
+    u32 h = hash(arg, p->elem);
+    u32 s = h & (n_slots - 1);
+    while (slots[s] != GROUP_SLOT_EMPTY) {
+      pool_group_t *g = &groups[slots[s]];
+      if (g->hash == h && cmp(arg, g->head->elem, p->elem) == 0)
+        break;
+      s = (s + 1) & (n_slots - 1);
+    }
+
+    if (slots[s] == GROUP_SLOT_EMPTY) {
+      slots[s] = n_groups;
+      groups[n_groups].head = p;
+      groups[n_groups].tail = p;
+      groups[n_groups].hash = h;
+      n_groups++;
+    } else {
+      pool_group_t *g = &groups[slots[s]];
+      g->tail->hdr.next = p;
+      g->tail = p;
+    }
+    p = next;
+  }
+
+  pool->allocated_nodes_head = NULL;
+  pool->n_allocated = 0;
+
+  /* Working areas for the fold function and the aggregate, which is only
+   * added to the collection once its group has been returned to the pool so
+   * a full pool can always be reduced. */
+  u64 x_work[MEMORY_POOL_MAX_X_SIZE / sizeof(u64)];
+  u64 agg_work[MEMORY_POOL_MAX_ELEMENT_SIZE / sizeof(u64)];
+
+  for (u32 i = 0; i < n_groups; i++) {
+    if (x_size)
+      memcpy(x_work, x0, x_size);
+    memcpy(agg_work, groups[i].head->elem, pool->element_size);
+
+    u32 group_count = 0;
+    p = groups[i].head;
+    while (p) {
+      agg((element_t *)agg_work, (void *)x_work, group_count, p->elem);
+      group_count++;
+      p = p->hdr.next;
+    }
+
+    /* Return the whole group to the pool. */
+    groups[i].tail->hdr.next = pool->free_nodes_head;
+    pool->free_nodes_head = groups[i].head;
+
+    memcpy(memory_pool_add(pool), agg_work, pool->element_size);
+  }
+
+  if (!buff)
+    free(groups);
+
+  op_end(pool, MEMORY_POOL_OP_GROUP_BY, t0);
+  return n_groups;
 }
 
 /** Cartesian product of a memory pool collection with an array.
@@ -726,6 +1073,7 @@ s32 memory_pool_product(memory_pool_t *pool, void *xs, u32 n_xs, size_t x_size,
   node_t *old_head = pool->allocated_nodes_head;
   pool->allocated_nodes_head = NULL;
 
+  u64 t0 = op_start(pool);
   u32 count = 0;
 
   node_t *p = old_head;
@@ -750,10 +1098,13 @@ s32 memory_pool_product(memory_pool_t *pool, void *xs, u32 n_xs, size_t x_size,
     /* Return current node to the pool. */
     p->hdr.next = pool->free_nodes_head;
     pool->free_nodes_head = p;
+    pool->n_allocated--;
 
     p = next_p;
   }
 
+  op_end(pool, MEMORY_POOL_OP_PRODUCT, t0);
+
   if (count == pool->n_elements && p)
     /* The list of elements is larger than the pool,
      * something has gone horribly wrong. */
@@ -771,6 +1122,7 @@ s32 memory_pool_product_generator(memory_pool_t *pool, void *x0, u32 max_xs, siz
   node_t *old_head = pool->allocated_nodes_head;
   pool->allocated_nodes_head = NULL;
 
+  u64 t0 = op_start(pool);
   u32 count = 0;
 
   node_t *p = old_head;
@@ -803,10 +1155,13 @@ s32 memory_pool_product_generator(memory_pool_t *pool, void *x0, u32 max_xs, siz
     /* Return current node to the pool. */
     p->hdr.next = pool->free_nodes_head;
     pool->free_nodes_head = p;
+    pool->n_allocated--;
 
     p = next_p;
   }
 
+  op_end(pool, MEMORY_POOL_OP_PRODUCT, t0);
+
   if (count == pool->n_elements && p)
     /* The list of elements is larger than the pool,
      * something has gone horribly wrong. */
@@ -815,6 +1170,517 @@ s32 memory_pool_product_generator(memory_pool_t *pool, void *x0, u32 max_xs, siz
   return count;
 }
 
+/* Return a detached list of nodes to the pool. */
+static void release_list(memory_pool_t *pool, node_t *p)
+{
+  while (p) {
+    node_t *next_p = p->hdr.next;
+    p->hdr.next = pool->free_nodes_head;
+    pool->free_nodes_head = p;
+    pool->n_allocated--;
+    p = next_p;
+  }
+}
+
+/** Cartesian product of a memory pool collection with an array, keeping only
+ * the elements that pass a filter.
+ * Equivalent to memory_pool_product() followed by memory_pool_filter() with
+ * `keep`, but each candidate element is built in a working area and only
+ * added to the collection if `keep` returns `!=0`. Each original element is
+ * also returned to the pool before its products are made, so at most
+ * `N - 1 + n_kept` elements are ever resident and a product far larger than
+ * the pool can be taken as long as the survivors fit.
+ *
+ * \param pool Pointer to a memory pool
+ * \param xs Array to take the Cartesian product with
+ * \param n_xs Number of items in array `xs`
+ * \param x_size The size in bytes of each item in `xs`
+ * \param prod The product function, as for memory_pool_product()
+ * \param arg Arbitrary argument passed through to `keep`
+ * \param keep Function that takes a candidate element and returns `0` to
+ *             discard it or `!=0` to keep it.
+ * \return Number of elements in the new collection, `-1` if the collection
+ *         was corrupt, `-2` if the kept elements do not fit in the pool or
+ *         `-4` if the pool's element size is larger than
+ *         ::MEMORY_POOL_MAX_ELEMENT_SIZE. On an error other than `-4` the
+ *         collection is emptied.
+ */
+s32 memory_pool_product_filter(memory_pool_t *pool, void *xs, u32 n_xs,
+                               size_t x_size,
+                               void (*prod)(element_t *new, void *x, u32 n_xs, u32 n, element_t *elem),
+                               void *arg, s8 (*keep)(void *arg, element_t *elem))
+{
+  if (pool->element_size > MEMORY_POOL_MAX_ELEMENT_SIZE)
+    return -4;
+
+  u64 t0 = op_start(pool);
+
+  /* Save the head of the original list and reset the pool head where the
+   * new elements will be added. */
+  node_t *p = pool->allocated_nodes_head;
+  pool->allocated_nodes_head = NULL;
+
+  /* Working areas for the original element and the candidate. */
+  u64 elem_work[MEMORY_POOL_MAX_ELEMENT_SIZE / sizeof(u64)];
+  u64 new_work[MEMORY_POOL_MAX_ELEMENT_SIZE / sizeof(u64)];
+
+  u32 count = 0;
+  u32 n_old = 0;
+
+  while (p && n_old < pool->n_elements) {
+    /* Take a copy of the original element and return its node to the pool
+     * so it can be reused for the products. */
+    memcpy(elem_work, p->elem, pool->element_size);
+    node_t *next_p = p->hdr.next;
+    p->hdr.next = NULL;
+    release_list(pool, p);
+    p = next_p;
+    n_old++;
+
+    for (u32 i=0; i<n_xs; i++) {
+      /* Initialize the candidate to the same as the original element. */
+      memcpy(new_work, elem_work, pool->element_size);
+      prod((element_t *)new_work, ((u8 *)xs + i*x_size), n_xs, i,
+           (element_t *)elem_work);
+      if (!keep(arg, (element_t *)new_work))
+        continue;
+
+      element_t *new = memory_pool_add(pool);
+      if (!new) {
+        /* Pool is full. */
+        release_list(pool, p);
+        memory_pool_clear(pool);
+        return -2;
+      }
+      memcpy(new, new_work, pool->element_size);
+      count++;
+    }
+  }
+
+  op_end(pool, MEMORY_POOL_OP_PRODUCT, t0);
+
+  if (p) {
+    /* The list of elements is larger than the pool,
+     * something has gone horribly wrong. */
+    memory_pool_clear(pool);
+    return -1;
+  }
+
+  return count;
+}
+
+/** Cartesian product of a memory pool collection with a generator, keeping
+ * only the elements that pass a filter.
+ * The generator form of memory_pool_product_filter(), equivalent to
+ * memory_pool_product_generator() followed by memory_pool_filter() with
+ * `keep` but only ever holding the surviving elements in the pool.
+ *
+ * \param pool Pointer to a memory pool
+ * \param x0 Initial generator state, copied afresh for each element
+ * \param max_xs Maximum number of items the generator may produce per element
+ * \param x_size The size in bytes of the generator state, at most
+ *               ::MEMORY_POOL_MAX_X_SIZE
+ * \param next Function advancing the generator state, returning `0` when the
+ *             generator is exhausted.
+ * \param prod The product function, as for memory_pool_product_generator()
+ * \param arg Arbitrary argument passed through to `keep`
+ * \param keep Function that takes a candidate element and returns `0` to
+ *             discard it or `!=0` to keep it.
+ * \return Number of elements in the new collection, `-1` if the collection
+ *         was corrupt, `-2` if the kept elements do not fit in the pool,
+ *         `-3` if the generator ran past `max_xs` items or `-4` if `x_size`
+ *         or the pool's element size is larger than
+ *         ::MEMORY_POOL_MAX_ELEMENT_SIZE. On an error other than `-4` the
+ *         collection is emptied.
+ */
+s32 memory_pool_product_generator_filter(memory_pool_t *pool, void *x0,
+                                         u32 max_xs, size_t x_size,
+                                         s8 (*next)(void *x, u32 n),
+                                         void (*prod)(element_t *new, void *x, u32 n, element_t *elem),
+                                         void *arg, s8 (*keep)(void *arg, element_t *elem))
+{
+  if (pool->element_size > MEMORY_POOL_MAX_ELEMENT_SIZE ||
+      x_size > MEMORY_POOL_MAX_X_SIZE)
+    return -4;
+
+  u64 t0 = op_start(pool);
+
+  node_t *p = pool->allocated_nodes_head;
+  pool->allocated_nodes_head = NULL;
+
+  u64 elem_work[MEMORY_POOL_MAX_ELEMENT_SIZE / sizeof(u64)];
+  u64 new_work[MEMORY_POOL_MAX_ELEMENT_SIZE / sizeof(u64)];
+  u64 x_work[MEMORY_POOL_MAX_X_SIZE / sizeof(u64)];
+
+  u32 count = 0;
+  u32 n_old = 0;
+  s32 ret = 0;
+
+  while (p && n_old < pool->n_elements) {
+    memcpy(elem_work, p->elem, pool->element_size);
+    node_t *next_p = p->hdr.next;
+    p->hdr.next = NULL;
+    release_list(pool, p);
+    p = next_p;
+    n_old++;
+
+    /* Iterate through our generator building a candidate for each pair
+     * (elem, x). */
+    memcpy(x_work, x0, x_size);
+    u32 x_count = 0;
+    do {
+      if (x_count > max_xs) {
+        /* Exceded maximum number of generator iterations. */
+        ret = -3;
+        break;
+      }
+      memcpy(new_work, elem_work, pool->element_size);
+      prod((element_t *)new_work, x_work, x_count, (element_t *)elem_work);
+      x_count++;
+      if (!keep(arg, (element_t *)new_work))
+        continue;
+
+      element_t *new = memory_pool_add(pool);
+      if (!new) {
+        /* Pool is full. */
+        ret = -2;
+        break;
+      }
+      memcpy(new, new_work, pool->element_size);
+      count++;
+    } while (next(x_work, x_count));
+
+    if (ret < 0) {
+      release_list(pool, p);
+      memory_pool_clear(pool);
+      return ret;
+    }
+  }
+
+  op_end(pool, MEMORY_POOL_OP_PRODUCT, t0);
+
+  if (p) {
+    /* The list of elements is larger than the pool,
+     * something has gone horribly wrong. */
+    memory_pool_clear(pool);
+    return -1;
+  }
+
+  return count;
+}
+
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+
+/* One chunk of a parallel operation, a run of `count` consecutive nodes of
+ * the allocated list starting at `head`. */
+typedef struct {
+  node_t *head;
+  u32 count;
+  void *arg;
+  union {
+    void (*map)(void *arg, element_t *elem);
+    void (*fold)(void *x, element_t *elem);
+    double (*dfold)(double x, element_t *elem);
+    s8 (*filter)(void *arg, element_t *elem);
+  } f;
+  double dx;
+  /* Filter results, the kept and dropped nodes relinked into two lists. */
+  node_t *kept_head, *kept_tail, *drop_head, *drop_tail;
+  u32 n_kept;
+} pool_chunk_t;
+
+static void *chunk_map(void *arg)
+{
+  pool_chunk_t *c = (pool_chunk_t *)arg;
+  node_t *p = c->head;
+  for (u32 i = 0; i < c->count; i++, p = p->hdr.next)
+    c->f.map(c->arg, p->elem);
+  return NULL;
+}
+
+static void *chunk_fold(void *arg)
+{
+  pool_chunk_t *c = (pool_chunk_t *)arg;
+  node_t *p = c->head;
+  for (u32 i = 0; i < c->count; i++, p = p->hdr.next)
+    c->f.fold(c->arg, p->elem);
+  return NULL;
+}
+
+static void *chunk_dfold(void *arg)
+{
+  pool_chunk_t *c = (pool_chunk_t *)arg;
+  node_t *p = c->head;
+  for (u32 i = 0; i < c->count; i++, p = p->hdr.next)
+    c->dx = c->f.dfold(c->dx, p->elem);
+  return NULL;
+}
+
+static void *chunk_filter(void *arg)
+{
+  pool_chunk_t *c = (pool_chunk_t *)arg;
+  node_t fake_kept = {.hdr = {.next = NULL}}, fake_drop = {.hdr = {.next = NULL}};
+  node_t *kept_tail = &fake_kept, *drop_tail = &fake_drop;
+  node_t *p = c->head;
+  c->n_kept = 0;
+  for (u32 i = 0; i < c->count; i++) {
+    /* Read the link before it is overwritten below. */
+    node_t *next = p->hdr.next;
+    if (c->f.filter(c->arg, p->elem)) {
+      kept_tail->hdr.next = p;
+      kept_tail = p;
+      c->n_kept++;
+    } else {
+      drop_tail->hdr.next = p;
+      drop_tail = p;
+    }
+    p = next;
+  }
+  c->kept_head = fake_kept.hdr.next;
+  c->kept_tail = (kept_tail == &fake_kept) ? NULL : kept_tail;
+  c->drop_head = fake_drop.hdr.next;
+  c->drop_tail = (drop_tail == &fake_drop) ? NULL : drop_tail;
+  return NULL;
+}
+
+/* Split the allocated list into at most `n_threads` chunks of at least
+ * MEMORY_POOL_PAR_MIN_CHUNK nodes, or a single chunk if the list is shorter.
+ * Returns the number of chunks, or -1 if the list is corrupt. */
+static s32 split_chunks(memory_pool_t *pool, u32 n_threads,
+                        pool_chunk_t chunks[MEMORY_POOL_PAR_MAX_THREADS])
+{
+  s32 n_allocated = memory_pool_n_allocated(pool);
+  if (n_allocated <= 0)
+    return n_allocated;
+  u32 n = n_allocated;
+
+  u32 n_chunks = MIN(n_threads, MEMORY_POOL_PAR_MAX_THREADS);
+  n_chunks = MIN(n_chunks, n / MEMORY_POOL_PAR_MIN_CHUNK);
+  n_chunks = MAX(n_chunks, 1);
+
+  node_t *p = pool->allocated_nodes_head;
+  for (u32 i = 0; i < n_chunks; i++) {
+    chunks[i].head = p;
+    chunks[i].count = n / n_chunks + (i < n % n_chunks);
+    for (u32 j = 0; j < chunks[i].count; j++)
+      p = p->hdr.next;
+  }
+  return n_chunks;
+}
+
+#endif /* LIBSWIFTNAV_ENABLE_PTHREADS */
+
+/** Map a function across all elements of the collection in parallel.
+ * As memory_pool_map(), but the collection is split into up to `n_threads`
+ * contiguous chunks which are mapped over concurrently. `f` must therefore be
+ * safe to call concurrently on different elements with the same `arg`.
+ *
+ * Each chunk is at least ::MEMORY_POOL_PAR_MIN_CHUNK elements, smaller
+ * collections use fewer threads. If the library is built without
+ * LIBSWIFTNAV_ENABLE_PTHREADS this is memory_pool_map().
+ *
+ * \param pool Pointer to a memory pool
+ * \param n_threads Maximum number of threads, including the calling thread
+ * \param arg Arbitrary argument passed through to `f`
+ * \param f Pointer to a function that does an in-place update of an element.
+ * \return Number of elements mapped across or `< 0` on an error.
+ */
+s32 memory_pool_parallel_map(memory_pool_t *pool, u32 n_threads, void *arg,
+                             void (*f)(void *arg, element_t *elem))
+{
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+  pool_chunk_t chunks[MEMORY_POOL_PAR_MAX_THREADS];
+  s32 n_chunks = split_chunks(pool, n_threads, chunks);
+  if (n_chunks <= 1)
+    return memory_pool_map(pool, arg, f);
+
+  u64 t0 = op_start(pool);
+  s32 count = 0;
+  for (s32 i = 0; i < n_chunks; i++) {
+    chunks[i].arg = arg;
+    chunks[i].f.map = f;
+    count += chunks[i].count;
+  }
+  parallel_run(chunks, n_chunks, sizeof(pool_chunk_t), chunk_map);
+
+  op_end(pool, MEMORY_POOL_OP_MAP, t0);
+  return count;
+#else
+  (void)n_threads;
+  return memory_pool_map(pool, arg, f);
+#endif
+}
+
+/** Calculate a fold reduction on the collection in parallel.
+ * The collection is split into up to `n_threads` contiguous chunks, as for
+ * memory_pool_parallel_map(). Each chunk is folded with `f` into its own copy
+ * of `x0` and the per-chunk states are then merged, in collection order, with
+ * `combine` into `x0`.
+ *
+ * `combine` must be associative and `x0` must be its identity (e.g. zero for
+ * a sum) for the result to match memory_pool_fold(). `f` may update its
+ * element in-place but must otherwise only touch its accumulator.
+ *
+ * The per-chunk accumulators are kept on the stack, accumulators larger than
+ * ::MEMORY_POOL_PAR_MAX_FOLD_SIZE bytes are folded serially with
+ * memory_pool_fold().
+ *
+ * \param pool Pointer to a memory pool
+ * \param n_threads Maximum number of threads, including the calling thread
+ * \param x0 Pointer to the initial (identity) accumulator state, updated with
+ *           the result.
+ * \param x_size The size in bytes of the accumulator state
+ * \param f Pointer to a function that does an in-place update of an
+ *          accumulator state given an element.
+ * \param combine Pointer to a function that merges accumulator state `y` into
+ *                `x` in-place.
+ * \return Number of elements folded or `< 0` on an error.
+ */
+s32 memory_pool_parallel_fold(memory_pool_t *pool, u32 n_threads,
+                              void *x0, size_t x_size,
+                              void (*f)(void *x, element_t *elem),
+                              void (*combine)(void *x, const void *y))
+{
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+  pool_chunk_t chunks[MEMORY_POOL_PAR_MAX_THREADS];
+  s32 n_chunks = split_chunks(pool, n_threads, chunks);
+  if (n_chunks <= 1 || x_size > MEMORY_POOL_PAR_MAX_FOLD_SIZE)
+    return memory_pool_fold(pool, x0, f);
+
+  u64 t0 = op_start(pool);
+
+  /* Working areas for the chunk accumulators. */
+  u64 x_work[MEMORY_POOL_PAR_MAX_THREADS]
+            [MEMORY_POOL_PAR_MAX_FOLD_SIZE / sizeof(u64)];
+  s32 count = 0;
+  for (s32 i = 0; i < n_chunks; i++) {
+    chunks[i].arg = x_work[i];
+    memcpy(chunks[i].arg, x0, x_size);
+    chunks[i].f.fold = f;
+    count += chunks[i].count;
+  }
+  parallel_run(chunks, n_chunks, sizeof(pool_chunk_t), chunk_fold);
+
+  memcpy(x0, x_work[0], x_size);
+  for (s32 i = 1; i < n_chunks; i++)
+    combine(x0, chunks[i].arg);
+
+  op_end(pool, MEMORY_POOL_OP_FOLD, t0);
+  return count;
+#else
+  (void)n_threads;
+  (void)x_size;
+  (void)combine;
+  return memory_pool_fold(pool, x0, f);
+#endif
+}
+
+/** Calculate a double valued fold reduction on the collection in parallel.
+ * As memory_pool_parallel_fold() for a double valued accumulator, each chunk
+ * is folded from `x0` and the chunk results merged in collection order with
+ * `combine`, which must be associative with identity `x0`. As floating point
+ * addition is not associative the result of e.g. a sum may differ from
+ * memory_pool_dfold() in the last few bits.
+ *
+ * \param pool Pointer to a memory pool
+ * \param n_threads Maximum number of threads, including the calling thread
+ * \param x0 Initial (identity) accumulator state.
+ * \param f Pointer to a function that returns a new accumulator value given a
+ *          current accumulator value and an element.
+ * \param combine Pointer to a function that merges two accumulator values.
+ * \return Result of the fold operation, i.e. final accumulator value.
+ */
+double memory_pool_parallel_dfold(memory_pool_t *pool, u32 n_threads,
+                                  double x0,
+                                  double (*f)(double x, element_t *elem),
+                                  double (*combine)(double x, double y))
+{
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+  pool_chunk_t chunks[MEMORY_POOL_PAR_MAX_THREADS];
+  s32 n_chunks = split_chunks(pool, n_threads, chunks);
+  if (n_chunks <= 1)
+    return memory_pool_dfold(pool, x0, f);
+
+  u64 t0 = op_start(pool);
+  for (s32 i = 0; i < n_chunks; i++) {
+    chunks[i].dx = x0;
+    chunks[i].f.dfold = f;
+  }
+  parallel_run(chunks, n_chunks, sizeof(pool_chunk_t), chunk_dfold);
+
+  double x = chunks[0].dx;
+  for (s32 i = 1; i < n_chunks; i++)
+    x = combine(x, chunks[i].dx);
+
+  op_end(pool, MEMORY_POOL_OP_FOLD, t0);
+  return x;
+#else
+  (void)n_threads;
+  (void)combine;
+  return memory_pool_dfold(pool, x0, f);
+#endif
+}
+
+/** Filter elements in the collection in parallel, returning filtered out
+ * elements back to the pool.
+ * As memory_pool_filter(), but the collection is split into up to
+ * `n_threads` contiguous chunks, as for memory_pool_parallel_map(). Each
+ * chunk is filtered and relinked independently and the kept chunks are then
+ * joined back together, so the order of the kept elements is preserved.
+ * `f` must be safe to call concurrently on different elements with the same
+ * `arg`.
+ *
+ * \param pool Pointer to a memory pool
+ * \param n_threads Maximum number of threads, including the calling thread
+ * \param arg Arbitrary argument passed through to `f`
+ * \param f Pointer to a function that takes an element and returns `0` to
+ *          discard that element or `!=0` to keep that element.
+ * \return Number of elements in the filtered collection or `< 0` on an error.
+ */
+s32 memory_pool_parallel_filter(memory_pool_t *pool, u32 n_threads, void *arg,
+                                s8 (*f)(void *arg, element_t *elem))
+{
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+  pool_chunk_t chunks[MEMORY_POOL_PAR_MAX_THREADS];
+  s32 n_chunks = split_chunks(pool, n_threads, chunks);
+  if (n_chunks <= 1)
+    return memory_pool_filter(pool, arg, f);
+
+  u64 t0 = op_start(pool);
+  for (s32 i = 0; i < n_chunks; i++) {
+    chunks[i].arg = arg;
+    chunks[i].f.filter = f;
+  }
+  parallel_run(chunks, n_chunks, sizeof(pool_chunk_t), chunk_filter);
+
+  /* Join the kept lists, in order, and push the dropped lists onto the free
+   * list. */
+  node_t fake_head_node_prev = {.hdr = {.next = NULL}};
+  node_t *tail = &fake_head_node_prev;
+  s32 count = 0;
+  for (s32 i = 0; i < n_chunks; i++) {
+    if (chunks[i].kept_head) {
+      tail->hdr.next = chunks[i].kept_head;
+      tail = chunks[i].kept_tail;
+      count += chunks[i].n_kept;
+    }
+    if (chunks[i].drop_head) {
+      chunks[i].drop_tail->hdr.next = pool->free_nodes_head;
+      pool->free_nodes_head = chunks[i].drop_head;
+    }
+  }
+  tail->hdr.next = NULL;
+  pool->allocated_nodes_head = fake_head_node_prev.hdr.next;
+  pool->n_allocated = count;
+
+  op_end(pool, MEMORY_POOL_OP_FILTER, t0);
+  return count;
+#else
+  (void)n_threads;
+  return memory_pool_filter(pool, arg, f);
+#endif
+}
+
 /** \} */
 
 
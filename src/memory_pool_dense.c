@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2014 Swift Navigation Inc.
+ * Contact: Fergus Noble <fergus@swift-nav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_pool_dense.h"
+
+inline static element_t *get_elem_n(memory_pool_dense_t *pool, u32 n)
+{
+  return pool->elems + pool->element_size * n;
+}
+
+/** Move the element at dense index `from` to `to`, updating its handle. */
+inline static void move_elem(memory_pool_dense_t *pool, u32 from, u32 to)
+{
+  u32 h = pool->handles[from];
+  memcpy(get_elem_n(pool, to), get_elem_n(pool, from), pool->element_size);
+  pool->handles[from] = pool->handles[to];
+  pool->handles[to] = h;
+  pool->indices[h] = to;
+}
+
+/** \defgroup memory_pool_dense Dense Memory Pool
+ * Fixed size memory pool keeping its elements packed in one array.
+ *
+ * An alternative layout to the linked list ::memory_pool_t for collections
+ * that want random access or to be handed to vectorised or parallel code as
+ * a plain array: the allocated elements are always the first
+ * memory_pool_dense_n_allocated() entries of the array returned by
+ * memory_pool_dense_array(), so no copy is needed.
+ *
+ * Removing an element moves the last element into its place, so pointers and
+ * indices to elements are only valid until the next remove or filter.
+ * Elements that need to be referred to across those operations should be
+ * referred to by the handle returned from memory_pool_dense_add(), which is
+ * resolved in O(1) by memory_pool_dense_get().
+ *
+ * Add, remove and lookup by index or handle are constant time, map, fold and
+ * filter are O(N) over contiguous memory.
+ *
+ * \{ */
+
+/** Create a new dense memory pool.
+ * Creates a new memory pool containing a maximum of `n_elements` elements of
+ * size `element_size`. This function calls malloc(), remember to free the
+ * pool with memory_pool_dense_destroy().
+ *
+ * \param n_elements Number of elements that the pool can hold
+ * \param element_size Size in bytes of the user payload elements
+ * \returns Pointer to a new ::memory_pool_dense_t or NULL upon a malloc()
+ *          failure
+ */
+memory_pool_dense_t *memory_pool_dense_new(u32 n_elements, size_t element_size)
+{
+  memory_pool_dense_t *new_pool = malloc(sizeof(memory_pool_dense_t));
+  if (!new_pool) {
+    return NULL;
+  }
+
+  void *buff = malloc(MEMORY_POOL_DENSE_BUFF_SIZE(n_elements, element_size));
+  if (!buff) {
+    free(new_pool);
+    return NULL;
+  }
+
+  if (memory_pool_dense_init(new_pool, n_elements, element_size, buff) < 0) {
+    free(buff);
+    free(new_pool);
+    return NULL;
+  }
+
+  return new_pool;
+}
+
+/** Initialise a new dense memory pool.
+ * Initialises a new memory pool containing a maximum of `n_elements` elements
+ * of size `element_size`. This function does not allocate memory and must be
+ * passed a buffer of MEMORY_POOL_DENSE_BUFF_SIZE() bytes, i.e. each element
+ * has an overhead of two `u32` indices:
+ *
+ * ~~~
+ * n_elements * (element_size + 2 * sizeof(u32)) (+ up to 3 bytes padding)
+ * ~~~
+ *
+ * The elements are stored at the start of the buffer so they keep its
+ * alignment.
+ *
+ * \param new_pool Pointer to a memory pool to initialise
+ * \param n_elements Number of elements that the pool can hold, less than
+ *                   ::MEMORY_POOL_DENSE_INVALID
+ * \param element_size Size in bytes of the user payload elements
+ * \param buff Pointer to a buffer to use as the memory pool working area
+ * \returns `0` on success, `<0` on failure.
+ */
+s8 memory_pool_dense_init(memory_pool_dense_t *new_pool, u32 n_elements,
+                          size_t element_size, void *buff)
+{
+  if (!new_pool || n_elements >= MEMORY_POOL_DENSE_INVALID) {
+    return -1;
+  }
+
+  if (!buff) {
+    return -2;
+  }
+
+  new_pool->n_elements = n_elements;
+  new_pool->element_size = element_size;
+  new_pool->n_allocated = 0;
+  new_pool->elems = (element_t *)buff;
+  new_pool->handles = (u32 *)(new_pool->elems +
+             MEMORY_POOL_DENSE_ELEMS_SIZE(n_elements, element_size));
+  new_pool->indices = new_pool->handles + n_elements;
+
+  for (u32 i = 0; i < n_elements; i++) {
+    new_pool->handles[i] = i;
+    new_pool->indices[i] = i;
+  }
+
+  return 0;
+}
+
+/** Destroy a dense memory pool.
+ * Cleans up and frees the memory associated with the pool. This must only be
+ * called on memory pools allocated with memory_pool_dense_new().
+ *
+ * \param pool Pointer to the memory pool to destroy.
+ */
+void memory_pool_dense_destroy(memory_pool_dense_t *pool)
+{
+  free(pool->elems);
+  free(pool);
+}
+
+/** Number of free (unallocated) elements remaining in the pool.
+ * This operation is O(1).
+ *
+ * \param pool Pointer to a memory pool
+ * \returns Number of free elements
+ */
+u32 memory_pool_dense_n_free(memory_pool_dense_t *pool)
+{
+  return pool->n_elements - pool->n_allocated;
+}
+
+/** Number of elements allocated in the collection.
+ * This operation is O(1).
+ *
+ * \param pool Pointer to a memory pool
+ * \returns Number of allocated elements
+ */
+u32 memory_pool_dense_n_allocated(memory_pool_dense_t *pool)
+{
+  return pool->n_allocated;
+}
+
+/** Check if the memory pool is empty.
+ *
+ * \param pool Pointer to a memory pool
+ * \returns True if the memory pool is empty, otherwise false.
+ */
+u8 memory_pool_dense_empty(memory_pool_dense_t *pool)
+{
+  return pool->n_allocated == 0;
+}
+
+/** Adds an element to a collection.
+ * The new element is placed at the end of the dense array.
+ *
+ * \param pool Pointer to a memory pool
+ * \param handle If not NULL, set to the handle of the new element
+ * \return A pointer to the new element or NULL if the pool is full.
+ */
+element_t *memory_pool_dense_add(memory_pool_dense_t *pool, u32 *handle)
+{
+  if (pool->n_allocated == pool->n_elements) {
+    return NULL;
+  }
+
+  u32 index = pool->n_allocated++;
+  /* The next unused handle is already stacked at this index. */
+  u32 h = pool->handles[index];
+  pool->indices[h] = index;
+  if (handle)
+    *handle = h;
+
+  return get_elem_n(pool, index);
+}
+
+/** Look up an element by handle.
+ *
+ * \param pool Pointer to a memory pool
+ * \param handle Handle returned by memory_pool_dense_add()
+ * \return A pointer to the element or NULL if the handle is not valid, i.e.
+ *         the element has been removed and the handle not yet reused by a
+ *         later memory_pool_dense_add().
+ */
+element_t *memory_pool_dense_get(memory_pool_dense_t *pool, u32 handle)
+{
+  if (handle >= pool->n_elements)
+    return NULL;
+  u32 index = pool->indices[handle];
+  if (index >= pool->n_allocated || pool->handles[index] != handle)
+    return NULL;
+  return get_elem_n(pool, index);
+}
+
+/** Look up an element by its current index in the dense array.
+ *
+ * \param pool Pointer to a memory pool
+ * \param index Index, less than memory_pool_dense_n_allocated()
+ * \return A pointer to the element or NULL if the index is out of range.
+ */
+element_t *memory_pool_dense_at(memory_pool_dense_t *pool, u32 index)
+{
+  if (index >= pool->n_allocated)
+    return NULL;
+  return get_elem_n(pool, index);
+}
+
+/** Get the handle of the element at an index of the dense array.
+ *
+ * \param pool Pointer to a memory pool
+ * \param index Index, less than memory_pool_dense_n_allocated()
+ * \return The element's handle or ::MEMORY_POOL_DENSE_INVALID if the index is
+ *         out of range.
+ */
+u32 memory_pool_dense_handle(memory_pool_dense_t *pool, u32 index)
+{
+  if (index >= pool->n_allocated)
+    return MEMORY_POOL_DENSE_INVALID;
+  return pool->handles[index];
+}
+
+/** Remove an element from the collection, returning it to the pool.
+ * The last element of the dense array is moved into the hole, so this is
+ * O(1) but does not preserve ordering.
+ *
+ * \param pool Pointer to a memory pool
+ * \param handle Handle of the element to remove
+ * \return `0` on success, `-1` if the handle is not valid.
+ */
+s8 memory_pool_dense_remove(memory_pool_dense_t *pool, u32 handle)
+{
+  if (!memory_pool_dense_get(pool, handle))
+    return -1;
+
+  u32 last = --pool->n_allocated;
+  u32 index = pool->indices[handle];
+  if (index != last) {
+    /* Swap the handles too, which leaves the freed handle stacked at the top
+     * ready for reuse. */
+    move_elem(pool, last, index);
+  }
+
+  return 0;
+}
+
+/** Get a direct view of the collection as an array.
+ * The allocated elements are contiguous, element `i` being at byte offset
+ * `i * element_size`. The view is valid until the next add, remove, filter or
+ * clear.
+ *
+ * \param pool Pointer to a memory pool
+ * \param n If not NULL, set to the number of elements in the array
+ * \return Pointer to the first element.
+ */
+element_t *memory_pool_dense_array(memory_pool_dense_t *pool, u32 *n)
+{
+  if (n)
+    *n = pool->n_allocated;
+  return pool->elems;
+}
+
+/** Map a function across all elements allocated in the collection.
+ *
+ * \param pool Pointer to a memory pool
+ * \param arg Arbitrary argument passed through to `f`
+ * \param f Pointer to a function that does an in-place update of an element.
+ * \return Number of elements mapped across.
+ */
+s32 memory_pool_dense_map(memory_pool_dense_t *pool, void *arg,
+                          void (*f)(void *arg, element_t *elem))
+{
+  for (u32 i = 0; i < pool->n_allocated; i++)
+    f(arg, get_elem_n(pool, i));
+  return pool->n_allocated;
+}
+
+/** Calculate a fold reduction on the collection, optionally applying a map at
+ * the same time.
+ *
+ * \param pool Pointer to a memory pool
+ * \param x0 Pointer to an initial accumulator state.
+ * \param f Pointer to a function that does an in-place update of an
+ *          accumulator state given an element and optionally updates that
+ *          element in-place.
+ * \return Number of elements folded.
+ */
+s32 memory_pool_dense_fold(memory_pool_dense_t *pool, void *x0,
+                           void (*f)(void *x, element_t *elem))
+{
+  for (u32 i = 0; i < pool->n_allocated; i++)
+    f(x0, get_elem_n(pool, i));
+  return pool->n_allocated;
+}
+
+/** Calculate a double valued fold reduction on the collection, optionally
+ * applying a map at the same time.
+ *
+ * \param pool Pointer to a memory pool
+ * \param x0 Initial accumulator state.
+ * \param f Pointer to a function that returns a new accumulator value given a
+ *          current accumulator value and an element, optionally updating the
+ *          element in-place.
+ * \return Result of the fold operation, i.e. final accumulator value.
+ */
+double memory_pool_dense_dfold(memory_pool_dense_t *pool, double x0,
+                               double (*f)(double x, element_t *elem))
+{
+  double x = x0;
+  for (u32 i = 0; i < pool->n_allocated; i++)
+    x = f(x, get_elem_n(pool, i));
+  return x;
+}
+
+/** Filter elements in the collection, returning filtered out elements back to
+ * the pool.
+ * The kept elements are compacted towards the start of the array in a single
+ * pass, preserving their order, and keep their handles.
+ *
+ * \param pool Pointer to a memory pool
+ * \param arg Arbitrary argument passed through to `f`
+ * \param f Pointer to a function that takes an element and returns `0` to
+ *          discard that element or `!=0` to keep that element.
+ * \return Number of elements in the filtered collection.
+ */
+s32 memory_pool_dense_filter(memory_pool_dense_t *pool, void *arg,
+                             s8 (*f)(void *arg, element_t *elem))
+{
+  u32 kept = 0;
+  for (u32 i = 0; i < pool->n_allocated; i++) {
+    if (f(arg, get_elem_n(pool, i))) {
+      if (i != kept)
+        move_elem(pool, i, kept);
+      kept++;
+    }
+  }
+  /* The dropped elements' handles have all been swapped above `kept`. */
+  pool->n_allocated = kept;
+  return kept;
+}
+
+/** Remove all elements from the collection and return them to the pool.
+ * This operation is O(1), all outstanding handles become invalid.
+ *
+ * \param pool Pointer to a memory pool
+ */
+void memory_pool_dense_clear(memory_pool_dense_t *pool)
+{
+  pool->n_allocated = 0;
+}
+
+/** \} */
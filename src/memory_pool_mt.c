@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2014 Swift Navigation Inc.
+ * Contact: Fergus Noble <fergus@swift-nav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_pool_mt.h"
+
+inline static size_t calc_node_size(size_t element_size)
+{
+  return element_size + sizeof(memory_pool_mt_node_hdr_t);
+}
+
+inline static memory_pool_mt_node_t *get_node_n(memory_pool_mt_t *pool, u32 n)
+{
+  return (memory_pool_mt_node_t *)
+    ((u8 *)pool->pool + calc_node_size(pool->element_size) * n);
+}
+
+inline static u32 get_node_index(memory_pool_mt_t *pool, element_t *elem)
+{
+  u8 *node = (u8 *)elem - sizeof(memory_pool_mt_node_hdr_t);
+  return (node - (u8 *)pool->pool) / calc_node_size(pool->element_size);
+}
+
+inline static u64 pack_head(u32 tag, u32 index)
+{
+  return ((u64)tag << 32) | index;
+}
+
+#ifdef MEMORY_POOL_MT_LOCK_FREE
+
+/** Push the chain of nodes `first` ... `last`, already linked through their
+ * headers, onto the shared free list. */
+static void free_list_push(memory_pool_mt_t *pool, u32 first, u32 last, u32 n)
+{
+  memory_pool_mt_node_t *last_node = get_node_n(pool, last);
+  /* Count first so a racing pop of these nodes can't take n_free below 0. */
+  __atomic_fetch_add(&pool->n_free, n, __ATOMIC_RELAXED);
+  u64 old = __atomic_load_n(&pool->free_head, __ATOMIC_RELAXED);
+  u64 new;
+  do {
+    __atomic_store_n(&last_node->hdr.next, (u32)old, __ATOMIC_RELAXED);
+    new = pack_head((u32)(old >> 32) + 1, first);
+  } while (!__atomic_compare_exchange_n(&pool->free_head, &old, new, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/** Pop one node from the shared free list.
+ * The popped node's header may be read after another thread has already
+ * taken it, that is harmless as the pool memory is never released and the tag
+ * makes the compare and swap fail in that case. */
+static u32 free_list_pop(memory_pool_mt_t *pool)
+{
+  u64 old = __atomic_load_n(&pool->free_head, __ATOMIC_ACQUIRE);
+  u64 new;
+  do {
+    u32 index = (u32)old;
+    if (index == MEMORY_POOL_MT_NIL)
+      return MEMORY_POOL_MT_NIL;
+    u32 next = __atomic_load_n(&get_node_n(pool, index)->hdr.next,
+                               __ATOMIC_RELAXED);
+    new = pack_head((u32)(old >> 32) + 1, next);
+  } while (!__atomic_compare_exchange_n(&pool->free_head, &old, new, true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+  __atomic_fetch_sub(&pool->n_free, 1, __ATOMIC_RELAXED);
+  return (u32)old;
+}
+
+#else /* MEMORY_POOL_MT_LOCK_FREE */
+
+/* Without a 64-bit compare and swap the tagged head can't be updated
+ * atomically, guard the free list with a lock instead. */
+
+static void free_list_lock(memory_pool_mt_t *pool)
+{
+  while (__atomic_test_and_set(&pool->lock, __ATOMIC_ACQUIRE))
+    ;
+}
+
+static void free_list_unlock(memory_pool_mt_t *pool)
+{
+  __atomic_clear(&pool->lock, __ATOMIC_RELEASE);
+}
+
+/** Push the chain of nodes `first` ... `last`, already linked through their
+ * headers, onto the shared free list. */
+static void free_list_push(memory_pool_mt_t *pool, u32 first, u32 last, u32 n)
+{
+  free_list_lock(pool);
+  get_node_n(pool, last)->hdr.next = (u32)pool->free_head;
+  pool->free_head = pack_head(0, first);
+  __atomic_fetch_add(&pool->n_free, n, __ATOMIC_RELAXED);
+  free_list_unlock(pool);
+}
+
+/** Pop one node from the shared free list. */
+static u32 free_list_pop(memory_pool_mt_t *pool)
+{
+  free_list_lock(pool);
+  u32 index = (u32)pool->free_head;
+  if (index != MEMORY_POOL_MT_NIL) {
+    pool->free_head = pack_head(0, get_node_n(pool, index)->hdr.next);
+    __atomic_fetch_sub(&pool->n_free, 1, __ATOMIC_RELAXED);
+  }
+  free_list_unlock(pool);
+  return index;
+}
+
+#endif /* MEMORY_POOL_MT_LOCK_FREE */
+
+/** \defgroup memory_pool_mt Thread-safe Memory Pool
+ * Fixed size memory pool that can be shared between threads.
+ *
+ * Unlike the functional ::memory_pool_t this is an allocator only, the pool
+ * does not keep a collection of the allocated elements. It is intended for
+ * measurement and message buffers handed from one thread to another in a
+ * pipeline, where the producer allocates and the consumer releases.
+ *
+ * Allocation and release are lock-free and constant time (one compare and
+ * swap in the absence of contention) on targets with a 64-bit compare and
+ * swap, elsewhere the shared free list is guarded by a spin lock. Threads
+ * that allocate and release at a high rate should each go through a
+ * ::memory_pool_mt_cache_t, which touches the shared free list only once per
+ * half cache of operations.
+ *
+ * \{ */
+
+/** Create a new thread-safe memory pool.
+ * Creates a new memory pool containing a maximum of `n_elements` elements of
+ * size `element_size`, see memory_pool_mt_init(). This function calls
+ * malloc(), remember to free the pool with memory_pool_mt_destroy().
+ *
+ * \param n_elements Number of elements that the pool can hold
+ * \param element_size Size in bytes of the user payload elements
+ * \returns Pointer to a new ::memory_pool_mt_t or NULL upon a malloc() failure
+ */
+memory_pool_mt_t *memory_pool_mt_new(u32 n_elements, size_t element_size)
+{
+  memory_pool_mt_t *new_pool = malloc(sizeof(memory_pool_mt_t));
+  if (!new_pool) {
+    return NULL;
+  }
+
+  void *buff = malloc(calc_node_size(element_size) * n_elements);
+  if (!buff) {
+    free(new_pool);
+    return NULL;
+  }
+
+  if (memory_pool_mt_init(new_pool, n_elements, element_size, buff) < 0) {
+    free(buff);
+    free(new_pool);
+    return NULL;
+  }
+
+  return new_pool;
+}
+
+/** Initialise a new thread-safe memory pool.
+ * Initialises a new memory pool containing a maximum of `n_elements` elements
+ * of size `element_size`. This function does not allocate memory and must be
+ * passed a buffer of a suitable size to hold the memory pool elements. Each
+ * element has an overhead of eight bytes so the total space used will be:
+ *
+ * ~~~
+ * n_elements * (element_size + 8)
+ * ~~~
+ *
+ * The pool must be initialised before it is shared with other threads.
+ *
+ * \param new_pool Pointer to a memory pool to initialise
+ * \param n_elements Number of elements that the pool can hold, less than
+ *                   ::MEMORY_POOL_MT_NIL
+ * \param element_size Size in bytes of the user payload elements
+ * \param buff Pointer to a buffer to use as the memory pool working area
+ * \returns `0` on success, `<0` on failure.
+ */
+s8 memory_pool_mt_init(memory_pool_mt_t *new_pool, u32 n_elements,
+                       size_t element_size, void *buff)
+{
+  if (!new_pool || n_elements >= MEMORY_POOL_MT_NIL) {
+    return -1;
+  }
+
+  if (!buff) {
+    return -2;
+  }
+
+  new_pool->n_elements = n_elements;
+  new_pool->element_size = element_size;
+  new_pool->pool = (memory_pool_mt_node_t *)buff;
+
+  /* Link all the nodes into the free list, in order. */
+  for (u32 i = 0; i < n_elements; i++)
+    get_node_n(new_pool, i)->hdr.next =
+      (i + 1 < n_elements) ? i + 1 : MEMORY_POOL_MT_NIL;
+
+  new_pool->free_head = pack_head(0, n_elements ? 0 : MEMORY_POOL_MT_NIL);
+  new_pool->n_free = n_elements;
+#ifndef MEMORY_POOL_MT_LOCK_FREE
+  new_pool->lock = 0;
+#endif
+
+  return 0;
+}
+
+/** Destroy a thread-safe memory pool.
+ * Frees the memory associated with the pool. This must only be called on
+ * memory pools allocated with memory_pool_mt_new() once no other thread is
+ * using the pool.
+ *
+ * \param pool Pointer to the memory pool to destroy.
+ */
+void memory_pool_mt_destroy(memory_pool_mt_t *pool)
+{
+  free(pool->pool);
+  free(pool);
+}
+
+/** Number of elements on the shared free list.
+ * This operation is O(1). Elements held in per-thread caches are not counted
+ * and the value may already be stale when it is returned if other threads
+ * are using the pool.
+ *
+ * \param pool Pointer to a memory pool
+ * \returns Number of free elements
+ */
+u32 memory_pool_mt_n_free(memory_pool_mt_t *pool)
+{
+  return __atomic_load_n(&pool->n_free, __ATOMIC_RELAXED);
+}
+
+/** Allocate an element from the shared free list.
+ * Safe to call from any thread concurrently with any other operation on the
+ * pool.
+ *
+ * \param pool Pointer to a memory pool
+ * \return A pointer to the new element or NULL if the pool is exhausted.
+ */
+element_t *memory_pool_mt_alloc(memory_pool_mt_t *pool)
+{
+  u32 index = free_list_pop(pool);
+  if (index == MEMORY_POOL_MT_NIL)
+    return NULL;
+  return get_node_n(pool, index)->elem;
+}
+
+/** Release an element back to the shared free list.
+ * Safe to call from any thread concurrently with any other operation on the
+ * pool. `elem` must have been allocated from this pool and not already have
+ * been released.
+ *
+ * \param pool Pointer to a memory pool
+ * \param elem Element to release
+ */
+void memory_pool_mt_free(memory_pool_mt_t *pool, element_t *elem)
+{
+  u32 index = get_node_index(pool, elem);
+  free_list_push(pool, index, index, 1);
+}
+
+/** Initialise an empty per-thread cache for a pool.
+ *
+ * \param cache Cache to initialise
+ * \param pool Pointer to the memory pool the cache serves
+ */
+void memory_pool_mt_cache_init(memory_pool_mt_cache_t *cache,
+                               memory_pool_mt_t *pool)
+{
+  cache->pool = pool;
+  cache->n = 0;
+}
+
+/** Allocate an element through a per-thread cache.
+ * When the cache is empty it is refilled with up to half its capacity from
+ * the shared free list. Must only be called from the thread owning `cache`.
+ *
+ * \param cache Per-thread cache
+ * \return A pointer to the new element or NULL if the pool is exhausted.
+ */
+element_t *memory_pool_mt_cache_alloc(memory_pool_mt_cache_t *cache)
+{
+  if (cache->n == 0) {
+    while (cache->n < MEMORY_POOL_MT_CACHE_SIZE / 2) {
+      u32 index = free_list_pop(cache->pool);
+      if (index == MEMORY_POOL_MT_NIL)
+        break;
+      cache->nodes[cache->n++] = index;
+    }
+    if (cache->n == 0)
+      return NULL;
+  }
+  return get_node_n(cache->pool, cache->nodes[--cache->n])->elem;
+}
+
+/** Push the top `n` cached nodes back onto the shared free list in one
+ * compare and swap. */
+static void cache_spill(memory_pool_mt_cache_t *cache, u32 n)
+{
+  if (n == 0)
+    return;
+  u32 first = cache->n - n;
+  for (u32 i = first; i + 1 < cache->n; i++)
+    __atomic_store_n(&get_node_n(cache->pool, cache->nodes[i])->hdr.next,
+                     cache->nodes[i + 1], __ATOMIC_RELAXED);
+  free_list_push(cache->pool, cache->nodes[first], cache->nodes[cache->n - 1],
+                 n);
+  cache->n = first;
+}
+
+/** Release an element through a per-thread cache.
+ * When the cache is full half of it is returned to the shared free list.
+ * Must only be called from the thread owning `cache`, but the element may
+ * have been allocated on any thread.
+ *
+ * \param cache Per-thread cache
+ * \param elem Element to release
+ */
+void memory_pool_mt_cache_free(memory_pool_mt_cache_t *cache,
+                               element_t *elem)
+{
+  if (cache->n == MEMORY_POOL_MT_CACHE_SIZE)
+    cache_spill(cache, MEMORY_POOL_MT_CACHE_SIZE / 2);
+  cache->nodes[cache->n++] = get_node_index(cache->pool, elem);
+}
+
+/** Return all the elements held by a per-thread cache to the pool.
+ * Call before the owning thread exits so the cached elements are not lost.
+ *
+ * \param cache Per-thread cache
+ */
+void memory_pool_mt_cache_flush(memory_pool_mt_cache_t *cache)
+{
+  cache_spill(cache, cache->n);
+}
+
+/** \} */
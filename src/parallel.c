@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2014 Swift Navigation Inc.
+ * Contact: Fergus Noble <fergus@swift-nav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "parallel.h"
+
+/** \defgroup parallel Parallel
+ * Thread fan-out shared by the multi-threaded functions.
+ * \{ */
+
+/** Run a function on each of an array of tasks in parallel.
+ * `fn` is called once with a pointer to each of the `n_tasks` tasks of
+ * `task_size` bytes starting at `tasks`. Task 0 runs on the calling thread
+ * and each of the others on a thread of its own. Tasks beyond
+ * ::PARALLEL_MAX_THREADS, or whose thread could not be started, also run on
+ * the calling thread. Returns once every task has finished.
+ *
+ * If the library is built without LIBSWIFTNAV_ENABLE_PTHREADS all the tasks
+ * run in turn on the calling thread.
+ *
+ * \param tasks Array of tasks
+ * \param n_tasks Number of tasks
+ * \param task_size Size in bytes of each task
+ * \param fn Function to run on each task
+ */
+void parallel_run(void *tasks, u32 n_tasks, size_t task_size,
+                  void *(*fn)(void *task))
+{
+  u8 *t = (u8 *)tasks;
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+  pthread_t threads[PARALLEL_MAX_THREADS];
+  u8 started[PARALLEL_MAX_THREADS] = {0};
+  u32 n_threads = MIN(n_tasks, PARALLEL_MAX_THREADS);
+
+  for (u32 i = 1; i < n_threads; i++)
+    started[i] = !pthread_create(&threads[i], NULL, fn, t + i * task_size);
+  for (u32 i = 0; i < n_tasks; i++)
+    if (i >= n_threads || !started[i])
+      fn(t + i * task_size);
+  for (u32 i = 1; i < n_threads; i++)
+    if (started[i])
+      pthread_join(threads[i], NULL);
+#else
+  for (u32 i = 0; i < n_tasks; i++)
+    fn(t + i * task_size);
+#endif
+}
+
+/** \} */
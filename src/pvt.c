@@ -26,12 +26,12 @@ static double vel_solve(double rx_vel[],
                         const u8 n_used,
                         const navigation_measurement_t nav_meas[n_used],
                         const double G[n_used][4],
-                        const double X[4][n_used])
+                        const double L[4][4])
 {
   /* Velocity Solution
    *
-   * G and X matrices already exist from the position
-   * solution loop through valid measurements.  Here we form satellite
+   * G and the Cholesky factor L of G^{T} G already exist from the
+   * position solution loop through valid measurements.  Here we form satellite
    * velocity and pseudorange rate vectors -- it's the same
    * prediction-error least-squares thing, but we do only one step.
   */
@@ -50,11 +50,18 @@ static double vel_solve(double rx_vel[],
     tempvX[j] = -nav_meas[j].doppler * GPS_C / GPS_L1_HZ - pdot_pred;
   }
 
-  /* Use X to map our pseudorange rate residuals onto the Jacobian update.
+  /* Map our pseudorange rate residuals onto the Jacobian update by
+   * solving the normal equations with the existing factorisation.
    *
-   *   rx_vel[j] = X[j] . tempvX[j]
+   *   G^{T} G rx_vel = G^{T} tempvX
    */
-  matrix_multiply(4, n_used, 1, (double *) X, (double *) tempvX, (double *) rx_vel);
+  double Gt_tempvX[4];
+  for (u8 i = 0; i < 4; i++) {
+    Gt_tempvX[i] = 0;
+    for (u8 j = 0; j < n_used; j++)
+      Gt_tempvX[i] += G[j][i] * tempvX[j];
+  }
+  matrix_cholesky_solve(4, (const double *) L, Gt_tempvX, rx_vel);
 
   /* Return just the receiver clock bias. */
   return rx_vel[3];
@@ -109,16 +116,16 @@ void compute_dops(const double H[4][4],
  *     There's no explicit differentiation; it's done symbolically
  *     first and just coded as a "line of sight" vector.
  *
- *     4. Get the inverse of the Jacobian times its transpose.  This
- *     matrix is normalized to one, but it tells us the direction we
- *     must move the state estimate during this step.
+ *     4. Factorise the Jacobian's transpose times itself (Cholesky).
+ *     Its inverse (H) is normalized to one, but it tells us the shape
+ *     of our error in terms of the receiver state, and is kept for
+ *     the DOPs.
  *
- *     5. Multiply this inverse matrix (H) by the transpose of the
- *     Jacobian (to yield X).  This maps the direction of our state
- *     error into a direction of pseudorange error.
+ *     5. Project the error between the estimated (ephemeris) position
+ *     and the measured pseudoranges onto the transpose of the
+ *     Jacobian.  This maps pseudorange error into state error.
  *
- *     6. Multiply this matrix (X) by the error between the estimated
- *     (ephemeris) position and the measured pseudoranges.  This
+ *     6. Solve the normal equations with the factorisation.  This
  *     yields a vector of corrections to our state estimate.  We apply
  *     these to our current estimate and recurse to the next step.
  *
@@ -126,8 +133,11 @@ void compute_dops(const double H[4][4],
  *     enough solution.  Solve for the receiver's velocity (with
  *     vel_solve) and do some bookkeeping to pass the solution back
  *     out.
+ *
+ * Returns 0 once converged, 1 if another iteration is needed and -1
+ * if the geometry is degenerate and no solution can be found.
  */
-static double pvt_solve(double rx_state[],
+static s8 pvt_solve(double rx_state[],
                         const u8 n_used,
                         const navigation_measurement_t nav_meas[n_used],
                         double H[4][4])
@@ -141,16 +151,15 @@ static double pvt_solve(double rx_state[],
    * our state estimates -- it's the Jacobian of d(p_i)/d(x_j) where
    * x_j are x, y, z, Δt. */
   double G[n_used][4];
-  double Gtrans[4][n_used];
-  double GtG[4][4];
 
-  /* H is the square of the Jacobian matrix; it tells us the shape of
-     our error (or, if you prefer, the direction in which we need to
-     move to get a better solution) in terms of the receiver state. */
+  /* L is the Cholesky factor of G^{T} G, used to solve the normal
+   * equations without forming an explicit inverse. */
+  double L[4][4];
 
-  /* X is just H * Gtrans -- it maps our pseudoranges onto our
-   * Jacobian update */
-  double X[4][n_used];
+  /* H is the inverse square of the Jacobian matrix; it tells us the
+     shape of our error (or, if you prefer, the direction in which we
+     need to move to get a better solution) in terms of the receiver
+     state. */
 
   double tempv[3];
   double los[3];
@@ -217,16 +226,16 @@ static double pvt_solve(double rx_state[],
    * in Wikipedia's article on GPS.
    */
 
-  /* Gt := G^{T} */
-  matrix_transpose(n_used, 4, (double *) G, (double *) Gtrans);
-  /* GtG := G^{T} G */
-  matrix_multiply(4, n_used, 4, (double *) Gtrans, (double *) G, (double *) GtG);
-  /* H \elem \mathbb{R}^{4 \times 4} := GtG^{-1} */
-  matrix_inverse(4, (const double *) GtG, (double *) H);
-  /* X := H * G^{T} */
-  matrix_multiply(4, 4, n_used, (double *) H, (double *) Gtrans, (double *) X);
-  /* correction := X * E (= X * omp) */
-  matrix_multiply(4, n_used, 1, (double *) X, (double *) omp, (double *) correction);
+  /* G^{T} G correction = G^{T} omp, with L L^{T} := G^{T} G */
+  if (solve_normal_equations(n_used, 4, (const double *) G, NULL, omp,
+                             correction, (double *) L) < 0) {
+    /* Singular or ill-conditioned geometry, there is no solution to
+     * iterate towards and further iterations would not change that. */
+    memset(H, 0, sizeof(double) * 4 * 4);
+    return -1;
+  }
+  /* H \elem \mathbb{R}^{4 \times 4} := (G^{T} G)^{-1} */
+  matrix_cholesky_inverse(4, (const double *) L, (double *) H);
 
   /* Increment ecef estimate by the new corrections */
   for (u8 i=0; i<3; i++) {
@@ -242,19 +251,23 @@ static double pvt_solve(double rx_state[],
    * the solution has converged yet.
    */
   tempd = vector_norm(3, correction);
+  if (!isfinite(tempd)) {
+    /* The iteration has diverged. */
+    return -1;
+  }
   if(tempd > 0.001) {
-    /* The solution has not converged, return a negative value to
-     * indicate that we should continue iterating.
+    /* The solution has not converged, indicate that we should
+     * continue iterating.
      */
-    return -tempd;
+    return 1;
   }
 
   /* The solution has converged! */
 
   /* Perform the velocity solution. */
-  vel_solve(&rx_state[4], n_used, nav_meas, (const double (*)[4]) G, (const double (*)[n_used]) X);
+  vel_solve(&rx_state[4], n_used, nav_meas, (const double (*)[4]) G, (const double (*)[4]) L);
 
-  return tempd;
+  return 0;
 }
 
 u8 filter_solution(gnss_solution* soln, dops_t* dops)
@@ -304,11 +317,11 @@ s8 calc_PVT(const u8 n_used,
     rx_state[i] = 0;
   }
 
-  double update;
-  u8 iters;
-  /* Newton-Raphson iteration. */
-  for (iters=0; iters<PVT_MAX_ITERATIONS; iters++) {
-    if ((update = pvt_solve(rx_state, n_used, nav_meas, H)) > 0) {
+  s8 solved = 1;
+  /* Newton-Raphson iteration, stopping early on convergence or on
+   * degenerate geometry. */
+  for (u8 iters=0; iters<PVT_MAX_ITERATIONS; iters++) {
+    if ((solved = pvt_solve(rx_state, n_used, nav_meas, H)) <= 0) {
       break;
     }
   }
@@ -327,7 +340,7 @@ s8 calc_PVT(const u8 n_used,
   soln->err_cov[4] = H[1][2];
   soln->err_cov[5] = H[2][2];
 
-  if (iters >= PVT_MAX_ITERATIONS) {
+  if (solved != 0) {
     /* Reset state if solution fails */
     rx_state[0] = 0;
     rx_state[1] = 0;
@@ -11,17 +11,23 @@
  */
 
 #include <math.h>
+#include <stddef.h>
+#include <string.h>
 
 #include "bits.h"
+#include "constants.h"
 #include "edc.h"
+#include "parallel.h"
 #include "rtcm3.h"
 
-#define RTCM3_PREAMBLE 0xD3 /**< RTCM v3 Frame sync / preamble byte. */
 #define PRUNIT_GPS 299792.458 /**< RTCM v3 Unit of GPS Pseudorange (m) */
 
 #define CLIGHT  299792458.0         /* speed of light (m/s) */
 #define FREQ1   1.57542e9           /* L1/E1  frequency (Hz) */
+#define FREQ2   1.22760e9           /* L2     frequency (Hz) */
 #define LAMBDA1 (CLIGHT / FREQ1)
+#define LAMBDA2 (CLIGHT / FREQ2)
+#define RANGE_MS (CLIGHT * 0.001)   /* range in 1 ms (m) */
 
 /** \addtogroup io Input / Output
  * \{ */
@@ -33,6 +39,42 @@
  *
  * DFxxx codes indicate a corresponding Data Field as described in RTCM 10403.1
  * Table 3.4-1.
+ *
+ * Receiving a stream
+ * ------------------
+ *
+ * rtcm3_check_frame() only checks a frame already aligned at the start of a
+ * buffer. To extract frames from a byte stream, e.g. a serial port or an
+ * NTRIP connection, register a callback for each message type of interest
+ * with an #rtcm3_framer_t and pass it each chunk of data as it arrives:
+ *
+ * ~~~
+ * void my_1002_callback(u16 msg_type, u8 msg[], u16 len, void *context)
+ * {
+ *   rtcm3_decode_1002(msg, &id, &tow, &n_sat, nm, &sync);
+ * }
+ *
+ * static rtcm3_framer_t framer;
+ * static rtcm3_msg_callbacks_node_t my_1002_node;
+ *
+ * rtcm3_framer_init(&framer);
+ * rtcm3_framer_register_callback(&framer, 1002, &my_1002_callback, 0,
+ *                                &my_1002_node);
+ *
+ * while ((n = read(fd, buff, sizeof(buff))) > 0)
+ *   rtcm3_framer_process(&framer, buff, n);
+ * ~~~
+ *
+ * Register a callback for #RTCM3_ALL_MSG_TYPES to see every frame.
+ *
+ * Message layouts
+ * ---------------
+ *
+ * The data messages are described by tables of #rtcm3_field_t, one entry per
+ * data field giving its length in bits and the struct member it is stored
+ * in, which are packed and unpacked in a single pass with a #bit_writer_t or
+ * #bit_reader_t. Messages 1002, 1004, 1005, 1006, 1019 and the MSM4 and MSM7
+ * messages of all GNSSs are supported.
  * \{ */
 
 /** Check RTCM frame header and CRC valid.
@@ -64,6 +106,239 @@ s16 rtcm3_check_frame(u8 *buff)
   return len;
 }
 
+/** Check a candidate frame in a stream.
+ *
+ * \param p     Pointer to the candidate frame, starting with the preamble.
+ * \param avail Number of bytes available at `p`.
+ * \return Length of the frame if it is complete and valid, 0 if more data is
+ *         needed to tell and -1 if it is not a valid frame.
+ */
+static s32 rtcm3_frame_status(const u8 *p, u32 avail)
+{
+  /* The six bits after the preamble are reserved and always zero, this
+   * cheaply rejects most preamble bytes occurring within other data. */
+  if (avail >= 2 && (p[1] & 0xFC))
+    return -1;
+  if (avail < 3)
+    return 0;
+
+  u32 len = ((p[1] & 0x03) << 8) | p[2];
+  if (avail < RTCM3_FRAME_LEN(len))
+    return 0;
+
+  u32 crc = ((u32)p[len+3] << 16) | (p[len+4] << 8) | p[len+5];
+  if (crc24q(p, len + 3, 0) != crc)
+    return -1;
+
+  return RTCM3_FRAME_LEN(len);
+}
+
+/** Pass a valid frame to the callbacks registered for its message type. */
+static void rtcm3_framer_dispatch(rtcm3_framer_t *f, const u8 *frame,
+                                  u32 frame_len)
+{
+  u16 len = frame_len - 6;
+  u8 *msg = (u8 *)frame + 3;
+  u16 msg_type = len >= 2 ? getbitu(msg, 0, 12) : 0;
+
+  f->n_frames++;
+  for (rtcm3_msg_callbacks_node_t *n = f->callbacks_head; n; n = n->next)
+    if (n->msg_type == msg_type || n->msg_type == RTCM3_ALL_MSG_TYPES)
+      (*n->cb)(msg_type, msg, len, n->context);
+}
+
+/** Remove bytes from the start of the staged data.
+ * After resynchronising the staged data can hold more than one frame, so
+ * after the first `n` bytes anything up to the next preamble is also
+ * dropped and the rest kept for rtcm3_framer_process() to check.
+ */
+static void rtcm3_framer_unstage(rtcm3_framer_t *f, u32 n)
+{
+  u8 *next = memchr(&f->frame[n], RTCM3_PREAMBLE, f->n_staged - n);
+  u32 n_drop = next ? (u32)(next - f->frame) : f->n_staged;
+  f->n_skipped += n_drop - n;
+  f->n_staged -= n_drop;
+  f->n_checked = f->n_checked > n_drop ? f->n_checked - n_drop : 0;
+  memmove(f->frame, &f->frame[n_drop], f->n_staged);
+}
+
+/** Look for a complete, valid frame inside an incomplete one.
+ * If one is found the outer frame's preamble was most likely a data byte and
+ * the stream can be resynchronised without waiting for the outer frame's
+ * (bogus) length worth of data to arrive. Only inner frames ending after
+ * `n_checked` are checked, the others were checked on an earlier call.
+ *
+ * \return Offset of the inner frame, or 0 if none was found.
+ */
+static u32 rtcm3_find_inner_frame(const u8 *frame, u32 n, u32 n_checked)
+{
+  const u8 *q = frame + 1;
+  while ((q = memchr(q, RTCM3_PREAMBLE, frame + n - q)) != 0) {
+    u32 k = q - frame;
+    if (n - k < 3)
+      break;
+    u32 end = k + RTCM3_FRAME_LEN(((q[1] & 0x03) << 8) | q[2]);
+    if (end > n_checked && end <= n && rtcm3_frame_status(q, n - k) > 0)
+      return k;
+    q++;
+  }
+  return 0;
+}
+
+/** Initialize an #rtcm3_framer_t before use.
+ * Clears any callbacks, partial frame and statistics.
+ *
+ * \param f Framer to initialize.
+ */
+void rtcm3_framer_init(rtcm3_framer_t *f)
+{
+  f->n_staged = 0;
+  f->n_checked = 0;
+  f->n_frames = 0;
+  f->n_errors = 0;
+  f->n_skipped = 0;
+  f->callbacks_head = 0;
+}
+
+/** Register a callback for an RTCM message type.
+ * Any number of callbacks may be registered for a message type, they are
+ * called in the order they were registered. Use #RTCM3_ALL_MSG_TYPES to
+ * register a callback for every frame.
+ *
+ * The callback is passed the data message, which is valid only during the
+ * call. The whole frame starts 3 bytes before the data message and is
+ * `len + 6` bytes long, e.g. for forwarding it unchanged.
+ *
+ * \param f        Framer.
+ * \param msg_type Message type number (DF002) associated with callback.
+ * \param cb       Pointer to message callback function.
+ * \param context  Pointer to context for callback function.
+ * \param node     Statically allocated #rtcm3_msg_callbacks_node_t struct.
+ * \return Zero on success, -1 if `cb` or `node` was NULL.
+ */
+s8 rtcm3_framer_register_callback(rtcm3_framer_t *f, u16 msg_type,
+                                  rtcm3_msg_callback_t cb, void *context,
+                                  rtcm3_msg_callbacks_node_t *node)
+{
+  if (cb == 0 || node == 0)
+    return -1;
+
+  node->msg_type = msg_type;
+  node->cb = cb;
+  node->context = context;
+  node->next = 0;
+
+  rtcm3_msg_callbacks_node_t **p = &f->callbacks_head;
+  while (*p)
+    p = &(*p)->next;
+  *p = node;
+
+  return 0;
+}
+
+/** Process a chunk of an RTCM stream.
+ * Finds the frames in the chunk, checks their length and CRC-24Q and passes
+ * the valid ones to the registered callbacks. Frames lying wholly within the
+ * chunk are passed straight from `buf` without copying. A frame left
+ * incomplete at the end of the chunk is kept in the framer and completed
+ * from the next chunk.
+ *
+ * On a bad frame the framer resynchronises by searching for the next
+ * preamble from the byte after the bad frame's preamble. A preamble byte
+ * within other data whose header claims a long frame is abandoned as soon as
+ * a good frame is found within it, rather than holding up the stream until
+ * its length worth of data has arrived and the CRC check fails.
+ *
+ * \param f   Framer.
+ * \param buf Chunk of the stream.
+ * \param len Length of the chunk in bytes.
+ * \return Number of valid frames found.
+ */
+s32 rtcm3_framer_process(rtcm3_framer_t *f, const u8 *buf, u32 len)
+{
+  const u8 *p = buf;
+  const u8 *end = buf + len;
+  s32 n_frames = 0;
+
+  for (;;) {
+    if (f->n_staged > 0) {
+      /* Continue the frame left over from the last chunk, topping it up with
+       * just its header at first so we know how much more to take. */
+      u32 need = 3;
+      if (f->n_staged >= 3)
+        need = RTCM3_FRAME_LEN(((f->frame[1] & 0x03) << 8) | f->frame[2]);
+      if (need > f->n_staged) {
+        u32 n = need - f->n_staged;
+        if (n > (u32)(end - p))
+          n = end - p;
+        memcpy(&f->frame[f->n_staged], p, n);
+        f->n_staged += n;
+        p += n;
+      }
+
+      s32 ret = rtcm3_frame_status(f->frame, f->n_staged);
+      if (ret > 0) {
+        rtcm3_framer_dispatch(f, f->frame, ret);
+        n_frames++;
+        rtcm3_framer_unstage(f, ret);
+        continue;
+      }
+      if (ret < 0) {
+        /* Not a frame, look for another preamble among the staged bytes. */
+        f->n_errors++;
+        f->n_skipped++;
+        rtcm3_framer_unstage(f, 1);
+        continue;
+      }
+
+      u32 k = rtcm3_find_inner_frame(f->frame, f->n_staged, f->n_checked);
+      if (k) {
+        /* Nothing after the inner frame has been checked yet. */
+        f->n_checked = k;
+        f->n_errors++;
+        f->n_skipped += k;
+        rtcm3_framer_unstage(f, k);
+        continue;
+      }
+      f->n_checked = f->n_staged;
+
+      if (p == end)
+        break;
+      continue;
+    }
+
+    if (p == end)
+      break;
+
+    const u8 *q = memchr(p, RTCM3_PREAMBLE, end - p);
+    if (!q) {
+      f->n_skipped += end - p;
+      break;
+    }
+    f->n_skipped += q - p;
+    p = q;
+
+    s32 ret = rtcm3_frame_status(p, end - p);
+    if (ret > 0) {
+      rtcm3_framer_dispatch(f, p, ret);
+      n_frames++;
+      p += ret;
+    } else if (ret < 0) {
+      f->n_errors++;
+      f->n_skipped++;
+      p++;
+    } else {
+      /* Incomplete, keep the rest of the chunk until the next one. */
+      f->n_staged = end - p;
+      f->n_checked = 0;
+      memcpy(f->frame, p, f->n_staged);
+      p = end;
+    }
+  }
+
+  return n_frames;
+}
+
 /** Write RTCM frame header and CRC into a buffer.
  *
  * The buffer should already contain the data message starting at the
@@ -232,8 +507,217 @@ static u32 from_lock_ind(u8 lock)
   return 937;
 }
 
-/** Generate RTCMv3 formatted GPS observation fields.
- * Currently L1 only.
+
+/** Storage type of the struct member holding a data field, see
+ * #rtcm3_field_t. */
+enum {
+  RTCM3_SKIP,   /**< Reserved bits, written as zero and not stored. */
+  RTCM3_U8,     /**< `u8` */
+  RTCM3_U16,    /**< `u16` */
+  RTCM3_U32,    /**< `u32` */
+  RTCM3_U64,    /**< `u64` */
+  RTCM3_S32,    /**< `s32`, the field is signed. */
+  RTCM3_DOUBLE, /**< `double`, the field scaled by `scale`. */
+};
+
+/** Description of a data field of a message, see rtcm3_read_fields(). */
+typedef struct {
+  u8 len;       /**< Length of the field in bits, up to 64. */
+  u8 sign;      /**< Set if the field is a two's complement signed value. */
+  u8 type;      /**< Type of the struct member holding the field. */
+  u16 offset;   /**< Offset of the struct member holding the field. */
+  double scale; /**< Units of the field for #RTCM3_DOUBLE members. */
+} rtcm3_field_t;
+
+#define FIELD_U(len, type, rec, member) \
+  {len, 0, type, offsetof(rec, member), 1}
+#define FIELD_S(len, rec, member) \
+  {len, 1, RTCM3_S32, offsetof(rec, member), 1}
+#define FIELD_D(len, sign, scale, rec, member) \
+  {len, sign, RTCM3_DOUBLE, offsetof(rec, member), scale}
+#define FIELD_SKIP(len) \
+  {len, 0, RTCM3_SKIP, 0, 0}
+
+#define N_FIELDS(fields) (sizeof(fields) / sizeof(fields[0]))
+
+/** Total length in bits of a table of fields. */
+static u32 rtcm3_fields_len(const rtcm3_field_t *fields, u32 n_fields)
+{
+  u32 len = 0;
+  for (u32 i = 0; i < n_fields; i++)
+    len += fields[i].len;
+  return len;
+}
+
+/** Read a data field into its struct member.
+ * Members are accessed with memcpy() as they may be in packed structs. */
+static void rtcm3_read_field(bit_reader_t *r, const rtcm3_field_t *f, u8 *rec)
+{
+  u64 raw;
+  if (f->len > 32) {
+    raw = (u64)bit_reader_getu(r, f->len - 32) << 32;
+    raw |= bit_reader_getu(r, 32);
+  } else {
+    raw = bit_reader_getu(r, f->len);
+  }
+
+  s64 sraw = raw;
+  if (f->sign) {
+    u64 m = 1ULL << (f->len - 1);
+    sraw = (s64)((raw ^ m) - m);
+  }
+
+  u8 *p = rec + f->offset;
+  switch (f->type) {
+    case RTCM3_U8:  { u8 v = raw;  memcpy(p, &v, sizeof(v)); break; }
+    case RTCM3_U16: { u16 v = raw; memcpy(p, &v, sizeof(v)); break; }
+    case RTCM3_U32: { u32 v = raw; memcpy(p, &v, sizeof(v)); break; }
+    case RTCM3_U64: { u64 v = raw; memcpy(p, &v, sizeof(v)); break; }
+    case RTCM3_S32: { s32 v = sraw; memcpy(p, &v, sizeof(v)); break; }
+    case RTCM3_DOUBLE: {
+      double v = (f->sign ? (double)sraw : (double)raw) * f->scale;
+      memcpy(p, &v, sizeof(v));
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/** Write a data field from its struct member, see rtcm3_read_field(). */
+static void rtcm3_write_field(bit_writer_t *w, const rtcm3_field_t *f,
+                              const u8 *rec)
+{
+  const u8 *p = rec + f->offset;
+  u64 raw = 0;
+  switch (f->type) {
+    case RTCM3_U8:  { u8 v;  memcpy(&v, p, sizeof(v)); raw = v; break; }
+    case RTCM3_U16: { u16 v; memcpy(&v, p, sizeof(v)); raw = v; break; }
+    case RTCM3_U32: { u32 v; memcpy(&v, p, sizeof(v)); raw = v; break; }
+    case RTCM3_U64: { u64 v; memcpy(&v, p, sizeof(v)); raw = v; break; }
+    case RTCM3_S32: { s32 v; memcpy(&v, p, sizeof(v)); raw = (s64)v; break; }
+    case RTCM3_DOUBLE: {
+      double v;
+      memcpy(&v, p, sizeof(v));
+      raw = llround(v / f->scale);
+      break;
+    }
+    default:
+      break;
+  }
+
+  if (f->len > 32) {
+    bit_writer_setu(w, f->len - 32, raw >> 32);
+    bit_writer_setu(w, 32, raw);
+  } else {
+    bit_writer_setu(w, f->len, raw);
+  }
+}
+
+/** Read `count` records whose fields are stored one after the other, i.e.
+ * all the fields of the first record, then the second, ...
+ *
+ * \param r        Bit reader positioned at the first field.
+ * \param fields   Table describing the fields of a record.
+ * \param n_fields Number of fields in the table.
+ * \param recs     Array of records to read into.
+ * \param stride   Size of each record in bytes.
+ * \param count    Number of records.
+ */
+static void rtcm3_read_fields(bit_reader_t *r, const rtcm3_field_t *fields,
+                              u32 n_fields, void *recs, size_t stride,
+                              u32 count)
+{
+  for (u32 i = 0; i < count; i++)
+    for (u32 j = 0; j < n_fields; j++)
+      rtcm3_read_field(r, &fields[j], (u8 *)recs + i*stride);
+}
+
+/** Read `count` records whose fields are stored column by column, i.e. the
+ * first field of every record, then the second field of every record, ...
+ * as in the satellite and signal data of MSM messages. Parameters as for
+ * rtcm3_read_fields(). */
+static void rtcm3_read_columns(bit_reader_t *r, const rtcm3_field_t *fields,
+                               u32 n_fields, void *recs, size_t stride,
+                               u32 count)
+{
+  for (u32 j = 0; j < n_fields; j++)
+    for (u32 i = 0; i < count; i++)
+      rtcm3_read_field(r, &fields[j], (u8 *)recs + i*stride);
+}
+
+/** Write records stored one after the other, see rtcm3_read_fields(). */
+static void rtcm3_write_fields(bit_writer_t *w, const rtcm3_field_t *fields,
+                               u32 n_fields, const void *recs, size_t stride,
+                               u32 count)
+{
+  for (u32 i = 0; i < count; i++)
+    for (u32 j = 0; j < n_fields; j++)
+      rtcm3_write_field(w, &fields[j], (const u8 *)recs + i*stride);
+}
+
+/** Write records stored column by column, see rtcm3_read_columns(). */
+static void rtcm3_write_columns(bit_writer_t *w, const rtcm3_field_t *fields,
+                                u32 n_fields, const void *recs, size_t stride,
+                                u32 count)
+{
+  for (u32 j = 0; j < n_fields; j++)
+    for (u32 i = 0; i < count; i++)
+      rtcm3_write_field(w, &fields[j], (const u8 *)recs + i*stride);
+}
+
+/** Raw GPS observation fields of a satellite in messages 1001..1004. */
+typedef struct {
+  u8 prn;       /* DF009 */
+  u8 code;      /* DF010 */
+  u32 pr;       /* DF011 */
+  s32 ppr;      /* DF012 */
+  u8 lock;      /* DF013 */
+  u8 amb;       /* DF014 */
+  u8 cnr;       /* DF015 */
+  u8 l2_code;   /* DF016 */
+  s32 l2_pr;    /* DF017 */
+  s32 l2_ppr;   /* DF018 */
+  u8 l2_lock;   /* DF019 */
+  u8 l2_cnr;    /* DF020 */
+} gps_obs_t;
+
+/** Fields of a satellite in message 1004, the first `GPS_OBS_L1_FIELDS` of
+ * which are those of message 1002. */
+static const rtcm3_field_t gps_obs_fields[] = {
+  FIELD_U(6,  RTCM3_U8,  gps_obs_t, prn),
+  FIELD_U(1,  RTCM3_U8,  gps_obs_t, code),
+  FIELD_U(24, RTCM3_U32, gps_obs_t, pr),
+  FIELD_S(20,            gps_obs_t, ppr),
+  FIELD_U(7,  RTCM3_U8,  gps_obs_t, lock),
+  FIELD_U(8,  RTCM3_U8,  gps_obs_t, amb),
+  FIELD_U(8,  RTCM3_U8,  gps_obs_t, cnr),
+  FIELD_U(2,  RTCM3_U8,  gps_obs_t, l2_code),
+  FIELD_S(14,            gps_obs_t, l2_pr),
+  FIELD_S(20,            gps_obs_t, l2_ppr),
+  FIELD_U(7,  RTCM3_U8,  gps_obs_t, l2_lock),
+  FIELD_U(8,  RTCM3_U8,  gps_obs_t, l2_cnr),
+};
+#define GPS_OBS_L1_FIELDS 7
+
+#define L2_PR_INVALID  (-8192)   /* DF017 value for no L2 pseudorange */
+#define L2_PPR_INVALID (-524288) /* DF018 value for no L2 phaserange */
+
+/** L1 pseudorange in meters of a satellite's observation, from its
+ * pseudorange (DF011) and integer ambiguity (DF014). */
+static inline double gps_obs_pseudorange(const gps_obs_t *obs)
+{
+  return 0.02*obs->pr + PRUNIT_GPS*obs->amb;
+}
+
+/** L1 carrier phase in cycles of a satellite's observation, from its L1
+ * pseudorange `prc` and phaserange - pseudorange (DF012). */
+static inline double gps_obs_carrier_phase(const gps_obs_t *obs, double prc)
+{
+  return (prc + 0.0005*obs->ppr) / (CLIGHT / FREQ1);
+}
+
+/** Generate RTCMv3 formatted GPS L1 observation fields.
  *
  * \param nm Struct containing the observation.
  * \param amb The GPS Integer L1 Pseudorange Modulus Ambiguity (DF014).
@@ -281,6 +765,138 @@ static void gen_obs_gps(navigation_measurement_t *nm,
     *cnr = (u8)((10.0*log10(nm->snr) + 40.0) * 4.0);
 }
 
+/** Generate RTCMv3 formatted GPS L2 observation fields, relative to the L1
+ * pseudorange as transmitted.
+ *
+ * \param nm Struct containing the L2 observation, `carrier_phase` in L2
+ *           cycles.
+ * \param prc The GPS L1 Pseudorange as transmitted in meters.
+ * \param pr The GPS L2-L1 Pseudorange Difference (DF017).
+ * \param ppr The GPS L2 PhaseRange – L1 Pseudorange (DF018).
+ * \param lock The GPS L2 Lock Time Indicator (DF019).
+ * \param cnr The GPS L2 CNR (DF020).
+ */
+static void gen_obs_gps_l2(navigation_measurement_t *nm, double prc,
+                           s32 *pr, s32 *ppr, u8 *lock, u8 *cnr)
+{
+  /* DF017 is 14 bits of 0.02 m. */
+  double pr_diff = (nm->raw_pseudorange - prc) / 0.02;
+  *pr = fabs(pr_diff) < 8191 ? lround(pr_diff) : L2_PR_INVALID;
+
+  /* L2 phaserange - L1 pseudorange, brought back into range as for L1. The
+   * 20 bit field covers +/- 1073 L2 cycles. */
+  double cp_pr = nm->carrier_phase - prc / LAMBDA2;
+  if (fabs(cp_pr) > 1000) {
+    nm->lock_time = 0;
+    nm->carrier_phase -= (s32)cp_pr;
+    cp_pr -= (s32)cp_pr;
+  }
+  *ppr = lround(cp_pr * LAMBDA2 / 0.0005);
+
+  *lock = to_lock_ind(nm->lock_time);
+  *cnr = (u8)((10.0*log10(nm->snr) + 40.0) * 4.0);
+}
+
+/** Encode an RTCMv3 GPS observation message, 1002 or 1004. */
+static u16 rtcm3_encode_gps_obs(u8 *buff, u16 type, u16 id, gps_time_t t,
+                                u8 n_sat, navigation_measurement_t *nm,
+                                navigation_measurement_t *nm_l2, u8 sync)
+{
+  u32 n_fields = type == 1004 ? N_FIELDS(gps_obs_fields) : GPS_OBS_L1_FIELDS;
+  u32 sat_len = rtcm3_fields_len(gps_obs_fields, n_fields);
+
+  rtcm3_write_header(buff, type, id, t, sync, n_sat, 0, 0);
+
+  /* Start at end of header. */
+  bit_writer_t w;
+  bit_writer_init(&w, buff, (64 + n_sat*sat_len + 7) / 8, 64);
+
+  for (u8 i=0; i<n_sat; i++) {
+    gps_obs_t obs;
+    gen_obs_gps(&nm[i], &obs.amb, &obs.pr, &obs.ppr, &obs.lock, &obs.cnr);
+    obs.prn = nm[i].prn + 1;
+    /* TODO: set GPS code indicator if we ever support P(Y) code measurements. */
+    obs.code = 0;
+
+    obs.l2_code = 0;
+    if (nm_l2) {
+      gen_obs_gps_l2(&nm_l2[i], gps_obs_pseudorange(&obs),
+                     &obs.l2_pr, &obs.l2_ppr, &obs.l2_lock, &obs.l2_cnr);
+    } else {
+      obs.l2_pr = L2_PR_INVALID;
+      obs.l2_ppr = L2_PPR_INVALID;
+      obs.l2_lock = 0;
+      obs.l2_cnr = 0;
+    }
+
+    rtcm3_write_fields(&w, gps_obs_fields, n_fields, &obs, 0, 1);
+  }
+  bit_writer_flush(&w);
+
+  /* Round number of bits up to nearest whole byte. */
+  return (bit_writer_pos(&w) + 7) / 8;
+}
+
+/** Decode an RTCMv3 GPS observation message, 1002 or 1004. */
+static s8 rtcm3_decode_gps_obs(u8 *buff, u16 expected_type, u16 *id,
+                               double *tow, u8 *n_sat,
+                               navigation_measurement_t *nm,
+                               navigation_measurement_t *nm_l2, u8 *sync)
+{
+  u16 type;
+  u8 div_free, smooth;
+
+  rtcm3_read_header(buff, &type, id, tow, sync, n_sat, &div_free, &smooth);
+
+  if (type != expected_type)
+    /* Unexpected message type. */
+    return -1;
+
+  /* TODO: Fill in t->wn. */
+
+  if (!nm)
+    /* No nav meas pointer, probably just interested in
+     * n_sat so we are all done. */
+    return 0;
+
+  u32 n_fields = type == 1004 ? N_FIELDS(gps_obs_fields) : GPS_OBS_L1_FIELDS;
+  u32 sat_len = rtcm3_fields_len(gps_obs_fields, n_fields);
+
+  bit_reader_t r;
+  bit_reader_init(&r, buff, (64 + *n_sat*sat_len + 7) / 8, 64);
+  for (u8 i=0; i<*n_sat; i++) {
+    gps_obs_t obs;
+    rtcm3_read_fields(&r, gps_obs_fields, n_fields, &obs, 0, 1);
+
+    /* TODO: Handle SBAS prns properly, numbered differently in RTCM? */
+    nm[i].prn = obs.prn - 1;
+
+    /* TODO: When we start storing the signal/system etc. properly we can
+     * store the code flag in the nav meas struct. */
+    if (obs.code == 1)
+      /* P(Y) code not currently supported. */
+      return -2;
+
+    double prc = gps_obs_pseudorange(&obs);
+    nm[i].raw_pseudorange = prc;
+    nm[i].carrier_phase = gps_obs_carrier_phase(&obs, prc);
+    nm[i].lock_time = from_lock_ind(obs.lock);
+    nm[i].snr = pow(10.0, ((obs.cnr / 4.0) - 40.0) / 10.0);
+
+    if (type == 1004 && nm_l2) {
+      nm_l2[i].prn = nm[i].prn;
+      nm_l2[i].raw_pseudorange = obs.l2_pr == L2_PR_INVALID ?
+                                 NAN : prc + 0.02*obs.l2_pr;
+      nm_l2[i].carrier_phase = obs.l2_ppr == L2_PPR_INVALID ?
+                               NAN : (prc + 0.0005*obs.l2_ppr) / LAMBDA2;
+      nm_l2[i].lock_time = from_lock_ind(obs.l2_lock);
+      nm_l2[i].snr = pow(10.0, ((obs.l2_cnr / 4.0) - 40.0) / 10.0);
+    }
+  }
+
+  return 0;
+}
+
 /** Encode an RTCMv3 message type 1002 (Extended L1-Only GPS RTK Observables)
  * Message type 1002 has length `64 + n_sat*74` bits. Returned message length
  * is rounded up to the nearest whole byte.
@@ -296,29 +912,7 @@ static void gen_obs_gps(navigation_measurement_t *nm,
 u16 rtcm3_encode_1002(u8 *buff, u16 id, gps_time_t t, u8 n_sat,
                       navigation_measurement_t *nm, u8 sync)
 {
-  rtcm3_write_header(buff, 1002, id, t, sync, n_sat, 0, 0);
-
-  u16 bit = 64; /* Start at end of header. */
-
-  u32 pr;
-  s32 ppr;
-  u8 amb, lock, cnr;
-
-  for (u8 i=0; i<n_sat; i++) {
-    gen_obs_gps(&nm[i], &amb, &pr, &ppr, &lock, &cnr);
-
-    setbitu(buff, bit, 6,  nm[i].prn + 1); bit += 6;
-    /* TODO: set GPS code indicator if we ever support P(Y) code measurements. */
-    setbitu(buff, bit, 1,  0);    bit += 1;
-    setbitu(buff, bit, 24, pr);   bit += 24;
-    setbits(buff, bit, 20, ppr);  bit += 20;
-    setbitu(buff, bit, 7,  lock); bit += 7;
-    setbitu(buff, bit, 8,  amb);  bit += 8;
-    setbitu(buff, bit, 8,  cnr);  bit += 8;
-  }
-
-  /* Round number of bits up to nearest whole byte. */
-  return (bit + 7) / 8;
+  return rtcm3_encode_gps_obs(buff, 1002, id, t, n_sat, nm, 0, sync);
 }
 
 /** Decode an RTCMv3 message type 1002 (Extended L1-Only GPS RTK Observables)
@@ -337,51 +931,967 @@ u16 rtcm3_encode_1002(u8 *buff, u16 id, gps_time_t t, u8 n_sat,
 s8 rtcm3_decode_1002(u8 *buff, u16 *id, double *tow, u8 *n_sat,
                      navigation_measurement_t *nm, u8 *sync)
 {
-  u16 type;
-  u8 div_free, smooth;
+  return rtcm3_decode_gps_obs(buff, 1002, id, tow, n_sat, nm, 0, sync);
+}
 
-  rtcm3_read_header(buff, &type, id, tow, sync, n_sat, &div_free, &smooth);
+/** Encode an RTCMv3 message type 1004 (Extended L1&L2 GPS RTK Observables)
+ * Message type 1004 has length `64 + n_sat*125` bits. Returned message length
+ * is rounded up to the nearest whole byte.
+ *
+ * The L2 observations are sent relative to the L1 pseudorange, an L2
+ * pseudorange more than 163 m from it is sent as invalid. As for the L1
+ * carrier phase, the L2 carrier phase may be adjusted by an integer number of
+ * cycles to keep it in range, resetting its lock time to zero.
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param id Reference station ID (DF003).
+ * \param t GPS time of epoch (DF004).
+ * \param n_sat Number of GPS satellites included in the message (DF006).
+ * \param nm_l1 Struct containing the L1 observations.
+ * \param nm_l2 Struct containing the L2 observations, carrier phase in L2
+ *              cycles. If NULL the L2 observations are sent as invalid.
+ * \param sync Synchronous GNSS Flag (DF005).
+ * \return The message length in bytes.
+ */
+u16 rtcm3_encode_1004(u8 *buff, u16 id, gps_time_t t, u8 n_sat,
+                      navigation_measurement_t *nm_l1,
+                      navigation_measurement_t *nm_l2, u8 sync)
+{
+  return rtcm3_encode_gps_obs(buff, 1004, id, t, n_sat, nm_l1, nm_l2, sync);
+}
 
-  if (type != 1002)
-    /* Unexpected message type. */
+/** Decode an RTCMv3 message type 1004 (Extended L1&L2 GPS RTK Observables)
+ * L2 pseudoranges and carrier phases sent as invalid are decoded as NAN.
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param id Reference station ID (DF003).
+ * \param tow GPS time of week of epoch (DF004).
+ * \param n_sat Number of GPS satellites included in the message (DF006).
+ * \param nm_l1 Struct containing the L1 observations.
+ * \param nm_l2 Struct containing the L2 observations, may be NULL.
+ * \param sync Synchronous GNSS Flag (DF005).
+ * \return If valid then return 0.
+ *         Returns a negative number if the message is invalid:
+ *          - `-1` : Message type mismatch
+ *          - `-2` : Message uses unsupported P(Y) code
+ */
+s8 rtcm3_decode_1004(u8 *buff, u16 *id, double *tow, u8 *n_sat,
+                     navigation_measurement_t *nm_l1,
+                     navigation_measurement_t *nm_l2, u8 *sync)
+{
+  return rtcm3_decode_gps_obs(buff, 1004, id, tow, n_sat, nm_l1, nm_l2, sync);
+}
+
+/** Stationary antenna reference point messages 1005 and 1006. */
+typedef struct {
+  u16 msg_type;
+  rtcm3_station_t s;
+} station_msg_t;
+
+/** Fields of message 1006, all but the last are those of message 1005. */
+static const rtcm3_field_t station_fields[] = {
+  FIELD_U(12, RTCM3_U16, station_msg_t, msg_type),          /* DF002 */
+  FIELD_U(12, RTCM3_U16, station_msg_t, s.id),              /* DF003 */
+  FIELD_U(6,  RTCM3_U8,  station_msg_t, s.itrf),            /* DF021 */
+  FIELD_U(1,  RTCM3_U8,  station_msg_t, s.gps),             /* DF022 */
+  FIELD_U(1,  RTCM3_U8,  station_msg_t, s.glo),             /* DF023 */
+  FIELD_U(1,  RTCM3_U8,  station_msg_t, s.gal),             /* DF024 */
+  FIELD_U(1,  RTCM3_U8,  station_msg_t, s.ref_station),     /* DF141 */
+  FIELD_D(38, 1, 0.0001, station_msg_t, s.pos[0]),          /* DF025 */
+  FIELD_U(1,  RTCM3_U8,  station_msg_t, s.osc),             /* DF142 */
+  FIELD_SKIP(1),                                            /* DF001 */
+  FIELD_D(38, 1, 0.0001, station_msg_t, s.pos[1]),          /* DF026 */
+  FIELD_U(2,  RTCM3_U8,  station_msg_t, s.quarter_cycle),   /* DF364 */
+  FIELD_D(38, 1, 0.0001, station_msg_t, s.pos[2]),          /* DF027 */
+  FIELD_D(16, 0, 0.0001, station_msg_t, s.height),          /* DF028 */
+};
+
+static u16 rtcm3_encode_station(u8 *buff, u16 type,
+                                const rtcm3_station_t *station)
+{
+  u32 n_fields = N_FIELDS(station_fields) - (type == 1005);
+  station_msg_t m = {.msg_type = type, .s = *station};
+
+  bit_writer_t w;
+  bit_writer_init(&w, buff, (rtcm3_fields_len(station_fields, n_fields) + 7) / 8,
+                  0);
+  rtcm3_write_fields(&w, station_fields, n_fields, &m, 0, 1);
+  bit_writer_flush(&w);
+
+  return (bit_writer_pos(&w) + 7) / 8;
+}
+
+static s8 rtcm3_decode_station(u8 *buff, u16 type, rtcm3_station_t *station)
+{
+  u32 n_fields = N_FIELDS(station_fields) - (type == 1005);
+  station_msg_t m;
+
+  bit_reader_t r;
+  bit_reader_init(&r, buff, (rtcm3_fields_len(station_fields, n_fields) + 7) / 8,
+                  0);
+  rtcm3_read_fields(&r, station_fields, n_fields, &m, 0, 1);
+
+  if (m.msg_type != type)
     return -1;
 
-  /* TODO: Fill in t->wn. */
+  if (type == 1005)
+    m.s.height = 0;
+  *station = m.s;
 
-  if (!nm)
-    /* No nav meas pointer, probably just interested in
-     * n_sat so we are all done. */
+  return 0;
+}
+
+/** Encode an RTCMv3 message type 1005 (Stationary RTK Reference Station ARP)
+ * Message type 1005 is 19 bytes long.
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param station Reference station, `height` is not sent.
+ * \return The message length in bytes.
+ */
+u16 rtcm3_encode_1005(u8 *buff, const rtcm3_station_t *station)
+{
+  return rtcm3_encode_station(buff, 1005, station);
+}
+
+/** Decode an RTCMv3 message type 1005 (Stationary RTK Reference Station ARP)
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param station Reference station, `height` is set to zero.
+ * \return If valid then return 0.
+ *         Returns a negative number if the message is invalid:
+ *          - `-1` : Message type mismatch
+ */
+s8 rtcm3_decode_1005(u8 *buff, rtcm3_station_t *station)
+{
+  return rtcm3_decode_station(buff, 1005, station);
+}
+
+/** Encode an RTCMv3 message type 1006 (Stationary RTK Reference Station ARP
+ * with Antenna Height). Message type 1006 is 21 bytes long.
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param station Reference station.
+ * \return The message length in bytes.
+ */
+u16 rtcm3_encode_1006(u8 *buff, const rtcm3_station_t *station)
+{
+  return rtcm3_encode_station(buff, 1006, station);
+}
+
+/** Decode an RTCMv3 message type 1006 (Stationary RTK Reference Station ARP
+ * with Antenna Height).
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param station Reference station.
+ * \return If valid then return 0.
+ *         Returns a negative number if the message is invalid:
+ *          - `-1` : Message type mismatch
+ */
+s8 rtcm3_decode_1006(u8 *buff, rtcm3_station_t *station)
+{
+  return rtcm3_decode_station(buff, 1006, station);
+}
+
+/** GPS ephemeris message 1019. */
+typedef struct {
+  u16 msg_type;
+  u8 prn;        /* DF009 */
+  u16 wn;        /* DF076 */
+  u8 ura;        /* DF077 */
+  u8 l2_code;    /* DF078 */
+  u8 iode;       /* DF071 */
+  u16 iodc;      /* DF085 */
+  u8 health;     /* DF102 */
+  u8 l2p_flag;   /* DF103 */
+  u8 fit;        /* DF137 */
+  ephemeris_t eph;
+} eph_msg_t;
+
+static const rtcm3_field_t eph_fields[] = {
+  FIELD_U(12, RTCM3_U16, eph_msg_t, msg_type),                    /* DF002 */
+  FIELD_U(6,  RTCM3_U8,  eph_msg_t, prn),                         /* DF009 */
+  FIELD_U(10, RTCM3_U16, eph_msg_t, wn),                          /* DF076 */
+  FIELD_U(4,  RTCM3_U8,  eph_msg_t, ura),                         /* DF077 */
+  FIELD_U(2,  RTCM3_U8,  eph_msg_t, l2_code),                     /* DF078 */
+  FIELD_D(14, 1, 0x1p-43 * GPS_PI, eph_msg_t, eph.inc_dot),       /* DF079 */
+  FIELD_U(8,  RTCM3_U8,  eph_msg_t, iode),                        /* DF071 */
+  FIELD_D(16, 0, 0x1p4,  eph_msg_t, eph.toc.tow),                 /* DF081 */
+  FIELD_D(8,  1, 0x1p-55, eph_msg_t, eph.af2),                    /* DF082 */
+  FIELD_D(16, 1, 0x1p-43, eph_msg_t, eph.af1),                    /* DF083 */
+  FIELD_D(22, 1, 0x1p-31, eph_msg_t, eph.af0),                    /* DF084 */
+  FIELD_U(10, RTCM3_U16, eph_msg_t, iodc),                        /* DF085 */
+  FIELD_D(16, 1, 0x1p-5,  eph_msg_t, eph.crs),                    /* DF086 */
+  FIELD_D(16, 1, 0x1p-43 * GPS_PI, eph_msg_t, eph.dn),            /* DF087 */
+  FIELD_D(32, 1, 0x1p-31 * GPS_PI, eph_msg_t, eph.m0),            /* DF088 */
+  FIELD_D(16, 1, 0x1p-29, eph_msg_t, eph.cuc),                    /* DF089 */
+  FIELD_D(32, 0, 0x1p-33, eph_msg_t, eph.ecc),                    /* DF090 */
+  FIELD_D(16, 1, 0x1p-29, eph_msg_t, eph.cus),                    /* DF091 */
+  FIELD_D(32, 0, 0x1p-19, eph_msg_t, eph.sqrta),                  /* DF092 */
+  FIELD_D(16, 0, 0x1p4,   eph_msg_t, eph.toe.tow),                /* DF093 */
+  FIELD_D(16, 1, 0x1p-29, eph_msg_t, eph.cic),                    /* DF094 */
+  FIELD_D(32, 1, 0x1p-31 * GPS_PI, eph_msg_t, eph.omega0),        /* DF095 */
+  FIELD_D(16, 1, 0x1p-29, eph_msg_t, eph.cis),                    /* DF096 */
+  FIELD_D(32, 1, 0x1p-31 * GPS_PI, eph_msg_t, eph.inc),           /* DF097 */
+  FIELD_D(16, 1, 0x1p-5,  eph_msg_t, eph.crc),                    /* DF098 */
+  FIELD_D(32, 1, 0x1p-31 * GPS_PI, eph_msg_t, eph.w),             /* DF099 */
+  FIELD_D(24, 1, 0x1p-43 * GPS_PI, eph_msg_t, eph.omegadot),      /* DF100 */
+  FIELD_D(8,  1, 0x1p-31, eph_msg_t, eph.tgd),                    /* DF101 */
+  FIELD_U(6,  RTCM3_U8,  eph_msg_t, health),                      /* DF102 */
+  FIELD_U(1,  RTCM3_U8,  eph_msg_t, l2p_flag),                    /* DF103 */
+  FIELD_U(1,  RTCM3_U8,  eph_msg_t, fit),                         /* DF137 */
+};
+
+/** Encode an RTCMv3 message type 1019 (GPS Ephemerides)
+ * Message type 1019 is 61 bytes long.
+ *
+ * The week number is sent modulo 1024 and that of `eph->toe` is used. The
+ * satellite is sent as healthy if `eph->healthy` is set, and the URA, L2
+ * code, L2 P data flag and fit interval fields, which are not held in an
+ * #ephemeris_t, are sent as zero.
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param prn PRN of the satellite, numbered from zero.
+ * \param eph Ephemeris of the satellite.
+ * \param iode Issue of Data Ephemeris (DF071).
+ * \param iodc Issue of Data Clock (DF085).
+ * \return The message length in bytes.
+ */
+u16 rtcm3_encode_1019(u8 *buff, u8 prn, const ephemeris_t *eph,
+                      u8 iode, u16 iodc)
+{
+  eph_msg_t m;
+  memset(&m, 0, sizeof(m));
+  m.msg_type = 1019;
+  m.prn = prn + 1;
+  m.wn = eph->toe.wn % 1024;
+  m.iode = iode;
+  m.iodc = iodc;
+  m.health = eph->healthy ? 0 : 0x3F;
+  m.eph = *eph;
+
+  bit_writer_t w;
+  bit_writer_init(&w, buff, (rtcm3_fields_len(eph_fields, N_FIELDS(eph_fields))
+                             + 7) / 8, 0);
+  rtcm3_write_fields(&w, eph_fields, N_FIELDS(eph_fields), &m, 0, 1);
+  bit_writer_flush(&w);
+
+  return (bit_writer_pos(&w) + 7) / 8;
+}
+
+/** Decode an RTCMv3 message type 1019 (GPS Ephemerides)
+ *
+ * The week number is only sent modulo 1024, `eph->toe.wn` and `eph->toc.wn`
+ * are set to the week number as sent and must be resolved by the caller.
+ * The ephemeris is marked valid and is healthy if the SV health field is
+ * zero.
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param prn PRN of the satellite, numbered from zero.
+ * \param eph Ephemeris of the satellite.
+ * \param iode Issue of Data Ephemeris (DF071), may be NULL.
+ * \param iodc Issue of Data Clock (DF085), may be NULL.
+ * \return If valid then return 0.
+ *         Returns a negative number if the message is invalid:
+ *          - `-1` : Message type mismatch
+ */
+s8 rtcm3_decode_1019(u8 *buff, u8 *prn, ephemeris_t *eph,
+                     u8 *iode, u16 *iodc)
+{
+  eph_msg_t m;
+  memset(&m, 0, sizeof(m));
+
+  bit_reader_t r;
+  bit_reader_init(&r, buff, (rtcm3_fields_len(eph_fields, N_FIELDS(eph_fields))
+                             + 7) / 8, 0);
+  rtcm3_read_fields(&r, eph_fields, N_FIELDS(eph_fields), &m, 0, 1);
+
+  if (m.msg_type != 1019)
+    return -1;
+
+  m.eph.toe.wn = m.wn;
+  m.eph.toc.wn = m.wn;
+  m.eph.valid = 1;
+  m.eph.healthy = m.health == 0;
+
+  *prn = m.prn - 1;
+  *eph = m.eph;
+  if (iode)
+    *iode = m.iode;
+  if (iodc)
+    *iodc = m.iodc;
+
+  return 0;
+}
+
+/** Satellite and signal masks of an MSM message. */
+typedef struct {
+  u64 sat_mask;  /* DF394 */
+  u32 sig_mask;  /* DF395 */
+  u64 cell_mask; /* DF396 */
+} msm_masks_t;
+
+/** Raw satellite data of an MSM message. */
+typedef struct {
+  u8 int_ms;     /* DF397 */
+  u8 ext_info;   /* Extended satellite information */
+  u16 frac_ms;   /* DF398 */
+  s32 rate;      /* DF399 */
+} msm_sat_t;
+
+/** Raw signal data of an MSM message. */
+typedef struct {
+  s32 pr;        /* DF400 or DF405 */
+  s32 cp;        /* DF401 or DF406 */
+  u16 lock;      /* DF402 or DF407 */
+  u8 half_cycle; /* DF420 */
+  double cnr;    /* DF403 or DF408 */
+  s32 rate;      /* DF404 */
+} msm_cell_t;
+
+static const rtcm3_field_t msm_header_fields[] = {
+  FIELD_U(12, RTCM3_U16, rtcm3_msm_t, msg_type),     /* DF002 */
+  FIELD_U(12, RTCM3_U16, rtcm3_msm_t, id),           /* DF003 */
+  FIELD_U(30, RTCM3_U32, rtcm3_msm_t, epoch),        /* GNSS epoch time */
+  FIELD_U(1,  RTCM3_U8,  rtcm3_msm_t, multiple),     /* DF393 */
+  FIELD_U(3,  RTCM3_U8,  rtcm3_msm_t, iods),         /* DF409 */
+  FIELD_SKIP(7),                                     /* DF001 */
+  FIELD_U(2,  RTCM3_U8,  rtcm3_msm_t, clk_steering), /* DF411 */
+  FIELD_U(2,  RTCM3_U8,  rtcm3_msm_t, ext_clk),      /* DF412 */
+  FIELD_U(1,  RTCM3_U8,  rtcm3_msm_t, div_free),     /* DF417 */
+  FIELD_U(3,  RTCM3_U8,  rtcm3_msm_t, smooth),       /* DF418 */
+};
+
+static const rtcm3_field_t msm_mask_fields[] = {
+  FIELD_U(64, RTCM3_U64, msm_masks_t, sat_mask),     /* DF394 */
+  FIELD_U(32, RTCM3_U32, msm_masks_t, sig_mask),     /* DF395 */
+};
+
+static const rtcm3_field_t msm4_sat_fields[] = {
+  FIELD_U(8,  RTCM3_U8,  msm_sat_t, int_ms),         /* DF397 */
+  FIELD_U(10, RTCM3_U16, msm_sat_t, frac_ms),        /* DF398 */
+};
+
+static const rtcm3_field_t msm4_cell_fields[] = {
+  FIELD_S(15,            msm_cell_t, pr),            /* DF400 */
+  FIELD_S(22,            msm_cell_t, cp),            /* DF401 */
+  FIELD_U(4,  RTCM3_U16, msm_cell_t, lock),          /* DF402 */
+  FIELD_U(1,  RTCM3_U8,  msm_cell_t, half_cycle),    /* DF420 */
+  FIELD_D(6, 0, 1,       msm_cell_t, cnr),           /* DF403 */
+};
+
+static const rtcm3_field_t msm7_sat_fields[] = {
+  FIELD_U(8,  RTCM3_U8,  msm_sat_t, int_ms),         /* DF397 */
+  FIELD_U(4,  RTCM3_U8,  msm_sat_t, ext_info),
+  FIELD_U(10, RTCM3_U16, msm_sat_t, frac_ms),        /* DF398 */
+  FIELD_S(14,            msm_sat_t, rate),           /* DF399 */
+};
+
+static const rtcm3_field_t msm7_cell_fields[] = {
+  FIELD_S(20,            msm_cell_t, pr),            /* DF405 */
+  FIELD_S(24,            msm_cell_t, cp),            /* DF406 */
+  FIELD_U(10, RTCM3_U16, msm_cell_t, lock),          /* DF407 */
+  FIELD_U(1,  RTCM3_U8,  msm_cell_t, half_cycle),    /* DF420 */
+  FIELD_D(10, 0, 0x1p-4, msm_cell_t, cnr),           /* DF408 */
+  FIELD_S(15,            msm_cell_t, rate),          /* DF404 */
+};
+
+#define MSM_INT_MS_INVALID 255      /* DF397 value for no rough range */
+#define MSM_RATE_INVALID   (-8192)  /* DF399 value for no rough rate */
+#define MSM_FINE_RATE_INVALID (-16384) /* DF404 value for no fine rate */
+
+/** Layout of the satellite and signal data of an MSM message. */
+typedef struct {
+  const rtcm3_field_t *sat_fields;
+  u32 n_sat_fields;
+  const rtcm3_field_t *cell_fields;
+  u32 n_cell_fields;
+  double pr_scale;  /* Units of the fine pseudorange in ms. */
+  double cp_scale;  /* Units of the fine phase range in ms. */
+  u8 has_rate;      /* Phase range rates are included. */
+} msm_layout_t;
+
+static const msm_layout_t msm4_layout = {
+  msm4_sat_fields, N_FIELDS(msm4_sat_fields),
+  msm4_cell_fields, N_FIELDS(msm4_cell_fields),
+  0x1p-24, 0x1p-29, 0
+};
+
+static const msm_layout_t msm7_layout = {
+  msm7_sat_fields, N_FIELDS(msm7_sat_fields),
+  msm7_cell_fields, N_FIELDS(msm7_cell_fields),
+  0x1p-29, 0x1p-31, 1
+};
+
+/** Layout for an MSM message type, or NULL if it is not MSM4 or MSM7. */
+static const msm_layout_t *msm_layout(u16 msg_type)
+{
+  if (msg_type < 1071 || msg_type > 1127)
     return 0;
+  switch (msg_type % 10) {
+    case 4: return &msm4_layout;
+    case 7: return &msm7_layout;
+    default: return 0;
+  }
+}
 
-  u16 bit = 64;
-  for (u8 i=0; i<*n_sat; i++) {
-    /* TODO: Handle SBAS prns properly, numbered differently in RTCM? */
-    nm[i].prn = getbitu(buff, bit, 6) - 1; bit += 6;
+/** Fine value of a measurement relative to its rough value in a signed field
+ * of `len` bits, or the field's invalid value if it can't be represented. */
+static s32 msm_fine(double x, double rough, double scale, u8 len)
+{
+  s32 invalid = -(1 << (len - 1));
+  double fine = round((x - rough) / scale);
+  if (isnan(fine) || fine <= invalid || fine >= -invalid)
+    return invalid;
+  return (s32)fine;
+}
 
-    u8 code = getbitu(buff, bit, 1); bit += 1;
-    /* TODO: When we start storing the signal/system etc. properly we can
-     * store the code flag in the nav meas struct. */
-    if (code == 1)
-      /* P(Y) code not currently supported. */
-      return -2;
+/** Encode an RTCMv3 MSM4 or MSM7 message (Multiple Signal Message)
+ *
+ * The satellite, signal and cell masks are built from the satellites and
+ * cells. The rough range of each satellite is taken from the first of its
+ * cells with a pseudorange, or failing that a phase range, and its rough
+ * range rate from the first with a phase range rate. Measurements too far
+ * from these to be sent, and NAN measurements, are sent as invalid. Lock
+ * time indicators and CNRs beyond the range of their fields are sent as the
+ * largest value the field holds.
+ *
+ * \param buff A pointer to the RTCM data message buffer, up to 1023 bytes.
+ * \param msm Message to encode, `msg_type` selects the GNSS and MSM4 or MSM7.
+ * \return The message length in bytes, or 0 if `msm` is invalid: not an MSM4
+ *         or MSM7 message type, satellites or cells out of order or out of
+ *         range, a cell of a satellite not in `sats` or more than 64
+ *         satellite and signal pairs.
+ */
+u16 rtcm3_encode_msm(u8 *buff, const rtcm3_msm_t *msm)
+{
+  const msm_layout_t *l = msm_layout(msm->msg_type);
+  if (!l || msm->n_sats > RTCM3_MSM_MAX_SATS ||
+      msm->n_cells > RTCM3_MSM_MAX_CELLS)
+    return 0;
 
-    u32 pr = getbitu(buff, bit,24); bit += 24;
-    s32 ppr = getbits(buff, bit,20); bit += 20;
-    u8 lock = getbitu(buff, bit, 7); bit += 7;
-    u8 amb = getbitu(buff, bit, 8); bit += 8;
-    u8 cnr = getbitu(buff, bit, 8); bit += 8;
+  msm_masks_t masks = {0, 0, 0};
+  for (u8 i = 0; i < msm->n_sats; i++) {
+    u8 id = msm->sats[i].id;
+    if (id < 1 || id > 64 || (i > 0 && id <= msm->sats[i-1].id))
+      return 0;
+    masks.sat_mask |= 1ULL << (64 - id);
+  }
 
-    nm[i].raw_pseudorange = 0.02*pr + PRUNIT_GPS*amb;
-    nm[i].carrier_phase = (nm[i].raw_pseudorange + 0.0005*ppr) / (CLIGHT / FREQ1);
-    nm[i].lock_time = from_lock_ind(lock);
-    nm[i].snr = pow(10.0, ((cnr / 4.0) - 40.0) / 10.0);
+  u8 sigs[32];
+  u32 n_sigs = 0;
+  for (u8 c = 0; c < msm->n_cells; c++) {
+    u8 sig = msm->cells[c].sig;
+    if (sig < 1 || sig > 32)
+      return 0;
+    masks.sig_mask |= 1u << (32 - sig);
+  }
+  for (u8 sig = 1; sig <= 32; sig++)
+    if (masks.sig_mask & (1u << (32 - sig)))
+      sigs[n_sigs++] = sig;
+
+  u32 n_mask = msm->n_sats * n_sigs;
+  if (n_mask > RTCM3_MSM_MAX_CELLS)
+    return 0;
+
+  /* Walk the satellite and signal pairs in order, the cells must be in the
+   * same order. */
+  u8 cell_sat[RTCM3_MSM_MAX_CELLS];
+  u32 n = 0;
+  for (u32 k = 0; k < n_mask && n < msm->n_cells; k++) {
+    if (msm->cells[n].sat == msm->sats[k / n_sigs].id &&
+        msm->cells[n].sig == sigs[k % n_sigs]) {
+      masks.cell_mask |= 1ULL << (n_mask - 1 - k);
+      cell_sat[n++] = k / n_sigs;
+    }
+  }
+  if (n != msm->n_cells)
+    return 0;
+
+  double rough[RTCM3_MSM_MAX_SATS];
+  double rough_rate[RTCM3_MSM_MAX_SATS];
+  for (u8 i = 0; i < msm->n_sats; i++)
+    rough[i] = rough_rate[i] = NAN;
+  for (u8 c = 0; c < msm->n_cells; c++) {
+    const rtcm3_msm_cell_t *cell = &msm->cells[c];
+    u8 i = cell_sat[c];
+    if (isnan(rough[i]))
+      rough[i] = (isnan(cell->pseudorange) ? cell->phase_range :
+                                             cell->pseudorange) / RANGE_MS;
+    if (isnan(rough_rate[i]))
+      rough_rate[i] = cell->phase_rate;
+  }
+
+  msm_sat_t sats[RTCM3_MSM_MAX_SATS];
+  for (u8 i = 0; i < msm->n_sats; i++) {
+    /* Rough range in units of 2^-10 ms. */
+    double units = round(rough[i] * 1024);
+    if (isnan(units) || units < 0 || units >= MSM_INT_MS_INVALID * 1024) {
+      sats[i].int_ms = MSM_INT_MS_INVALID;
+      sats[i].frac_ms = 0;
+      rough[i] = NAN;
+    } else {
+      sats[i].int_ms = (u32)units >> 10;
+      sats[i].frac_ms = (u32)units & 0x3FF;
+      rough[i] = units / 1024;
+    }
+    sats[i].ext_info = msm->sats[i].ext_info;
+
+    double rate = round(rough_rate[i]);
+    if (!l->has_rate || isnan(rate) || fabs(rate) > -MSM_RATE_INVALID - 1) {
+      sats[i].rate = MSM_RATE_INVALID;
+      rough_rate[i] = NAN;
+    } else {
+      sats[i].rate = rate;
+      rough_rate[i] = rate;
+    }
+  }
+
+  u8 pr_len = l->cell_fields[0].len;
+  u8 cp_len = l->cell_fields[1].len;
+  u16 lock_max = (1 << l->cell_fields[2].len) - 1;
+  double cnr_max = ((1 << l->cell_fields[4].len) - 1) * l->cell_fields[4].scale;
+  msm_cell_t cells[RTCM3_MSM_MAX_CELLS];
+  for (u8 c = 0; c < msm->n_cells; c++) {
+    const rtcm3_msm_cell_t *cell = &msm->cells[c];
+    u8 i = cell_sat[c];
+    cells[c].pr = msm_fine(cell->pseudorange / RANGE_MS, rough[i],
+                           l->pr_scale, pr_len);
+    cells[c].cp = msm_fine(cell->phase_range / RANGE_MS, rough[i],
+                           l->cp_scale, cp_len);
+    cells[c].rate = msm_fine(cell->phase_rate, rough_rate[i], 0.0001, 15);
+    cells[c].lock = MIN(cell->lock, lock_max);
+    cells[c].half_cycle = cell->half_cycle;
+    /* Saturate at the largest value the field holds rather than wrap. */
+    cells[c].cnr = isnan(cell->cnr) || cell->cnr < 0 ? 0 :
+                   MIN(cell->cnr, cnr_max);
+  }
+
+  u32 len = rtcm3_fields_len(msm_header_fields, N_FIELDS(msm_header_fields)) +
+            rtcm3_fields_len(msm_mask_fields, N_FIELDS(msm_mask_fields)) +
+            n_mask +
+            msm->n_sats * rtcm3_fields_len(l->sat_fields, l->n_sat_fields) +
+            msm->n_cells * rtcm3_fields_len(l->cell_fields, l->n_cell_fields);
+  rtcm3_field_t cell_mask_field =
+    FIELD_U(n_mask, RTCM3_U64, msm_masks_t, cell_mask);
+
+  bit_writer_t w;
+  bit_writer_init(&w, buff, (len + 7) / 8, 0);
+  rtcm3_write_fields(&w, msm_header_fields, N_FIELDS(msm_header_fields),
+                     msm, 0, 1);
+  rtcm3_write_fields(&w, msm_mask_fields, N_FIELDS(msm_mask_fields),
+                     &masks, 0, 1);
+  rtcm3_write_fields(&w, &cell_mask_field, 1, &masks, 0, 1);
+  rtcm3_write_columns(&w, l->sat_fields, l->n_sat_fields,
+                      sats, sizeof(sats[0]), msm->n_sats);
+  rtcm3_write_columns(&w, l->cell_fields, l->n_cell_fields,
+                      cells, sizeof(cells[0]), msm->n_cells);
+  bit_writer_flush(&w);
+
+  return (bit_writer_pos(&w) + 7) / 8;
+}
+
+/** Decode an RTCMv3 MSM4 or MSM7 message (Multiple Signal Message)
+ * Measurements sent as invalid are decoded as NAN, as are the phase range
+ * rates of MSM4 messages.
+ *
+ * \param buff A pointer to the RTCM data message buffer.
+ * \param msm Decoded message.
+ * \return If valid then return 0.
+ *         Returns a negative number if the message is invalid:
+ *          - `-1` : Not an MSM4 or MSM7 message
+ *          - `-2` : More than 64 satellite and signal pairs
+ */
+s8 rtcm3_decode_msm(u8 *buff, rtcm3_msm_t *msm)
+{
+  u32 header_len =
+    rtcm3_fields_len(msm_header_fields, N_FIELDS(msm_header_fields)) +
+    rtcm3_fields_len(msm_mask_fields, N_FIELDS(msm_mask_fields));
+  msm_masks_t masks;
+
+  bit_reader_t r;
+  bit_reader_init(&r, buff, (header_len + 7) / 8, 0);
+  rtcm3_read_fields(&r, msm_header_fields, N_FIELDS(msm_header_fields),
+                    msm, 0, 1);
+
+  const msm_layout_t *l = msm_layout(msm->msg_type);
+  if (!l)
+    return -1;
+
+  rtcm3_read_fields(&r, msm_mask_fields, N_FIELDS(msm_mask_fields),
+                    &masks, 0, 1);
+
+  msm->n_sats = 0;
+  for (u8 id = 1; id <= 64; id++)
+    if (masks.sat_mask & (1ULL << (64 - id)))
+      msm->sats[msm->n_sats++].id = id;
+
+  u8 sigs[32];
+  u32 n_sigs = 0;
+  for (u8 sig = 1; sig <= 32; sig++)
+    if (masks.sig_mask & (1u << (32 - sig)))
+      sigs[n_sigs++] = sig;
+
+  u32 n_mask = msm->n_sats * n_sigs;
+  if (n_mask > RTCM3_MSM_MAX_CELLS)
+    return -2;
+
+  rtcm3_field_t cell_mask_field =
+    FIELD_U(n_mask, RTCM3_U64, msm_masks_t, cell_mask);
+  masks.cell_mask = 0;
+  bit_reader_init(&r, buff, (header_len + n_mask + 7) / 8, header_len);
+  rtcm3_read_fields(&r, &cell_mask_field, 1, &masks, 0, 1);
+
+  u8 cell_sat[RTCM3_MSM_MAX_CELLS];
+  msm->n_cells = 0;
+  for (u32 k = 0; k < n_mask; k++) {
+    if (masks.cell_mask & (1ULL << (n_mask - 1 - k))) {
+      msm->cells[msm->n_cells].sat = msm->sats[k / n_sigs].id;
+      msm->cells[msm->n_cells].sig = sigs[k % n_sigs];
+      cell_sat[msm->n_cells++] = k / n_sigs;
+    }
+  }
+
+  u32 len = header_len + n_mask +
+            msm->n_sats * rtcm3_fields_len(l->sat_fields, l->n_sat_fields) +
+            msm->n_cells * rtcm3_fields_len(l->cell_fields, l->n_cell_fields);
+  msm_sat_t sats[RTCM3_MSM_MAX_SATS];
+  msm_cell_t cells[RTCM3_MSM_MAX_CELLS];
+  memset(sats, 0, msm->n_sats * sizeof(sats[0]));
+  memset(cells, 0, msm->n_cells * sizeof(cells[0]));
+
+  bit_reader_init(&r, buff, (len + 7) / 8, header_len + n_mask);
+  rtcm3_read_columns(&r, l->sat_fields, l->n_sat_fields,
+                     sats, sizeof(sats[0]), msm->n_sats);
+  rtcm3_read_columns(&r, l->cell_fields, l->n_cell_fields,
+                     cells, sizeof(cells[0]), msm->n_cells);
+
+  double rough[RTCM3_MSM_MAX_SATS];
+  double rough_rate[RTCM3_MSM_MAX_SATS];
+  for (u8 i = 0; i < msm->n_sats; i++) {
+    msm->sats[i].ext_info = sats[i].ext_info;
+    rough[i] = sats[i].int_ms == MSM_INT_MS_INVALID ?
+               NAN : sats[i].int_ms + sats[i].frac_ms / 1024.0;
+    rough_rate[i] = !l->has_rate || sats[i].rate == MSM_RATE_INVALID ?
+                    NAN : sats[i].rate;
+  }
+
+  s32 pr_invalid = -(1 << (l->cell_fields[0].len - 1));
+  s32 cp_invalid = -(1 << (l->cell_fields[1].len - 1));
+  for (u8 c = 0; c < msm->n_cells; c++) {
+    rtcm3_msm_cell_t *cell = &msm->cells[c];
+    u8 i = cell_sat[c];
+    cell->pseudorange = cells[c].pr == pr_invalid ?
+      NAN : (rough[i] + cells[c].pr * l->pr_scale) * RANGE_MS;
+    cell->phase_range = cells[c].cp == cp_invalid ?
+      NAN : (rough[i] + cells[c].cp * l->cp_scale) * RANGE_MS;
+    cell->phase_rate = cells[c].rate == MSM_FINE_RATE_INVALID ?
+      NAN : rough_rate[i] + cells[c].rate * 0.0001;
+    cell->lock = cells[c].lock;
+    cell->half_cycle = cells[c].half_cycle;
+    cell->cnr = cells[c].cnr;
   }
 
   return 0;
 }
 
+/** Header of GPS observation messages 1001..1004, see rtcm3_read_header(). */
+typedef struct {
+  u16 msg_type;  /* DF002 */
+  u16 id;        /* DF003 */
+  u32 tow_ms;    /* DF004 */
+  u8 sync;       /* DF005 */
+  u8 n_sat;      /* DF006 */
+  u8 div_free;   /* DF007 */
+  u8 smooth;     /* DF008 */
+} gps_obs_header_t;
+
+static const rtcm3_field_t gps_obs_header_fields[] = {
+  FIELD_U(12, RTCM3_U16, gps_obs_header_t, msg_type),
+  FIELD_U(12, RTCM3_U16, gps_obs_header_t, id),
+  FIELD_U(30, RTCM3_U32, gps_obs_header_t, tow_ms),
+  FIELD_U(1,  RTCM3_U8,  gps_obs_header_t, sync),
+  FIELD_U(5,  RTCM3_U8,  gps_obs_header_t, n_sat),
+  FIELD_U(1,  RTCM3_U8,  gps_obs_header_t, div_free),
+  FIELD_U(3,  RTCM3_U8,  gps_obs_header_t, smooth),
+};
+
+/** Initialize an #rtcm3_obs_array_t with its arrays in a single buffer.
+ *
+ * \param a       Observation array to initialize.
+ * \param max_obs Capacity of the array in observations.
+ * \param buff    Buffer of at least `RTCM3_OBS_ARRAY_BUFF_SIZE(max_obs)`
+ *                bytes, aligned for a `double`.
+ */
+void rtcm3_obs_array_init(rtcm3_obs_array_t *a, u32 max_obs, void *buff)
+{
+  a->n_obs = 0;
+  a->max_obs = max_obs;
+  a->n_msgs = 0;
+  a->n_errors = 0;
+  /* Widest columns first to keep them aligned. */
+  a->tow = (double *)buff;
+  a->pseudorange = a->tow + max_obs;
+  a->carrier_phase = a->pseudorange + max_obs;
+  a->cnr = (float *)(a->carrier_phase + max_obs);
+  a->lock_time = (u16 *)(a->cnr + max_obs);
+  a->prn = (u8 *)(a->lock_time + max_obs);
+}
+
+/** Upper bound on the number of observations held by `len` bytes of RTCM
+ * frames. Each observation takes at least 74 bits of a data message.
+ *
+ * \param len Length of the data in bytes.
+ * \return Maximum number of observations.
+ */
+u32 rtcm3_obs_array_bound(u32 len)
+{
+  return (u64)len * 8 / 74;
+}
+
+/** Append the observations of a data message to an observation array.
+ * Messages other than 1002 and 1004 are ignored.
+ *
+ * \return 0 on success, -1 if the observations don't fit, in which case
+ *         nothing is added.
+ */
+static s8 rtcm3_obs_array_add(rtcm3_obs_array_t *a, const u8 *msg, u16 len)
+{
+  bit_reader_t r;
+  gps_obs_header_t h;
+
+  bit_reader_init(&r, msg, len, 0);
+  rtcm3_read_fields(&r, gps_obs_header_fields,
+                    N_FIELDS(gps_obs_header_fields), &h, 0, 1);
+  if (r.overrun || (h.msg_type != 1002 && h.msg_type != 1004))
+    return 0;
+
+  u32 n_fields = h.msg_type == 1004 ? N_FIELDS(gps_obs_fields)
+                                    : GPS_OBS_L1_FIELDS;
+  if (64 + h.n_sat * rtcm3_fields_len(gps_obs_fields, n_fields) > 8u*len) {
+    /* Too short for its number of satellites. */
+    a->n_errors++;
+    return 0;
+  }
+  if (a->n_obs + h.n_sat > a->max_obs)
+    return -1;
+
+  double tow = h.tow_ms / 1e3;
+  for (u8 i = 0; i < h.n_sat; i++) {
+    gps_obs_t obs;
+    rtcm3_read_fields(&r, gps_obs_fields, n_fields, &obs, 0, 1);
+
+    double prc = gps_obs_pseudorange(&obs);
+    u32 k = a->n_obs++;
+    a->tow[k] = tow;
+    a->prn[k] = obs.prn - 1;
+    a->pseudorange[k] = prc;
+    a->carrier_phase[k] = gps_obs_carrier_phase(&obs, prc);
+    a->lock_time[k] = from_lock_ind(obs.lock);
+    a->cnr[k] = obs.cnr / 4.0f;
+  }
+  a->n_msgs++;
+
+  return 0;
+}
+
+/** Decode the observation messages of the frames starting in `buf[start]` to
+ * `buf[end-1]`, frames may extend up to `buf[len-1]`.
+ *
+ * \return Offset in `buf` at which decoding stopped.
+ */
+static u32 rtcm3_decode_obs_range(rtcm3_obs_array_t *a, const u8 *buf,
+                                  u32 len, u32 start, u32 end)
+{
+  u32 pos = start;
+  while (pos < end) {
+    const u8 *q = memchr(&buf[pos], RTCM3_PREAMBLE, end - pos);
+    if (!q)
+      return end;
+    pos = q - buf;
+
+    s32 ret = rtcm3_frame_status(q, len - pos);
+    if (ret == 0) {
+      /* Incomplete, unless it is a false preamble hiding a frame. */
+      u32 k = rtcm3_find_inner_frame(q, len - pos, 0);
+      if (!k)
+        break;
+      a->n_errors++;
+      pos += k;
+      continue;
+    }
+    if (ret < 0) {
+      a->n_errors++;
+      pos++;
+      continue;
+    }
+
+    if (rtcm3_obs_array_add(a, q + 3, ret - 6) < 0)
+      break;
+    pos += ret;
+  }
+  return pos;
+}
+
+/** Decode the GPS observations in a buffer of RTCM frames.
+ * The L1 observations of every 1002 and 1004 message are appended to the
+ * observation array in a single pass, other messages and data between
+ * frames are skipped. Decoding stops before a frame whose observations don't
+ * fit or an incomplete frame at the end of the buffer, so a stream or file
+ * can be decoded in pieces by passing the bytes not consumed again with the
+ * next piece.
+ *
+ * \param a   Observation array to append to.
+ * \param buf Buffer of RTCM frames.
+ * \param len Length of the buffer in bytes.
+ * \return Number of bytes of `buf` consumed.
+ */
+u32 rtcm3_decode_obs_bulk(rtcm3_obs_array_t *a, const u8 *buf, u32 len)
+{
+  return rtcm3_decode_obs_range(a, buf, len, 0, len);
+}
+
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+
+/* One chunk of a parallel bulk decode, the frames starting in
+ * `buf[start]` to `buf[end-1]`. */
+typedef struct {
+  rtcm3_obs_array_t a;
+  const u8 *buf;
+  u32 len, start, end, stop;
+} obs_chunk_t;
+
+static void *obs_chunk_decode(void *arg)
+{
+  obs_chunk_t *c = (obs_chunk_t *)arg;
+  c->stop = rtcm3_decode_obs_range(&c->a, c->buf, c->len, c->start, c->end);
+  return NULL;
+}
+
+/** First offset at or after `pos` holding a complete, valid frame, or `len`
+ * if there is none. */
+static u32 next_frame(const u8 *buf, u32 len, u32 pos)
+{
+  const u8 *q = &buf[pos];
+  while ((q = memchr(q, RTCM3_PREAMBLE, buf + len - q)) != 0) {
+    if (rtcm3_frame_status(q, buf + len - q) > 0)
+      return q - buf;
+    q++;
+  }
+  return len;
+}
+
+/** Point a chunk's arrays into the caller's arrays from `base`. */
+static void obs_chunk_slice(rtcm3_obs_array_t *c, const rtcm3_obs_array_t *a,
+                            u32 base, u32 max_obs)
+{
+  c->n_obs = 0;
+  c->max_obs = max_obs;
+  c->n_msgs = 0;
+  c->n_errors = 0;
+  c->tow = a->tow + base;
+  c->pseudorange = a->pseudorange + base;
+  c->carrier_phase = a->carrier_phase + base;
+  c->cnr = a->cnr + base;
+  c->lock_time = a->lock_time + base;
+  c->prn = a->prn + base;
+}
+
+/** Move a chunk's observations down to the end of the caller's arrays. */
+static void obs_chunk_merge(rtcm3_obs_array_t *a, const rtcm3_obs_array_t *c)
+{
+  u32 k = a->n_obs, n = c->n_obs;
+  memmove(&a->tow[k], c->tow, n * sizeof(a->tow[0]));
+  memmove(&a->pseudorange[k], c->pseudorange, n * sizeof(a->pseudorange[0]));
+  memmove(&a->carrier_phase[k], c->carrier_phase,
+          n * sizeof(a->carrier_phase[0]));
+  memmove(&a->cnr[k], c->cnr, n * sizeof(a->cnr[0]));
+  memmove(&a->lock_time[k], c->lock_time, n * sizeof(a->lock_time[0]));
+  memmove(&a->prn[k], c->prn, n * sizeof(a->prn[0]));
+  a->n_obs += n;
+  a->n_msgs += c->n_msgs;
+  a->n_errors += c->n_errors;
+}
+
+#endif /* LIBSWIFTNAV_ENABLE_PTHREADS */
+
+/** Decode the GPS observations in a buffer of RTCM frames in parallel.
+ * As rtcm3_decode_obs_bulk(), with identical results, but the buffer is
+ * split at frame boundaries into up to `n_threads` chunks of at least
+ * ::RTCM3_BULK_MIN_CHUNK bytes which are decoded concurrently, e.g. to
+ * reprocess a whole archive file read or mapped into memory.
+ *
+ * Each chunk is decoded into its own part of the observation array, so the
+ * array must have room for rtcm3_obs_array_bound() of each chunk plus a
+ * frame. If it hasn't, or if the library is built without
+ * LIBSWIFTNAV_ENABLE_PTHREADS, this is rtcm3_decode_obs_bulk().
+ *
+ * A frame boundary is taken to be the first valid frame after the split
+ * point. Should a frame decoded by the previous chunk overlap it, the chunk
+ * is decoded again after the previous one.
+ *
+ * \param a         Observation array to append to.
+ * \param n_threads Maximum number of threads, including the calling thread.
+ * \param buf       Buffer of RTCM frames.
+ * \param len       Length of the buffer in bytes.
+ * \return Number of bytes of `buf` consumed.
+ */
+u32 rtcm3_decode_obs_bulk_parallel(rtcm3_obs_array_t *a, u32 n_threads,
+                                   const u8 *buf, u32 len)
+{
+#ifdef LIBSWIFTNAV_ENABLE_PTHREADS
+  u32 n_chunks = MIN(n_threads, RTCM3_BULK_MAX_THREADS);
+  n_chunks = MIN(n_chunks, len / RTCM3_BULK_MIN_CHUNK);
+  if (n_chunks <= 1)
+    return rtcm3_decode_obs_bulk(a, buf, len);
+
+  obs_chunk_t chunks[RTCM3_BULK_MAX_THREADS];
+  u32 start = 0, base = a->n_obs;
+  for (u32 i = 0; i < n_chunks; i++) {
+    u32 end = len;
+    if (i < n_chunks - 1)
+      end = next_frame(buf, len, MAX(start, (u64)len * (i+1) / n_chunks));
+    u32 max_obs = rtcm3_obs_array_bound(end - start + RTCM3_MAX_FRAME_LEN);
+    if (base + max_obs > a->max_obs)
+      return rtcm3_decode_obs_bulk(a, buf, len);
+
+    obs_chunk_slice(&chunks[i].a, a, base, max_obs);
+    chunks[i].buf = buf;
+    chunks[i].len = len;
+    chunks[i].start = start;
+    chunks[i].end = end;
+    base += max_obs;
+    start = end;
+  }
+
+  parallel_run(chunks, n_chunks, sizeof(obs_chunk_t), obs_chunk_decode);
+
+  obs_chunk_merge(a, &chunks[0].a);
+  u32 stop = chunks[0].stop;
+  for (u32 i = 1; i < n_chunks; i++) {
+    obs_chunk_t *c = &chunks[i];
+    if (stop < c->start)
+      /* The previous chunk stopped early, as would a serial decode. */
+      break;
+    if (stop != c->start) {
+      /* The previous chunk's last frame overlapped this chunk's first. */
+      obs_chunk_slice(&c->a, a, c->a.tow - a->tow, c->a.max_obs);
+      c->start = stop;
+      c->stop = stop;
+      if (stop < c->end)
+        obs_chunk_decode(c);
+    }
+    obs_chunk_merge(a, &c->a);
+    stop = c->stop;
+  }
+
+  return stop;
+#else
+  (void)n_threads;
+  return rtcm3_decode_obs_bulk(a, buf, len);
+#endif
+}
+
 
 /** \} */
 /** \} */
 
-
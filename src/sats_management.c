@@ -124,7 +124,7 @@ void set_reference_sat_of_prns(u8 ref_prn, u8 num_sats, u8 *prns)
   u8 j;
   if (old_ref != ref_prn) {
     j = 1;
-    u8 old_prns[num_sats];
+    u8 old_prns[MAX_CHANNELS];
     memcpy(old_prns, prns, num_sats * sizeof(u8));
     u8 set_old_yet = 0;
     prns[0] = ref_prn;
@@ -163,7 +163,7 @@ void set_reference_sat(u8 ref_prn, sats_management_t *sats_management,
   u8 j;
   if (old_ref != ref_prn) {
     j = 1;
-    u8 old_prns[sats_management->num_sats];
+    u8 old_prns[MAX_CHANNELS];
     memcpy(old_prns, sats_management->prns, sats_management->num_sats * sizeof(u8));
     u8 set_old_yet = 0;
     sats_management->prns[0] = ref_prn;
@@ -288,7 +288,7 @@ s8 rebase_sats_management(sats_management_t *sats_management,
     return_code = OLD_REF;
   }
   else {
-    sdiff_t intersection_sats[num_sdiffs];
+    sdiff_t intersection_sats[MAX_CHANNELS];
     u8 num_intersection = intersect_sats(sats_management->num_sats, num_sdiffs,
                                          &(sats_management->prns[1]), sdiffs, intersection_sats);
     if (num_intersection < INTERSECTION_SATS_THRESHOLD_SIZE) {
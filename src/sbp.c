@@ -10,6 +10,8 @@
  * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
  */
 
+#include <string.h>
+
 #include "edc.h"
 
 #include "sbp.h"
@@ -54,6 +56,13 @@
  *
  * where `SBP_MY_MSG_TYPE` is the numerical identifier of your message type.
  *
+ * sbp_register_callback() allows only one callback per message type, use
+ * sbp_add_callback() to attach further callbacks to a message type and
+ * sbp_register_all_callback() for a callback that sees every message, e.g.
+ * for logging. Callbacks are kept in a small hash table so the cost of
+ * dispatching a message does not grow with the number of message types
+ * registered.
+ *
  * You must now call sbp_process() periodically whenever you have received SBP
  * data to be processed, e.g. from the serial port. Remember sbp_process() may
  * not use all available data so keep calling sbp_process() until all the
@@ -95,6 +104,28 @@
  * an object in the my_read function, you can use the context set
  * by calling sbp_state_set_io_context()
  *
+ * Receiving from a buffer
+ * -----------------------
+ *
+ * When the data already arrives in chunks, e.g. reading a log file or a
+ * serial driver with DMA, hand each chunk to sbp_process_buffer() instead.
+ * It decodes every complete message in the chunk in one call and keeps any
+ * trailing partial message in the #sbp_state_t until the next chunk arrives.
+ *
+ * ~~~
+ * u8 buff[4096];
+ * u32 n;
+ * while ((n = fread(buff, 1, sizeof(buff), f)) > 0) {
+ *   u32 offset = 0;
+ *   while (offset < n) {
+ *     u32 consumed;
+ *     if (sbp_process_buffer(&s, buff + offset, n - offset, &consumed) < 0)
+ *       crc_errors++;
+ *     offset += consumed;
+ *   }
+ * }
+ * ~~~
+ *
  *
  * Sending
  * -------
@@ -145,9 +176,98 @@
  * }
  * ~~~
  *
+ * Sending many messages
+ * ---------------------
+ *
+ * When several messages are produced together, e.g. a position, baseline,
+ * velocity and DOPs solution each epoch, add them to an #sbp_tx_buffer_t and
+ * write them all at once. sbp_tx_buffer_flush() calls `write` at most twice
+ * per flush, or take the pending data with sbp_tx_buffer_peek() and pass it
+ * to `writev()` yourself.
+ *
+ * ~~~
+ * static u8 tx_buff[4096];
+ * sbp_tx_buffer_t tx;
+ * sbp_tx_buffer_init(&tx, tx_buff, sizeof(tx_buff));
+ *
+ * sbp_tx_buffer_add(&tx, SBP_POS_LLH, MY_SENDER_ID, sizeof(pos), (u8*)&pos);
+ * sbp_tx_buffer_add(&tx, SBP_VEL_NED, MY_SENDER_ID, sizeof(vel), (u8*)&vel);
+ *
+ * sbp_tx_segment_t seg[2];
+ * struct iovec iov[2];
+ * u8 n = sbp_tx_buffer_peek(&tx, seg);
+ * for (u8 i = 0; i < n; i++) {
+ *   iov[i].iov_base = seg[i].data;
+ *   iov[i].iov_len = seg[i].len;
+ * }
+ * ssize_t written = writev(fd, iov, n);
+ * if (written > 0)
+ *   sbp_tx_buffer_consume(&tx, written);
+ * ~~~
+ *
  *
  * \{ */
 
+/** Bucket of the callback table holding the callbacks for a message type.
+ * Message types are a class in the high byte and an index within the class
+ * in the low byte. Indices are mostly small and sequential so they are used
+ * directly, with the class mixed in to spread the classes across the table.
+ */
+static inline u32 sbp_callback_bucket(u16 msg_type)
+{
+  return (msg_type ^ (7 * (msg_type >> 8))) & (SBP_CALLBACK_TABLE_SIZE - 1);
+}
+
+/** Append a node to the end of a callback list. */
+static void sbp_append_callback(sbp_msg_callbacks_node_t **head,
+                                sbp_msg_callbacks_node_t *node)
+{
+  /* The next pointer is set to NULL, i.e. this
+   * will be the new end of the linked list.
+   */
+  node->next = 0;
+
+  while (*head)
+    head = &(*head)->next;
+  *head = node;
+}
+
+/** Add a callback for a message type.
+ * Adds a callback that is called when a message with type msg_type is
+ * received. Any number of callbacks may be added for the same message type,
+ * they are called in the order they were added.
+ *
+ * \param msg_type Message type associated with callback
+ * \param cb       Pointer to message callback function
+ * \param context  Pointer to context for callback function
+ * \param node     Statically allocated #sbp_msg_callbacks_node_t struct
+ * \return `SBP_OK` (0) if successful, `SBP_NULL_ERROR` if `cb` or `node` was
+ *         NULL.
+ */
+s8 sbp_add_callback(sbp_state_t *s, u16 msg_type, sbp_msg_callback_t cb,
+                    void *context, sbp_msg_callbacks_node_t *node)
+{
+  /* Check our callback function pointer isn't NULL. */
+  if (cb == 0)
+    return SBP_NULL_ERROR;
+
+  /* Check our callback node pointer isn't NULL. */
+  if (node == 0)
+    return SBP_NULL_ERROR;
+
+  /* Fill in our new sbp_msg_callback_node_t. */
+  node->msg_type = msg_type;
+  node->cb = cb;
+  node->context = context;
+
+  /* Only this message type's bucket needs to be walked, which normally holds
+   * just the callbacks for this type. */
+  sbp_append_callback(&s->sbp_msg_callbacks[sbp_callback_bucket(msg_type)],
+                      node);
+
+  return SBP_OK;
+}
+
 /** Register a callback for a message type.
  * Register a callback that is called when a message
  * with type msg_type is received.
@@ -174,31 +294,37 @@ s8 sbp_register_callback(sbp_state_t *s, u16 msg_type, sbp_msg_callback_t cb, vo
   if (sbp_find_callback(s, msg_type) != 0)
     return SBP_CALLBACK_ERROR;
 
-  /* Fill in our new sbp_msg_callback_node_t. */
-  node->msg_type = msg_type;
+  return sbp_add_callback(s, msg_type, cb, context, node);
+}
+
+/** Register a callback for all message types.
+ * Register a callback that is called for every message received with a good
+ * CRC, after any callbacks for that message's type. Useful for logging and
+ * forwarding. Unlike the per-type callbacks it is of type
+ * #sbp_msg_all_callback_t and is also passed the message type. Any number of
+ * these callbacks may be registered, they are called in the order they were
+ * registered.
+ *
+ * \param cb       Pointer to message callback function
+ * \param context  Pointer to context for callback function
+ * \param node     Statically allocated #sbp_msg_all_callbacks_node_t struct
+ * \return `SBP_OK` (0) if successful, `SBP_NULL_ERROR` if `cb` or `node` was
+ *         NULL.
+ */
+s8 sbp_register_all_callback(sbp_state_t *s, sbp_msg_all_callback_t cb,
+                             void *context, sbp_msg_all_callbacks_node_t *node)
+{
+  if (cb == 0 || node == 0)
+    return SBP_NULL_ERROR;
+
   node->cb = cb;
   node->context = context;
-  /* The next pointer is set to NULL, i.e. this
-   * will be the new end of the linked list.
-   */
   node->next = 0;
 
-  /* If our linked list is empty then just
-   * add the new node to the start.
-   */
-  if (s->sbp_msg_callbacks_head == 0) {
-    s->sbp_msg_callbacks_head = node;
-    return SBP_OK;
-  }
-
-  /* Find the tail of our linked list and
-   * add our new node to the end.
-   */
-  sbp_msg_callbacks_node_t *p = s->sbp_msg_callbacks_head;
-  while (p->next)
-    p = p->next;
-
-  p->next = node;
+  sbp_msg_all_callbacks_node_t **head = &s->sbp_msg_callbacks_all;
+  while (*head)
+    head = &(*head)->next;
+  *head = node;
 
   return SBP_OK;
 }
@@ -208,13 +334,16 @@ s8 sbp_register_callback(sbp_state_t *s, u16 msg_type, sbp_msg_callback_t cb, vo
  */
 void sbp_clear_callbacks(sbp_state_t *s)
 {
-  /* Reset the head of the callbacks list to NULL. */
-  s->sbp_msg_callbacks_head = 0;
+  /* Reset the heads of the callbacks lists to NULL. */
+  for (u32 i = 0; i < SBP_CALLBACK_TABLE_SIZE; i++)
+    s->sbp_msg_callbacks[i] = 0;
+  s->sbp_msg_callbacks_all = 0;
 }
 
 /** Find the callback function associated with a message type.
- * Searches through the list of registered callbacks to find the callback
- * associated with the passed message type.
+ * Looks up the first callback registered for the passed message type. This
+ * is O(1) in the number of registered callbacks as long as the message types
+ * spread over the callback table, as they do for the standard SBP messages.
  *
  * \param msg_type Message type to find callback for
  * \return Pointer to callback node (#sbp_msg_callbacks_node_t) or `NULL` if
@@ -222,21 +351,15 @@ void sbp_clear_callbacks(sbp_state_t *s)
  */
 sbp_msg_callbacks_node_t* sbp_find_callback(sbp_state_t *s, u16 msg_type)
 {
-  /* If our list is empty, return NULL. */
-  if (!s->sbp_msg_callbacks_head)
-    return 0;
+  sbp_msg_callbacks_node_t *p = s->sbp_msg_callbacks[sbp_callback_bucket(msg_type)];
 
-  /* Traverse the linked list and return the callback
-   * function pointer if we find a node with a matching
+  /* Traverse the bucket and return the first node with a matching
    * message id.
    */
-  sbp_msg_callbacks_node_t *p = s->sbp_msg_callbacks_head;
-  do
+  for (; p; p = p->next)
     if (p->msg_type == msg_type)
       return p;
 
-  while ((p = p->next));
-
   /* Didn't find a matching callback, return NULL. */
   return 0;
 }
@@ -255,6 +378,8 @@ void sbp_state_init(sbp_state_t *s)
   /* Set the IO context pointer, passed to read and write functions, to NULL. */
   s->io_context = 0;
 
+  s->zero_copy = 0;
+
   /* Clear the callbacks, if any, currently in s */
   sbp_clear_callbacks(s);
 }
@@ -271,6 +396,65 @@ void sbp_state_set_io_context(sbp_state_t *s, void *context)
   s->io_context = context;
 }
 
+/** Turn zero-copy dispatch on or off for sbp_process_buffer().
+ * In zero-copy mode a message that lies entirely within the buffer passed to
+ * sbp_process_buffer() is handed to its callback as a pointer into that
+ * buffer, saving a copy of every payload. Only messages split across two
+ * buffers are staged in the #sbp_state_t. The callback must then treat `msg`
+ * as read only and must not keep the pointer after it returns. sbp_process()
+ * is not affected. Off by default.
+ *
+ * \param s State structure
+ * \param zero_copy Non-zero to turn zero-copy mode on
+ */
+void sbp_state_set_zero_copy(sbp_state_t *s, u8 zero_copy)
+{
+  s->zero_copy = zero_copy;
+}
+
+/** Calculate the CRC of the message held in the state structure. */
+static u16 sbp_msg_crc(sbp_state_t *s)
+{
+  u16 crc;
+
+  crc = crc16_ccitt((u8*)&(s->msg_type), 2, 0);
+  crc = crc16_ccitt((u8*)&(s->sender_id), 2, crc);
+  crc = crc16_ccitt(&(s->msg_len), 1, crc);
+  crc = crc16_ccitt(s->msg_buff, s->msg_len, crc);
+  return crc;
+}
+
+/** Check the CRC of a complete message and pass it to its callback.
+ *
+ * \param s State structure holding the message header and received CRC
+ * \param payload Message payload, either `s->msg_buff` or the caller's buffer
+ * \param crc CRC calculated over the received message
+ * \return As sbp_process() for a complete message.
+ */
+static s8 sbp_dispatch(sbp_state_t *s, u8 *payload, u16 crc)
+{
+  if (s->crc != crc)
+    return SBP_CRC_ERROR;
+
+  /* Message complete, process it. */
+  s8 ret = SBP_OK_CALLBACK_UNDEFINED;
+  sbp_msg_callbacks_node_t* node = sbp_find_callback(s, s->msg_type);
+  for (; node; node = node->next) {
+    if (node->msg_type == s->msg_type) {
+      (*node->cb)(s->sender_id, s->msg_len, payload, node->context);
+      ret = SBP_OK_CALLBACK_EXECUTED;
+    }
+  }
+  sbp_msg_all_callbacks_node_t* all_node;
+  for (all_node = s->sbp_msg_callbacks_all; all_node;
+       all_node = all_node->next) {
+    (*all_node->cb)(s->msg_type, s->sender_id, s->msg_len, payload,
+                    all_node->context);
+    ret = SBP_OK_CALLBACK_EXECUTED;
+  }
+  return ret;
+}
+
 /** Read and process SBP messages.
  * Reads bytes from an input source using the provided `read` function, decodes
  * the SBP framing and performs a CRC check on the message.
@@ -313,7 +497,6 @@ void sbp_state_set_io_context(sbp_state_t *s, void *context)
 s8 sbp_process(sbp_state_t *s, u32 (*read)(u8 *buff, u32 n, void *context))
 {
   u8 temp;
-  u16 crc;
 
   switch (s->state) {
   case WAITING:
@@ -368,24 +551,7 @@ s8 sbp_process(sbp_state_t *s, u32 (*read)(u8 *buff, u32 n, void *context))
                          2-s->n_read, s->io_context);
     if (s->n_read >= 2) {
       s->state = WAITING;
-
-      /* Swap bytes to little endian. */
-      crc = crc16_ccitt((u8*)&(s->msg_type), 2, 0);
-      crc = crc16_ccitt((u8*)&(s->sender_id), 2, crc);
-      crc = crc16_ccitt(&(s->msg_len), 1, crc);
-      crc = crc16_ccitt(s->msg_buff, s->msg_len, crc);
-      if (s->crc == crc) {
-
-        /* Message complete, process it. */
-        sbp_msg_callbacks_node_t* node = sbp_find_callback(s, s->msg_type);
-        if (node) {
-          (*node->cb)(s->sender_id, s->msg_len, s->msg_buff, node->context);
-          return SBP_OK_CALLBACK_EXECUTED;
-        } else {
-          return SBP_OK_CALLBACK_UNDEFINED;
-        }
-      } else
-          return SBP_CRC_ERROR;
+      return sbp_dispatch(s, s->msg_buff, sbp_msg_crc(s));
     }
     break;
 
@@ -397,6 +563,174 @@ s8 sbp_process(sbp_state_t *s, u32 (*read)(u8 *buff, u32 n, void *context))
   return SBP_OK;
 }
 
+/** Process a buffer of received SBP data.
+ * A push style alternative to sbp_process() for when the received data is
+ * already in memory. Decodes every complete message in `buf`, checking its
+ * CRC and calling its callback exactly as sbp_process() does.
+ *
+ * The preamble is found with memchr() and a message lying entirely within
+ * `buf` is decoded straight from it, so the cost is a few function calls per
+ * message rather than per byte. A message split across the end of `buf` is
+ * kept in `s` and completed by the next call, the two functions share the
+ * same state and may be mixed on one stream.
+ *
+ * Normally the payload passed to the callback is copied into `s` first. With
+ * zero-copy mode on, see sbp_state_set_zero_copy(), messages lying entirely
+ * within `buf` are instead passed as a pointer into `buf`.
+ *
+ * All of `buf` is consumed unless a message fails its CRC check, processing
+ * stops just after that message so the error can be reported and the caller
+ * should then call again with the remainder.
+ *
+ * \param s State structure
+ * \param buf Received data
+ * \param len Number of bytes in `buf`
+ * \param n_consumed If not NULL, set to the number of bytes of `buf` consumed
+ * \return Number of messages decoded with a good CRC, or `SBP_CRC_ERROR` (-2)
+ *         if a CRC error has occurred.
+ */
+s32 sbp_process_buffer(sbp_state_t *s, const u8 *buf, u32 len, u32 *n_consumed)
+{
+  const u8 *p = buf;
+  const u8 *end = buf + len;
+  s32 n_msgs = 0;
+  s8 ret = SBP_OK;
+
+  while (p < end && ret != SBP_CRC_ERROR) {
+    u32 avail = end - p;
+    u32 n;
+
+    switch (s->state) {
+    case WAITING: {
+      const u8 *preamble = memchr(p, SBP_PREAMBLE, avail);
+      if (!preamble) {
+        p = end;
+        break;
+      }
+      p = preamble + 1;
+      avail = end - p;
+
+      /* Type, sender, length, payload and CRC all present? Then decode the
+       * message directly from the buffer. */
+      if (avail >= 5 && avail >= 7u + p[4]) {
+        memcpy(&(s->msg_type), p, 2);
+        memcpy(&(s->sender_id), p + 2, 2);
+        s->msg_len = p[4];
+        memcpy(&(s->crc), p + 5 + s->msg_len, 2);
+        /* The header and payload are contiguous, check them in one go. */
+        u16 crc = crc16_ccitt(p, 5 + s->msg_len, 0);
+        u8 *payload = (u8 *)p + 5;
+        if (!s->zero_copy) {
+          memcpy(s->msg_buff, payload, s->msg_len);
+          payload = s->msg_buff;
+        }
+        p += 7 + s->msg_len;
+        ret = sbp_dispatch(s, payload, crc);
+        if (ret > 0)
+          n_msgs++;
+      } else {
+        s->n_read = 0;
+        s->state = GET_TYPE;
+      }
+      break;
+    }
+
+    case GET_TYPE:
+      n = MIN(avail, 2u - s->n_read);
+      memcpy((u8*)&(s->msg_type) + s->n_read, p, n);
+      p += n;
+      s->n_read += n;
+      if (s->n_read >= 2) {
+        s->n_read = 0;
+        s->state = GET_SENDER;
+      }
+      break;
+
+    case GET_SENDER:
+      n = MIN(avail, 2u - s->n_read);
+      memcpy((u8*)&(s->sender_id) + s->n_read, p, n);
+      p += n;
+      s->n_read += n;
+      if (s->n_read >= 2)
+        s->state = GET_LEN;
+      break;
+
+    case GET_LEN:
+      s->msg_len = *p++;
+      s->n_read = 0;
+      s->state = s->msg_len ? GET_MSG : GET_CRC;
+      break;
+
+    case GET_MSG:
+      n = MIN(avail, (u32)(s->msg_len - s->n_read));
+      memcpy(&(s->msg_buff[s->n_read]), p, n);
+      p += n;
+      s->n_read += n;
+      if (s->n_read >= s->msg_len) {
+        s->n_read = 0;
+        s->state = GET_CRC;
+      }
+      break;
+
+    case GET_CRC:
+      n = MIN(avail, 2u - s->n_read);
+      memcpy((u8*)&(s->crc) + s->n_read, p, n);
+      p += n;
+      s->n_read += n;
+      if (s->n_read >= 2) {
+        s->state = WAITING;
+        ret = sbp_dispatch(s, s->msg_buff, sbp_msg_crc(s));
+        if (ret > 0)
+          n_msgs++;
+      }
+      break;
+
+    default:
+      s->state = WAITING;
+      break;
+    }
+  }
+
+  if (n_consumed)
+    *n_consumed = p - buf;
+
+  if (ret == SBP_CRC_ERROR)
+    return SBP_CRC_ERROR;
+
+  return n_msgs;
+}
+
+/** Encode a complete SBP frame.
+ * Writes the preamble, header, payload and CRC of a message to `frame` in one
+ * go, ready to be written to the output stream with a single call.
+ *
+ * \param msg_type  Message type
+ * \param sender_id Sender ID
+ * \param len       Length of the payload
+ * \param payload   Pointer to the payload, may be NULL if `len` is 0
+ * \param frame     Output buffer of at least `SBP_FRAME_LEN(len)` bytes
+ * \return Length of the frame, `SBP_FRAME_LEN(len)`
+ */
+u32 sbp_encode_message(u16 msg_type, u16 sender_id, u8 len, const u8 *payload,
+                       u8 *frame)
+{
+  frame[0] = SBP_PREAMBLE;
+  frame[1] = msg_type & 0xFF;
+  frame[2] = msg_type >> 8;
+  frame[3] = sender_id & 0xFF;
+  frame[4] = sender_id >> 8;
+  frame[5] = len;
+  if (len > 0)
+    memcpy(&frame[6], payload, len);
+
+  /* The CRC covers everything but the preamble. */
+  u16 crc = crc16_ccitt(&frame[1], 5 + len, 0);
+  frame[6 + len] = crc & 0xFF;
+  frame[7 + len] = crc >> 8;
+
+  return SBP_FRAME_LEN(len);
+}
+
 /** Send SBP messages.
  * Takes an SBP message payload, type and sender ID then writes a message to
  * the output stream using the supplied `write` function with the correct
@@ -415,10 +749,10 @@ s8 sbp_process(sbp_state_t *s, u32 (*read)(u8 *buff, u32 n, void *context))
  * the number of bytes written is different from `n` then `sbp_send_message`
  * will immediately return with an error.
  *
- * Note that `sbp_send_message` makes multiple calls to write and therefore if
- * a `write` call fails then this may result in a partial message being written
- * to the output. This should be caught by the CRC check on the receiving end
- * but will result in lost messages.
+ * The whole frame is written with a single call to `write`, however if the
+ * call only writes part of it a partial message will be left in the output.
+ * This should be caught by the CRC check on the receiving end but will result
+ * in lost messages. To send many messages at once see #sbp_tx_buffer_t.
  *
  * \param write Function pointer to a function that writes `n` bytes from
  *              `buff` to the output stream  and returns the number of bytes
@@ -437,33 +771,162 @@ s8 sbp_send_message(sbp_state_t *s, u16 msg_type, u16 sender_id, u8 len, u8 *pay
   if (write == 0)
     return SBP_NULL_ERROR;
 
-  u16 crc;
+  u8 frame[SBP_MAX_FRAME_LEN];
+  u32 n = sbp_encode_message(msg_type, sender_id, len, payload, frame);
 
-  u8 preamble = SBP_PREAMBLE;
-  if ((*write)(&preamble, 1, s->io_context) != 1)
+  if ((*write)(frame, n, s->io_context) != n)
     return SBP_SEND_ERROR;
 
-  if ((*write)((u8*)&msg_type, 2, s->io_context) != 2)
-    return SBP_SEND_ERROR;
+  return SBP_OK;
+}
 
-  if ((*write)((u8*)&sender_id, 2, s->io_context) != 2)
-    return SBP_SEND_ERROR;
+/** Initialize an #sbp_tx_buffer_t.
+ *
+ * \param b    Transmit buffer to initialize
+ * \param buff Storage for the buffer
+ * \param size Size of `buff` in bytes
+ */
+void sbp_tx_buffer_init(sbp_tx_buffer_t *b, u8 *buff, u32 size)
+{
+  b->buff = buff;
+  b->size = size;
+  b->start = 0;
+  b->n_pending = 0;
+}
+
+/** Number of bytes waiting to be sent in an #sbp_tx_buffer_t. */
+u32 sbp_tx_buffer_pending(sbp_tx_buffer_t *b)
+{
+  return b->n_pending;
+}
+
+/** Number of bytes free in an #sbp_tx_buffer_t. */
+u32 sbp_tx_buffer_space(sbp_tx_buffer_t *b)
+{
+  return b->size - b->n_pending;
+}
+
+/** Add a message to an #sbp_tx_buffer_t.
+ * The complete frame is encoded into the buffer, to be sent with the other
+ * pending messages by sbp_tx_buffer_flush() or the caller's own gather-write
+ * using sbp_tx_buffer_peek(). Messages are either added whole or not at all.
+ *
+ * \param b         Transmit buffer
+ * \param msg_type  Message type
+ * \param sender_id Sender ID
+ * \param len       Length of the payload
+ * \param payload   Pointer to the payload, may be NULL if `len` is 0
+ * \return `SBP_OK` (0) if successful, `SBP_NULL_ERROR` if `payload` was NULL
+ *         and `len` not 0, `SBP_SEND_ERROR` if there is not enough space in
+ *         the buffer.
+ */
+s8 sbp_tx_buffer_add(sbp_tx_buffer_t *b, u16 msg_type, u16 sender_id, u8 len,
+                     const u8 *payload)
+{
+  if (len != 0 && payload == 0)
+    return SBP_NULL_ERROR;
 
-  if ((*write)(&len, 1, s->io_context) != 1)
+  u32 n = SBP_FRAME_LEN(len);
+  if (n > sbp_tx_buffer_space(b))
     return SBP_SEND_ERROR;
 
-  if (len > 0) {
-    if ((*write)(payload, len, s->io_context) != len)
-      return SBP_SEND_ERROR;
+  u32 end = b->start + b->n_pending;
+  if (end >= b->size)
+    end -= b->size;
+
+  if (end + n <= b->size) {
+    /* Encode straight into the buffer. */
+    sbp_encode_message(msg_type, sender_id, len, payload, &b->buff[end]);
+  } else {
+    /* The frame wraps around the end of the buffer. */
+    u8 frame[SBP_MAX_FRAME_LEN];
+    sbp_encode_message(msg_type, sender_id, len, payload, frame);
+    u32 n_first = b->size - end;
+    memcpy(&b->buff[end], frame, n_first);
+    memcpy(b->buff, &frame[n_first], n - n_first);
   }
+  b->n_pending += n;
 
-  crc = crc16_ccitt((u8*)&(msg_type), 2, 0);
-  crc = crc16_ccitt((u8*)&(sender_id), 2, crc);
-  crc = crc16_ccitt(&(len), 1, crc);
-  crc = crc16_ccitt(payload, len, crc);
+  return SBP_OK;
+}
 
-  if ((*write)((u8*)&crc, 2, s->io_context) != 2)
-    return SBP_SEND_ERROR;
+/** Get the pending data in an #sbp_tx_buffer_t.
+ * The pending data is returned as up to two contiguous segments, in order,
+ * suitable for a single `writev()` or `sendmsg()` call. The data stays in the
+ * buffer until released with sbp_tx_buffer_consume().
+ *
+ * \param b   Transmit buffer
+ * \param seg Output, the segments of pending data
+ * \return Number of segments filled in, 0, 1 or 2
+ */
+u8 sbp_tx_buffer_peek(sbp_tx_buffer_t *b, sbp_tx_segment_t seg[2])
+{
+  if (b->n_pending == 0)
+    return 0;
+
+  seg[0].data = &b->buff[b->start];
+  if (b->start + b->n_pending <= b->size) {
+    seg[0].len = b->n_pending;
+    return 1;
+  }
+
+  seg[0].len = b->size - b->start;
+  seg[1].data = b->buff;
+  seg[1].len = b->n_pending - seg[0].len;
+  return 2;
+}
+
+/** Release data that has been sent from an #sbp_tx_buffer_t.
+ *
+ * \param b Transmit buffer
+ * \param n Number of bytes sent from the start of the pending data
+ */
+void sbp_tx_buffer_consume(sbp_tx_buffer_t *b, u32 n)
+{
+  if (n >= b->n_pending) {
+    /* Empty, start again at the beginning so the next batch is contiguous. */
+    b->start = 0;
+    b->n_pending = 0;
+    return;
+  }
+
+  b->start += n;
+  if (b->start >= b->size)
+    b->start -= b->size;
+  b->n_pending -= n;
+}
+
+/** Write all the pending data in an #sbp_tx_buffer_t.
+ * Calls `write` once for each segment returned by sbp_tx_buffer_peek(), i.e.
+ * at most twice however many messages are pending. `write` has the same
+ * prototype as for sbp_send_message(). Data that was written is released
+ * even if the write was partial, so a later flush resumes where this one
+ * stopped.
+ *
+ * \param b       Transmit buffer
+ * \param write   Function pointer to a function that writes `n` bytes from
+ *                `buff` to the output stream and returns the number of bytes
+ *                successfully written.
+ * \param context Pointer passed to `write`
+ * \return `SBP_OK` (0) if all the pending data was written, `SBP_NULL_ERROR`
+ *         if `write` was NULL, `SBP_SEND_ERROR` if it was only partially
+ *         written.
+ */
+s8 sbp_tx_buffer_flush(sbp_tx_buffer_t *b,
+                       u32 (*write)(u8 *buff, u32 n, void *context),
+                       void *context)
+{
+  if (write == 0)
+    return SBP_NULL_ERROR;
+
+  sbp_tx_segment_t seg[2];
+  u8 n_segs = sbp_tx_buffer_peek(b, seg);
+  for (u8 i = 0; i < n_segs; i++) {
+    u32 n = (*write)(seg[i].data, seg[i].len, context);
+    sbp_tx_buffer_consume(b, n);
+    if (n != seg[i].len)
+      return SBP_SEND_ERROR;
+  }
 
   return SBP_OK;
 }
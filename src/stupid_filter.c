@@ -12,15 +12,13 @@
 
 #include <math.h>
 #include <string.h>
-#include <cblas.h>
 #include <stdio.h>
 
 #include "constants.h"
 #include "stupid_filter.h"
 #include "amb_kf.h"
 #include "linear_algebra.h"
-
-#include <lapacke.h>
+#include "small_matrix.h"
 
 /** Estimate the integer ambiguity vector from a double difference measurement
  * and a given baseline.
@@ -65,11 +63,7 @@ void amb_from_baseline(u8 num_sats, double *DE, double *dd_meas,
    * N_float <= beta * N_float + alpha * (DE . b)
    */
   memcpy(N_float, dd_meas, (num_sats-1) * sizeof(double));
-  cblas_dgemv(
-    CblasRowMajor, CblasNoTrans, num_sats-1, 3,
-    -1.0 / GPS_L1_LAMBDA_NO_VAC, DE, 3, b, 1,
-    1.0, N_float, 1
-  );
+  smat_gemv(num_sats-1, 3, -1.0 / GPS_L1_LAMBDA_NO_VAC, DE, b, 1.0, N_float);
 
   /* Round the values of N_float to estimate the integer valued ambiguities. */
   for (u8 i=0; i<num_sats-1; i++) {
@@ -174,9 +168,6 @@ void update_sats_stupid_filter(stupid_filter_state_t *s, u8 num_old, u8 *old_prn
 
 void lesq_solution(u8 num_dds, double *dd_meas, s32 *N, double *DE, double b[3], double *resid)
 {
-  double DE_work[num_dds*3];
-  memcpy(DE_work, DE, num_dds * 3 * sizeof(double));
-
   /* Solve for b via least squares, i.e.
    * dd_meas = DE . b + N
    *  =>  DE . b = (dd_meas - N) * lambda */
@@ -191,23 +182,11 @@ void lesq_solution(u8 num_dds, double *dd_meas, s32 *N, double *DE, double b[3],
     rhs[i] = (dd_meas[i] - N[i]) * GPS_L1_LAMBDA_NO_VAC;
   }
 
-  int jpvt[3] = {0, 0, 0};
-  int rank;
-  /* TODO: This function calls malloc to allocate work area, refactor to use
-   * LAPACKE_dgelsy_work instead. */
-  LAPACKE_dgelsy(
-    LAPACK_ROW_MAJOR, num_dds, 3,
-    1, DE_work, 3,
-    rhs, 1, jpvt,
-    -1, &rank
-  );
-  memcpy(b, rhs, 3*sizeof(double));
+  smat_lstsq(num_dds, 3, DE, rhs, b);
 
   if (resid) {
     /* Calculate Least Squares Residuals */
 
-    memcpy(DE_work, DE, num_dds * 3 * sizeof(double));
-
     /* resid <= dd_meas - N
      * alpha <= - 1.0 / GPS_L1_LAMBDA_NO_VAC
      * beta <= 1.0
@@ -216,11 +195,7 @@ void lesq_solution(u8 num_dds, double *dd_meas, s32 *N, double *DE, double b[3],
     for (u8 i=0; i<num_dds; i++) {
       resid[i] = dd_meas[i] - N[i];
     }
-    cblas_dgemv(
-      CblasRowMajor, CblasNoTrans, num_dds, 3,
-      -1.0 / GPS_L1_LAMBDA_NO_VAC, DE_work, 3, b, 1,
-      1.0, resid, 1
-    );
+    smat_gemv(num_dds, 3, -1.0 / GPS_L1_LAMBDA_NO_VAC, DE, b, 1.0, resid);
   }
 }
 
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2014 Swift Navigation Inc.
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* Micro-benchmark of the small matrix kernels against the BLAS / LAPACK calls
+ * they replaced, at the sizes a full MAX_CHANNELS DGNSS epoch uses.
+ *
+ * Build with `make bench_small_matrix`, run with an optional iteration count.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <cblas.h>
+#include <lapacke.h>
+
+#include <linear_algebra.h>
+#include <small_matrix.h>
+
+/* Dimensions of the amb_kf / ambiguity_test matrices with every channel in
+ * use (MAX_STATE_DIM, MAX_OBS_DIM and the DD observation count). */
+#define NUM_DDS  (MAX_CHANNELS - 1)
+#define RES_DIM  (2 * MAX_CHANNELS - 5)
+#define DD_DIM   (2 * NUM_DDS)
+#define NULL_DIM (NUM_DDS - 3)
+
+static double A[SMAT_MAX_DIM * SMAT_MAX_DIM];
+static double B[SMAT_MAX_DIM * SMAT_MAX_DIM];
+static double C[SMAT_MAX_DIM * SMAT_MAX_DIM];
+static double S[SMAT_MAX_DIM * SMAT_MAX_DIM];
+static double U[SMAT_MAX_DIM * SMAT_MAX_DIM];
+static double W[SMAT_MAX_DIM * SMAT_MAX_DIM];
+static double x[SMAT_MAX_DIM];
+static double y[SMAT_MAX_DIM];
+
+/* Keeps the compiler from discarding results. */
+static volatile double sink;
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+#define BENCH(name, iters, ...) do {                       \
+    double _t0 = now();                                    \
+    for (u32 _i = 0; _i < (iters); _i++) {                 \
+      __VA_ARGS__;                                         \
+      sink += W[0] + y[0];                                 \
+    }                                                      \
+    printf("  %-28s %9.1f ns\n", name,                     \
+           1e9 * (now() - _t0) / (iters));                 \
+  } while (0)
+
+static void fill(u32 n, double *v)
+{
+  for (u32 i = 0; i < n; i++)
+    v[i] = (double)rand() / RAND_MAX - 0.5;
+}
+
+int main(int argc, char **argv)
+{
+  u32 iters = (argc > 1) ? (u32)atoi(argv[1]) : 200000;
+  u8 piv[SMAT_MAX_DIM];
+  lapack_int ipiv[SMAT_MAX_DIM];
+  lapack_int jpvt[3];
+  lapack_int rank;
+
+  srand(1);
+  fill(SMAT_MAX_DIM * SMAT_MAX_DIM, A);
+  fill(SMAT_MAX_DIM * SMAT_MAX_DIM, B);
+  fill(SMAT_MAX_DIM * SMAT_MAX_DIM, U);
+  fill(SMAT_MAX_DIM, x);
+  /* Well conditioned SPD matrix for the inverse / LU benchmarks. */
+  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, RES_DIM, RES_DIM,
+              RES_DIM, 1, A, RES_DIM, A, RES_DIM, 0, S, RES_DIM);
+  for (u32 i = 0; i < RES_DIM; i++)
+    S[i*RES_DIM + i] += RES_DIM;
+
+  printf("backend: %s, %u iterations\n", linear_algebra_backend(), iters);
+
+  printf("gemv %ux%u\n", NULL_DIM, NUM_DDS);
+  BENCH("cblas_dgemv", iters,
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, NULL_DIM, NUM_DDS,
+                    1, A, NUM_DDS, x, 1, 0, y, 1));
+  BENCH("smat_gemv", iters,
+        smat_gemv(NULL_DIM, NUM_DDS, 1, A, x, 0, y));
+
+  printf("symv %u\n", RES_DIM);
+  BENCH("cblas_dsymv", iters,
+        cblas_dsymv(CblasRowMajor, CblasUpper, RES_DIM,
+                    1, S, RES_DIM, x, 1, 0, y, 1));
+  BENCH("smat_symv_upper", iters,
+        smat_symv_upper(RES_DIM, S, x, y));
+
+  printf("trmv %u\n", RES_DIM);
+  BENCH("cblas_dtrmv", iters,
+        cblas_dtrmv(CblasRowMajor, CblasUpper, CblasNoTrans, CblasUnit,
+                    RES_DIM, U, RES_DIM, y, 1));
+  BENCH("smat_trmv_unit_upper", iters,
+        smat_trmv_unit_upper(RES_DIM, U, y));
+
+  printf("residual covariance %ux%u\n", RES_DIM, DD_DIM);
+  BENCH("cblas_dsymm + cblas_dgemm", iters / 10, {
+        cblas_dsymm(CblasRowMajor, CblasRight, CblasUpper, RES_DIM, DD_DIM,
+                    1, A, DD_DIM, B, DD_DIM, 0, C, DD_DIM);
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, RES_DIM, RES_DIM,
+                    DD_DIM, 1, C, DD_DIM, B, DD_DIM, 0, W, RES_DIM);
+  });
+  BENCH("smat_symm + smat_gemm_nt", iters / 10, {
+        smat_symm_right_upper(RES_DIM, DD_DIM, 1, A, B, C);
+        smat_gemm_nt(RES_DIM, RES_DIM, DD_DIM, 1, C, B, W);
+  });
+
+  printf("spd inverse %u\n", RES_DIM);
+  BENCH("dpotrf + dpotri", iters / 10, {
+        memcpy(W, S, RES_DIM * RES_DIM * sizeof(double));
+        LAPACKE_dpotrf(LAPACK_ROW_MAJOR, 'U', RES_DIM, W, RES_DIM);
+        LAPACKE_dpotri(LAPACK_ROW_MAJOR, 'U', RES_DIM, W, RES_DIM);
+  });
+  BENCH("smat_spd_inverse", iters / 10, {
+        memcpy(W, S, RES_DIM * RES_DIM * sizeof(double));
+        smat_spd_inverse(RES_DIM, W);
+  });
+
+  printf("unit upper inverse %u\n", RES_DIM);
+  BENCH("dtrtri", iters / 10, {
+        memcpy(W, U, RES_DIM * RES_DIM * sizeof(double));
+        LAPACKE_dtrtri(LAPACK_ROW_MAJOR, 'U', 'U', RES_DIM, W, RES_DIM);
+  });
+  BENCH("smat_trtri_unit_upper", iters / 10, {
+        memcpy(W, U, RES_DIM * RES_DIM * sizeof(double));
+        smat_trtri_unit_upper(RES_DIM, W);
+  });
+
+  printf("least squares %ux3\n", NUM_DDS);
+  BENCH("dgelss", iters / 10, {
+        double s[3];
+        memcpy(W, A, NUM_DDS * 3 * sizeof(double));
+        memcpy(y, x, NUM_DDS * sizeof(double));
+        LAPACKE_dgelss(LAPACK_ROW_MAJOR, NUM_DDS, 3, 1, W, 3, y, 1,
+                       s, 1e-12, &rank);
+  });
+  BENCH("dgelsy", iters / 10, {
+        memset(jpvt, 0, sizeof(jpvt));
+        memcpy(W, A, NUM_DDS * 3 * sizeof(double));
+        memcpy(y, x, NUM_DDS * sizeof(double));
+        LAPACKE_dgelsy(LAPACK_ROW_MAJOR, NUM_DDS, 3, 1, W, 3, y, 1,
+                       jpvt, -1, &rank);
+  });
+  BENCH("smat_lstsq", iters / 10,
+        smat_lstsq(NUM_DDS, 3, A, x, y));
+
+  printf("lu solve %u\n", NUM_DDS);
+  BENCH("dgetrf + dgetrs", iters / 10, {
+        memcpy(W, S, NUM_DDS * NUM_DDS * sizeof(double));
+        memcpy(y, x, NUM_DDS * sizeof(double));
+        LAPACKE_dgetrf(LAPACK_ROW_MAJOR, NUM_DDS, NUM_DDS, W, NUM_DDS, ipiv);
+        LAPACKE_dgetrs(LAPACK_ROW_MAJOR, 'T', NUM_DDS, 1, W, NUM_DDS, ipiv,
+                       y, 1);
+  });
+  BENCH("smat_lu + smat_lu_solve", iters / 10, {
+        memcpy(W, S, NUM_DDS * NUM_DDS * sizeof(double));
+        memcpy(y, x, NUM_DDS * sizeof(double));
+        smat_lu(NUM_DDS, W, piv);
+        smat_lu_solve(NUM_DDS, W, piv, 1, y);
+  });
+
+  return 0;
+}
@@ -1,7 +1,11 @@
 
 #include <check.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include "amb_kf.h"
+#include "constants.h"
+#include "linear_algebra.h"
 #include "single_diff.h"
 #include "check_utils.h"
 
@@ -66,12 +70,146 @@ START_TEST(test_lsq) {
 }
 END_TEST
 
+void assign_residual_obs_cov(u8 num_dds, double phase_var, double code_var,
+                             double *q, double *r_cov);
+
+/* Check that M * Sig * M^T == diag(D) for an n x n Sig. */
+static void check_decorrelates(u32 n, double *M, double *Sig, double *D)
+{
+  for (u32 i=0; i<n; i++) {
+    for (u32 j=0; j<n; j++) {
+      double x = 0;
+      for (u32 k=0; k<n; k++) {
+        for (u32 l=0; l<n; l++) {
+          x += M[i*n + k] * Sig[k*n + l] * M[j*n + l];
+        }
+      }
+      fail_unless(fabs(x - (i == j ? D[i] : 0)) < 1e-9 * D[0],
+                  "(M Sig M^T)[%u][%u] = %g, expected %g",
+                  i, j, x, i == j ? D[i] : 0);
+    }
+  }
+}
+
+START_TEST(test_invert_U) {
+  /* invert_U() must give the actual inverse of a unit upper triangular U.
+   * The LAPACK version left U unchanged, so U * invert_U(U) was U^2. */
+  seed_rng();
+  for (u32 n=1; n<=MAX_OBS_DIM; n++) {
+    double U[MAX_OBS_DIM * MAX_OBS_DIM], U_inv[MAX_OBS_DIM * MAX_OBS_DIM];
+    for (u32 i=0; i<n; i++) {
+      for (u32 j=0; j<n; j++) {
+        U[i*n + j] = i == j ? 1 : (j > i ? frand(-0.5, 0.5) : 0);
+      }
+    }
+    memcpy(U_inv, U, n * n * sizeof(double));
+    invert_U(n, U_inv);
+    for (u32 i=0; i<n; i++) {
+      for (u32 j=0; j<n; j++) {
+        double x = 0;
+        for (u32 k=0; k<n; k++) {
+          x += U[i*n + k] * U_inv[k*n + j];
+        }
+        fail_unless(fabs(x - (i == j)) < 1e-9,
+                    "n = %u: (U U^-1)[%u][%u] = %g", n, i, j, x);
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_decorrelation_simple) {
+  /* With 4 sats there is no null space constraint and the DD covariance is
+   * v * (I + 1 1^T), whose UDU^T factors are known in closed form. */
+  sdiff_t sdiffs[4];
+  memset(sdiffs, 0, sizeof(sdiffs));
+  for (u8 i=0; i<4; i++) {
+    sdiffs[i].sat_pos[i % 3] = 2e7;
+    sdiffs[i].sat_pos[(i + 1) % 3] = 1e7 * i;
+  }
+  double ref_ecef[3] = {0, 0, 0};
+  double phase_var = 0.01, code_var = 1;
+  double v = phase_var + code_var / (GPS_L1_LAMBDA_NO_VAC * GPS_L1_LAMBDA_NO_VAC);
+
+  nkf_t kf;
+  set_nkf_matrices(&kf, phase_var, code_var, 4, sdiffs, ref_ecef);
+  fail_unless(kf.obs_dim == 3);
+
+  double U_inv[9] = {1, -1.0/3, -1.0/3,
+                     0,  1,     -0.5,
+                     0,  0,      1};
+  double D[3] = {4 * v / 3, 1.5 * v, 2 * v};
+  for (u8 i=0; i<9; i++) {
+    fail_unless(within_epsilon(kf.decor_mtx[i], U_inv[i]),
+                "decor_mtx[%u] = %f, expected %f", i, kf.decor_mtx[i], U_inv[i]);
+    fail_unless(within_epsilon(kf.decor_obs_mtx[i], U_inv[i]),
+                "decor_obs_mtx[%u] = %f, expected %f",
+                i, kf.decor_obs_mtx[i], U_inv[i]);
+  }
+  for (u8 i=0; i<3; i++) {
+    fail_unless(fabs(kf.decor_obs_cov[i] - D[i]) < 1e-12,
+                "decor_obs_cov[%u] = %g, expected %g",
+                i, kf.decor_obs_cov[i], D[i]);
+  }
+
+  double Sig[9];
+  for (u8 i=0; i<9; i++) {
+    Sig[i] = (i % 4 == 0) ? 2 * v : v;
+  }
+  check_decorrelates(3, kf.decor_mtx, Sig, kf.decor_obs_cov);
+}
+END_TEST
+
+START_TEST(test_decorrelation_constrained) {
+  /* With 5 sats the residual covariance includes a null space constraint,
+   * check that the decorrelation matrix whitens it and that the
+   * decorrelated observation matrix is decor_mtx * (Q; I). */
+  sdiff_t sdiffs[5];
+  double pos[5][3] = {{1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0, 0, 1}, {0, 1, 1}};
+  for (u8 i=0; i<5; i++) {
+    for (u8 j=0; j<3; j++) {
+      sdiffs[i].sat_pos[j] = 2e7 * pos[i][j];
+    }
+  }
+  double ref_ecef[3] = {1e6, 2e6, 3e6};
+  double phase_var = 0.01, code_var = 1;
+
+  nkf_t kf;
+  set_nkf_matrices(&kf, phase_var, code_var, 5, sdiffs, ref_ecef);
+  u32 n = kf.obs_dim;
+  fail_unless(n == 5);
+  fail_unless(kf.state_dim == 4);
+
+  double Sig[25];
+  assign_residual_obs_cov(4, phase_var, code_var, kf.null_basis_Q, Sig);
+  check_decorrelates(n, kf.decor_mtx, Sig, kf.decor_obs_cov);
+
+  double H[5 * 4];
+  memcpy(H, kf.null_basis_Q, 4 * sizeof(double));
+  matrix_eye(4, &H[4]);
+  for (u32 i=0; i<n; i++) {
+    for (u32 j=0; j<4; j++) {
+      double x = 0;
+      for (u32 k=0; k<n; k++) {
+        x += kf.decor_mtx[i*n + k] * H[k*4 + j];
+      }
+      fail_unless(within_epsilon(kf.decor_obs_mtx[i*4 + j], x),
+                  "decor_obs_mtx[%u][%u] = %f, expected %f",
+                  i, j, kf.decor_obs_mtx[i*4 + j], x);
+    }
+  }
+}
+END_TEST
+
 Suite* amb_kf_test_suite(void)
 {
   Suite *s = suite_create("Ambiguity Kalman Filter");
 
   TCase *tc_core = tcase_create("Core");
   tcase_add_test(tc_core, test_lsq);
+  tcase_add_test(tc_core, test_invert_U);
+  tcase_add_test(tc_core, test_decorrelation_simple);
+  tcase_add_test(tc_core, test_decorrelation_constrained);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -2,6 +2,7 @@
 #include <check.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include <ambiguity_test.h>
@@ -121,6 +122,53 @@ START_TEST(test_sats_match)
 }
 END_TEST
 
+// assure that projection merges the hypotheses that agree on the remaining
+// sats and leaves them in reverse order of their first appearance in the pool
+START_TEST(test_sat_projection_order)
+{
+  ambiguity_test_t amb_test;
+  create_ambiguity_test(&amb_test);
+
+  amb_test.sats.num_sats = 4;
+  amb_test.sats.prns[0] = 3;
+  amb_test.sats.prns[1] = 1;
+  amb_test.sats.prns[2] = 2;
+  amb_test.sats.prns[3] = 4;
+
+  s32 Ns[5][3] = {{1, 0, 2},
+                  {0, 5, 1},
+                  {1, 3, 2},
+                  {0, 0, 0},
+                  {0, 1, 1}};
+  for (u8 i=0; i<5; i++) {
+    hypothesis_t *hyp = (hypothesis_t *)memory_pool_add(amb_test.pool);
+    memcpy(hyp->N, Ns[i], sizeof(Ns[i]));
+    hyp->ll = 0;
+  }
+
+  u8 intersection_ndxs[2] = {0, 2};
+  fail_unless(ambiguity_sat_projection(&amb_test, 2, intersection_ndxs) == 1);
+  fail_unless(amb_test.sats.num_sats == 3);
+  fail_unless(amb_test.sats.prns[1] == 1);
+  fail_unless(amb_test.sats.prns[2] == 4);
+
+  hypothesis_t hyps[5];
+  fail_unless(memory_pool_to_array(amb_test.pool, hyps) == 3);
+  s32 expected_N[3][2] = {{1, 2}, {0, 0}, {0, 1}};
+  double expected_ll[3] = {log(2), 0, log(2)};
+  for (u8 i=0; i<3; i++) {
+    fail_unless(hyps[i].N[0] == expected_N[i][0] &&
+                hyps[i].N[1] == expected_N[i][1],
+                "Hypothesis %u is (%d, %d), expected (%d, %d)", i,
+                hyps[i].N[0], hyps[i].N[1],
+                expected_N[i][0], expected_N[i][1]);
+    fail_unless(fabs(hyps[i].ll - expected_ll[i]) < 1e-6,
+                "Hypothesis %u ll %f, expected %f", i,
+                hyps[i].ll, expected_ll[i]);
+  }
+}
+END_TEST
+
 
 Suite* ambiguity_test_suite(void)
 {
@@ -131,6 +179,7 @@ Suite* ambiguity_test_suite(void)
   tcase_add_test(tc_core, test_ambiguity_update_reference);
   tcase_add_test(tc_core, test_update_sats_same_sats);
   tcase_add_test(tc_core, test_update_sats_rebase);
+  tcase_add_test(tc_core, test_sat_projection_order);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -1,5 +1,7 @@
 
 #include <check.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <bits.h>
 
@@ -106,6 +108,128 @@ START_TEST(test_setbits)
 }
 END_TEST
 
+/* Bit at a time reference implementations. */
+static u32 ref_getbitu(const u8 *buff, u32 pos, u8 len)
+{
+  u32 bits = 0;
+  for (u32 i = pos; i < pos + len; i++)
+    bits = (bits << 1) + ((buff[i/8] >> (7 - i%8)) & 1u);
+  return bits;
+}
+
+static void ref_setbitu(u8 *buff, u32 pos, u32 len, u32 data)
+{
+  for (u32 i = pos, mask = 1u << (len - 1); i < pos + len; i++, mask >>= 1) {
+    if (data & mask)
+      buff[i/8] |= 1u << (7 - i % 8);
+    else
+      buff[i/8] &= ~(1u << (7 - i % 8));
+  }
+}
+
+START_TEST(test_bits_reference)
+{
+  u8 buff[16], ref[16];
+  srand(1);
+  for (u32 i = 0; i < sizeof(buff); i++)
+    buff[i] = rand();
+
+  for (u32 pos = 0; pos < 64; pos++) {
+    for (u8 len = 0; len <= 40; len++) {
+      u32 ret = getbitu(buff, pos, len);
+      u32 expected = ref_getbitu(buff, pos, len);
+      fail_unless(ret == expected,
+          "getbitu(%u, %u) expected 0x%08X, got 0x%08X",
+          pos, len, expected, ret);
+    }
+
+    for (u32 len = 1; len <= 32; len++) {
+      u32 data = rand();
+      memcpy(ref, buff, sizeof(buff));
+      ref_setbitu(ref, pos, len, data);
+      setbitu(buff, pos, len, data);
+      fail_unless(memcmp(buff, ref, sizeof(buff)) == 0,
+          "setbitu(%u, %u) changed the wrong bits", pos, len);
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_bit_reader_writer)
+{
+  u8 buff[32], ref[32];
+  u8 lens[40];
+  u32 data[40];
+
+  srand(2);
+  for (u32 i = 0; i < sizeof(buff); i++)
+    buff[i] = rand();
+  memcpy(ref, buff, sizeof(buff));
+
+  /* Write a run of fields from an unaligned position, the result must be the
+   * same as writing them with setbitu. */
+  bit_writer_t w;
+  bit_writer_init(&w, buff, sizeof(buff), 3);
+  u32 pos = 3;
+  u32 n_fields = 0;
+  while (n_fields < 40) {
+    u8 len = 1 + rand() % 32;
+    if (pos + len > 8*sizeof(buff) - 5)
+      break;
+    lens[n_fields] = len;
+    data[n_fields] = rand();
+    bit_writer_setu(&w, len, data[n_fields]);
+    setbitu(ref, pos, len, data[n_fields]);
+    pos += len;
+    n_fields++;
+  }
+  fail_unless(bit_writer_pos(&w) == pos, "Writer in wrong position");
+  bit_writer_flush(&w);
+  fail_unless(!w.overrun, "Writer overrun");
+  fail_unless(memcmp(buff, ref, sizeof(buff)) == 0,
+      "bit_writer output differs from setbitu");
+
+  /* And read them back. */
+  bit_reader_t r;
+  bit_reader_init(&r, buff, sizeof(buff), 3);
+  for (u32 i = 0; i < n_fields; i++) {
+    u32 mask = 0xFFFFFFFFu >> (32 - lens[i]);
+    u32 ret = bit_reader_getu(&r, lens[i]);
+    fail_unless(ret == (data[i] & mask),
+        "Field %u expected 0x%08X, got 0x%08X", i, data[i] & mask, ret);
+  }
+  fail_unless(bit_reader_pos(&r) == pos, "Reader in wrong position");
+  fail_unless(!r.overrun, "Reader overrun");
+
+  /* Signed fields. */
+  bit_writer_init(&w, buff, sizeof(buff), 14);
+  bit_writer_sets(&w, 3, -1);
+  bit_writer_sets(&w, 20, -12345);
+  bit_writer_sets(&w, 32, -1);
+  bit_writer_flush(&w);
+  bit_reader_init(&r, buff, sizeof(buff), 14);
+  fail_unless(bit_reader_gets(&r, 3) == -1, "Signed field 1 incorrect");
+  fail_unless(bit_reader_gets(&r, 20) == -12345, "Signed field 2 incorrect");
+  fail_unless(bit_reader_gets(&r, 32) == -1, "Signed field 3 incorrect");
+
+  /* Running off the end of the buffer. */
+  bit_reader_init(&r, buff, 2, 4);
+  bit_reader_getu(&r, 12);
+  fail_unless(!r.overrun, "Reader overrun too early");
+  fail_unless(bit_reader_getu(&r, 1) == 0 && r.overrun,
+      "Reader overrun not detected");
+
+  memcpy(ref, buff, sizeof(buff));
+  bit_writer_init(&w, buff, 2, 4);
+  bit_writer_setu(&w, 12, 0xABC);
+  bit_writer_setu(&w, 8, 0xFF);
+  fail_unless(w.overrun, "Writer overrun not detected");
+  fail_unless(memcmp(buff + 2, ref + 2, sizeof(buff) - 2) == 0,
+      "Writer wrote past the end of the buffer");
+  fail_unless(getbitu(buff, 4, 12) == 0xABC, "Writer lost data before overrun");
+}
+END_TEST
+
 Suite* bits_suite(void)
 {
   Suite *s = suite_create("Bit Utils");
@@ -115,6 +239,8 @@ Suite* bits_suite(void)
   tcase_add_test(tc_core, test_getbits);
   tcase_add_test(tc_core, test_setbitu);
   tcase_add_test(tc_core, test_setbits);
+  tcase_add_test(tc_core, test_bits_reference);
+  tcase_add_test(tc_core, test_bit_reader_writer);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -1,10 +1,16 @@
 
 #include <check.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
+#ifdef __GLIBC__
+#include <ucontext.h>
+#endif
 #include "linear_algebra.h"
 #include "check_utils.h"
 #include "dgnss_management.h"
 #include "ambiguity_test.h"
+#include "constants.h"
 
 extern sats_management_t sats_management;
 extern nkf_t nkf;
@@ -53,7 +59,7 @@ void check_dgnss_management_setup()
   nkf.state_dim = 4;
   nkf.obs_dim = 8;
 
-  create_ambiguity_test(&ambiguity_test);
+  dgnss_reset_iar();
 }
 
 void check_dgnss_management_teardown()
@@ -76,6 +82,78 @@ void matrix_eye_s32(u32 n, s32 *M)
   }
 }
 
+#ifdef __GLIBC__
+/* Counting allocator, interposed over the glibc one for the whole test
+ * binary. Allocations are only counted while `count_allocs` is set. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static volatile u8 count_allocs = 0;
+static volatile u32 n_allocs = 0;
+
+void *malloc(size_t size)
+{
+  if (count_allocs) n_allocs++;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+  if (count_allocs) n_allocs++;
+  return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+  if (count_allocs) n_allocs++;
+  return __libc_realloc(ptr, size);
+}
+
+#define EPOCH_STACK_SIZE (256 * 1024)
+#define EPOCH_STACK_BOUND (32 * 1024)
+#define EPOCH_STACK_PAINT 0xA5
+#define EPOCH_NUM_SATS 8
+
+static u8 epoch_stack[EPOCH_STACK_SIZE];
+static ucontext_t epoch_ctx, main_ctx;
+static sdiff_t epoch_sdiffs[MAX_CHANNELS];
+static double epoch_rx_ecef[3] = {-2704369.0, -4263211.0, 3884185.0};
+
+/* Fill `sdiffs` with a consistent set of single differences for a static
+ * 3 m baseline, with satellites slowly moving from epoch to epoch. */
+static void make_epoch_sdiffs(u32 epoch, u8 num_sats, sdiff_t *sds)
+{
+  double b[3] = {1.0, 2.0, -2.0};
+  for (u8 i = 0; i < num_sats; i++) {
+    double az = 2 * M_PI * i / EPOCH_NUM_SATS + 1e-4 * epoch;
+    double el = 0.3 + 0.8 * (i % 3) / 3.0;
+    double e[3] = {cos(el) * cos(az), cos(el) * sin(az), sin(el)};
+    sds[i].prn = 2 * i + 1;
+    for (u8 j = 0; j < 3; j++) {
+      sds[i].sat_pos[j] = epoch_rx_ecef[j] + 2.2e7 * e[j];
+      sds[i].sat_vel[j] = 0;
+    }
+    double range = e[0] * b[0] + e[1] * b[1] + e[2] * b[2];
+    sds[i].pseudorange = range;
+    sds[i].carrier_phase = range / GPS_L1_LAMBDA_NO_VAC + (s32)(3 * i) - 7;
+    sds[i].doppler = 0;
+    sds[i].snr = 40;
+  }
+}
+
+/* Run a sequence of epochs, temporarily losing the last satellite. */
+static void run_epochs(void)
+{
+  for (u32 epoch = 1; epoch < 40; epoch++) {
+    u8 num_sats = (epoch >= 20 && epoch < 25) ? EPOCH_NUM_SATS - 1
+                                              : EPOCH_NUM_SATS;
+    make_epoch_sdiffs(epoch, num_sats, epoch_sdiffs);
+    dgnss_update(num_sats, epoch_sdiffs, epoch_rx_ecef);
+  }
+}
+#endif
+
 /* Check that it works with the first sdiff as the reference sat.
  * This should verify that the loop can start correctly.*/
 START_TEST(test_dgnss_low_latency_float_baseline_ref_first) {
@@ -424,6 +502,60 @@ START_TEST(test_dgnss_low_latency_IAR_baseline_fixed_point) {
 }
 END_TEST
 
+/* Check that consecutive low latency IAR baselines follow the satellites and
+ * the reference position as they move, with the same resolved set and
+ * ambiguities. */
+START_TEST(test_dgnss_low_latency_IAR_baseline_moving_geometry) {
+  u8 ref_prn = 5;
+  u8 prns[4] = {1, 2, 3, 4};
+  s32 lower[4] = {0, 0, 0, 0};
+  s32 upper[4] = {0, 0, 0, 0};
+  s32 Z_inv[16];
+  matrix_eye_s32(4, Z_inv);
+  add_sats(&ambiguity_test, ref_prn, 4, prns, lower, upper, Z_inv);
+
+  ambiguity_test.amb_check.initialized = 1;
+  ambiguity_test.amb_check.num_matching_ndxs = 4;
+  for (u8 i = 0; i < 4; i++) {
+    ambiguity_test.amb_check.matching_ndxs[i] = i;
+    ambiguity_test.amb_check.ambs[i] = 3 * i - 2;
+  }
+
+  double b_true[3] = {1.5, -0.5, 2};
+  double b[3];
+  u8 num_used;
+  for (u8 k = 0; k < 3; k++) {
+    for (u8 i = 0; i < 5; i++) {
+      double e[3];
+      vector_subtract(3, sdiffs[i].sat_pos, ref_ecef, e);
+      sdiffs[i].carrier_phase = vector_dot(3, b_true, e) / vector_norm(3, e) /
+                                GPS_L1_LAMBDA_NO_VAC;
+      if (i != 4) {
+        sdiffs[i].carrier_phase += ambiguity_test.amb_check.ambs[i];
+      }
+    }
+    s8 valid = _dgnss_low_latency_IAR_baseline(6, sdiffs, ref_ecef,
+                                               &num_used, b);
+    fail_unless(valid == 0);
+    fail_unless(num_used == 5);
+    for (u8 j = 0; j < 3; j++) {
+      fail_unless(within_epsilon(b[j], b_true[j]),
+                  "Epoch %u: b[%u] = %f, expected %f",
+                  k, j, b[j], b_true[j]);
+    }
+
+    /* Move the satellites, and from the second epoch the reference
+     * position too, keeping the same resolved set and ambiguities. */
+    for (u8 i = 0; i < 5; i++) {
+      sdiffs[i].sat_pos[(i + k) % 3] += 0.5 + 0.1 * i;
+    }
+    if (k > 0) {
+      ref_ecef[k] -= 0.2;
+    }
+  }
+}
+END_TEST
+
 START_TEST(test_dgnss_low_latency_IAR_baseline_few_sats) {
   ambiguity_test.amb_check.initialized = 1;
   ambiguity_test.amb_check.num_matching_ndxs = 1;
@@ -482,6 +614,55 @@ START_TEST(test_dgnss_low_latency_baseline_uninitialized) {
 }
 END_TEST
 
+#ifdef __GLIBC__
+/* After the first (initialising) epoch, dgnss_update must not touch the heap
+ * and must run within a small fixed stack budget, including epochs where
+ * satellites are dropped and re-added. */
+START_TEST(test_dgnss_update_no_alloc_bounded_stack) {
+  /* Tight code variance so the ambiguity test gets populated quickly. */
+  dgnss_set_settings(DEFAULT_PHASE_VAR_TEST, 1e-2,
+                     DEFAULT_PHASE_VAR_KF, 1e-2,
+                     DEFAULT_AMB_DRIFT_VAR, DEFAULT_AMB_INIT_VAR,
+                     DEFAULT_NEW_INT_VAR);
+  make_epoch_sdiffs(0, EPOCH_NUM_SATS, epoch_sdiffs);
+  dgnss_init(EPOCH_NUM_SATS, epoch_sdiffs, epoch_rx_ecef);
+  dgnss_update(EPOCH_NUM_SATS, epoch_sdiffs, epoch_rx_ecef);
+
+  memset(epoch_stack, EPOCH_STACK_PAINT, sizeof(epoch_stack));
+  getcontext(&epoch_ctx);
+  epoch_ctx.uc_stack.ss_sp = epoch_stack;
+  epoch_ctx.uc_stack.ss_size = sizeof(epoch_stack);
+  epoch_ctx.uc_link = &main_ctx;
+  makecontext(&epoch_ctx, run_epochs, 0);
+
+  n_allocs = 0;
+  count_allocs = 1;
+  swapcontext(&main_ctx, &epoch_ctx);
+  count_allocs = 0;
+
+  u32 untouched = 0;
+  while (untouched < EPOCH_STACK_SIZE &&
+         epoch_stack[untouched] == EPOCH_STACK_PAINT) {
+    untouched++;
+  }
+  u32 used = EPOCH_STACK_SIZE - untouched;
+
+  dgnss_set_settings(DEFAULT_PHASE_VAR_TEST, DEFAULT_CODE_VAR_TEST,
+                     DEFAULT_PHASE_VAR_KF, DEFAULT_CODE_VAR_KF,
+                     DEFAULT_AMB_DRIFT_VAR, DEFAULT_AMB_INIT_VAR,
+                     DEFAULT_NEW_INT_VAR);
+
+  fail_unless(dgnss_iar_num_hyps() > 0,
+              "Ambiguity test was never populated");
+  fail_unless(n_allocs == 0,
+              "dgnss_update performed %u heap allocations", n_allocs);
+  fail_unless(used <= EPOCH_STACK_BOUND,
+              "dgnss_update used %u bytes of stack, bound is %u",
+              used, EPOCH_STACK_BOUND);
+}
+END_TEST
+#endif
+
 Suite* dgnss_management_test_suite(void)
 {
   Suite *s = suite_create("DGNSS Management");
@@ -499,9 +680,13 @@ Suite* dgnss_management_test_suite(void)
   tcase_add_test(tc_core, test_dgnss_low_latency_IAR_baseline_ref_middle);
   tcase_add_test(tc_core, test_dgnss_low_latency_IAR_baseline_ref_end);
   tcase_add_test(tc_core, test_dgnss_low_latency_IAR_baseline_fixed_point);
+  tcase_add_test(tc_core, test_dgnss_low_latency_IAR_baseline_moving_geometry);
   tcase_add_test(tc_core, test_dgnss_low_latency_IAR_baseline_few_sats);
   tcase_add_test(tc_core, test_dgnss_low_latency_IAR_baseline_uninitialized);
   tcase_add_test(tc_core, test_dgnss_low_latency_baseline_uninitialized);
+#ifdef __GLIBC__
+  tcase_add_test(tc_core, test_dgnss_update_no_alloc_bounded_stack);
+#endif
   suite_add_tcase(s, tc_core);
 
   return s;
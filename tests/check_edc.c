@@ -1,4 +1,5 @@
 #include <check.h>
+#include <stdlib.h>
 
 #include <edc.h>
 
@@ -45,6 +46,50 @@ START_TEST(test_crc24q)
 }
 END_TEST
 
+START_TEST(test_crc_implementations)
+{
+  /* The slicing-by-8 and folding implementations must match the byte at a
+   * time implementation exactly, for every length, alignment and initial
+   * value. */
+  static u8 buf[1100];
+  srand(1);
+  for (u32 i = 0; i < sizeof(buf); i++)
+    buf[i] = rand();
+
+  for (u32 offset = 0; offset < 4; offset++) {
+    for (u32 len = 0; len + offset <= sizeof(buf); len++) {
+      u16 init16 = (len * 0x9E37) & 0xFFFF;
+      u16 ref16 = crc16_ccitt_bytewise(buf + offset, len, init16);
+      u16 crc16 = crc16_ccitt_slice8(buf + offset, len, init16);
+      fail_unless(crc16 == ref16,
+        "crc16_ccitt_slice8 differs at offset %u len %u: 0x%04X vs 0x%04X",
+        offset, len, crc16, ref16);
+      crc16 = crc16_ccitt(buf + offset, len, init16);
+      fail_unless(crc16 == ref16,
+        "crc16_ccitt differs at offset %u len %u: 0x%04X vs 0x%04X",
+        offset, len, crc16, ref16);
+
+      u32 init24 = (len * 0x9E3779) & 0xFFFFFF;
+      u32 ref24 = crc24q_bytewise(buf + offset, len, init24);
+      u32 crc24 = crc24q_slice8(buf + offset, len, init24);
+      fail_unless(crc24 == ref24,
+        "crc24q_slice8 differs at offset %u len %u: 0x%06X vs 0x%06X",
+        offset, len, crc24, ref24);
+      crc24 = crc24q(buf + offset, len, init24);
+      fail_unless(crc24 == ref24,
+        "crc24q differs at offset %u len %u: 0x%06X vs 0x%06X",
+        offset, len, crc24, ref24);
+    }
+  }
+
+  /* And the CRC of a buffer can still be computed in pieces. */
+  u32 crc24 = crc24q(buf, 700, 0);
+  crc24 = crc24q(buf + 700, 400, crc24);
+  fail_unless(crc24 == crc24q_bytewise(buf, 1100, 0),
+    "crc24q of a buffer in two pieces differs");
+}
+END_TEST
+
 Suite* edc_suite(void)
 {
   Suite *s = suite_create("Error Detection and Correction");
@@ -52,6 +97,7 @@ Suite* edc_suite(void)
   TCase *tc_crc = tcase_create("CRC");
   tcase_add_test(tc_crc, test_crc16_ccitt);
   tcase_add_test(tc_crc, test_crc24q);
+  tcase_add_test(tc_crc, test_crc_implementations);
   suite_add_tcase(s, tc_crc);
 
   return s;
@@ -0,0 +1,303 @@
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <lambda.h>
+
+#include "check_utils.h"
+
+#define LAMBDA_TEST_CANDS 2
+
+/* Fill Q with a random, well conditioned but strongly correlated SPD matrix,
+ * Q = A * A' + n * I. */
+static void random_cov(u32 n, double *Q)
+{
+  double A[n * n];
+  for (u32 i=0; i < n*n; i++) {
+    A[i] = frand(-3, 3);
+  }
+  for (u32 i=0; i < n; i++) {
+    for (u32 j=0; j < n; j++) {
+      Q[i*n + j] = (i == j) ? n : 0;
+      for (u32 k=0; k < n; k++) {
+        Q[i*n + j] += A[i*n + k] * A[j*n + k];
+      }
+    }
+  }
+}
+
+START_TEST(test_lambda_solution_ws_diagonal)
+{
+  double Q[9] = {0.1, 0,   0,
+                 0,   0.2, 0,
+                 0,   0,   0.3};
+  double a[3] = {1.2, -3.9, 7.4};
+  double F[3 * LAMBDA_TEST_CANDS];
+  double s[LAMBDA_TEST_CANDS];
+  lambda_workspace_t ws;
+
+  s32 ret = lambda_solution_ws(&ws, 3, LAMBDA_TEST_CANDS, a, Q, F, s);
+  fail_unless(ret == 0, "lambda_solution_ws returned %d", ret);
+
+  /* With an uncorrelated covariance the best candidate is simple rounding. */
+  fail_unless(F[0] == 1 && F[1] == -4 && F[2] == 7,
+              "Best candidate should be [1 -4 7], got [%f %f %f]",
+              F[0], F[1], F[2]);
+  fail_unless(s[0] <= s[1], "Candidates should be sorted by residual");
+}
+END_TEST
+
+START_TEST(test_lambda_solution_ws_matches)
+{
+  seed_rng();
+  lambda_workspace_t ws;
+
+  for (u32 n=1; n <= LAMBDA_MAX_DIM; n++) {
+    double Q[n * n];
+    double a[n];
+    double F[n * LAMBDA_TEST_CANDS], F_ws[n * LAMBDA_TEST_CANDS];
+    double s[LAMBDA_TEST_CANDS], s_ws[LAMBDA_TEST_CANDS];
+
+    random_cov(n, Q);
+    for (u32 i=0; i < n; i++) {
+      a[i] = frand(-100, 100);
+    }
+
+    s32 ret = lambda_solution(n, LAMBDA_TEST_CANDS, a, Q, F, s);
+    fail_unless(ret == 0, "lambda_solution returned %d for n = %u", ret, n);
+    ret = lambda_solution_ws(&ws, n, LAMBDA_TEST_CANDS, a, Q, F_ws, s_ws);
+    fail_unless(ret == 0, "lambda_solution_ws returned %d for n = %u", ret, n);
+
+    for (u32 i=0; i < LAMBDA_TEST_CANDS; i++) {
+      fail_unless(within_epsilon(s[i], s_ws[i]),
+                  "Residual %u differs for n = %u: %f vs %f",
+                  i, n, s[i], s_ws[i]);
+    }
+    for (u32 i=0; i < n * LAMBDA_TEST_CANDS; i++) {
+      fail_unless(F_ws[i] == round(F_ws[i]),
+                  "Fixed solution should be integer, got %f", F_ws[i]);
+      fail_unless(within_epsilon(F[i], F_ws[i]),
+                  "Fixed solution element %u differs for n = %u: %f vs %f",
+                  i, n, F[i], F_ws[i]);
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_lambda_reduction_ws_matches)
+{
+  seed_rng();
+  lambda_workspace_t ws;
+
+  for (u32 n=1; n <= LAMBDA_MAX_DIM; n++) {
+    double Q[n * n];
+    double Z[n * n], Z_ws[n * n];
+
+    random_cov(n, Q);
+    lambda_reduction(n, Q, Z);
+    s32 ret = lambda_reduction_ws(&ws, n, Q, Z_ws);
+    fail_unless(ret == 0, "lambda_reduction_ws returned %d for n = %u", ret, n);
+
+    for (u32 i=0; i < n * n; i++) {
+      fail_unless(Z[i] == Z_ws[i],
+                  "Z element %u differs for n = %u: %f vs %f",
+                  i, n, Z[i], Z_ws[i]);
+    }
+
+    /* ws.Zi holds the exact inverse of Z. */
+    for (u32 i=0; i < n; i++) {
+      for (u32 j=0; j < n; j++) {
+        double acc = 0;
+        for (u32 k=0; k < n; k++) {
+          acc += Z_ws[i + n*k] * ws.Zi[k + n*j];
+        }
+        fail_unless(acc == (i == j ? 1 : 0),
+                    "Z * Zi element (%u, %u) is %f for n = %u", i, j, acc, n);
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_lambda_ws_bad_dims)
+{
+  lambda_workspace_t ws;
+  double Q[1] = {1}, a[1] = {0}, F[LAMBDA_MAX_CANDS + 1], s[LAMBDA_MAX_CANDS + 1];
+
+  fail_unless(lambda_solution_ws(&ws, 0, 1, a, Q, F, s) < 0);
+  fail_unless(lambda_solution_ws(&ws, LAMBDA_MAX_DIM + 1, 1, a, Q, F, s) < 0);
+  fail_unless(lambda_solution_ws(&ws, 1, LAMBDA_MAX_CANDS + 1, a, Q, F, s) < 0);
+  fail_unless(lambda_reduction_ws(&ws, LAMBDA_MAX_DIM + 1, Q, F) < 0);
+}
+END_TEST
+
+START_TEST(test_lambda_search_ws_full_fix)
+{
+  seed_rng();
+  lambda_workspace_t ws;
+  lambda_search_params_t params = {.m = LAMBDA_TEST_CANDS};
+  lambda_search_stats_t stats;
+
+  for (u32 n=1; n <= LAMBDA_MAX_DIM; n++) {
+    double Q[n * n];
+    double a[n];
+    double F[n * LAMBDA_TEST_CANDS], F_ws[n * LAMBDA_TEST_CANDS];
+    double s[LAMBDA_TEST_CANDS], s_ws[LAMBDA_TEST_CANDS];
+
+    random_cov(n, Q);
+    for (u32 i=0; i < n; i++) {
+      a[i] = frand(-100, 100);
+    }
+
+    lambda_solution_ws(&ws, n, LAMBDA_TEST_CANDS, a, Q, F_ws, s_ws);
+    s32 ret = lambda_search_ws(&ws, n, a, Q, &params, F, s, &stats);
+    fail_unless(ret == 0, "lambda_search_ws returned %d for n = %u", ret, n);
+    fail_unless(stats.n_fixed == n,
+                "All %u ambiguities should be fixed, got %u", n, stats.n_fixed);
+    fail_unless(stats.n_cands == LAMBDA_TEST_CANDS);
+    fail_unless(stats.nodes >= n && stats.leaves >= LAMBDA_TEST_CANDS);
+
+    for (u32 i=0; i < LAMBDA_TEST_CANDS; i++) {
+      fail_unless(s[i] == s_ws[i], "Residual %u differs for n = %u", i, n);
+    }
+    for (u32 i=0; i < n * LAMBDA_TEST_CANDS; i++) {
+      fail_unless(F[i] == F_ws[i], "Element %u differs for n = %u", i, n);
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_lambda_search_ws_partial)
+{
+  double Q[9] = {0.001, 0,  0,
+                 0,     10, 0,
+                 0,     0,  0.002};
+  double a[3] = {1.2, 3.7, -2.1};
+  double F[3 * LAMBDA_TEST_CANDS];
+  double s[LAMBDA_TEST_CANDS];
+  lambda_workspace_t ws;
+  lambda_search_params_t params = {.m = LAMBDA_TEST_CANDS,
+                                   .min_success_rate = 0.99};
+  lambda_search_stats_t stats;
+
+  s32 ret = lambda_search_ws(&ws, 3, a, Q, &params, F, s, &stats);
+  fail_unless(ret == 0, "lambda_search_ws returned %d", ret);
+  fail_unless(stats.n_fixed == 2,
+              "Only the two precise ambiguities should be fixed, got %u",
+              stats.n_fixed);
+  fail_unless(stats.success_rate >= 0.99 && stats.success_rate <= 1);
+  fail_unless(F[0] == 1 && F[2] == -2,
+              "Precise ambiguities should be fixed to [1 -2], got [%f %f]",
+              F[0], F[2]);
+  fail_unless(within_epsilon(F[1], 3.7),
+              "Imprecise ambiguity should stay at its float value, got %f",
+              F[1]);
+
+  /* Nothing reaches an impossible success rate. */
+  params.min_success_rate = 1.5;
+  ret = lambda_search_ws(&ws, 3, a, Q, &params, F, s, &stats);
+  fail_unless(ret == 0 && stats.n_fixed == 0);
+  fail_unless(F[0] == a[0] && F[1] == a[1] && F[2] == a[2]);
+}
+END_TEST
+
+START_TEST(test_lambda_search_ws_ratio)
+{
+  seed_rng();
+  lambda_workspace_t ws;
+  lambda_search_params_t params = {.m = LAMBDA_TEST_CANDS};
+  lambda_search_stats_t stats, stats_pruned;
+  double ratio = 2;
+
+  for (u32 n=1; n <= LAMBDA_MAX_DIM; n++) {
+    double Q[n * n];
+    double a[n];
+    double F[n * LAMBDA_TEST_CANDS];
+    double s[LAMBDA_TEST_CANDS], s_pruned[LAMBDA_TEST_CANDS];
+
+    random_cov(n, Q);
+    for (u32 i=0; i < n*n; i++) {
+      Q[i] *= 0.01;
+    }
+    for (u32 i=0; i < n; i++) {
+      a[i] = frand(-100, 100);
+    }
+
+    params.ratio = 0;
+    lambda_search_ws(&ws, n, a, Q, &params, F, s, &stats);
+    params.ratio = ratio;
+    s32 ret = lambda_search_ws(&ws, n, a, Q, &params, F, s_pruned,
+                               &stats_pruned);
+    fail_unless(ret == 0, "lambda_search_ws returned %d for n = %u", ret, n);
+
+    fail_unless(stats_pruned.leaves <= stats.leaves,
+                "Pruning should not evaluate more candidates");
+    fail_unless(s_pruned[0] == s[0], "Best candidate should be unchanged");
+    fail_unless(stats_pruned.ratio_passed == (s[1] >= ratio * s[0]),
+                "Ratio test outcome differs for n = %u", n);
+  }
+}
+END_TEST
+
+START_TEST(test_lambda_search_parallel)
+{
+  seed_rng();
+  lambda_workspace_t ws;
+  lambda_search_params_t params = {.m = LAMBDA_TEST_CANDS};
+  lambda_search_stats_t stats, stats_par;
+
+  for (u32 t=0; t < 20; t++) {
+    for (u32 n=1; n <= LAMBDA_MAX_DIM; n++) {
+      double Q[n * n];
+      double a[n];
+      double F[n * LAMBDA_TEST_CANDS], F_par[n * LAMBDA_TEST_CANDS];
+      double s[LAMBDA_TEST_CANDS], s_par[LAMBDA_TEST_CANDS];
+
+      random_cov(n, Q);
+      for (u32 i=0; i < n; i++) {
+        a[i] = frand(-100, 100);
+      }
+      params.ratio = (t % 2) ? 3 : 0;
+
+      s32 ret = lambda_search_ws(&ws, n, a, Q, &params, F, s, &stats);
+      s32 ret_par = lambda_search_parallel(&ws, n, a, Q, &params, 4,
+                                           F_par, s_par, &stats_par);
+      fail_unless(ret == 0 && ret_par == 0,
+                  "Search returned %d, parallel search %d", ret, ret_par);
+      fail_unless(stats.n_cands == stats_par.n_cands,
+                  "Number of candidates differs for n = %u", n);
+      fail_unless(stats.ratio_passed == stats_par.ratio_passed);
+
+      for (u32 i=0; i < stats.n_cands; i++) {
+        fail_unless(within_epsilon(s[i], s_par[i]),
+                    "Residual %u differs for n = %u: %f vs %f",
+                    i, n, s[i], s_par[i]);
+      }
+      for (u32 i=0; i < n; i++) {
+        fail_unless(F[i] == F_par[i],
+                    "Best candidate element %u differs for n = %u", i, n);
+      }
+    }
+  }
+}
+END_TEST
+
+Suite* lambda_suite(void)
+{
+  Suite *s = suite_create("LAMBDA");
+
+  TCase *tc_core = tcase_create("Core");
+  tcase_add_test(tc_core, test_lambda_solution_ws_diagonal);
+  tcase_add_test(tc_core, test_lambda_solution_ws_matches);
+  tcase_add_test(tc_core, test_lambda_reduction_ws_matches);
+  tcase_add_test(tc_core, test_lambda_ws_bad_dims);
+  tcase_add_test(tc_core, test_lambda_search_ws_full_fix);
+  tcase_add_test(tc_core, test_lambda_search_ws_partial);
+  tcase_add_test(tc_core, test_lambda_search_ws_ratio);
+  tcase_add_test(tc_core, test_lambda_search_parallel);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
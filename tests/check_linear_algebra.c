@@ -1,5 +1,7 @@
+#include <float.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 
 #include <stdio.h>
@@ -152,6 +154,141 @@ START_TEST(test_matrix_inverse_5x5) {
 }
 END_TEST
 
+START_TEST(test_matrix_cholesky) {
+  u32 i, j, k, t, n;
+  double A[MSIZE_MAX], C[8*8], L[8*8], Cinv[8*8], I[8*8];
+
+  seed_rng();
+  for (t = 0; t < LINALG_NUM; t++) {
+    n = 1 + t % 8;
+    /* C := A^{T} A + I is symmetric positive definite */
+    for (i = 0; i < n*n; i++)
+      A[i] = frand(-1, 1);
+    matrix_atwa(n, n, A, NULL, C);
+    for (i = 0; i < n; i++)
+      C[n*i + i] += 1;
+    fail_unless(matrix_cholesky(n, C, L) == 0,
+                "Cholesky failed on positive definite matrix");
+    for (i = 0; i < n; i++)
+      for (j = 0; j < n; j++) {
+        double llt = 0;
+        for (k = 0; k < n; k++)
+          llt += L[n*i + k] * L[n*j + k];
+        fail_unless(fabs(llt - C[n*i + j]) < LINALG_TOL,
+                    "L L^T differs from C by %lf", llt - C[n*i + j]);
+        if (j > i)
+          fail_unless(L[n*i + j] == 0, "L is not lower triangular");
+      }
+    matrix_cholesky_inverse(n, L, Cinv);
+    matrix_multiply(n, n, n, C, Cinv, I);
+    for (i = 0; i < n; i++)
+      for (j = 0; j < n; j++)
+        fail_unless(fabs(I[n*i + j] - (i == j)) < LINALG_TOL,
+                    "C C^{-1} differs from identity: %lf", I[n*i + j]);
+    /* In place */
+    matrix_cholesky_inverse(n, L, L);
+    for (i = 0; i < n*n; i++)
+      fail_unless(L[i] == Cinv[i], "In place inverse differs");
+  }
+  /* Not positive definite */
+  for (i = 0; i < 9; i++)
+    C[i] = 1;
+  fail_unless(matrix_cholesky(3, C, L) < 0,
+              "Singular matrix not detected.");
+}
+END_TEST
+
+START_TEST(test_solve_normal_equations) {
+  u32 i, t, n, m;
+  double A[12*4], w[12], y[12], x_ne[4], x_qr[4], x_inv[4], x_l[4];
+  double B[4*12], L[4*4];
+
+  seed_rng();
+  for (t = 0; t < LINALG_NUM; t++) {
+    m = 1 + t % 4;
+    n = m + 1 + t % 8;
+    for (i = 0; i < n*m; i++)
+      A[i] = frand(-1, 1);
+    for (i = 0; i < n; i++) {
+      w[i] = frand(0.1, 10);
+      y[i] = mrand;
+    }
+    /* Against the explicit (A^{T} W A)^{-1} A^{T} W y */
+    fail_unless(solve_normal_equations(n, m, A, w, y, x_ne, L) == 0,
+                "Normal equations solve failed");
+    fail_unless(matrix_atwaiat(n, m, A, w, B) == 0,
+                "matrix_atwaiat failed");
+    for (i = 0; i < m; i++) {
+      u32 k;
+      x_inv[i] = 0;
+      for (k = 0; k < n; k++)
+        x_inv[i] += B[n*i + k] * w[k] * y[k];
+    }
+    fail_unless(weighted_least_squares(n, m, A, w, y, x_qr) == 0,
+                "QR least squares failed");
+    for (i = 0; i < m; i++) {
+      fail_unless(fabs(x_ne[i] - x_inv[i]) < LINALG_TOL * MATRIX_MAX,
+                  "Normal equations differ from inverse by %lf",
+                  x_ne[i] - x_inv[i]);
+      fail_unless(fabs(x_ne[i] - x_qr[i]) < LINALG_TOL * MATRIX_MAX,
+                  "Normal equations differ from QR by %lf",
+                  x_ne[i] - x_qr[i]);
+    }
+    /* The returned factor solves the same system again */
+    double aty[4];
+    for (i = 0; i < m; i++) {
+      u32 k;
+      aty[i] = 0;
+      for (k = 0; k < n; k++)
+        aty[i] += A[m*k + i] * w[k] * y[k];
+    }
+    matrix_cholesky_solve(m, L, aty, x_l);
+    for (i = 0; i < m; i++)
+      fail_unless(fabs(x_ne[i] - x_l[i]) < LINALG_TOL * MATRIX_MAX,
+                  "Cholesky factor solve differs by %lf", x_ne[i] - x_l[i]);
+  }
+  /* Underdetermined and rank deficient systems */
+  fail_unless(solve_normal_equations(2, 3, A, NULL, y, x_ne, NULL) < 0,
+              "n < m not detected.");
+  for (i = 0; i < 6*2; i++)
+    A[i] = 1;
+  fail_unless(solve_normal_equations(6, 2, A, NULL, y, x_ne, NULL) < 0,
+              "Rank deficient matrix not detected.");
+  fail_unless(weighted_least_squares(6, 2, A, NULL, y, x_qr) < 0,
+              "Rank deficient matrix not detected.");
+}
+END_TEST
+
+START_TEST(test_matrix_pseudoinverse_identities) {
+  u32 i, j, t, n, m;
+  double A[4*8], B[8*4], I[8*8];
+
+  seed_rng();
+  for (t = 0; t < LINALG_NUM; t++) {
+    /* Tall: (A^{T} A)^{-1} A^{T} is a left inverse */
+    m = 1 + t % 4;
+    n = m + 1 + t % 4;
+    for (i = 0; i < n*m; i++)
+      A[i] = frand(-1, 1);
+    fail_unless(matrix_ataiat(n, m, A, B) == 0, "matrix_ataiat failed");
+    matrix_multiply(m, n, m, B, A, I);
+    for (i = 0; i < m; i++)
+      for (j = 0; j < m; j++)
+        fail_unless(fabs(I[m*i + j] - (i == j)) < LINALG_TOL,
+                    "B A differs from identity: %lf", I[m*i + j]);
+    /* Wide: A^{T} (A A^{T})^{-1} is a right inverse */
+    fail_unless(matrix_ataati(m, n, A, B) == 0, "matrix_ataati failed");
+    matrix_multiply(m, n, m, A, B, I);
+    for (i = 0; i < m; i++)
+      for (j = 0; j < m; j++)
+        fail_unless(fabs(I[m*i + j] - (i == j)) < LINALG_TOL,
+                    "A B differs from identity: %lf", I[m*i + j]);
+  }
+  fail_unless(matrix_ataiat(2, 2, A, B) < 0, "n <= m not detected.");
+  fail_unless(matrix_ataati(2, 2, A, B) < 0, "n >= m not detected.");
+}
+END_TEST
+
 START_TEST(test_matrix_eye)
 {
   double M[10][10];
@@ -615,6 +752,126 @@ START_TEST(test_vector_three) {
 }
 END_TEST
 
+/* Exhaustive checks of the SIMD primitives against the portable scalar
+ * implementations, over every vector / matrix size up to SIMD_SIZE_MAX
+ * (covering all the vector body / tail splits) and every pointer alignment
+ * mod 32 bytes. Reductions may be reassociated so are compared to within
+ * rounding of the sum of absolute terms. */
+
+#define SIMD_SIZE_MAX 19
+#define SIMD_OFFSETS 4
+
+static void fill_rand(u32 n, double *a)
+{
+  for (u32 i = 0; i < n; i++)
+    a[i] = mrand;
+}
+
+START_TEST(test_simd_vector_dot_norm) {
+  double A[SIMD_SIZE_MAX + SIMD_OFFSETS], B[SIMD_SIZE_MAX + SIMD_OFFSETS];
+
+  seed_rng();
+  for (u32 n = 0; n <= SIMD_SIZE_MAX; n++)
+    for (u32 oa = 0; oa < SIMD_OFFSETS; oa++)
+      for (u32 ob = 0; ob < SIMD_OFFSETS; ob++) {
+        const double *a = &A[oa], *b = &B[ob];
+        fill_rand(SIMD_SIZE_MAX + SIMD_OFFSETS, A);
+        fill_rand(SIMD_SIZE_MAX + SIMD_OFFSETS, B);
+        double abs_sum = 0;
+        for (u32 i = 0; i < n; i++)
+          abs_sum += fabs(a[i] * b[i]);
+        double tol = (n + 1) * DBL_EPSILON * abs_sum;
+        double d = vector_dot(n, a, b), d_ref = vector_dot_scalar(n, a, b);
+        fail_unless(fabs(d - d_ref) <= tol,
+                    "vector_dot n=%u differs from scalar by %g", n, d - d_ref);
+        double r = vector_norm(n, a), r_ref = vector_norm_scalar(n, a);
+        fail_unless(fabs(r - r_ref) <= (n + 1) * DBL_EPSILON * r_ref,
+                    "vector_norm n=%u differs from scalar by %g", n, r - r_ref);
+      }
+}
+END_TEST
+
+START_TEST(test_simd_vector_add_sc) {
+  double A[SIMD_SIZE_MAX + SIMD_OFFSETS], B[SIMD_SIZE_MAX + SIMD_OFFSETS];
+  double C[SIMD_SIZE_MAX + SIMD_OFFSETS + 1], C_ref[SIMD_SIZE_MAX + 1];
+
+  seed_rng();
+  for (u32 n = 0; n <= SIMD_SIZE_MAX; n++)
+    for (u32 oa = 0; oa < SIMD_OFFSETS; oa++)
+      for (u32 oc = 0; oc < SIMD_OFFSETS; oc++) {
+        fill_rand(SIMD_SIZE_MAX + SIMD_OFFSETS, A);
+        fill_rand(SIMD_SIZE_MAX + SIMD_OFFSETS, B);
+        double gamma = mrand;
+        double *c = &C[oc];
+        c[n] = C_ref[n] = 22;
+        vector_add_sc(n, &A[oa], &B[oc], gamma, c);
+        vector_add_sc_scalar(n, &A[oa], &B[oc], gamma, C_ref);
+        for (u32 i = 0; i < n; i++)
+          fail_unless(fabs(c[i] - C_ref[i]) <=
+                      DBL_EPSILON * (fabs(A[oa + i]) +
+                                     2 * fabs(gamma * B[oc + i])),
+                      "vector_add_sc n=%u differs from scalar at %u", n, i);
+        fail_unless(c[n] == 22, "vector_add_sc n=%u wrote past the end", n);
+        matrix_add_sc(1, n, &A[oa], &B[oc], gamma, c);
+        matrix_add_sc_scalar(1, n, &A[oa], &B[oc], gamma, C_ref);
+        for (u32 i = 0; i < n; i++)
+          fail_unless(fabs(c[i] - C_ref[i]) <=
+                      DBL_EPSILON * (fabs(A[oa + i]) +
+                                     2 * fabs(gamma * B[oc + i])),
+                      "matrix_add_sc n=%u differs from scalar at %u", n, i);
+      }
+}
+END_TEST
+
+START_TEST(test_simd_matrix_transpose) {
+  double A[SIMD_SIZE_MAX * SIMD_SIZE_MAX + SIMD_OFFSETS];
+  double B[SIMD_SIZE_MAX * SIMD_SIZE_MAX + SIMD_OFFSETS];
+  double B_ref[SIMD_SIZE_MAX * SIMD_SIZE_MAX];
+
+  seed_rng();
+  for (u32 n = 1; n <= SIMD_SIZE_MAX; n++)
+    for (u32 m = 1; m <= SIMD_SIZE_MAX; m++)
+      for (u32 o = 0; o < SIMD_OFFSETS; o++) {
+        fill_rand(n * m + o, A);
+        matrix_transpose(n, m, &A[o], &B[SIMD_OFFSETS - 1 - o]);
+        matrix_transpose_scalar(n, m, &A[o], B_ref);
+        fail_unless(memcmp(&B[SIMD_OFFSETS - 1 - o], B_ref,
+                           n * m * sizeof(double)) == 0,
+                    "matrix_transpose %ux%u differs from scalar", n, m);
+      }
+}
+END_TEST
+
+START_TEST(test_simd_matrix_multiply) {
+  const u32 max = SIMD_SIZE_MAX / 2;
+  double A[SIMD_SIZE_MAX * SIMD_SIZE_MAX + SIMD_OFFSETS];
+  double B[SIMD_SIZE_MAX * SIMD_SIZE_MAX + SIMD_OFFSETS];
+  double C[SIMD_SIZE_MAX * SIMD_SIZE_MAX], C_ref[SIMD_SIZE_MAX * SIMD_SIZE_MAX];
+
+  seed_rng();
+  for (u32 n = 1; n <= max; n++)
+    for (u32 m = 1; m <= max; m++)
+      for (u32 p = 1; p <= max; p++)
+        for (u32 o = 0; o < SIMD_OFFSETS; o++) {
+          const double *a = &A[o], *b = &B[SIMD_OFFSETS - 1 - o];
+          fill_rand(SIMD_SIZE_MAX * SIMD_SIZE_MAX + SIMD_OFFSETS, A);
+          fill_rand(SIMD_SIZE_MAX * SIMD_SIZE_MAX + SIMD_OFFSETS, B);
+          matrix_multiply(n, m, p, a, b, C);
+          matrix_multiply_scalar(n, m, p, a, b, C_ref);
+          for (u32 i = 0; i < n; i++)
+            for (u32 j = 0; j < p; j++) {
+              double abs_sum = 0;
+              for (u32 k = 0; k < m; k++)
+                abs_sum += fabs(a[m*i + k] * b[p*k + j]);
+              fail_unless(fabs(C[p*i + j] - C_ref[p*i + j]) <=
+                          (m + 1) * DBL_EPSILON * abs_sum,
+                          "matrix_multiply %ux%ux%u differs from scalar",
+                          n, m, p);
+            }
+        }
+}
+END_TEST
+
 /*
 START_TEST(test_qrsolve_consistency) {
   u32 i, j, t;
@@ -684,6 +941,9 @@ Suite* linear_algebra_suite(void) {
   tcase_add_test(tc_core, test_matrix_inverse_3x3);
   tcase_add_test(tc_core, test_matrix_inverse_4x4);
   tcase_add_test(tc_core, test_matrix_inverse_5x5);
+  tcase_add_test(tc_core, test_matrix_cholesky);
+  tcase_add_test(tc_core, test_solve_normal_equations);
+  tcase_add_test(tc_core, test_matrix_pseudoinverse_identities);
 
   tcase_add_test(tc_core, test_vector_dot);
   tcase_add_test(tc_core, test_vector_mean);
@@ -698,6 +958,13 @@ Suite* linear_algebra_suite(void) {
   /*tcase_add_test(tc_core, test_qrsolve_rect);*/
   suite_add_tcase(s, tc_core);
 
+  TCase *tc_simd = tcase_create("SIMD");
+  tcase_add_test(tc_simd, test_simd_vector_dot_norm);
+  tcase_add_test(tc_simd, test_simd_vector_add_sc);
+  tcase_add_test(tc_simd, test_simd_matrix_transpose);
+  tcase_add_test(tc_simd, test_simd_matrix_multiply);
+  suite_add_tcase(s, tc_simd);
+
   return s;
 }
 
@@ -2,11 +2,14 @@
 #include <check.h>
 
 #include "check_suites.h"
+#include "linear_algebra.h"
 
 int main(void)
 {
   int number_failed;
 
+  linear_algebra_backend_report();
+
   Suite *s = edc_suite();
 
   SRunner *sr = srunner_create(s);
@@ -18,9 +21,14 @@ int main(void)
   srunner_add_suite(sr, rtcm3_suite());
   srunner_add_suite(sr, bits_suite());
   srunner_add_suite(sr, memory_pool_suite());
+  srunner_add_suite(sr, memory_pool_mt_suite());
+  srunner_add_suite(sr, memory_pool_dense_suite());
   srunner_add_suite(sr, sbp_suite());
+  srunner_add_suite(sr, sbp_messages_suite());
   srunner_add_suite(sr, coord_system_suite());
   srunner_add_suite(sr, linear_algebra_suite());
+  srunner_add_suite(sr, lambda_suite());
+  srunner_add_suite(sr, small_matrix_suite());
 
   srunner_set_fork_status(sr, CK_NOFORK);
   srunner_run_all(sr, CK_NORMAL);
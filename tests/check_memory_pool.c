@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 
 #include <memory_pool.h>
 
@@ -57,6 +58,14 @@ void teardown()
               == 50,
               "Memory leak! test_pool_empty lost elements!");
 
+  /* And check the lists against the element counters. */
+  fail_unless(memory_pool_check(test_pool_seq) >= 0,
+              "test_pool_seq inconsistent!");
+  fail_unless(memory_pool_check(test_pool_random) >= 0,
+              "test_pool_random inconsistent!");
+  fail_unless(memory_pool_check(test_pool_empty) >= 0,
+              "test_pool_empty inconsistent!");
+
   memory_pool_destroy(test_pool_seq);
   memory_pool_destroy(test_pool_random);
   memory_pool_destroy(test_pool_empty);
@@ -550,6 +559,311 @@ START_TEST(test_groupby_2)
 }
 END_TEST
 
+u64 key_s32(void *arg, element_t *elem)
+{
+  (void)arg;
+  /* Flip the sign bit so negative values order before positive ones. */
+  return (u32)*((s32 *)elem) ^ 0x80000000;
+}
+
+u64 key_div4(void *arg, element_t *elem)
+{
+  (void)arg;
+  return *((s32 *)elem) / 4;
+}
+
+s32 cmp_div4(void *arg, element_t *a, element_t *b)
+{
+  (void)arg;
+  return *((s32 *)a) / 4 - *((s32 *)b) / 4;
+}
+
+int qsort_cmp_s32s(const void *a, const void *b)
+{
+  s32 x = *((const s32 *)a), y = *((const s32 *)b);
+  return (x > y) - (x < y);
+}
+
+START_TEST(test_sort_key)
+{
+  s32 xs[22];
+  s32 test_xs_sorted[22] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+    12, 13, 14, 15, 16, 17, 18, 19, 20, 21
+  };
+
+  fail_unless(memory_pool_sort_key(test_pool_seq, 0, &key_s32, 0) == 22,
+      "Sorted length does not match");
+  memory_pool_to_array(test_pool_seq, xs);
+  fail_unless(memcmp(xs, test_xs_sorted, sizeof(test_xs_sorted)) == 0,
+      "Output of sort operation does not match test data");
+
+  /* Sorting on a coarser key must be stable, matching memory_pool_sort(). */
+  s32 ys[20], ys_ref[20];
+  memory_pool_sort(test_pool_random, 0, &cmp_div4);
+  memory_pool_to_array(test_pool_random, ys_ref);
+  memory_pool_sort_key(test_pool_random, 0, &key_s32, 0);
+  memory_pool_sort_key(test_pool_random, 0, &key_div4, 0);
+  memory_pool_to_array(test_pool_random, ys);
+  for (u32 i=0; i<20; i++)
+    fail_unless(ys[i] / 4 == ys_ref[i] / 4 && (i == 0 || ys[i-1] <= ys[i]),
+        "Sort by key is not stable");
+
+  /* Empty and single element lists. */
+  fail_unless(memory_pool_sort_key(test_pool_empty, 0, &key_s32, 0) == 0,
+      "Sorted length does not match");
+  s32 *x = (s32 *)memory_pool_add(test_pool_empty); *x = 22;
+  fail_unless(memory_pool_sort_key(test_pool_empty, 0, &key_s32, 0) == 1,
+      "Sorted length does not match");
+  fail_unless(memory_pool_n_free(test_pool_empty) == 49,
+      "Sorted length does not match");
+
+  /* A large collection with keys spanning all four bytes and both signs. */
+  memory_pool_t *test_pool_big = memory_pool_new(1000, sizeof(s32));
+  for (u32 i=0; i<1000; i++)
+    *((s32 *)memory_pool_add(test_pool_big)) = (s32)random() - (1 << 30);
+  s32 big_ref[1000], big[1000];
+  memory_pool_to_array(test_pool_big, big_ref);
+  qsort(big_ref, 1000, sizeof(s32), &qsort_cmp_s32s);
+  u64 sort_buff[MEMORY_POOL_SORT_KEY_BUFF_SIZE(1000) / sizeof(u64)];
+  memory_pool_sort_key(test_pool_big, 0, &key_s32, sort_buff);
+  memory_pool_to_array(test_pool_big, big);
+  fail_unless(memcmp(big, big_ref, sizeof(big)) == 0,
+      "Sort by key does not match memory_pool_sort");
+  fail_unless(memory_pool_n_allocated(test_pool_big) == 1000,
+      "Sorted length does not match");
+  memory_pool_destroy(test_pool_big);
+}
+END_TEST
+
+u32 hash_evens(void *arg, element_t *elem)
+{
+  (void)arg;
+  return *((s32 *)elem) % 2;
+}
+
+u32 hash_s32(void *arg, element_t *elem)
+{
+  (void)arg;
+  return *((s32 *)elem) * 2654435761u;
+}
+
+u32 hash_N_i(void *i_, element_t *a_)
+{
+  u8 *i = (u8 *)i_;
+  hypothesis_t *a = (hypothesis_t *)a_;
+
+  u32 h = 0;
+  for (u8 n=0; n<a->len; n++)
+    if (n != *i)
+      h = 31 * h + a->N[n];
+  return h;
+}
+
+START_TEST(test_groupby_hash)
+{
+  s32 xs[2];
+
+  fail_unless(memory_pool_group_by_hash(test_pool_seq, 0, &hash_evens,
+                                        &group_evens, 0, 0,
+                                        &agg_sum_s32s, 0) == 2,
+      "Reduced length does not match");
+  fail_unless(memory_pool_n_allocated(test_pool_seq) == 2,
+      "Reduced length does not match");
+  memory_pool_to_array(test_pool_seq, xs);
+  fail_unless((xs[0] == 121 && xs[1] == 110) || (xs[0] == 110 && xs[1] == 121),
+      "Output of groupby operation does not match test data");
+
+  /* Working state too large to copy onto the stack is rejected. */
+  fail_unless(memory_pool_group_by_hash(test_pool_seq, 0, &hash_evens,
+                                        &group_evens, 0,
+                                        MEMORY_POOL_MAX_X_SIZE + 1,
+                                        &agg_sum_s32s, 0) < 0,
+      "Oversized working state not rejected");
+  fail_unless(memory_pool_n_allocated(test_pool_seq) == 2,
+      "Collection changed by a rejected groupby");
+
+  /* As are elements too large to aggregate on the stack. */
+  memory_pool_t *pool_big = memory_pool_new(4, MEMORY_POOL_MAX_ELEMENT_SIZE + 1);
+  fail_unless(pool_big != NULL, "Pool with large elements not created");
+  memset(memory_pool_add(pool_big), 0, MEMORY_POOL_MAX_ELEMENT_SIZE + 1);
+  fail_unless(memory_pool_group_by_hash(pool_big, 0, &hash_evens,
+                                        &group_evens, 0, 0,
+                                        &agg_sum_s32s, 0) == -3,
+      "Oversized elements not rejected");
+  fail_unless(memory_pool_n_allocated(pool_big) == 1,
+      "Collection changed by a rejected groupby");
+  memory_pool_destroy(pool_big);
+
+  /* Reducing a full pool, grouping on equal values. */
+  s32 sum = memory_pool_ifold(test_pool_random, 0, &isum);
+  s32 n_groups = memory_pool_group_by_hash(test_pool_random, 0, &hash_s32,
+                                           &cmp_s32s, 0, 0, &agg_sum_s32s, 0);
+  fail_unless(n_groups == 14,
+      "Reduced length does not match, got %d", n_groups);
+  fail_unless(memory_pool_ifold(test_pool_random, 0, &isum) == sum,
+      "Output of groupby operation does not match test data");
+
+  fail_unless(memory_pool_group_by_hash(test_pool_empty, 0, &hash_s32,
+                                        &cmp_s32s, 0, 0, &agg_sum_s32s, 0) == 0,
+      "Reduced length does not match");
+
+  /* Must give the same groups as memory_pool_group_by(). */
+  memory_pool_t *pool_a = memory_pool_new(200, sizeof(hypothesis_t));
+  memory_pool_t *pool_b = memory_pool_new(200, sizeof(hypothesis_t));
+  for (u32 i=0; i<200; i++) {
+    hypothesis_t *hyp_a = (hypothesis_t *)memory_pool_add(pool_a);
+    hypothesis_t *hyp_b = (hypothesis_t *)memory_pool_add(pool_b);
+    hyp_a->len = 4;
+    for (u8 j=0; j<hyp_a->len; j++)
+      hyp_a->N[j] = sizerand(3);
+    hyp_a->p = frand(0, 1);
+    memcpy(hyp_b, hyp_a, sizeof(hypothesis_t));
+  }
+
+  u8 col = 2;
+  memory_pool_group_by(pool_a, &col, &group_by_N_i, &col, 1, &agg_sum_p);
+  u64 group_buff[MEMORY_POOL_GROUP_BY_HASH_BUFF_SIZE(200) / sizeof(u64) + 1];
+  n_groups = memory_pool_group_by_hash(pool_b, &col, &hash_N_i, &group_by_N_i,
+                                       &col, 1, &agg_sum_p, group_buff);
+  fail_unless(n_groups == memory_pool_n_allocated(pool_a),
+      "Hash groupby gave %d groups, expected %d",
+      n_groups, memory_pool_n_allocated(pool_a));
+
+  /* After reduction column `col` is gone, compare on all columns. */
+  u8 no_col = 0xFF;
+  memory_pool_sort(pool_a, &no_col, &group_by_N_i);
+  memory_pool_sort(pool_b, &no_col, &group_by_N_i);
+  hypothesis_t hyps_a[200], hyps_b[200];
+  memory_pool_to_array(pool_a, hyps_a);
+  memory_pool_to_array(pool_b, hyps_b);
+  for (s32 i=0; i<n_groups; i++) {
+    fail_unless(memcmp(hyps_a[i].N, hyps_b[i].N, hyps_a[i].len) == 0,
+        "Hash groupby groups do not match");
+    fail_unless(hyps_a[i].p == hyps_b[i].p,
+        "Hash groupby aggregates do not match");
+  }
+
+  memory_pool_destroy(pool_a);
+  memory_pool_destroy(pool_b);
+}
+END_TEST
+
+s8 filter_lt_10(void *arg, element_t *elem)
+{
+  (void)arg;
+  return *((s32 *)elem) < 10;
+}
+
+void prod_s32_x(element_t *new_, void *x_, u32 n_xs, u32 n, element_t *elem_)
+{
+  (void)n_xs;
+  (void)n;
+  (void)elem_;
+  *((s32 *)new_) += *((u8 *)x_);
+}
+
+static u64 fake_time;
+
+u64 fake_clock(void)
+{
+  /* Every operation takes 5 ticks. */
+  return fake_time += 5;
+}
+
+START_TEST(test_stats)
+{
+  memory_pool_stats_t stats;
+
+  memory_pool_get_stats(test_pool_random, &stats);
+  fail_unless(stats.high_water == 20 && stats.n_adds == 20 &&
+              stats.n_add_failures == 0,
+      "Stats do not match, %u %u %u",
+      stats.high_water, stats.n_adds, stats.n_add_failures);
+
+  memory_pool_add(test_pool_random);
+  memory_pool_add(test_pool_random);
+  memory_pool_get_stats(test_pool_random, &stats);
+  fail_unless(stats.n_add_failures == 2, "Add failures not counted");
+
+  /* The counters follow filter and clear, the high water mark stays. */
+  fail_unless(memory_pool_filter(test_pool_seq, 0, &filter_lt_10) == 10,
+      "Filter returned the wrong count");
+  fail_unless(memory_pool_n_allocated(test_pool_seq) == 10,
+      "Allocated count not updated by filter");
+  fail_unless(memory_pool_n_free(test_pool_seq) == 40,
+      "Free count not updated by filter");
+  fail_unless(memory_pool_check(test_pool_seq) == 10,
+      "Pool inconsistent after filter");
+  memory_pool_get_stats(test_pool_seq, &stats);
+  fail_unless(stats.high_water == 22, "High water mark lost");
+
+  memory_pool_reset_stats(test_pool_seq);
+  memory_pool_get_stats(test_pool_seq, &stats);
+  fail_unless(stats.high_water == 10 && stats.n_adds == 0,
+      "Stats not reset");
+
+  /* A product briefly needs room for both the old and new elements. */
+  u8 xs[3] = {0, 1, 2};
+  memory_pool_product(test_pool_seq, xs, 3, 1, &prod_s32_x);
+  fail_unless(memory_pool_check(test_pool_seq) == 30,
+      "Pool inconsistent after product");
+  memory_pool_get_stats(test_pool_seq, &stats);
+  fail_unless(stats.high_water == 31,
+      "High water mark %u, expected 31", stats.high_water);
+
+  memory_pool_group_by(test_pool_seq, 0, &group_evens, 0, 0, &agg_sum_s32s);
+  fail_unless(memory_pool_check(test_pool_seq) == 2,
+      "Pool inconsistent after group by");
+
+  memory_pool_clear(test_pool_seq);
+  fail_unless(memory_pool_check(test_pool_seq) == 0,
+      "Pool inconsistent after clear");
+
+  /* Check notices a broken list. */
+  node_t *next = test_pool_random->allocated_nodes_head->hdr.next;
+  test_pool_random->allocated_nodes_head->hdr.next = NULL;
+  fail_unless(memory_pool_check(test_pool_random) < 0,
+      "Lost elements not detected");
+  test_pool_random->allocated_nodes_head->hdr.next = next;
+}
+END_TEST
+
+START_TEST(test_timing)
+{
+  memory_pool_stats_t stats;
+
+  /* Timing is off by default. */
+  memory_pool_map(test_pool_seq, 0, &times_two);
+  memory_pool_get_stats(test_pool_seq, &stats);
+  for (u32 i=0; i<MEMORY_POOL_TIMING_BINS; i++)
+    fail_unless(stats.op_time_hist[MEMORY_POOL_OP_MAP][i] == 0,
+        "Operation timed without a clock");
+
+  memory_pool_set_clock(test_pool_seq, &fake_clock);
+  memory_pool_map(test_pool_seq, 0, &times_two);
+  memory_pool_ifold(test_pool_seq, 0, &isum);
+  memory_pool_dfold(test_pool_seq, 0, &dsum);
+  memory_pool_filter(test_pool_seq, 0, &filter_lt_10);
+  memory_pool_sort(test_pool_seq, 0, &cmp_s32s);
+  memory_pool_set_clock(test_pool_seq, NULL);
+  memory_pool_map(test_pool_seq, 0, &times_two);
+
+  /* 5 ticks lands in bin 3, [4, 8). */
+  memory_pool_get_stats(test_pool_seq, &stats);
+  fail_unless(stats.op_time_hist[MEMORY_POOL_OP_MAP][3] == 1,
+      "Map not timed");
+  fail_unless(stats.op_time_hist[MEMORY_POOL_OP_FOLD][3] == 2,
+      "Folds not timed");
+  fail_unless(stats.op_time_hist[MEMORY_POOL_OP_FILTER][3] == 1,
+      "Filter not timed");
+  fail_unless(stats.op_time_hist[MEMORY_POOL_OP_SORT][3] == 1,
+      "Sort not timed");
+  fail_unless(stats.op_time_hist[MEMORY_POOL_OP_PRODUCT][3] == 0,
+      "Product timed but not run");
+}
+END_TEST
+
 void prod_N(element_t *new_, void *x_, u32 n_xs, u32 n, element_t *elem_)
 {
   (void)n;
@@ -666,6 +980,243 @@ START_TEST(test_prod_generator)
 }
 END_TEST
 
+void prod_s32_times_x(element_t *new_, void *x_, u32 n_xs, u32 n, element_t *elem_)
+{
+  (void)n_xs;
+  (void)n;
+  *((s32 *)new_) = *((s32 *)elem_) * 100 + *((u8 *)x_);
+}
+
+s8 keep_x_lt(void *arg, element_t *elem)
+{
+  return *((s32 *)elem) % 100 < *((s32 *)arg);
+}
+
+void prod_s32_gen(element_t *new_, void *x_, u32 n, element_t *elem_)
+{
+  (void)x_;
+  *((s32 *)new_) = *((s32 *)elem_) * 100 + n;
+}
+
+s8 gen_upto_10(void *x, u32 n)
+{
+  (void)x;
+  return n < 10;
+}
+
+START_TEST(test_prod_filter)
+{
+  /* 22 x 10 candidates would overflow the 50 element pool. */
+  u8 xs[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  s32 lim = 2;
+  s32 n = memory_pool_product_filter(test_pool_seq, xs, 10, sizeof(u8),
+                                     &prod_s32_times_x, &lim, &keep_x_lt);
+  fail_unless(n == 44, "Product filter returned %d, expected 44", n);
+  fail_unless(memory_pool_check(test_pool_seq) == 44,
+      "Pool inconsistent after product filter");
+
+  s32 sum = memory_pool_ifold(test_pool_seq, 0, &isum);
+  fail_unless(sum == 2 * 100 * 231 + 22,
+      "Product filter kept the wrong elements, sum %d", sum);
+
+  memory_pool_stats_t stats;
+  memory_pool_get_stats(test_pool_seq, &stats);
+  fail_unless(stats.n_add_failures == 0, "Product filter overflowed");
+
+  /* Too many survivors, the pool is left empty but consistent. */
+  lim = 3;
+  n = memory_pool_product_filter(test_pool_seq, xs, 10, sizeof(u8),
+                                 &prod_s32_times_x, &lim, &keep_x_lt);
+  fail_unless(n == -2, "Overflow not reported, got %d", n);
+  fail_unless(memory_pool_check(test_pool_seq) == 0,
+      "Pool inconsistent after overflow");
+
+  /* Empty collection. */
+  n = memory_pool_product_filter(test_pool_empty, xs, 10, sizeof(u8),
+                                 &prod_s32_times_x, &lim, &keep_x_lt);
+  fail_unless(n == 0, "Product of empty collection returned %d", n);
+
+  /* Elements too large for the working areas, the collection is untouched. */
+  memory_pool_t *pool_big = memory_pool_new(4, MEMORY_POOL_MAX_ELEMENT_SIZE + 1);
+  fail_unless(pool_big != NULL, "Pool with large elements not created");
+  memset(memory_pool_add(pool_big), 0, MEMORY_POOL_MAX_ELEMENT_SIZE + 1);
+  n = memory_pool_product_filter(pool_big, xs, 2, sizeof(u8),
+                                 &prod_s32_times_x, &lim, &keep_x_lt);
+  fail_unless(n == -4, "Oversized elements not rejected, got %d", n);
+  u8 x0 = 0;
+  n = memory_pool_product_generator_filter(pool_big, &x0, 100, 1,
+                                           &gen_upto_10, &prod_s32_gen,
+                                           &lim, &keep_x_lt);
+  fail_unless(n == -4, "Oversized elements not rejected, got %d", n);
+  fail_unless(memory_pool_check(pool_big) == 1,
+      "Collection changed by a rejected product filter");
+  memory_pool_destroy(pool_big);
+}
+END_TEST
+
+START_TEST(test_prod_generator_filter)
+{
+  s32 lim = 2;
+  u8 x0 = 0;
+  s32 n = memory_pool_product_generator_filter(test_pool_seq, &x0, 100, 1,
+                                               &gen_upto_10, &prod_s32_gen,
+                                               &lim, &keep_x_lt);
+  fail_unless(n == 44, "Product filter returned %d, expected 44", n);
+  fail_unless(memory_pool_check(test_pool_seq) == 44,
+      "Pool inconsistent after product filter");
+  s32 sum = memory_pool_ifold(test_pool_seq, 0, &isum);
+  fail_unless(sum == 2 * 100 * 231 + 22,
+      "Product filter kept the wrong elements, sum %d", sum);
+
+  /* Generator state too large to copy onto the stack. */
+  n = memory_pool_product_generator_filter(test_pool_seq, &x0, 100,
+                                           MEMORY_POOL_MAX_X_SIZE + 1,
+                                           &gen_upto_10, &prod_s32_gen,
+                                           &lim, &keep_x_lt);
+  fail_unless(n == -4, "Oversized generator state not rejected, got %d", n);
+  fail_unless(memory_pool_check(test_pool_seq) == 44,
+      "Collection changed by a rejected product filter");
+
+  /* Generator longer than allowed. */
+  n = memory_pool_product_generator_filter(test_pool_seq, &x0, 5, 1,
+                                           &gen_upto_10, &prod_s32_gen,
+                                           &lim, &keep_x_lt);
+  fail_unless(n == -3, "Runaway generator not reported, got %d", n);
+  fail_unless(memory_pool_check(test_pool_seq) == 0,
+      "Pool inconsistent after error");
+}
+END_TEST
+
+#define PAR_POOL_SIZE 1000
+#define PAR_POOL_N 997
+#define PAR_N_THREADS 4
+
+memory_pool_t *test_pool_par;
+
+void par_setup()
+{
+  setup();
+
+  /* A pool big enough to be split between PAR_N_THREADS threads, with a
+   * count that does not divide evenly. */
+  test_pool_par = memory_pool_new(PAR_POOL_SIZE, sizeof(s32));
+  for (s32 i=0; i<PAR_POOL_N; i++)
+    *((s32 *)memory_pool_add(test_pool_par)) = i;
+}
+
+void par_teardown()
+{
+  fail_unless(memory_pool_n_free(test_pool_par)
+              + memory_pool_n_allocated(test_pool_par)
+              == PAR_POOL_SIZE,
+              "Memory leak! test_pool_par lost elements!");
+  memory_pool_destroy(test_pool_par);
+
+  teardown();
+}
+
+void min_max_combine(void *x, const void *y)
+{
+  min_max_t *mm = (min_max_t *)x;
+  const min_max_t *mm_y = (const min_max_t *)y;
+  mm->min = MIN(mm->min, mm_y->min);
+  mm->max = MAX(mm->max, mm_y->max);
+}
+
+double dadd(double x, double y)
+{
+  return x + y;
+}
+
+START_TEST(test_parallel_map_fold)
+{
+  s32 n = memory_pool_parallel_map(test_pool_par, PAR_N_THREADS, NULL,
+                                   &times_two);
+  fail_unless(n == PAR_POOL_N, "Parallel map returned %d", n);
+
+  s32 xs[PAR_POOL_N];
+  memory_pool_to_array(test_pool_par, xs);
+  for (s32 i=0; i<PAR_POOL_N; i++)
+    fail_unless(xs[i] == 2*(PAR_POOL_N - 1 - i),
+                "Parallel map output wrong at %d", i);
+
+  min_max_t mm = { .min = 1000000, .max = -1000000 };
+  n = memory_pool_parallel_fold(test_pool_par, PAR_N_THREADS, &mm,
+                                sizeof(mm), &min_max_finder, &min_max_combine);
+  fail_unless(n == PAR_POOL_N, "Parallel fold returned %d", n);
+  fail_unless(mm.min == 0 && mm.max == 2*(PAR_POOL_N - 1),
+              "Parallel fold wrong, got min %d max %d", mm.min, mm.max);
+
+  /* Accumulators too large to keep per chunk are folded serially. */
+  struct {
+    min_max_t mm;
+    u8 pad[MEMORY_POOL_PAR_MAX_FOLD_SIZE];
+  } big = { .mm = { .min = 1000000, .max = -1000000 } };
+  n = memory_pool_parallel_fold(test_pool_par, PAR_N_THREADS, &big,
+                                sizeof(big), &min_max_finder, &min_max_combine);
+  fail_unless(n == PAR_POOL_N, "Parallel fold returned %d", n);
+  fail_unless(big.mm.min == 0 && big.mm.max == 2*(PAR_POOL_N - 1),
+              "Parallel fold wrong, got min %d max %d", big.mm.min, big.mm.max);
+
+  double sum = memory_pool_parallel_dfold(test_pool_par, PAR_N_THREADS, 0,
+                                          &dsum, &dadd);
+  fail_unless(sum == memory_pool_dfold(test_pool_par, 0, &dsum),
+              "Parallel dfold differs from serial fold");
+
+  /* Small collections take the serial path. */
+  sum = memory_pool_parallel_dfold(test_pool_seq, PAR_N_THREADS, 0,
+                                   &dsum, &dadd);
+  fail_unless(sum == 231, "Parallel dfold on small pool got %f", sum);
+  sum = memory_pool_parallel_dfold(test_pool_empty, PAR_N_THREADS, 0,
+                                   &dsum, &dadd);
+  fail_unless(sum == 0, "Parallel dfold on empty pool got %f", sum);
+}
+END_TEST
+
+s8 par_keep(void *arg, element_t *elem)
+{
+  (void) arg;
+  s32 x = *((s32 *)elem);
+  /* Drop a whole chunk's worth in the middle as well as a scattering. */
+  return (x % 3 != 0) && !(x > 300 && x < 600);
+}
+
+START_TEST(test_parallel_filter)
+{
+  s32 n = memory_pool_parallel_filter(test_pool_par, PAR_N_THREADS, NULL,
+                                      &par_keep);
+  fail_unless(n == memory_pool_n_allocated(test_pool_par),
+              "Parallel filter returned %d, %d elements left",
+              n, memory_pool_n_allocated(test_pool_par));
+
+  /* Kept elements are all there and in their original order. */
+  s32 xs[PAR_POOL_N];
+  memory_pool_to_array(test_pool_par, xs);
+  s32 j = 0;
+  for (s32 x=PAR_POOL_N-1; x>=0; x--) {
+    if (par_keep(NULL, (element_t *)&x)) {
+      fail_unless(j < n && xs[j] == x, "Parallel filter output wrong at %d", j);
+      j++;
+    }
+  }
+  fail_unless(j == n, "Parallel filter kept %d, expected %d", n, j);
+
+  /* Dropped elements went back to the pool. */
+  for (s32 i=n; i<PAR_POOL_SIZE; i++)
+    fail_unless(memory_pool_add(test_pool_par) != NULL,
+                "Pool full after filter");
+
+  /* Dropping everything. */
+  memory_pool_clear(test_pool_par);
+  for (s32 i=0; i<PAR_POOL_N; i++)
+    *((s32 *)memory_pool_add(test_pool_par)) = 3*i;
+  n = memory_pool_parallel_filter(test_pool_par, PAR_N_THREADS, NULL,
+                                  &par_keep);
+  fail_unless(n == 0 && memory_pool_empty(test_pool_par),
+              "Parallel filter should have dropped everything");
+}
+END_TEST
+
 Suite* memory_pool_suite(void)
 {
   Suite *s = suite_create("Memory Pools");
@@ -688,10 +1239,22 @@ Suite* memory_pool_suite(void)
   tcase_add_test(tc_core, test_sort);
   tcase_add_test(tc_core, test_groupby_1);
   tcase_add_test(tc_core, test_groupby_2);
+  tcase_add_test(tc_core, test_sort_key);
+  tcase_add_test(tc_core, test_groupby_hash);
+  tcase_add_test(tc_core, test_stats);
+  tcase_add_test(tc_core, test_timing);
   tcase_add_test(tc_core, test_prod);
   tcase_add_test(tc_core, test_prod_generator);
+  tcase_add_test(tc_core, test_prod_filter);
+  tcase_add_test(tc_core, test_prod_generator_filter);
   suite_add_tcase(s, tc_core);
 
+  TCase *tc_par = tcase_create("Parallel");
+  tcase_add_checked_fixture (tc_par, par_setup, par_teardown);
+  tcase_add_test(tc_par, test_parallel_map_fold);
+  tcase_add_test(tc_par, test_parallel_filter);
+  suite_add_tcase(s, tc_par);
+
   return s;
 }
 
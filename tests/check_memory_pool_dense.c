@@ -0,0 +1,175 @@
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <memory_pool_dense.h>
+
+#include "check_utils.h"
+
+#define DENSE_POOL_SIZE 50
+
+memory_pool_dense_t *test_dense_pool;
+u32 test_dense_handles[DENSE_POOL_SIZE];
+
+static void dense_setup(void)
+{
+  /* Create a new pool and fill it with a sequence of ints. */
+  test_dense_pool = memory_pool_dense_new(DENSE_POOL_SIZE, sizeof(s32));
+  for (s32 i = 0; i < 22; i++) {
+    s32 *x = (s32 *)memory_pool_dense_add(test_dense_pool,
+                                          &test_dense_handles[i]);
+    fail_unless(x != 0, "Null pointer returned by memory_pool_dense_add");
+    *x = i;
+  }
+}
+
+static void dense_teardown(void)
+{
+  fail_unless(memory_pool_dense_n_free(test_dense_pool)
+              + memory_pool_dense_n_allocated(test_dense_pool)
+              == DENSE_POOL_SIZE,
+              "Memory leak! test_dense_pool lost elements!");
+
+  /* Every live element's handle must resolve back to it. */
+  for (u32 i = 0; i < memory_pool_dense_n_allocated(test_dense_pool); i++) {
+    u32 h = memory_pool_dense_handle(test_dense_pool, i);
+    fail_unless(memory_pool_dense_get(test_dense_pool, h) ==
+                memory_pool_dense_at(test_dense_pool, i),
+                "Handle %u does not resolve to index %u", h, i);
+  }
+
+  memory_pool_dense_destroy(test_dense_pool);
+}
+
+static s8 dense_filter_odd(void *arg, element_t *elem)
+{
+  (void)arg;
+  return *(s32 *)elem % 2;
+}
+
+static void dense_times_two(void *arg, element_t *elem)
+{
+  (void)arg;
+  *(s32 *)elem *= 2;
+}
+
+static double dense_dsum(double x, element_t *elem)
+{
+  return x + *(s32 *)elem;
+}
+
+START_TEST(test_dense_add_full)
+{
+  u32 n;
+  fail_unless(memory_pool_dense_n_allocated(test_dense_pool) == 22,
+              "Wrong number of allocated elements");
+  s32 *xs = (s32 *)memory_pool_dense_array(test_dense_pool, &n);
+  fail_unless(n == 22, "Array view has wrong length");
+  for (u32 i = 0; i < n; i++)
+    fail_unless(xs[i] == (s32)i, "Array view not in insertion order");
+
+  for (u32 i = 22; i < DENSE_POOL_SIZE; i++)
+    fail_unless(memory_pool_dense_add(test_dense_pool, NULL) != NULL,
+                "Pool full too early");
+  fail_unless(memory_pool_dense_add(test_dense_pool, NULL) == NULL,
+              "Add to full pool should return NULL");
+  fail_unless(memory_pool_dense_n_free(test_dense_pool) == 0,
+              "Full pool should have no free elements");
+
+  memory_pool_dense_clear(test_dense_pool);
+  fail_unless(memory_pool_dense_empty(test_dense_pool),
+              "Pool should be empty after clear");
+  fail_unless(memory_pool_dense_get(test_dense_pool,
+                                    test_dense_handles[0]) == NULL,
+              "Handle valid after clear");
+}
+END_TEST
+
+START_TEST(test_dense_remove)
+{
+  /* Remove the even elements one at a time. */
+  for (u32 i = 0; i < 22; i += 2) {
+    fail_unless(memory_pool_dense_remove(test_dense_pool,
+                                         test_dense_handles[i]) == 0,
+                "Remove failed");
+    fail_unless(memory_pool_dense_get(test_dense_pool,
+                                      test_dense_handles[i]) == NULL,
+                "Removed element's handle still valid");
+  }
+  fail_unless(memory_pool_dense_remove(test_dense_pool,
+                                       test_dense_handles[0]) < 0,
+              "Double remove not detected");
+  fail_unless(memory_pool_dense_remove(test_dense_pool, DENSE_POOL_SIZE) < 0,
+              "Out of range handle not detected");
+
+  /* The odd elements can still be found through their handles. */
+  fail_unless(memory_pool_dense_n_allocated(test_dense_pool) == 11,
+              "Wrong number of elements after remove");
+  for (u32 i = 1; i < 22; i += 2) {
+    s32 *x = (s32 *)memory_pool_dense_get(test_dense_pool,
+                                          test_dense_handles[i]);
+    fail_unless(x && *x == (s32)i, "Handle %u lost its element", i);
+  }
+
+  /* Handles are reused and the new elements land at the end. */
+  u32 h;
+  s32 *x = (s32 *)memory_pool_dense_add(test_dense_pool, &h);
+  *x = 100;
+  fail_unless(memory_pool_dense_at(test_dense_pool, 11) == (element_t *)x,
+              "New element should be at the end of the array");
+  fail_unless(memory_pool_dense_get(test_dense_pool, h) == (element_t *)x,
+              "New handle does not resolve");
+}
+END_TEST
+
+START_TEST(test_dense_filter)
+{
+  s32 n = memory_pool_dense_filter(test_dense_pool, NULL, dense_filter_odd);
+  fail_unless(n == 11, "Filter kept %d elements, expected 11", n);
+
+  /* Filter compacts in order and handles follow their elements. */
+  s32 *xs = (s32 *)memory_pool_dense_array(test_dense_pool, NULL);
+  for (s32 i = 0; i < n; i++)
+    fail_unless(xs[i] == 2*i + 1, "Filter did not preserve order");
+  for (u32 i = 0; i < 22; i++) {
+    s32 *x = (s32 *)memory_pool_dense_get(test_dense_pool,
+                                          test_dense_handles[i]);
+    if (i % 2)
+      fail_unless(x && *x == (s32)i, "Handle %u lost its element", i);
+    else
+      fail_unless(x == NULL, "Filtered element's handle still valid");
+  }
+
+  /* Refill to capacity, the freed handles are all reusable. */
+  while (memory_pool_dense_add(test_dense_pool, NULL))
+    ;
+  fail_unless(memory_pool_dense_n_allocated(test_dense_pool) == DENSE_POOL_SIZE,
+              "Could not refill the pool after filter");
+}
+END_TEST
+
+START_TEST(test_dense_map_fold)
+{
+  fail_unless(memory_pool_dense_map(test_dense_pool, NULL,
+                                    dense_times_two) == 22,
+              "Map returned wrong count");
+  double sum = memory_pool_dense_dfold(test_dense_pool, 0, dense_dsum);
+  fail_unless(sum == 2 * (21 * 22 / 2), "Fold sum %f incorrect", sum);
+}
+END_TEST
+
+Suite* memory_pool_dense_suite(void)
+{
+  Suite *s = suite_create("Dense Memory Pools");
+
+  TCase *tc_core = tcase_create("Core");
+  tcase_add_checked_fixture(tc_core, dense_setup, dense_teardown);
+  tcase_add_test(tc_core, test_dense_add_full);
+  tcase_add_test(tc_core, test_dense_remove);
+  tcase_add_test(tc_core, test_dense_filter);
+  tcase_add_test(tc_core, test_dense_map_fold);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
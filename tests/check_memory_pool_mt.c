@@ -0,0 +1,204 @@
+
+#include <check.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory_pool_mt.h>
+
+#include "check_utils.h"
+
+#define MT_POOL_SIZE 64
+#define MT_N_THREADS 4
+#define MT_N_ITERS 20000
+
+typedef struct {
+  u32 owner;
+  u32 seq;
+  double payload;
+} mt_elem_t;
+
+/* Walk the shared free list, checking every node appears at most once. */
+static u32 check_free_list(memory_pool_mt_t *pool)
+{
+  u8 seen[MT_POOL_SIZE];
+  memset(seen, 0, sizeof(seen));
+  u32 count = 0;
+  u32 index = (u32)pool->free_head;
+  size_t node_size = sizeof(memory_pool_mt_node_hdr_t) + pool->element_size;
+  while (index != MEMORY_POOL_MT_NIL) {
+    fail_unless(index < pool->n_elements, "Free list index out of range");
+    fail_unless(!seen[index], "Node %u on the free list twice", index);
+    seen[index] = 1;
+    count++;
+    index = ((memory_pool_mt_node_t *)
+             ((u8 *)pool->pool + node_size * index))->hdr.next;
+  }
+  return count;
+}
+
+START_TEST(test_mt_alloc_free)
+{
+  memory_pool_mt_t *pool = memory_pool_mt_new(MT_POOL_SIZE, sizeof(mt_elem_t));
+  fail_unless(pool != NULL, "Failed to create pool");
+  fail_unless(memory_pool_mt_n_free(pool) == MT_POOL_SIZE,
+              "New pool should be all free");
+
+  mt_elem_t *elems[MT_POOL_SIZE];
+  for (u32 i = 0; i < MT_POOL_SIZE; i++) {
+    elems[i] = (mt_elem_t *)memory_pool_mt_alloc(pool);
+    fail_unless(elems[i] != NULL, "Null pointer returned by alloc");
+    fail_unless(((size_t)&elems[i]->payload & 7) == 0,
+                "Element not 8 byte aligned");
+    elems[i]->seq = i;
+  }
+  fail_unless(memory_pool_mt_alloc(pool) == NULL,
+              "Alloc from exhausted pool should return NULL");
+  fail_unless(memory_pool_mt_n_free(pool) == 0, "Pool should be empty");
+
+  for (u32 i = 0; i < MT_POOL_SIZE; i++)
+    fail_unless(elems[i]->seq == i, "Elements overlap");
+
+  /* Release in a different order to allocation. */
+  for (u32 i = 0; i < MT_POOL_SIZE; i += 2)
+    memory_pool_mt_free(pool, (element_t *)elems[i]);
+  for (u32 i = 1; i < MT_POOL_SIZE; i += 2)
+    memory_pool_mt_free(pool, (element_t *)elems[i]);
+
+  fail_unless(memory_pool_mt_n_free(pool) == MT_POOL_SIZE,
+              "Elements lost on release");
+  fail_unless(check_free_list(pool) == MT_POOL_SIZE,
+              "Free list inconsistent with n_free");
+
+  memory_pool_mt_destroy(pool);
+}
+END_TEST
+
+START_TEST(test_mt_cache)
+{
+  memory_pool_mt_t *pool = memory_pool_mt_new(MT_POOL_SIZE, sizeof(mt_elem_t));
+  memory_pool_mt_cache_t cache;
+  memory_pool_mt_cache_init(&cache, pool);
+
+  /* A cache can hand out the whole pool. */
+  mt_elem_t *elems[MT_POOL_SIZE];
+  for (u32 i = 0; i < MT_POOL_SIZE; i++) {
+    elems[i] = (mt_elem_t *)memory_pool_mt_cache_alloc(&cache);
+    fail_unless(elems[i] != NULL, "Null pointer returned by cache alloc");
+    for (u32 j = 0; j < i; j++)
+      fail_unless(elems[i] != elems[j], "Element allocated twice");
+  }
+  fail_unless(memory_pool_mt_cache_alloc(&cache) == NULL,
+              "Cache alloc from exhausted pool should return NULL");
+
+  /* Releasing through the cache spills to the shared list once full. */
+  for (u32 i = 0; i < MT_POOL_SIZE; i++) {
+    memory_pool_mt_cache_free(&cache, (element_t *)elems[i]);
+    fail_unless(cache.n <= MEMORY_POOL_MT_CACHE_SIZE, "Cache overflow");
+  }
+  fail_unless(memory_pool_mt_n_free(pool) + cache.n == MT_POOL_SIZE,
+              "Elements lost in cache");
+
+  memory_pool_mt_cache_flush(&cache);
+  fail_unless(cache.n == 0, "Flush should empty the cache");
+  fail_unless(memory_pool_mt_n_free(pool) == MT_POOL_SIZE,
+              "Elements lost on flush");
+  fail_unless(check_free_list(pool) == MT_POOL_SIZE,
+              "Free list inconsistent with n_free");
+
+  memory_pool_mt_destroy(pool);
+}
+END_TEST
+
+/* Worker randomly allocating and releasing elements, both directly and
+ * through its own cache, tagging each element it holds. */
+typedef struct {
+  memory_pool_mt_t *pool;
+  u32 id;
+  u32 errors;
+  mt_elem_t *held[MT_POOL_SIZE / MT_N_THREADS];
+} mt_worker_t;
+
+static void *mt_worker(void *arg)
+{
+  mt_worker_t *w = (mt_worker_t *)arg;
+  memory_pool_mt_cache_t cache;
+  memory_pool_mt_cache_init(&cache, w->pool);
+  u32 n_held = 0;
+  u32 seed = w->id;
+
+  for (u32 i = 0; i < MT_N_ITERS; i++) {
+    seed = seed * 1103515245 + 12345;
+    u8 use_cache = (seed >> 16) & 1;
+    if (n_held < MT_POOL_SIZE / MT_N_THREADS && ((seed >> 17) & 1)) {
+      mt_elem_t *e = (mt_elem_t *)(use_cache ?
+                                   memory_pool_mt_cache_alloc(&cache) :
+                                   memory_pool_mt_alloc(w->pool));
+      if (!e)
+        continue;
+      e->owner = w->id;
+      e->seq = i;
+      w->held[n_held++] = e;
+    } else if (n_held) {
+      mt_elem_t *e = w->held[--n_held];
+      /* Nobody else may have been handed this element meanwhile. */
+      if (e->owner != w->id)
+        w->errors++;
+      if (use_cache)
+        memory_pool_mt_cache_free(&cache, (element_t *)e);
+      else
+        memory_pool_mt_free(w->pool, (element_t *)e);
+    }
+  }
+  while (n_held) {
+    mt_elem_t *e = w->held[--n_held];
+    if (e->owner != w->id)
+      w->errors++;
+    memory_pool_mt_cache_free(&cache, (element_t *)e);
+  }
+  memory_pool_mt_cache_flush(&cache);
+  return NULL;
+}
+
+START_TEST(test_mt_threads)
+{
+  memory_pool_mt_t *pool = memory_pool_mt_new(MT_POOL_SIZE, sizeof(mt_elem_t));
+  mt_worker_t workers[MT_N_THREADS];
+  pthread_t threads[MT_N_THREADS];
+
+  for (u32 i = 0; i < MT_N_THREADS; i++) {
+    workers[i].pool = pool;
+    workers[i].id = i + 1;
+    workers[i].errors = 0;
+    fail_unless(pthread_create(&threads[i], NULL, mt_worker, &workers[i]) == 0,
+                "Failed to start thread");
+  }
+  for (u32 i = 0; i < MT_N_THREADS; i++) {
+    pthread_join(threads[i], NULL);
+    fail_unless(workers[i].errors == 0,
+                "Thread %u saw %u elements shared with another thread",
+                i, workers[i].errors);
+  }
+
+  fail_unless(memory_pool_mt_n_free(pool) == MT_POOL_SIZE,
+              "Elements lost, %u free", memory_pool_mt_n_free(pool));
+  fail_unless(check_free_list(pool) == MT_POOL_SIZE,
+              "Free list inconsistent with n_free");
+
+  memory_pool_mt_destroy(pool);
+}
+END_TEST
+
+Suite* memory_pool_mt_suite(void)
+{
+  Suite *s = suite_create("Thread-safe Memory Pools");
+
+  TCase *tc_core = tcase_create("Core");
+  tcase_add_test(tc_core, test_mt_alloc_free);
+  tcase_add_test(tc_core, test_mt_cache);
+  tcase_add_test(tc_core, test_mt_threads);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -214,6 +214,661 @@ START_TEST(test_rtcm3_encode_decode)
 }
 END_TEST
 
+START_TEST(test_rtcm3_encode_decode_1004)
+{
+  navigation_measurement_t nm_l1[22], nm_l2[22];
+  navigation_measurement_t nm_l1_out[22], nm_l2_out[22];
+  double lambda1 = 299792458.0 / 1.57542e9;
+  double lambda2 = 299792458.0 / 1.2276e9;
+
+  seed_rng();
+
+  for (u8 i=0; i<22; i++) {
+    nm_l1[i].prn = i;
+    nm_l1[i].raw_pseudorange = frand(19e6, 21e6);
+    nm_l1[i].carrier_phase = nm_l1[i].raw_pseudorange / lambda1 +
+                             frand(-100, 100);
+    nm_l1[i].lock_time = frand(0, 1000);
+    nm_l1[i].snr = frand(1, 20);
+    nm_l2[i].prn = i;
+    nm_l2[i].raw_pseudorange = nm_l1[i].raw_pseudorange + frand(-100, 100);
+    nm_l2[i].carrier_phase = nm_l2[i].raw_pseudorange / lambda2 +
+                             frand(-100, 100);
+    nm_l2[i].lock_time = frand(0, 1000);
+    nm_l2[i].snr = frand(1, 20);
+  }
+
+  gps_time_t t = {
+    .wn = 1234,
+    .tow = frand(0, 604800)
+  };
+
+  u8 buff[355];
+  u16 len = rtcm3_encode_1004(buff, 1234, t, 22, nm_l1, nm_l2, 1);
+  fail_unless(len == (64 + 22*125 + 7) / 8,
+      "encoded length %d, expected %d", len, (64 + 22*125 + 7) / 8);
+
+  double tow_out;
+  u8 sync, n_sat;
+  u16 id;
+
+  s8 ret = rtcm3_decode_1002(buff, &id, &tow_out, &n_sat, 0, &sync);
+  fail_unless(ret == -1, "rtcm3_decode_1002 should reject a 1004 message");
+
+  ret = rtcm3_decode_1004(buff, &id, &tow_out, &n_sat, nm_l1_out, nm_l2_out,
+                          &sync);
+  fail_unless(ret == 0, "rtcm3_decode_1004 returned an error (%d)", ret);
+  fail_unless(id == 1234 && n_sat == 22 && sync == 1,
+      "decoded header incorrectly");
+
+  for (u8 i=0; i<22; i++) {
+    fail_unless(nm_l1_out[i].prn == i && nm_l2_out[i].prn == i,
+        "[%d] PRNs not equal", i);
+
+    double err = nm_l1[i].raw_pseudorange - nm_l1_out[i].raw_pseudorange;
+    fail_unless(fabs(err) <= 0.01 + 1e-6,
+        "[%d] L1 pseudorange error %f", i, err);
+    err = nm_l2[i].raw_pseudorange - nm_l2_out[i].raw_pseudorange;
+    fail_unless(fabs(err) <= 0.02 + 1e-6,
+        "[%d] L2 pseudorange error %f", i, err);
+
+    err = nm_l1[i].carrier_phase - nm_l1_out[i].carrier_phase;
+    fail_unless(fabs(err) < 0.003,
+        "[%d] L1 carrier phase error %f", i, err);
+    err = nm_l2[i].carrier_phase - nm_l2_out[i].carrier_phase;
+    fail_unless(fabs(err) < 0.003,
+        "[%d] L2 carrier phase error %f", i, err);
+
+    fail_unless(nm_l2_out[i].lock_time <= nm_l2[i].lock_time,
+        "[%d] L2 lock time should be less than input lock time", i);
+    double err_bound = nm_l2[i].snr * (pow(10.0, 1.0 / 40.0) - 1);
+    fail_unless(fabs(nm_l2[i].snr - nm_l2_out[i].snr) < err_bound,
+        "[%d] L2 SNR error", i);
+  }
+
+  /* Without L2 observations they are sent as invalid. */
+  rtcm3_encode_1004(buff, 1234, t, 22, nm_l1, 0, 0);
+  ret = rtcm3_decode_1004(buff, &id, &tow_out, &n_sat, nm_l1_out, nm_l2_out,
+                          &sync);
+  fail_unless(ret == 0, "rtcm3_decode_1004 returned an error (%d)", ret);
+  for (u8 i=0; i<22; i++)
+    fail_unless(isnan(nm_l2_out[i].raw_pseudorange) &&
+                isnan(nm_l2_out[i].carrier_phase),
+        "[%d] invalid L2 observation not decoded as NAN", i);
+}
+END_TEST
+
+START_TEST(test_rtcm3_encode_decode_1005_1006)
+{
+  /* Test data taken from RTCM 10403.1 Document Example 4.2 */
+  u8 test_data[] = {
+    0x3E, 0xD7, 0xD3, 0x02, 0x02, 0x98, 0x0E, 0xDE, 0xEF, 0x34, 0xB4, 0xBD,
+    0x62, 0xAC, 0x09, 0x41, 0x98, 0x6F, 0x33
+  };
+
+  rtcm3_station_t s;
+  s8 ret = rtcm3_decode_1005(test_data, &s);
+  fail_unless(ret == 0, "rtcm3_decode_1005 returned an error (%d)", ret);
+  fail_unless(s.id == 2003 && s.gps == 1 && s.glo == 0 && s.gal == 0,
+      "decoded station header incorrectly");
+  fail_unless(fabs(s.pos[0] - 1114104.5999) < 1e-6 &&
+              fabs(s.pos[1] - -4850729.7108) < 1e-6 &&
+              fabs(s.pos[2] - 3975521.4643) < 1e-6,
+      "decoded position as %f, %f, %f", s.pos[0], s.pos[1], s.pos[2]);
+
+  u8 buff[21];
+  u16 len = rtcm3_encode_1005(buff, &s);
+  fail_unless(len == 19 && memcmp(buff, test_data, 19) == 0,
+      "re-encoded message 1005 differs from example");
+
+  fail_unless(rtcm3_decode_1006(buff, &s) == -1,
+      "rtcm3_decode_1006 should reject a 1005 message");
+
+  rtcm3_station_t s_in = {
+    .id = 4095, .itrf = 63, .gps = 1, .glo = 1, .gal = 0, .ref_station = 1,
+    .pos = {-2703115.9184, -4291767.2037, 3854247.9027},
+    .osc = 1, .quarter_cycle = 2, .height = 1.5432
+  };
+  len = rtcm3_encode_1006(buff, &s_in);
+  fail_unless(len == 21, "encoded length %d, expected 21", len);
+  ret = rtcm3_decode_1006(buff, &s);
+  fail_unless(ret == 0, "rtcm3_decode_1006 returned an error (%d)", ret);
+  fail_unless(s.id == s_in.id && s.itrf == s_in.itrf && s.gps == s_in.gps &&
+              s.glo == s_in.glo && s.gal == s_in.gal &&
+              s.ref_station == s_in.ref_station && s.osc == s_in.osc &&
+              s.quarter_cycle == s_in.quarter_cycle,
+      "decoded station flags incorrectly");
+  for (u8 i=0; i<3; i++)
+    fail_unless(fabs(s.pos[i] - s_in.pos[i]) < 1e-6,
+        "decoded pos[%d] as %f, expected %f", i, s.pos[i], s_in.pos[i]);
+  fail_unless(fabs(s.height - s_in.height) < 1e-6,
+      "decoded height as %f, expected %f", s.height, s_in.height);
+}
+END_TEST
+
+START_TEST(test_rtcm3_encode_decode_1019)
+{
+  seed_rng();
+
+  ephemeris_t e = {
+    .tgd = frand(-1e-8, 1e-8),
+    .crs = frand(-100, 100), .crc = frand(-300, 300),
+    .cuc = frand(-1e-5, 1e-5), .cus = frand(-1e-5, 1e-5),
+    .cic = frand(-1e-7, 1e-7), .cis = frand(-1e-7, 1e-7),
+    .dn = frand(-5e-9, 5e-9), .m0 = frand(-3, 3), .ecc = frand(0, 0.03),
+    .sqrta = frand(5150, 5160), .omega0 = frand(-3, 3),
+    .omegadot = frand(-1e-8, 1e-8), .w = frand(-3, 3), .inc = frand(0.9, 1),
+    .inc_dot = frand(-1e-10, 1e-10),
+    .af0 = frand(-1e-4, 1e-4), .af1 = frand(-1e-11, 1e-11), .af2 = 0,
+    .toe = {.tow = 16 * (u32)frand(0, 37800), .wn = 1800},
+    .toc = {.tow = 16 * (u32)frand(0, 37800), .wn = 1800},
+    .valid = 1, .healthy = 1
+  };
+
+  u8 buff[61];
+  u16 len = rtcm3_encode_1019(buff, 12, &e, 45, 301);
+  fail_unless(len == 61, "encoded length %d, expected 61", len);
+
+  ephemeris_t e_out;
+  u8 prn, iode;
+  u16 iodc;
+  s8 ret = rtcm3_decode_1019(buff, &prn, &e_out, &iode, &iodc);
+  fail_unless(ret == 0, "rtcm3_decode_1019 returned an error (%d)", ret);
+  fail_unless(prn == 12 && iode == 45 && iodc == 301,
+      "decoded PRN %d, IODE %d, IODC %d", prn, iode, iodc);
+  fail_unless(e_out.valid && e_out.healthy, "decoded health incorrectly");
+  fail_unless(e_out.toe.wn == 1800 % 1024 && e_out.toc.wn == 1800 % 1024,
+      "decoded week number %d", e_out.toe.wn);
+  fail_unless(e_out.toe.tow == e.toe.tow && e_out.toc.tow == e.toc.tow,
+      "decoded toe or toc incorrectly");
+
+  struct {
+    const char *name;
+    double in, out, scale;
+  } fields[] = {
+    {"tgd", e.tgd, e_out.tgd, pow(2, -31)},
+    {"crs", e.crs, e_out.crs, pow(2, -5)},
+    {"crc", e.crc, e_out.crc, pow(2, -5)},
+    {"cuc", e.cuc, e_out.cuc, pow(2, -29)},
+    {"cus", e.cus, e_out.cus, pow(2, -29)},
+    {"cic", e.cic, e_out.cic, pow(2, -29)},
+    {"cis", e.cis, e_out.cis, pow(2, -29)},
+    {"dn", e.dn, e_out.dn, pow(2, -43) * M_PI},
+    {"m0", e.m0, e_out.m0, pow(2, -31) * M_PI},
+    {"ecc", e.ecc, e_out.ecc, pow(2, -33)},
+    {"sqrta", e.sqrta, e_out.sqrta, pow(2, -19)},
+    {"omega0", e.omega0, e_out.omega0, pow(2, -31) * M_PI},
+    {"omegadot", e.omegadot, e_out.omegadot, pow(2, -43) * M_PI},
+    {"w", e.w, e_out.w, pow(2, -31) * M_PI},
+    {"inc", e.inc, e_out.inc, pow(2, -31) * M_PI},
+    {"inc_dot", e.inc_dot, e_out.inc_dot, pow(2, -43) * M_PI},
+    {"af0", e.af0, e_out.af0, pow(2, -31)},
+    {"af1", e.af1, e_out.af1, pow(2, -43)},
+    {"af2", e.af2, e_out.af2, pow(2, -55)},
+  };
+  for (u8 i=0; i<sizeof(fields)/sizeof(fields[0]); i++)
+    fail_unless(fabs(fields[i].in - fields[i].out) <= 0.5001*fields[i].scale,
+        "decoded %s as %g, expected %g", fields[i].name, fields[i].out,
+        fields[i].in);
+
+  e.healthy = 0;
+  rtcm3_encode_1019(buff, 31, &e, 0, 0);
+  rtcm3_decode_1019(buff, &prn, &e_out, 0, 0);
+  fail_unless(prn == 31 && !e_out.healthy, "decoded unhealthy SV incorrectly");
+}
+END_TEST
+
+/** Fill in an MSM message with test data. Satellite 10 has a single cell
+ * with no pseudorange and satellite 17 a cell with no phase range. */
+static void msm_test_data(rtcm3_msm_t *msm, u16 msg_type)
+{
+  const u8 sat_ids[] = {3, 10, 17, 32};
+
+  memset(msm, 0, sizeof(*msm));
+  msm->msg_type = msg_type;
+  msm->id = 2003;
+  msm->epoch = 345678000;
+  msm->multiple = 1;
+  msm->iods = 5;
+  msm->clk_steering = 1;
+  msm->ext_clk = 2;
+  msm->div_free = 1;
+  msm->smooth = 3;
+  msm->n_sats = 4;
+  for (u8 i=0; i<4; i++) {
+    msm->sats[i].id = sat_ids[i];
+    msm->sats[i].ext_info = msg_type % 10 == 7 ? i + 5 : 0;
+    double range = frand(20e6, 26e6);
+    double rate = frand(-800, 800);
+    for (u8 j=0; j<2; j++) {
+      if (i == 1 && j == 0)
+        continue;
+      rtcm3_msm_cell_t *c = &msm->cells[msm->n_cells++];
+      c->sat = sat_ids[i];
+      c->sig = j == 0 ? 2 : 15;
+      c->pseudorange = range + frand(-5, 5);
+      c->phase_range = range + frand(-5, 5);
+      c->phase_rate = msg_type % 10 == 7 ? rate + frand(-0.5, 0.5) : NAN;
+      c->lock = msg_type % 10 == 7 ? 700 + i : 10 + i;
+      c->half_cycle = j;
+      c->cnr = msg_type % 10 == 7 ? 45.0625 : 45;
+      if (i == 1)
+        c->pseudorange = NAN;
+      if (i == 2 && j == 1)
+        c->phase_range = NAN;
+    }
+  }
+}
+
+START_TEST(test_rtcm3_encode_decode_msm)
+{
+  seed_rng();
+
+  static rtcm3_msm_t msm, msm_out;
+  u8 buff[1023];
+
+  for (u8 k=0; k<2; k++) {
+    u16 msg_type = k == 0 ? 1074 : 1127;
+    double pr_res = (k == 0 ? pow(2, -24) : pow(2, -29)) * 299792.458;
+    double cp_res = (k == 0 ? pow(2, -29) : pow(2, -31)) * 299792.458;
+
+    msm_test_data(&msm, msg_type);
+    u16 len = rtcm3_encode_msm(buff, &msm);
+    fail_unless(len > 0, "rtcm3_encode_msm failed for %d", msg_type);
+
+    s8 ret = rtcm3_decode_msm(buff, &msm_out);
+    fail_unless(ret == 0, "rtcm3_decode_msm returned an error (%d)", ret);
+    fail_unless(msm_out.msg_type == msg_type && msm_out.id == msm.id &&
+                msm_out.epoch == msm.epoch &&
+                msm_out.multiple == msm.multiple && msm_out.iods == msm.iods &&
+                msm_out.clk_steering == msm.clk_steering &&
+                msm_out.ext_clk == msm.ext_clk &&
+                msm_out.div_free == msm.div_free &&
+                msm_out.smooth == msm.smooth,
+        "%d: decoded header incorrectly", msg_type);
+    fail_unless(msm_out.n_sats == msm.n_sats && msm_out.n_cells == msm.n_cells,
+        "%d: decoded %d sats and %d cells, expected %d and %d", msg_type,
+        msm_out.n_sats, msm_out.n_cells, msm.n_sats, msm.n_cells);
+
+    for (u8 i=0; i<msm.n_sats; i++)
+      fail_unless(msm_out.sats[i].id == msm.sats[i].id &&
+                  msm_out.sats[i].ext_info == msm.sats[i].ext_info,
+          "%d: [%d] decoded satellite incorrectly", msg_type, i);
+
+    for (u8 i=0; i<msm.n_cells; i++) {
+      rtcm3_msm_cell_t *c = &msm.cells[i], *c_out = &msm_out.cells[i];
+      fail_unless(c_out->sat == c->sat && c_out->sig == c->sig &&
+                  c_out->lock == c->lock &&
+                  c_out->half_cycle == c->half_cycle && c_out->cnr == c->cnr,
+          "%d: [%d] decoded cell incorrectly", msg_type, i);
+      fail_unless(isnan(c->pseudorange) ? isnan(c_out->pseudorange) :
+                  fabs(c->pseudorange - c_out->pseudorange) <= pr_res,
+          "%d: [%d] decoded pseudorange as %f, expected %f", msg_type, i,
+          c_out->pseudorange, c->pseudorange);
+      fail_unless(isnan(c->phase_range) ? isnan(c_out->phase_range) :
+                  fabs(c->phase_range - c_out->phase_range) <= cp_res,
+          "%d: [%d] decoded phase range as %f, expected %f", msg_type, i,
+          c_out->phase_range, c->phase_range);
+      fail_unless(isnan(c->phase_rate) ? isnan(c_out->phase_rate) :
+                  fabs(c->phase_rate - c_out->phase_rate) <= 0.0001,
+          "%d: [%d] decoded phase rate as %f, expected %f", msg_type, i,
+          c_out->phase_rate, c->phase_rate);
+    }
+  }
+
+  /* Invalid messages. */
+  msm_test_data(&msm, 1075);
+  fail_unless(rtcm3_encode_msm(buff, &msm) == 0,
+      "rtcm3_encode_msm should reject MSM5");
+
+  msm_test_data(&msm, 1077);
+  msm.sats[2].id = 2;
+  fail_unless(rtcm3_encode_msm(buff, &msm) == 0,
+      "rtcm3_encode_msm should reject unsorted satellites");
+
+  msm_test_data(&msm, 1077);
+  msm.cells[msm.n_cells - 1].sat = 31;
+  fail_unless(rtcm3_encode_msm(buff, &msm) == 0,
+      "rtcm3_encode_msm should reject a cell with no satellite");
+
+  msm_test_data(&msm, 1077);
+  for (u8 i=0; i<9; i++) {
+    msm.sats[i].id = i + 1;
+    msm.cells[i].sat = i + 1;
+    msm.cells[i].sig = i < 8 ? i + 1 : 2;
+  }
+  msm.n_sats = 9;
+  msm.n_cells = 9;
+  fail_unless(rtcm3_encode_msm(buff, &msm) == 0,
+      "rtcm3_encode_msm should reject more than 64 cells");
+
+  navigation_measurement_t nm[1] = {{.raw_pseudorange = 2e7, .snr = 10}};
+  gps_time_t t = {.wn = 1234, .tow = 100};
+  rtcm3_encode_1002(buff, 1234, t, 1, nm, 0);
+  fail_unless(rtcm3_decode_msm(buff, &msm_out) == -1,
+      "rtcm3_decode_msm should reject message 1002");
+}
+END_TEST
+
+START_TEST(test_rtcm3_encode_msm_saturate)
+{
+  seed_rng();
+
+  static rtcm3_msm_t msm, msm_out;
+  u8 buff[1023];
+
+  for (u8 k=0; k<2; k++) {
+    u16 msg_type = k == 0 ? 1074 : 1127;
+    double cnr_max = k == 0 ? 63 : 1023 / 16.0;
+    u16 lock_max = k == 0 ? 15 : 1023;
+
+    /* CNRs and lock time indicators past the end of their fields. */
+    msm_test_data(&msm, msg_type);
+    for (u8 i=0; i<msm.n_cells; i++) {
+      msm.cells[i].cnr = i % 2 ? 64 + 10*i : -1;
+      msm.cells[i].lock = lock_max + 1 + i;
+    }
+    fail_unless(rtcm3_encode_msm(buff, &msm) > 0,
+        "rtcm3_encode_msm failed for %d", msg_type);
+    fail_unless(rtcm3_decode_msm(buff, &msm_out) == 0,
+        "rtcm3_decode_msm failed for %d", msg_type);
+
+    for (u8 i=0; i<msm.n_cells; i++) {
+      rtcm3_msm_cell_t *c = &msm.cells[i], *c_out = &msm_out.cells[i];
+      fail_unless(c_out->cnr == (i % 2 ? cnr_max : 0) &&
+                  c_out->lock == lock_max,
+          "%d: [%d] CNR %f and lock %d not saturated", msg_type, i,
+          c_out->cnr, c_out->lock);
+      fail_unless(c_out->sat == c->sat && c_out->sig == c->sig &&
+                  c_out->half_cycle == c->half_cycle,
+          "%d: [%d] decoded cell incorrectly", msg_type, i);
+    }
+  }
+}
+END_TEST
+
+/** Append a 1002 or 1004 frame of `n_sat` random observations to `buf`.
+ * \return Length of the frame. */
+static u32 bulk_test_frame(u8 *buf, u16 type, u8 n_sat, double tow)
+{
+  navigation_measurement_t nm[31], nm_l2[31];
+  for (u8 i=0; i<n_sat; i++) {
+    nm[i].prn = i;
+    nm[i].raw_pseudorange = frand(19e6, 21e6);
+    nm[i].carrier_phase = nm[i].raw_pseudorange / (299792458.0 / 1.57542e9);
+    nm[i].lock_time = frand(0, 1000);
+    nm[i].snr = frand(1, 20);
+    nm_l2[i] = nm[i];
+  }
+  gps_time_t t = {.wn = 1234, .tow = tow};
+  u16 len = type == 1004 ?
+            rtcm3_encode_1004(&buf[3], 1234, t, n_sat, nm, nm_l2, 0) :
+            rtcm3_encode_1002(&buf[3], 1234, t, n_sat, nm, 0);
+  rtcm3_write_frame(len, buf);
+  return len + 6;
+}
+
+#define BULK_TEST_LEN 200000
+
+START_TEST(test_rtcm3_decode_obs_bulk)
+{
+  static u8 stream[BULK_TEST_LEN];
+  static double frame_buf[RTCM3_OBS_ARRAY_BUFF_SIZE(BULK_TEST_LEN / 9) /
+                          sizeof(double) + 1];
+  static double buff[RTCM3_OBS_ARRAY_BUFF_SIZE(BULK_TEST_LEN / 9) /
+                     sizeof(double) + 1];
+  static double ref_buff[RTCM3_OBS_ARRAY_BUFF_SIZE(BULK_TEST_LEN / 9) /
+                         sizeof(double) + 1];
+
+  seed_rng();
+
+  /* Expected observations, decoded a frame at a time. */
+  rtcm3_obs_array_t ref;
+  rtcm3_obs_array_init(&ref, BULK_TEST_LEN / 9, ref_buff);
+  u32 n_errors = 0;
+
+  u32 len = 0;
+  double tow = 0;
+  while (len < BULK_TEST_LEN - 2*RTCM3_MAX_FRAME_LEN) {
+    u32 kind = MIN(7, (u32)frand(0, 8));
+    if (kind == 0 &&
+        len + RTCM3_FRAME_LEN(0x155) < BULK_TEST_LEN - 2*RTCM3_MAX_FRAME_LEN) {
+      /* Noise, including a preamble. Its bogus frame must be complete so it
+       * is rejected by the CRC, a bogus frame running into the incomplete
+       * frame at the end would be skipped along with any noise within it
+       * as a single error. */
+      stream[len++] = 0xD3;
+      stream[len++] = 0x01;
+      stream[len++] = 0x55;
+      n_errors++;
+      continue;
+    }
+    if (kind <= 1) {
+      /* Other messages are skipped. */
+      rtcm3_station_t s = {.id = 1, .pos = {1, 2, 3}};
+      u16 n = rtcm3_encode_1005(&stream[len + 3], &s);
+      rtcm3_write_frame(n, &stream[len]);
+      len += n + 6;
+      continue;
+    }
+
+    u16 type = kind < 5 ? 1002 : 1004;
+    u8 n_sat = sizerand(31);
+    tow += 1;
+    u32 n = bulk_test_frame(&stream[len], type, n_sat, tow);
+
+    navigation_measurement_t nm[31], nm_l2[31];
+    u16 id;
+    double tow_out;
+    u8 n_sat_out, sync;
+    if (type == 1002)
+      rtcm3_decode_1002(&stream[len + 3], &id, &tow_out, &n_sat_out, nm,
+                        &sync);
+    else
+      rtcm3_decode_1004(&stream[len + 3], &id, &tow_out, &n_sat_out, nm,
+                        nm_l2, &sync);
+    for (u8 i=0; i<n_sat_out; i++) {
+      u32 k = ref.n_obs++;
+      ref.tow[k] = tow_out;
+      ref.prn[k] = nm[i].prn;
+      ref.pseudorange[k] = nm[i].raw_pseudorange;
+      ref.carrier_phase[k] = nm[i].carrier_phase;
+      ref.lock_time[k] = nm[i].lock_time;
+    }
+    ref.n_msgs++;
+    len += n;
+  }
+  /* Ends with a frame that is skipped and then an incomplete frame. */
+  rtcm3_station_t s = {.id = 2};
+  u16 n = rtcm3_encode_1006(&stream[len + 3], &s);
+  rtcm3_write_frame(n, &stream[len]);
+  len += n + 6;
+  u32 n_last = bulk_test_frame(&stream[len], 1002, 10, tow + 1);
+  len += n_last / 2;
+
+  rtcm3_obs_array_t a;
+  rtcm3_obs_array_init(&a, BULK_TEST_LEN / 9, buff);
+  u32 consumed = rtcm3_decode_obs_bulk(&a, stream, len);
+
+  fail_unless(consumed == len - n_last / 2,
+      "consumed %u bytes, expected %u", consumed, len - n_last / 2);
+  fail_unless(a.n_obs == ref.n_obs && a.n_msgs == ref.n_msgs &&
+              a.n_errors == n_errors,
+      "decoded %u obs from %u msgs with %u errors, expected %u, %u, %u",
+      a.n_obs, a.n_msgs, a.n_errors, ref.n_obs, ref.n_msgs, n_errors);
+  for (u32 k=0; k<a.n_obs; k++) {
+    fail_unless(a.tow[k] == ref.tow[k] && a.prn[k] == ref.prn[k] &&
+                a.pseudorange[k] == ref.pseudorange[k] &&
+                fabs(a.carrier_phase[k] - ref.carrier_phase[k]) < 1e-6 &&
+                a.lock_time[k] == ref.lock_time[k] &&
+                a.cnr[k] >= 0 && a.cnr[k] < 64,
+        "[%u] observation decoded incorrectly", k);
+  }
+
+  /* In pieces, passing on the bytes not consumed. */
+  rtcm3_obs_array_t b;
+  rtcm3_obs_array_init(&b, BULK_TEST_LEN / 9, frame_buf);
+  u32 pos = 0;
+  for (u32 end = 0; end < len; ) {
+    end = MIN(len, end + 1000);
+    pos += rtcm3_decode_obs_bulk(&b, &stream[pos], end - pos);
+  }
+  fail_unless(pos == consumed && b.n_obs == a.n_obs &&
+              memcmp(b.pseudorange, a.pseudorange,
+                     a.n_obs * sizeof(double)) == 0,
+      "decoding in pieces differs");
+
+  /* In parallel, results are identical. */
+  for (u32 n_threads=1; n_threads<=8; n_threads++) {
+    rtcm3_obs_array_init(&b, BULK_TEST_LEN / 9, frame_buf);
+    pos = rtcm3_decode_obs_bulk_parallel(&b, n_threads, stream, len);
+    fail_unless(pos == consumed && b.n_obs == a.n_obs &&
+                b.n_msgs == a.n_msgs && b.n_errors == a.n_errors,
+        "%u threads: consumed %u bytes, %u obs, %u msgs, %u errors",
+        n_threads, pos, b.n_obs, b.n_msgs, b.n_errors);
+    fail_unless(
+        memcmp(b.tow, a.tow, a.n_obs * sizeof(double)) == 0 &&
+        memcmp(b.pseudorange, a.pseudorange, a.n_obs * sizeof(double)) == 0 &&
+        memcmp(b.carrier_phase, a.carrier_phase,
+               a.n_obs * sizeof(double)) == 0 &&
+        memcmp(b.cnr, a.cnr, a.n_obs * sizeof(float)) == 0 &&
+        memcmp(b.lock_time, a.lock_time, a.n_obs * sizeof(u16)) == 0 &&
+        memcmp(b.prn, a.prn, a.n_obs) == 0,
+        "%u threads: observations differ", n_threads);
+  }
+
+  /* Stops before a frame that doesn't fit. */
+  rtcm3_obs_array_init(&b, 40, frame_buf);
+  pos = rtcm3_decode_obs_bulk(&b, stream, len);
+  fail_unless(b.n_obs <= 40 && b.n_obs + 31 > 40 && pos < len,
+      "decoded %u obs into an array of 40", b.n_obs);
+  rtcm3_obs_array_t c;
+  rtcm3_obs_array_init(&c, 40, buff);
+  u32 pos2 = rtcm3_decode_obs_bulk_parallel(&c, 4, stream, len);
+  fail_unless(pos2 == pos && c.n_obs == b.n_obs,
+      "parallel decode into a small array differs");
+}
+END_TEST
+
+u32 n_framer_msgs;
+u16 framer_types[16];
+u16 framer_lens[16];
+
+void framer_callback(u16 msg_type, u8 msg[], u16 len, void *context)
+{
+  (void)context;
+  /* The whole frame is available before the data message. */
+  fail_unless(msg[-3] == 0xD3 && rtcm3_check_frame(msg - 3) == len,
+      "Callback not passed a valid frame");
+  if (n_framer_msgs < 16) {
+    framer_types[n_framer_msgs] = msg_type;
+    framer_lens[n_framer_msgs] = len;
+  }
+  n_framer_msgs++;
+}
+
+u32 n_1002_msgs;
+
+void framer_1002_callback(u16 msg_type, u8 msg[], u16 len, void *context)
+{
+  (void)len;
+  fail_unless(msg_type == 1002 && *(u32 *)context == 0x1002,
+      "1002 callback called for the wrong message");
+  u16 id;
+  double tow;
+  u8 n_sat, sync;
+  fail_unless(rtcm3_decode_1002(msg, &id, &tow, &n_sat, 0, &sync) == 0 &&
+              id == 1234 && n_sat == 5,
+      "1002 message decoded incorrectly");
+  n_1002_msgs++;
+}
+
+START_TEST(test_rtcm3_framer)
+{
+  /* Build a stream of frames with noise, a corrupted frame and a false
+   * preamble whose length swallows the start of the next frame. */
+  u8 stream[512];
+  u32 n = 0;
+
+  /* Test data taken from RTCM 10403.1 Document Example 4.2 */
+  u8 example[] = {
+    0xD3, 0x00, 0x13,
+    0x3E, 0xD7, 0xD3, 0x02, 0x02, 0x98, 0x0E, 0xDE, 0xEF, 0x34, 0xB4, 0xBD,
+    0x62, 0xAC, 0x09, 0x41, 0x98, 0x6F, 0x33,
+    0x36, 0x0B, 0x98
+  };
+
+  navigation_measurement_t nm[5];
+  for (u8 i = 0; i < 5; i++) {
+    nm[i].prn = i;
+    nm[i].raw_pseudorange = 20e6 + i;
+    nm[i].carrier_phase = 1000 * i;
+    nm[i].lock_time = 10;
+    nm[i].snr = 10;
+  }
+  gps_time_t t = { .wn = 1234, .tow = 100 };
+  u8 frame_1002[64];
+  u16 len_1002 = rtcm3_encode_1002(&frame_1002[3], 1234, t, 5, nm, 0);
+  rtcm3_write_frame(len_1002, frame_1002);
+
+  u8 noise[] = { 0x00, 0xD3, 0x12, 0xD3, 0x00 };
+  memcpy(&stream[n], noise, sizeof(noise)); n += sizeof(noise);
+  memcpy(&stream[n], example, sizeof(example)); n += sizeof(example);
+  memcpy(&stream[n], frame_1002, RTCM3_FRAME_LEN(len_1002));
+  n += RTCM3_FRAME_LEN(len_1002);
+  /* Corrupted copy of the example. */
+  memcpy(&stream[n], example, sizeof(example));
+  stream[n + 10] ^= 0x01;
+  n += sizeof(example);
+  /* False preamble claiming a 16 byte message. */
+  u8 false_hdr[] = { 0xD3, 0x00, 0x10, 0x11 };
+  memcpy(&stream[n], false_hdr, sizeof(false_hdr)); n += sizeof(false_hdr);
+  memcpy(&stream[n], frame_1002, RTCM3_FRAME_LEN(len_1002));
+  n += RTCM3_FRAME_LEN(len_1002);
+  /* Empty frame. */
+  u8 empty[6];
+  rtcm3_write_frame(0, empty);
+  memcpy(&stream[n], empty, sizeof(empty)); n += sizeof(empty);
+  memcpy(&stream[n], example, sizeof(example)); n += sizeof(example);
+
+  rtcm3_framer_t f;
+  static rtcm3_msg_callbacks_node_t all_node, node_1002;
+  u32 context = 0x1002;
+
+  /* Feed the stream in chunks of every size. */
+  for (u32 chunk = 1; chunk <= n; chunk++) {
+    rtcm3_framer_init(&f);
+    fail_unless(rtcm3_framer_register_callback(&f, 1002, 0, 0, &node_1002)
+          == -1,
+        "Should return an error if cb is NULL");
+    rtcm3_framer_register_callback(&f, RTCM3_ALL_MSG_TYPES, &framer_callback,
+                                   0, &all_node);
+    rtcm3_framer_register_callback(&f, 1002, &framer_1002_callback,
+                                   &context, &node_1002);
+    n_framer_msgs = 0;
+    n_1002_msgs = 0;
+
+    s32 n_frames = 0;
+    for (u32 i = 0; i < n; i += chunk)
+      n_frames += rtcm3_framer_process(&f, &stream[i],
+                                       i + chunk <= n ? chunk : n - i);
+
+    fail_unless(n_frames == 5 && f.n_frames == 5,
+        "Chunk size %u: found %d frames, expected 5", chunk, n_frames);
+    fail_unless(n_framer_msgs == 5 && n_1002_msgs == 2,
+        "Chunk size %u: wrong callbacks", chunk);
+    fail_unless(framer_types[0] == 1005 && framer_lens[0] == 19 &&
+                framer_types[1] == 1002 && framer_types[2] == 1002 &&
+                framer_types[3] == 0 && framer_lens[3] == 0 &&
+                framer_types[4] == 1005,
+        "Chunk size %u: wrong frames found", chunk);
+    fail_unless(f.n_skipped == sizeof(noise) + sizeof(example) +
+                               sizeof(false_hdr),
+        "Chunk size %u: skipped %u bytes", chunk, f.n_skipped);
+    fail_unless(f.n_staged == 0, "Chunk size %u: data left staged", chunk);
+  }
+}
+END_TEST
 
 Suite* rtcm3_suite(void)
 {
@@ -224,6 +879,13 @@ Suite* rtcm3_suite(void)
   tcase_add_test(tc_core, test_rtcm3_write_frame);
   tcase_add_test(tc_core, test_rtcm3_read_write_header);
   tcase_add_test(tc_core, test_rtcm3_encode_decode);
+  tcase_add_test(tc_core, test_rtcm3_encode_decode_1004);
+  tcase_add_test(tc_core, test_rtcm3_encode_decode_1005_1006);
+  tcase_add_test(tc_core, test_rtcm3_encode_decode_1019);
+  tcase_add_test(tc_core, test_rtcm3_encode_decode_msm);
+  tcase_add_test(tc_core, test_rtcm3_encode_msm_saturate);
+  tcase_add_test(tc_core, test_rtcm3_framer);
+  tcase_add_test(tc_core, test_rtcm3_decode_obs_bulk);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -1,5 +1,6 @@
 
 #include <stdio.h>
+#include <string.h>
 #include <check.h>
 
 #include <sbp.h>
@@ -91,6 +92,15 @@ void logging_callback(u16 sender_id, u8 len, u8 msg[], void* context)
   /*printy_callback(sender_id, len, msg);*/
 }
 
+u16 last_msg_type;
+
+void logging_all_callback(u16 msg_type, u16 sender_id, u8 len, u8 msg[],
+                          void* context)
+{
+  last_msg_type = msg_type;
+  logging_callback(sender_id, len, msg, context);
+}
+
 void test_callback(u16 sender_id, u8 len, u8 msg[], void* context)
 {
   /* Do nothing. */
@@ -293,6 +303,143 @@ START_TEST(test_sbp_process)
 }
 END_TEST
 
+START_TEST(test_sbp_process_buffer)
+{
+  sbp_state_t s;
+  sbp_state_init(&s);
+
+  static sbp_msg_callbacks_node_t n;
+  sbp_register_callback(&s, 0x2269, &logging_callback,
+                        &DUMMY_MEMORY_FOR_CALLBACKS, &n);
+
+  /* A stream of messages with some line noise between them. */
+  u8 test_data[] = { 0x01, 0x02, 0x03, 0x04 };
+  u8 noise[] = { 0x00, 0x12, 0x34, 0xAA };
+
+  dummy_reset();
+  for (u8 i=0; i<6; i++) {
+    test_data[0] = i;
+    sbp_send_message(&s, 0x2269, 0x42, sizeof(test_data), test_data,
+                     &dummy_write);
+    sbp_send_message(&s, 0x2270, 0x42, 0, 0, &dummy_write);
+    sbp_send_message(&s, 0x2269, 0x43, 0, 0, &dummy_write);
+    if (i == 2)
+      dummy_write(noise, sizeof(noise), 0);
+  }
+  u32 stream_len = dummy_wr;
+
+  /* The whole stream in one call. */
+  logging_reset();
+  u32 consumed;
+  s32 ret = sbp_process_buffer(&s, dummy_buff, stream_len, &consumed);
+  fail_unless(ret == 18,
+      "sbp_process_buffer decoded %d messages, expected 18", ret);
+  fail_unless(consumed == stream_len,
+      "sbp_process_buffer consumed %u bytes, expected %u", consumed, stream_len);
+  fail_unless(n_callbacks_logged == 12,
+      "12 callbacks should have been logged, got %u", n_callbacks_logged);
+  fail_unless(last_sender_id == 0x43 && last_len == 0,
+      "last message decoded incorrectly");
+
+  /* Every split into two chunks gives the same messages. */
+  for (u32 split=0; split<=stream_len; split++) {
+    sbp_state_init(&s);
+    sbp_register_callback(&s, 0x2269, &logging_callback,
+                          &DUMMY_MEMORY_FOR_CALLBACKS, &n);
+    logging_reset();
+    ret = sbp_process_buffer(&s, dummy_buff, split, &consumed);
+    ret += sbp_process_buffer(&s, dummy_buff + split, stream_len - split, 0);
+    fail_unless(ret == 18 && n_callbacks_logged == 12,
+        "Split at %u decoded %d messages", split, ret);
+    fail_unless(consumed == split, "Split at %u not fully consumed", split);
+  }
+
+  /* One byte at a time, mixed with sbp_process. */
+  sbp_state_init(&s);
+  sbp_register_callback(&s, 0x2269, &logging_callback,
+                        &DUMMY_MEMORY_FOR_CALLBACKS, &n);
+  logging_reset();
+  ret = 0;
+  dummy_rd = 0;
+  while (dummy_rd < stream_len) {
+    if (dummy_rd % 3) {
+      ret += sbp_process_buffer(&s, dummy_buff + dummy_rd, 1, 0);
+      dummy_rd++;
+    } else {
+      ret += sbp_process(&s, &dummy_read_single_byte) > 0;
+    }
+  }
+  fail_unless(ret == 18 && n_callbacks_logged == 12,
+      "Byte by byte decoded %d messages", ret);
+  fail_unless(memcmp(last_msg, test_data, sizeof(test_data)) == 0,
+      "test data decoded incorrectly");
+
+  /* A corrupt message stops processing just after it. */
+  dummy_buff[13] ^= 0xFF;
+  sbp_state_init(&s);
+  ret = sbp_process_buffer(&s, dummy_buff, stream_len, &consumed);
+  fail_unless(ret == SBP_CRC_ERROR,
+      "sbp_process_buffer should return SBP_CRC_ERROR, got %d", ret);
+  fail_unless(consumed == 20,
+      "sbp_process_buffer should stop after the bad message, at %u", consumed);
+  ret = sbp_process_buffer(&s, dummy_buff + consumed, stream_len - consumed,
+                           &consumed);
+  fail_unless(ret == 16, "Remaining messages not decoded, got %d", ret);
+}
+END_TEST
+
+u8 *last_msg_ptr;
+
+void pointer_callback(u16 sender_id, u8 len, u8 msg[], void* context)
+{
+  last_msg_ptr = msg;
+  logging_callback(sender_id, len, msg, context);
+}
+
+START_TEST(test_sbp_zero_copy)
+{
+  sbp_state_t s;
+  sbp_state_init(&s);
+  sbp_state_set_zero_copy(&s, 1);
+
+  static sbp_msg_callbacks_node_t n;
+  sbp_register_callback(&s, 0x2269, &pointer_callback, 0, &n);
+
+  u8 test_data[] = { 0x01, 0x02, 0x03, 0x04 };
+  dummy_reset();
+  sbp_send_message(&s, 0x2269, 0x42, sizeof(test_data), test_data,
+                   &dummy_write);
+  sbp_send_message(&s, 0x2269, 0x42, sizeof(test_data), test_data,
+                   &dummy_write);
+
+  /* A whole message is passed straight from the buffer. */
+  logging_reset();
+  fail_unless(sbp_process_buffer(&s, dummy_buff, 12, 0) == 1,
+      "Message not decoded");
+  fail_unless(last_msg_ptr == dummy_buff + 6,
+      "Zero-copy callback not passed a pointer into the buffer");
+  fail_unless(memcmp(last_msg, test_data, sizeof(test_data)) == 0,
+      "test data decoded incorrectly");
+
+  /* A split message has to be staged. */
+  sbp_process_buffer(&s, dummy_buff + 12, 8, 0);
+  fail_unless(sbp_process_buffer(&s, dummy_buff + 20, 4, 0) == 1,
+      "Split message not decoded");
+  fail_unless(last_msg_ptr == s.msg_buff,
+      "Split message not passed from the staging buffer");
+  fail_unless(memcmp(last_msg, test_data, sizeof(test_data)) == 0,
+      "test data decoded incorrectly (2)");
+
+  /* And with zero-copy off the payload is always staged. */
+  sbp_state_set_zero_copy(&s, 0);
+  fail_unless(sbp_process_buffer(&s, dummy_buff, 12, 0) == 1,
+      "Message not decoded (2)");
+  fail_unless(last_msg_ptr == s.msg_buff,
+      "Payload not copied with zero-copy off");
+  fail_unless(n_callbacks_logged == 3, "Wrong number of callbacks");
+}
+END_TEST
+
 START_TEST(test_sbp_send_message)
 {
   /* TODO: Tests with different write function behaviour. */
@@ -416,6 +563,200 @@ START_TEST(test_callbacks)
 }
 END_TEST
 
+START_TEST(test_sbp_tx_buffer)
+{
+  sbp_state_t s;
+  sbp_state_init(&s);
+
+  u8 payloads[5][4];
+  u8 frames[5][SBP_FRAME_LEN(4)];
+  for (u8 i = 0; i < 5; i++) {
+    for (u8 j = 0; j < 4; j++)
+      payloads[i][j] = 16*i + j;
+    fail_unless(sbp_encode_message(0x2269 + i, 0x42, 4, payloads[i], frames[i])
+          == SBP_FRAME_LEN(4),
+        "sbp_encode_message returned wrong length");
+  }
+
+  /* An encoded frame is the same as one sent with sbp_send_message. */
+  dummy_reset();
+  sbp_send_message(&s, 0x2269, 0x42, 4, payloads[0], &dummy_write);
+  fail_unless(dummy_wr == SBP_FRAME_LEN(4) &&
+              memcmp(dummy_buff, frames[0], dummy_wr) == 0,
+      "sbp_encode_message and sbp_send_message differ");
+
+  /* Fill the buffer, the last message doesn't fit. */
+  u8 buff[50];
+  sbp_tx_buffer_t tx;
+  sbp_tx_buffer_init(&tx, buff, sizeof(buff));
+  for (u8 i = 0; i < 4; i++)
+    fail_unless(sbp_tx_buffer_add(&tx, 0x2269 + i, 0x42, 4, payloads[i])
+          == SBP_OK,
+        "sbp_tx_buffer_add failed");
+  fail_unless(sbp_tx_buffer_add(&tx, 0x2269 + 4, 0x42, 4, payloads[4])
+        == SBP_SEND_ERROR,
+      "sbp_tx_buffer_add should fail when the buffer is full");
+  fail_unless(sbp_tx_buffer_pending(&tx) == 4 * SBP_FRAME_LEN(4),
+      "Wrong number of bytes pending");
+  fail_unless(sbp_tx_buffer_add(&tx, 0x2269, 0x42, 1, 0) == SBP_NULL_ERROR,
+      "sbp_tx_buffer_add should return an error if payload is NULL");
+
+  /* All the messages are written in one call. */
+  dummy_reset();
+  fail_unless(sbp_tx_buffer_flush(&tx, &dummy_write, 0) == SBP_OK,
+      "sbp_tx_buffer_flush failed");
+  fail_unless(dummy_wr == 4 * SBP_FRAME_LEN(4) &&
+              memcmp(dummy_buff, frames, dummy_wr) == 0,
+      "Flushed data incorrect");
+  fail_unless(sbp_tx_buffer_pending(&tx) == 0,
+      "Data still pending after flush");
+
+  /* Messages wrapping around the end of the buffer. */
+  for (u8 i = 0; i < 3; i++)
+    sbp_tx_buffer_add(&tx, 0x2269 + i, 0x42, 4, payloads[i]);
+  sbp_tx_buffer_consume(&tx, 2 * SBP_FRAME_LEN(4));
+  sbp_tx_buffer_add(&tx, 0x2269 + 3, 0x42, 4, payloads[3]);
+  sbp_tx_buffer_add(&tx, 0x2269 + 4, 0x42, 4, payloads[4]);
+
+  sbp_tx_segment_t seg[2];
+  fail_unless(sbp_tx_buffer_peek(&tx, seg) == 2,
+      "Wrapped data should be returned in two segments");
+  fail_unless(seg[0].data == buff + 2 * SBP_FRAME_LEN(4) &&
+              seg[0].len + seg[1].len == 3 * SBP_FRAME_LEN(4) &&
+              seg[1].data == buff,
+      "Wrong segments returned");
+
+  dummy_reset();
+  fail_unless(sbp_tx_buffer_flush(&tx, &dummy_write, 0) == SBP_OK,
+      "sbp_tx_buffer_flush failed (2)");
+  fail_unless(memcmp(dummy_buff, frames[2], 3 * SBP_FRAME_LEN(4)) == 0,
+      "Wrapped data incorrect");
+
+  static sbp_msg_all_callbacks_node_t all;
+  sbp_register_all_callback(&s, &logging_all_callback, 0, &all);
+  logging_reset();
+  fail_unless(sbp_process_buffer(&s, dummy_buff, dummy_wr, 0) == 3,
+      "Wrapped messages not decoded");
+  fail_unless(memcmp(last_msg, payloads[4], 4) == 0,
+      "Wrapped message payload incorrect");
+  fail_unless(last_msg_type == 0x2269 + 4,
+      "Wrapped message type incorrect");
+
+  /* A partial write leaves the rest pending. */
+  sbp_tx_buffer_add(&tx, 0x2269, 0x42, 4, payloads[0]);
+  dummy_reset();
+  fail_unless(sbp_tx_buffer_flush(&tx, &dummy_write_single_byte, 0)
+        == SBP_SEND_ERROR,
+      "sbp_tx_buffer_flush should return an error on a partial write");
+  fail_unless(sbp_tx_buffer_pending(&tx) == SBP_FRAME_LEN(4) - 1,
+      "Written byte not released");
+  fail_unless(sbp_tx_buffer_flush(&tx, &dummy_write, 0) == SBP_OK &&
+              memcmp(dummy_buff, frames[0], SBP_FRAME_LEN(4)) == 0,
+      "Flush did not resume after partial write");
+}
+END_TEST
+
+u32 n_counted[4];
+u16 all_msg_types[4];
+
+void counting_callback(u16 sender_id, u8 len, u8 msg[], void* context)
+{
+  (void)sender_id; (void)len; (void)msg;
+  n_counted[*(u8 *)context]++;
+}
+
+void counting_all_callback(u16 msg_type, u16 sender_id, u8 len, u8 msg[],
+                           void* context)
+{
+  if (n_counted[*(u8 *)context] < 4)
+    all_msg_types[n_counted[*(u8 *)context]] = msg_type;
+  counting_callback(sender_id, len, msg, context);
+}
+
+START_TEST(test_callback_table)
+{
+  sbp_state_t s;
+  sbp_state_init(&s);
+
+  /* Register enough message types that buckets must be shared, spread over
+   * a few classes as the real message types are. */
+  static sbp_msg_callbacks_node_t nodes[4][64];
+  for (u16 c = 0; c < 4; c++)
+    for (u16 i = 0; i < 64; i++)
+      fail_unless(sbp_register_callback(&s, (c << 8) | i, &test_callback, 0,
+                                        &nodes[c][i]) == SBP_OK,
+          "Could not register callback 0x%04X", (c << 8) | i);
+
+  for (u16 c = 0; c < 4; c++)
+    for (u16 i = 0; i < 64; i++)
+      fail_unless(sbp_find_callback(&s, (c << 8) | i) == &nodes[c][i],
+          "sbp_find_callback returned wrong node for 0x%04X", (c << 8) | i);
+  fail_unless(sbp_find_callback(&s, 0x0440) == 0,
+      "sbp_find_callback should return NULL if callback not registered");
+
+  /* Several subscribers to one type and a catch-all, in registration
+   * order. */
+  sbp_clear_callbacks(&s);
+  static sbp_msg_callbacks_node_t a, b;
+  static sbp_msg_all_callbacks_node_t all;
+  u8 ids[] = {0, 1, 2};
+  memset(n_counted, 0, sizeof(n_counted));
+
+  fail_unless(sbp_add_callback(&s, 0x2269, 0, 0, &a) == SBP_NULL_ERROR,
+      "sbp_add_callback should return an error if cb is NULL");
+  fail_unless(sbp_register_all_callback(&s, &counting_all_callback, 0, 0)
+        == SBP_NULL_ERROR,
+      "sbp_register_all_callback should return an error if node is NULL");
+
+  fail_unless(sbp_register_callback(&s, 0x2269, &counting_callback, &ids[0],
+                                    &a) == SBP_OK,
+      "Could not register first callback");
+  fail_unless(sbp_add_callback(&s, 0x2269, &counting_callback, &ids[1], &b)
+        == SBP_OK,
+      "Could not add second callback");
+  fail_unless(sbp_register_all_callback(&s, &counting_all_callback, &ids[2],
+                                        &all)
+        == SBP_OK,
+      "Could not register catch-all callback");
+  fail_unless(sbp_find_callback(&s, 0x2269) == &a,
+      "sbp_find_callback should return the first callback registered");
+
+  u8 test_data[] = { 0x01, 0x02, 0x03, 0x04 };
+  dummy_reset();
+  sbp_send_message(&s, 0x2269, 0x42, sizeof(test_data), test_data,
+                   &dummy_write);
+  sbp_send_message(&s, 0x2270, 0x42, sizeof(test_data), test_data,
+                   &dummy_write);
+
+  fail_unless(sbp_process_buffer(&s, dummy_buff, dummy_wr, 0) == 2,
+      "Messages not decoded");
+  fail_unless(n_counted[0] == 1 && n_counted[1] == 1,
+      "Each subscriber should be called once");
+  fail_unless(n_counted[2] == 2,
+      "Catch-all should be called for every message");
+  fail_unless(all_msg_types[0] == 0x2269 && all_msg_types[1] == 0x2270,
+      "Catch-all passed the wrong message types");
+
+  /* A message only seen by the catch-all still counts as handled. */
+  dummy_rd = 0;
+  dummy_wr = 12;
+  s8 ret;
+  while ((ret = sbp_process(&s, &dummy_read)) == SBP_OK)
+    ;
+  fail_unless(ret == SBP_OK_CALLBACK_EXECUTED,
+      "Catch-all callback should count as executed");
+  fail_unless(n_counted[0] == 2 && n_counted[2] == 3,
+      "Wrong callbacks called from sbp_process");
+
+  sbp_clear_callbacks(&s);
+  fail_unless(sbp_find_callback(&s, 0x2269) == 0,
+      "sbp_find_callback should return NULL after clearing callbacks");
+  fail_unless(sbp_process_buffer(&s, dummy_buff, dummy_wr, 0) == 1
+        && n_counted[2] == 3,
+      "Catch-all not cleared");
+}
+END_TEST
+
 Suite* sbp_suite(void)
 {
   Suite *s = suite_create("SBP");
@@ -426,6 +767,10 @@ Suite* sbp_suite(void)
   tcase_add_test(tc_core, test_callbacks);
   tcase_add_test(tc_core, test_sbp_send_message);
   tcase_add_test(tc_core, test_sbp_process);
+  tcase_add_test(tc_core, test_sbp_process_buffer);
+  tcase_add_test(tc_core, test_sbp_zero_copy);
+  tcase_add_test(tc_core, test_callback_table);
+  tcase_add_test(tc_core, test_sbp_tx_buffer);
 
   suite_add_tcase(s, tc_core);
 
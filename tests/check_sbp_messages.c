@@ -0,0 +1,531 @@
+/* Generated by sbp_generate/generate.py from sbp.yaml, do not edit. */
+
+#include <string.h>
+#include <check.h>
+
+#include <sbp_messages.h>
+
+START_TEST(test_sbp_startup)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0,
+  };
+  sbp_startup_t msg = {
+    .reserved = 4039878273u,
+  };
+  sbp_startup_t out;
+  u8 buf[SBP_STARTUP_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_STARTUP_LEN,
+    "SBP_STARTUP_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_STARTUP_LEN,
+    "sbp_startup_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_startup(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_STARTUP_LEN) == 0,
+    "sbp_encode_startup output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_startup(&out, &buf[1]);
+  fail_unless(out.reserved == msg.reserved,
+    "sbp_decode_startup reserved does not match");
+
+  fail_unless(sbp_validate_startup(payload, SBP_STARTUP_LEN) == 0,
+    "sbp_validate_startup rejected a valid payload");
+  fail_unless(sbp_validate_startup(payload, SBP_STARTUP_LEN - 1) == -1,
+    "sbp_validate_startup accepted a short payload");
+}
+END_TEST
+
+START_TEST(test_sbp_heartbeat)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0,
+  };
+  sbp_heartbeat_t msg = {
+    .flags = 4039878273u,
+  };
+  sbp_heartbeat_t out;
+  u8 buf[SBP_HEARTBEAT_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_HEARTBEAT_LEN,
+    "SBP_HEARTBEAT_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_HEARTBEAT_LEN,
+    "sbp_heartbeat_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_heartbeat(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_HEARTBEAT_LEN) == 0,
+    "sbp_encode_heartbeat output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_heartbeat(&out, &buf[1]);
+  fail_unless(out.flags == msg.flags,
+    "sbp_decode_heartbeat flags does not match");
+
+  fail_unless(sbp_validate_heartbeat(payload, SBP_HEARTBEAT_LEN) == 0,
+    "sbp_validate_heartbeat rejected a valid payload");
+  fail_unless(sbp_validate_heartbeat(payload, SBP_HEARTBEAT_LEN - 1) == -1,
+    "sbp_validate_heartbeat accepted a short payload");
+}
+END_TEST
+
+START_TEST(test_sbp_gps_time)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0, 0x15, 0x3A, 0x5F, 0x84, 0xA9, 0xCE, 0xF3,
+  };
+  sbp_gps_time_t msg = {
+    .wn = 42625,
+    .tow = 974516427u,
+    .ns = -827751329,
+    .flags = 243,
+  };
+  sbp_gps_time_t out;
+  u8 buf[SBP_GPS_TIME_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_GPS_TIME_LEN,
+    "SBP_GPS_TIME_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_GPS_TIME_LEN,
+    "sbp_gps_time_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_gps_time(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_GPS_TIME_LEN) == 0,
+    "sbp_encode_gps_time output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_gps_time(&out, &buf[1]);
+  fail_unless(out.wn == msg.wn,
+    "sbp_decode_gps_time wn does not match");
+  fail_unless(out.tow == msg.tow,
+    "sbp_decode_gps_time tow does not match");
+  fail_unless(out.ns == msg.ns,
+    "sbp_decode_gps_time ns does not match");
+  fail_unless(out.flags == msg.flags,
+    "sbp_decode_gps_time flags does not match");
+
+  fail_unless(sbp_validate_gps_time(payload, SBP_GPS_TIME_LEN) == 0,
+    "sbp_validate_gps_time rejected a valid payload");
+  fail_unless(sbp_validate_gps_time(payload, SBP_GPS_TIME_LEN - 1) == -1,
+    "sbp_validate_gps_time accepted a short payload");
+}
+END_TEST
+
+START_TEST(test_sbp_dops)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0, 0x15, 0x3A, 0x5F, 0x84, 0xA9, 0xCE, 0xF3, 0x18,
+    0x3D, 0x62,
+  };
+  sbp_dops_t msg = {
+    .tow = 4039878273u,
+    .gdop = 14869,
+    .pdop = 33887,
+    .tdop = 52905,
+    .hdop = 6387,
+    .vdop = 25149,
+  };
+  sbp_dops_t out;
+  u8 buf[SBP_DOPS_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_DOPS_LEN,
+    "SBP_DOPS_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_DOPS_LEN,
+    "sbp_dops_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_dops(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_DOPS_LEN) == 0,
+    "sbp_encode_dops output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_dops(&out, &buf[1]);
+  fail_unless(out.tow == msg.tow,
+    "sbp_decode_dops tow does not match");
+  fail_unless(out.gdop == msg.gdop,
+    "sbp_decode_dops gdop does not match");
+  fail_unless(out.pdop == msg.pdop,
+    "sbp_decode_dops pdop does not match");
+  fail_unless(out.tdop == msg.tdop,
+    "sbp_decode_dops tdop does not match");
+  fail_unless(out.hdop == msg.hdop,
+    "sbp_decode_dops hdop does not match");
+  fail_unless(out.vdop == msg.vdop,
+    "sbp_decode_dops vdop does not match");
+
+  fail_unless(sbp_validate_dops(payload, SBP_DOPS_LEN) == 0,
+    "sbp_validate_dops rejected a valid payload");
+  fail_unless(sbp_validate_dops(payload, SBP_DOPS_LEN - 1) == -1,
+    "sbp_validate_dops accepted a short payload");
+}
+END_TEST
+
+START_TEST(test_sbp_pos_ecef)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4A, 0xA3, 0xC0,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xEF, 0xAC, 0x40, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x4A, 0xB3, 0xC0, 0x8D, 0xB2, 0xD7, 0x01,
+  };
+  sbp_pos_ecef_t msg = {
+    .tow = 4039878273u,
+    .x = -2469.0,
+    .y = 3703.5,
+    .z = -4938.0,
+    .accuracy = 45709,
+    .n_sats = 215,
+    .flags = 1,
+  };
+  sbp_pos_ecef_t out;
+  u8 buf[SBP_POS_ECEF_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_POS_ECEF_LEN,
+    "SBP_POS_ECEF_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_POS_ECEF_LEN,
+    "sbp_pos_ecef_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_pos_ecef(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_POS_ECEF_LEN) == 0,
+    "sbp_encode_pos_ecef output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_pos_ecef(&out, &buf[1]);
+  fail_unless(out.tow == msg.tow,
+    "sbp_decode_pos_ecef tow does not match");
+  fail_unless(out.x == msg.x,
+    "sbp_decode_pos_ecef x does not match");
+  fail_unless(out.y == msg.y,
+    "sbp_decode_pos_ecef y does not match");
+  fail_unless(out.z == msg.z,
+    "sbp_decode_pos_ecef z does not match");
+  fail_unless(out.accuracy == msg.accuracy,
+    "sbp_decode_pos_ecef accuracy does not match");
+  fail_unless(out.n_sats == msg.n_sats,
+    "sbp_decode_pos_ecef n_sats does not match");
+  fail_unless(out.flags == msg.flags,
+    "sbp_decode_pos_ecef flags does not match");
+
+  fail_unless(sbp_validate_pos_ecef(payload, SBP_POS_ECEF_LEN) == 0,
+    "sbp_validate_pos_ecef rejected a valid payload");
+  fail_unless(sbp_validate_pos_ecef(payload, SBP_POS_ECEF_LEN - 1) == -1,
+    "sbp_validate_pos_ecef accepted a short payload");
+
+  msg.flags = 2;
+  sbp_encode_pos_ecef(buf, &msg);
+  fail_unless(sbp_validate_pos_ecef(buf, SBP_POS_ECEF_LEN) == -2,
+    "sbp_validate_pos_ecef accepted flags = 2");
+  msg.flags = 1;
+}
+END_TEST
+
+START_TEST(test_sbp_pos_llh)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4A, 0xA3, 0xC0,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xEF, 0xAC, 0x40, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x4A, 0xB3, 0xC0, 0x8D, 0xB2, 0xD7, 0xFC, 0x21, 0x01,
+  };
+  sbp_pos_llh_t msg = {
+    .tow = 4039878273u,
+    .lat = -2469.0,
+    .lon = 3703.5,
+    .height = -4938.0,
+    .h_accuracy = 45709,
+    .v_accuracy = 64727,
+    .n_sats = 33,
+    .flags = 1,
+  };
+  sbp_pos_llh_t out;
+  u8 buf[SBP_POS_LLH_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_POS_LLH_LEN,
+    "SBP_POS_LLH_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_POS_LLH_LEN,
+    "sbp_pos_llh_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_pos_llh(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_POS_LLH_LEN) == 0,
+    "sbp_encode_pos_llh output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_pos_llh(&out, &buf[1]);
+  fail_unless(out.tow == msg.tow,
+    "sbp_decode_pos_llh tow does not match");
+  fail_unless(out.lat == msg.lat,
+    "sbp_decode_pos_llh lat does not match");
+  fail_unless(out.lon == msg.lon,
+    "sbp_decode_pos_llh lon does not match");
+  fail_unless(out.height == msg.height,
+    "sbp_decode_pos_llh height does not match");
+  fail_unless(out.h_accuracy == msg.h_accuracy,
+    "sbp_decode_pos_llh h_accuracy does not match");
+  fail_unless(out.v_accuracy == msg.v_accuracy,
+    "sbp_decode_pos_llh v_accuracy does not match");
+  fail_unless(out.n_sats == msg.n_sats,
+    "sbp_decode_pos_llh n_sats does not match");
+  fail_unless(out.flags == msg.flags,
+    "sbp_decode_pos_llh flags does not match");
+
+  fail_unless(sbp_validate_pos_llh(payload, SBP_POS_LLH_LEN) == 0,
+    "sbp_validate_pos_llh rejected a valid payload");
+  fail_unless(sbp_validate_pos_llh(payload, SBP_POS_LLH_LEN - 1) == -1,
+    "sbp_validate_pos_llh accepted a short payload");
+
+  msg.flags = 2;
+  sbp_encode_pos_llh(buf, &msg);
+  fail_unless(sbp_validate_pos_llh(buf, SBP_POS_LLH_LEN) == -2,
+    "sbp_validate_pos_llh accepted flags = 2");
+  msg.flags = 1;
+}
+END_TEST
+
+START_TEST(test_sbp_baseline_ecef)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0, 0x15, 0x3A, 0x5F, 0x84, 0xA9, 0xCE, 0xF3, 0x18,
+    0x3D, 0x62, 0x87, 0xAC, 0xD1, 0xF6, 0x1B, 0x01,
+  };
+  sbp_baseline_ecef_t msg = {
+    .tow = 4039878273u,
+    .x = -2074133995,
+    .y = 418631337,
+    .z = -1400413635,
+    .accuracy = 63185,
+    .n_sats = 27,
+    .flags = 1,
+  };
+  sbp_baseline_ecef_t out;
+  u8 buf[SBP_BASELINE_ECEF_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_BASELINE_ECEF_LEN,
+    "SBP_BASELINE_ECEF_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_BASELINE_ECEF_LEN,
+    "sbp_baseline_ecef_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_baseline_ecef(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_BASELINE_ECEF_LEN) == 0,
+    "sbp_encode_baseline_ecef output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_baseline_ecef(&out, &buf[1]);
+  fail_unless(out.tow == msg.tow,
+    "sbp_decode_baseline_ecef tow does not match");
+  fail_unless(out.x == msg.x,
+    "sbp_decode_baseline_ecef x does not match");
+  fail_unless(out.y == msg.y,
+    "sbp_decode_baseline_ecef y does not match");
+  fail_unless(out.z == msg.z,
+    "sbp_decode_baseline_ecef z does not match");
+  fail_unless(out.accuracy == msg.accuracy,
+    "sbp_decode_baseline_ecef accuracy does not match");
+  fail_unless(out.n_sats == msg.n_sats,
+    "sbp_decode_baseline_ecef n_sats does not match");
+  fail_unless(out.flags == msg.flags,
+    "sbp_decode_baseline_ecef flags does not match");
+
+  fail_unless(sbp_validate_baseline_ecef(payload, SBP_BASELINE_ECEF_LEN) == 0,
+    "sbp_validate_baseline_ecef rejected a valid payload");
+  fail_unless(sbp_validate_baseline_ecef(payload, SBP_BASELINE_ECEF_LEN - 1) == -1,
+    "sbp_validate_baseline_ecef accepted a short payload");
+
+  msg.flags = 2;
+  sbp_encode_baseline_ecef(buf, &msg);
+  fail_unless(sbp_validate_baseline_ecef(buf, SBP_BASELINE_ECEF_LEN) == -2,
+    "sbp_validate_baseline_ecef accepted flags = 2");
+  msg.flags = 1;
+}
+END_TEST
+
+START_TEST(test_sbp_baseline_ned)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0, 0x15, 0x3A, 0x5F, 0x84, 0xA9, 0xCE, 0xF3, 0x18,
+    0x3D, 0x62, 0x87, 0xAC, 0xD1, 0xF6, 0x1B, 0x40, 0x65, 0x01,
+  };
+  sbp_baseline_ned_t msg = {
+    .tow = 4039878273u,
+    .n = -2074133995,
+    .e = 418631337,
+    .d = -1400413635,
+    .h_accuracy = 63185,
+    .v_accuracy = 16411,
+    .n_sats = 101,
+    .flags = 1,
+  };
+  sbp_baseline_ned_t out;
+  u8 buf[SBP_BASELINE_NED_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_BASELINE_NED_LEN,
+    "SBP_BASELINE_NED_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_BASELINE_NED_LEN,
+    "sbp_baseline_ned_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_baseline_ned(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_BASELINE_NED_LEN) == 0,
+    "sbp_encode_baseline_ned output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_baseline_ned(&out, &buf[1]);
+  fail_unless(out.tow == msg.tow,
+    "sbp_decode_baseline_ned tow does not match");
+  fail_unless(out.n == msg.n,
+    "sbp_decode_baseline_ned n does not match");
+  fail_unless(out.e == msg.e,
+    "sbp_decode_baseline_ned e does not match");
+  fail_unless(out.d == msg.d,
+    "sbp_decode_baseline_ned d does not match");
+  fail_unless(out.h_accuracy == msg.h_accuracy,
+    "sbp_decode_baseline_ned h_accuracy does not match");
+  fail_unless(out.v_accuracy == msg.v_accuracy,
+    "sbp_decode_baseline_ned v_accuracy does not match");
+  fail_unless(out.n_sats == msg.n_sats,
+    "sbp_decode_baseline_ned n_sats does not match");
+  fail_unless(out.flags == msg.flags,
+    "sbp_decode_baseline_ned flags does not match");
+
+  fail_unless(sbp_validate_baseline_ned(payload, SBP_BASELINE_NED_LEN) == 0,
+    "sbp_validate_baseline_ned rejected a valid payload");
+  fail_unless(sbp_validate_baseline_ned(payload, SBP_BASELINE_NED_LEN - 1) == -1,
+    "sbp_validate_baseline_ned accepted a short payload");
+
+  msg.flags = 2;
+  sbp_encode_baseline_ned(buf, &msg);
+  fail_unless(sbp_validate_baseline_ned(buf, SBP_BASELINE_NED_LEN) == -2,
+    "sbp_validate_baseline_ned accepted flags = 2");
+  msg.flags = 1;
+}
+END_TEST
+
+START_TEST(test_sbp_vel_ecef)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0, 0x15, 0x3A, 0x5F, 0x84, 0xA9, 0xCE, 0xF3, 0x18,
+    0x3D, 0x62, 0x87, 0xAC, 0xD1, 0xF6, 0x1B, 0x40,
+  };
+  sbp_vel_ecef_t msg = {
+    .tow = 4039878273u,
+    .x = -2074133995,
+    .y = 418631337,
+    .z = -1400413635,
+    .accuracy = 63185,
+    .n_sats = 27,
+    .flags = 64,
+  };
+  sbp_vel_ecef_t out;
+  u8 buf[SBP_VEL_ECEF_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_VEL_ECEF_LEN,
+    "SBP_VEL_ECEF_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_VEL_ECEF_LEN,
+    "sbp_vel_ecef_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_vel_ecef(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_VEL_ECEF_LEN) == 0,
+    "sbp_encode_vel_ecef output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_vel_ecef(&out, &buf[1]);
+  fail_unless(out.tow == msg.tow,
+    "sbp_decode_vel_ecef tow does not match");
+  fail_unless(out.x == msg.x,
+    "sbp_decode_vel_ecef x does not match");
+  fail_unless(out.y == msg.y,
+    "sbp_decode_vel_ecef y does not match");
+  fail_unless(out.z == msg.z,
+    "sbp_decode_vel_ecef z does not match");
+  fail_unless(out.accuracy == msg.accuracy,
+    "sbp_decode_vel_ecef accuracy does not match");
+  fail_unless(out.n_sats == msg.n_sats,
+    "sbp_decode_vel_ecef n_sats does not match");
+  fail_unless(out.flags == msg.flags,
+    "sbp_decode_vel_ecef flags does not match");
+
+  fail_unless(sbp_validate_vel_ecef(payload, SBP_VEL_ECEF_LEN) == 0,
+    "sbp_validate_vel_ecef rejected a valid payload");
+  fail_unless(sbp_validate_vel_ecef(payload, SBP_VEL_ECEF_LEN - 1) == -1,
+    "sbp_validate_vel_ecef accepted a short payload");
+}
+END_TEST
+
+START_TEST(test_sbp_vel_ned)
+{
+  const u8 payload[] = {
+    0x81, 0xA6, 0xCB, 0xF0, 0x15, 0x3A, 0x5F, 0x84, 0xA9, 0xCE, 0xF3, 0x18,
+    0x3D, 0x62, 0x87, 0xAC, 0xD1, 0xF6, 0x1B, 0x40, 0x65, 0x8A,
+  };
+  sbp_vel_ned_t msg = {
+    .tow = 4039878273u,
+    .n = -2074133995,
+    .e = 418631337,
+    .d = -1400413635,
+    .h_accuracy = 63185,
+    .v_accuracy = 16411,
+    .n_sats = 101,
+    .flags = 138,
+  };
+  sbp_vel_ned_t out;
+  u8 buf[SBP_VEL_NED_LEN + 1];
+
+  fail_unless(sizeof(payload) == SBP_VEL_NED_LEN,
+    "SBP_VEL_NED_LEN does not match the payload");
+  fail_unless(sizeof(msg) == SBP_VEL_NED_LEN,
+    "sbp_vel_ned_t does not match the payload");
+
+  /* Encode to an odd address to check unaligned access. */
+  sbp_encode_vel_ned(&buf[1], &msg);
+  fail_unless(memcmp(&buf[1], payload, SBP_VEL_NED_LEN) == 0,
+    "sbp_encode_vel_ned output does not match the payload");
+
+  memset(&out, 0, sizeof(out));
+  sbp_decode_vel_ned(&out, &buf[1]);
+  fail_unless(out.tow == msg.tow,
+    "sbp_decode_vel_ned tow does not match");
+  fail_unless(out.n == msg.n,
+    "sbp_decode_vel_ned n does not match");
+  fail_unless(out.e == msg.e,
+    "sbp_decode_vel_ned e does not match");
+  fail_unless(out.d == msg.d,
+    "sbp_decode_vel_ned d does not match");
+  fail_unless(out.h_accuracy == msg.h_accuracy,
+    "sbp_decode_vel_ned h_accuracy does not match");
+  fail_unless(out.v_accuracy == msg.v_accuracy,
+    "sbp_decode_vel_ned v_accuracy does not match");
+  fail_unless(out.n_sats == msg.n_sats,
+    "sbp_decode_vel_ned n_sats does not match");
+  fail_unless(out.flags == msg.flags,
+    "sbp_decode_vel_ned flags does not match");
+
+  fail_unless(sbp_validate_vel_ned(payload, SBP_VEL_NED_LEN) == 0,
+    "sbp_validate_vel_ned rejected a valid payload");
+  fail_unless(sbp_validate_vel_ned(payload, SBP_VEL_NED_LEN - 1) == -1,
+    "sbp_validate_vel_ned accepted a short payload");
+}
+END_TEST
+
+Suite* sbp_messages_suite(void)
+{
+  Suite *s = suite_create("SBP messages");
+
+  TCase *tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_sbp_startup);
+  tcase_add_test(tc_core, test_sbp_heartbeat);
+  tcase_add_test(tc_core, test_sbp_gps_time);
+  tcase_add_test(tc_core, test_sbp_dops);
+  tcase_add_test(tc_core, test_sbp_pos_ecef);
+  tcase_add_test(tc_core, test_sbp_pos_llh);
+  tcase_add_test(tc_core, test_sbp_baseline_ecef);
+  tcase_add_test(tc_core, test_sbp_baseline_ned);
+  tcase_add_test(tc_core, test_sbp_vel_ecef);
+  tcase_add_test(tc_core, test_sbp_vel_ned);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include <math.h>
+#include <string.h>
+#include <check.h>
+
+#include <cblas.h>
+#include <lapacke.h>
+
+#include "check_utils.h"
+
+#include <small_matrix.h>
+
+#define SMAT_TOL 1e-9
+#define SMAT_NUM 22
+#define mrand frand(-1, 1)
+
+/* Kernels are compared against the reference BLAS / LAPACK routine they
+ * replace, on random matrices of every size up to SMAT_MAX_DIM. */
+
+static void rand_mtx(u32 m, u32 n, double *A)
+{
+  for (u32 i = 0; i < m * n; i++)
+    A[i] = mrand;
+}
+
+/* Random symmetric positive definite matrix, A = B B^T + n I. */
+static void rand_spd(u32 n, double *A)
+{
+  double B[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  rand_mtx(n, n, B);
+  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, n, n, n,
+              1, B, n, B, n, 0, A, n);
+  for (u32 i = 0; i < n; i++)
+    A[i*n + i] += n;
+}
+
+/* Random unit upper triangular matrix with junk in the diagonal and lower
+ * triangle, which the kernels must not read. */
+static void rand_unit_upper(u32 n, double *U)
+{
+  rand_mtx(n, n, U);
+  for (u32 i = 0; i < n; i++)
+    U[i*n + i] = 1e3;
+}
+
+static void check_close(u32 n, const double *a, const double *b,
+                        const char *what)
+{
+  for (u32 i = 0; i < n; i++)
+    fail_unless(fabs(a[i] - b[i]) < SMAT_TOL * MAX(1, fabs(b[i])),
+                "%s differs from reference at %u: %lf vs %lf",
+                what, i, a[i], b[i]);
+}
+
+START_TEST(test_smat_gemv) {
+  double A[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double x[SMAT_MAX_DIM], y[SMAT_MAX_DIM], y_ref[SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    u32 m = sizerand(SMAT_MAX_DIM);
+    u32 n = sizerand(SMAT_MAX_DIM);
+    rand_mtx(m, n, A);
+    rand_mtx(1, n, x);
+    rand_mtx(1, m, y);
+    memcpy(y_ref, y, m * sizeof(double));
+    smat_gemv(m, n, -0.5, A, x, 1.5, y);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, m, n, -0.5, A, n, x, 1,
+                1.5, y_ref, 1);
+    check_close(m, y, y_ref, "gemv");
+
+    /* beta == 0 must not read y. */
+    for (u32 i = 0; i < m; i++)
+      y[i] = NAN;
+    smat_gemv(m, n, 1, A, x, 0, y);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, m, n, 1, A, n, x, 1,
+                0, y_ref, 1);
+    check_close(m, y, y_ref, "gemv beta = 0");
+  }
+}
+END_TEST
+
+START_TEST(test_smat_symv) {
+  double A[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double x[SMAT_MAX_DIM], y[SMAT_MAX_DIM], y_ref[SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    u32 n = sizerand(SMAT_MAX_DIM);
+    rand_mtx(n, n, A);
+    rand_mtx(1, n, x);
+    smat_symv_upper(n, A, x, y);
+    cblas_dsymv(CblasRowMajor, CblasUpper, n, 1, A, n, x, 1, 0, y_ref, 1);
+    check_close(n, y, y_ref, "symv");
+  }
+}
+END_TEST
+
+START_TEST(test_smat_trmv) {
+  double U[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double x[SMAT_MAX_DIM], x_ref[SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    u32 n = sizerand(SMAT_MAX_DIM);
+    rand_unit_upper(n, U);
+
+    rand_mtx(1, n, x);
+    memcpy(x_ref, x, n * sizeof(double));
+    smat_trmv_unit_upper(n, U, x);
+    cblas_dtrmv(CblasRowMajor, CblasUpper, CblasNoTrans, CblasUnit,
+                n, U, n, x_ref, 1);
+    check_close(n, x, x_ref, "trmv");
+
+    rand_mtx(1, n, x);
+    memcpy(x_ref, x, n * sizeof(double));
+    smat_trmv_unit_upper_t(n, U, x);
+    cblas_dtrmv(CblasRowMajor, CblasUpper, CblasTrans, CblasUnit,
+                n, U, n, x_ref, 1);
+    check_close(n, x, x_ref, "trmv transposed");
+  }
+}
+END_TEST
+
+START_TEST(test_smat_trmm_trtri) {
+  double U[SMAT_MAX_DIM * SMAT_MAX_DIM], U_ref[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double B[SMAT_MAX_DIM * SMAT_MAX_DIM], B_ref[SMAT_MAX_DIM * SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    u32 m = sizerand(SMAT_MAX_DIM);
+    u32 n = sizerand(SMAT_MAX_DIM);
+    rand_unit_upper(m, U);
+
+    rand_mtx(m, n, B);
+    memcpy(B_ref, B, m * n * sizeof(double));
+    smat_trmm_unit_upper(m, n, U, B);
+    cblas_dtrmm(CblasRowMajor, CblasLeft, CblasUpper, CblasNoTrans, CblasUnit,
+                m, n, 1, U, m, B_ref, n);
+    check_close(m * n, B, B_ref, "trmm");
+
+    memcpy(U_ref, U, m * m * sizeof(double));
+    smat_trtri_unit_upper(m, U);
+    LAPACKE_dtrtri(LAPACK_ROW_MAJOR, 'U', 'U', m, U_ref, m);
+    for (u32 i = 0; i < m; i++)
+      for (u32 j = i + 1; j < m; j++)
+        fail_unless(fabs(U[i*m + j] - U_ref[i*m + j])
+                      < SMAT_TOL * MAX(1, fabs(U_ref[i*m + j])),
+                    "trtri differs from reference at (%u, %u)", i, j);
+    for (u32 i = 0; i < m; i++)
+      fail_unless(U[i*m + i] == 1e3, "trtri wrote the diagonal");
+  }
+}
+END_TEST
+
+START_TEST(test_smat_symm_gemm) {
+  double A[SMAT_MAX_DIM * SMAT_MAX_DIM], B[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double C[SMAT_MAX_DIM * SMAT_MAX_DIM], C_ref[SMAT_MAX_DIM * SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    u32 m = sizerand(SMAT_MAX_DIM);
+    u32 n = sizerand(SMAT_MAX_DIM);
+    u32 k = sizerand(SMAT_MAX_DIM);
+
+    rand_mtx(n, n, A);
+    rand_mtx(m, n, B);
+    smat_symm_right_upper(m, n, 2, A, B, C);
+    cblas_dsymm(CblasRowMajor, CblasRight, CblasUpper, m, n,
+                2, A, n, B, n, 0, C_ref, n);
+    check_close(m * n, C, C_ref, "symm");
+
+    rand_mtx(m, k, A);
+    rand_mtx(n, k, B);
+    smat_gemm_nt(m, n, k, 2, A, B, C);
+    cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, m, n, k,
+                2, A, k, B, k, 0, C_ref, n);
+    check_close(m * n, C, C_ref, "gemm");
+  }
+}
+END_TEST
+
+START_TEST(test_smat_spd_inverse) {
+  double A[SMAT_MAX_DIM * SMAT_MAX_DIM], A_ref[SMAT_MAX_DIM * SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    u32 n = sizerand(SMAT_MAX_DIM);
+    rand_spd(n, A);
+    memcpy(A_ref, A, n * n * sizeof(double));
+    fail_unless(smat_spd_inverse(n, A) == 0, "SPD matrix reported singular");
+    LAPACKE_dpotrf(LAPACK_ROW_MAJOR, 'U', n, A_ref, n);
+    LAPACKE_dpotri(LAPACK_ROW_MAJOR, 'U', n, A_ref, n);
+    for (u32 i = 0; i < n; i++)
+      for (u32 j = 0; j < i; j++)
+        A_ref[i*n + j] = A_ref[j*n + i];
+    check_close(n * n, A, A_ref, "spd_inverse");
+  }
+
+  double N[4] = {1, 2, 2, 1};
+  fail_unless(smat_spd_inverse(2, N) < 0, "Indefinite matrix not detected");
+}
+END_TEST
+
+START_TEST(test_smat_qr) {
+  double A[SMAT_MAX_DIM * SMAT_MAX_DIM], QR[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double Q[SMAT_MAX_DIM * SMAT_MAX_DIM], tau[SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    u32 m = sizerand(SMAT_MAX_DIM);
+    u32 n = sizerand(SMAT_MAX_DIM);
+    rand_mtx(m, n, A);
+    memcpy(QR, A, m * n * sizeof(double));
+    smat_qr(m, n, QR, tau);
+    smat_qr_q(m, n, QR, tau, Q);
+
+    for (u32 i = 0; i < m; i++) {
+      for (u32 j = 0; j < m; j++) {
+        double qtq = 0;
+        for (u32 k = 0; k < m; k++)
+          qtq += Q[k*m + i] * Q[k*m + j];
+        fail_unless(fabs(qtq - (i == j)) < SMAT_TOL,
+                    "Q not orthogonal at (%u, %u): %lf", i, j, qtq);
+      }
+    }
+    for (u32 i = 0; i < m; i++) {
+      for (u32 j = 0; j < n; j++) {
+        double qr = 0;
+        for (u32 k = 0; k <= MIN(j, m - 1); k++)
+          qr += Q[i*m + k] * QR[k*n + j];
+        fail_unless(fabs(qr - A[i*n + j]) < SMAT_TOL,
+                    "QR differs from A at (%u, %u)", i, j);
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_smat_lstsq) {
+  double A[SMAT_MAX_DIM * SMAT_MAX_DIM], A_ref[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double b[SMAT_MAX_DIM], x[SMAT_MAX_DIM], x_ref[SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    /* Covers the DE geometry shapes used by the filters, both over and
+     * underdetermined. */
+    u32 m = sizerand(SMAT_MAX_DIM);
+    u32 n = (t % 2) ? 3 : sizerand(SMAT_MAX_DIM);
+    rand_mtx(m, n, A);
+    rand_mtx(1, m, b);
+    fail_unless(smat_lstsq(m, n, A, b, x) == 0,
+                "Random matrix reported rank deficient");
+
+    memcpy(A_ref, A, m * n * sizeof(double));
+    memset(x_ref, 0, sizeof(x_ref));
+    memcpy(x_ref, b, m * sizeof(double));
+    LAPACKE_dgels(LAPACK_ROW_MAJOR, 'N', m, n, 1, A_ref, n, x_ref, 1);
+    check_close(n, x, x_ref, "lstsq");
+  }
+
+  /* Rank deficient: the second column duplicates the first. */
+  double D[6] = {1, 1, 2, 2, 3, 3};
+  double d[3] = {1, 2, 3};
+  fail_unless(smat_lstsq(3, 2, D, d, x) < 0, "Rank deficiency not detected");
+}
+END_TEST
+
+START_TEST(test_smat_lu) {
+  double A[SMAT_MAX_DIM * SMAT_MAX_DIM], A_ref[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double LU[SMAT_MAX_DIM * SMAT_MAX_DIM];
+  double x[SMAT_MAX_DIM], x_ref[SMAT_MAX_DIM];
+  u8 piv[SMAT_MAX_DIM];
+  lapack_int ipiv[SMAT_MAX_DIM];
+
+  seed_rng();
+  for (u32 t = 0; t < SMAT_NUM; t++) {
+    u32 n = sizerand(SMAT_MAX_DIM);
+    rand_mtx(n, n, A);
+    memcpy(LU, A, n * n * sizeof(double));
+    memcpy(A_ref, A, n * n * sizeof(double));
+    fail_unless(smat_lu(n, LU, piv) == 0, "Random matrix reported singular");
+    LAPACKE_dgetrf(LAPACK_ROW_MAJOR, n, n, A_ref, n, ipiv);
+
+    for (u8 trans = 0; trans < 2; trans++) {
+      rand_mtx(1, n, x);
+      memcpy(x_ref, x, n * sizeof(double));
+      smat_lu_solve(n, LU, piv, trans, x);
+      LAPACKE_dgetrs(LAPACK_ROW_MAJOR, trans ? 'T' : 'N', n, 1, A_ref, n,
+                     ipiv, x_ref, 1);
+      check_close(n, x, x_ref, "lu_solve");
+    }
+  }
+
+  double S[4] = {1, 2, 2, 4};
+  fail_unless(smat_lu(2, S, piv) < 0, "Singular matrix not detected");
+}
+END_TEST
+
+Suite* small_matrix_suite(void) {
+  Suite *s = suite_create("Small matrix");
+
+  TCase *tc_core = tcase_create("Core");
+  tcase_add_test(tc_core, test_smat_gemv);
+  tcase_add_test(tc_core, test_smat_symv);
+  tcase_add_test(tc_core, test_smat_trmv);
+  tcase_add_test(tc_core, test_smat_trmm_trtri);
+  tcase_add_test(tc_core, test_smat_symm_gemm);
+  tcase_add_test(tc_core, test_smat_spd_inverse);
+  tcase_add_test(tc_core, test_smat_qr);
+  tcase_add_test(tc_core, test_smat_lstsq);
+  tcase_add_test(tc_core, test_smat_lu);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -8,10 +8,15 @@ Suite* coord_system_suite(void);
 Suite* rtcm3_suite(void);
 Suite* bits_suite(void);
 Suite* memory_pool_suite(void);
+Suite* memory_pool_mt_suite(void);
+Suite* memory_pool_dense_suite(void);
 Suite* sbp_suite(void);
+Suite* sbp_messages_suite(void);
 Suite* edc_suite(void);
 Suite* linear_algebra_suite(void);
 Suite* ambiguity_test_suite(void);
+Suite* lambda_suite(void);
+Suite* small_matrix_suite(void);
 
 #endif /* CHECK_SUITES_H */
 